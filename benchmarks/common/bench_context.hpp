@@ -0,0 +1,221 @@
+#ifndef VINKAN_BENCH_CONTEXT_HPP
+#define VINKAN_BENCH_CONTEXT_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <vinkan/vinkan.hpp>
+
+// Same portability setup as the compute example
+#include "../../examples/compute/m_series_portability.hpp"
+#include "bench_stats.hpp"
+
+enum class BenchQueue { COMPUTE_QUEUE };
+enum class BenchTransferCommand { COPY };
+enum class BenchTransferPool { POOL };
+enum class BenchTransferFence { FENCE };
+enum class BenchTransferSemaphore {};
+
+// Headless compute setup shared by the benchmarks (no validation layers so
+// that they don't pollute the timings)
+struct BenchContext {
+  std::unique_ptr<vinkan::Instance> instance;
+  std::unique_ptr<vinkan::PhysicalDevice> physicalDevice;
+  std::unique_ptr<vinkan::Device<BenchQueue>> device;
+  VkQueue queue;
+  uint32_t queueFamilyIndex;
+  // Staging copies of uploadBuffer and readBuffer
+  std::unique_ptr<
+      vinkan::CommandCoordinator<BenchTransferCommand, BenchTransferPool>>
+      transferCoordinator;
+  std::unique_ptr<
+      vinkan::SyncMechanisms<BenchTransferFence, BenchTransferSemaphore>>
+      transferSync;
+
+  // The extra instance extensions are added to the portability ones
+  explicit BenchContext(uint32_t apiVersion = VK_API_VERSION_1_2,
+                        std::vector<const char *> extraExtensions = {}) {
+    vinkan::InstanceInfo instanceInfo{
+        .appName = "Vinkan benchmark",
+        .appVersion = {.major = 0, .minor = 0, .patch = 1},
+        .engineName = "Vinkan benchmark",
+        .engineVersion = {.major = 0, .minor = 0, .patch = 1},
+        .apiVersion = apiVersion,
+        .validationLayers = {},
+        .includePortabilityExtensions = NEED_PORTABILITY_EXTENSIONS,
+        .extraVkExtensions = extraExtensions};
+    instance = std::make_unique<vinkan::Instance>(instanceInfo);
+
+    vinkan::PhysicalDeviceInfo physicalDeviceInfo{
+        .requestedQueueFlags = {VK_QUEUE_COMPUTE_BIT},
+        .surfaceSupportRequested = std::nullopt,
+        .extensions = DEVICE_EXTENSIONS};
+    physicalDevice = std::make_unique<vinkan::PhysicalDevice>(
+        physicalDeviceInfo, instance->getHandle());
+  }
+
+  // The builder is exposed so that each benchmark can enable what it needs
+  template <typename ConfigureT>
+  void createDevice(ConfigureT configure) {
+    vinkan::Device<BenchQueue>::Builder deviceBuilder(
+        physicalDevice->getHandle(), physicalDevice->getQueues());
+    deviceBuilder.addExtensions(DEVICE_EXTENSIONS);
+    vinkan::QueueFamilyRequest<BenchQueue> queueRequest{
+        .queueFamilyIdentifier = BenchQueue::COMPUTE_QUEUE,
+        .flagsRequested = VK_QUEUE_COMPUTE_BIT,
+        .surfacePresentationSupport = std::nullopt,
+        .nQueues = 1,
+        .queuePriorities = {1.0}};
+    bool success = false;
+    deviceBuilder.addQueue(queueRequest, true, success);
+    assert(success);
+    configure(deviceBuilder);
+    device = deviceBuilder.build();
+    queue = device->getQueue(BenchQueue::COMPUTE_QUEUE, 0);
+    queueFamilyIndex = device->getQueueFamilyIndex(BenchQueue::COMPUTE_QUEUE);
+
+    transferCoordinator = std::make_unique<
+        vinkan::CommandCoordinator<BenchTransferCommand, BenchTransferPool>>(
+        device->getHandle());
+    transferCoordinator->createCommandPool(BenchTransferPool::POOL,
+                                           queueFamilyIndex, false);
+    transferCoordinator->createLongLivedCommand(BenchTransferCommand::COPY,
+                                                BenchTransferPool::POOL);
+    transferSync = std::make_unique<
+        vinkan::SyncMechanisms<BenchTransferFence, BenchTransferSemaphore>>(
+        device->getHandle());
+    transferSync->createFence(BenchTransferFence::FENCE);
+  }
+
+  void createDevice() {
+    createDevice([](vinkan::Device<BenchQueue>::Builder &) {});
+  }
+
+  // Copies the start of the source to the destination and waits for it. The
+  // barriers order the copy after the previous submissions and before the
+  // next ones and the host reads.
+  void copyBuffer(VkBuffer source, VkBuffer destination, VkDeviceSize size) {
+    transferCoordinator->resetCommandBuffer(BenchTransferCommand::COPY);
+    VkCommandBuffer commandBuffer =
+        transferCoordinator->beginCommandBuffer(BenchTransferCommand::COPY);
+    VkMemoryBarrier barrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                            .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+                            .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT |
+                                             VK_ACCESS_TRANSFER_WRITE_BIT};
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0,
+                         nullptr, 0, nullptr);
+    VkBufferCopy region{.size = size};
+    vkCmdCopyBuffer(commandBuffer, source, destination, 1, &region);
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT |
+                            VK_ACCESS_MEMORY_WRITE_BIT |
+                            VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT |
+                             VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+    transferCoordinator->endCommandBuffer(commandBuffer);
+
+    VkFence fence = transferSync->getFence(BenchTransferFence::FENCE);
+    transferCoordinator->submitCommandBuffer(
+        commandBuffer,
+        vinkan::SubmitCommandBufferInfo{.signalFence = fence, .queue = queue});
+    vkWaitForFences(device->getHandle(), 1, &fence, VK_TRUE, UINT64_MAX);
+    vkResetFences(device->getHandle(), 1, &fence);
+  }
+};
+
+// Storage buffer of the kernel libraries, accessed through its device
+// address. Device local so that the timings don't depend on host memory, it's
+// written and read with uploadBuffer and readBuffer.
+inline std::unique_ptr<vinkan::Buffer> createBuffer(BenchContext &context,
+                                                    VkDeviceSize size) {
+  return std::make_unique<vinkan::Buffer>(
+      context.device->getHandle(),
+      context.physicalDevice->getMemoryProperties(),
+      vinkan::BufferInfo{
+          .instanceSize = std::max<VkDeviceSize>(size, sizeof(uint32_t)),
+          .instanceCount = 1,
+          .usageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+                        VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+          .sharingMode = {.value = VK_SHARING_MODE_EXCLUSIVE},
+          .memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT});
+}
+
+inline vinkan::Buffer createStagingBuffer(BenchContext &context,
+                                          VkDeviceSize size) {
+  return vinkan::Buffer(
+      context.device->getHandle(),
+      context.physicalDevice->getMemoryProperties(),
+      vinkan::BufferInfo{
+          .instanceSize = std::max<VkDeviceSize>(size, sizeof(uint32_t)),
+          .instanceCount = 1,
+          .usageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+          .sharingMode = {.value = VK_SHARING_MODE_EXCLUSIVE},
+          .memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT});
+}
+
+// Writes the start of a createBuffer buffer through a staging buffer
+inline void uploadBuffer(BenchContext &context, vinkan::Buffer &buffer,
+                         const void *data, VkDeviceSize size) {
+  vinkan::Buffer staging = createStagingBuffer(context, size);
+  staging.map();
+  std::memcpy(staging.getMappedMemory(), data, size);
+  staging.unmap();
+  context.copyBuffer(staging.getHandle(), buffer.getHandle(), size);
+}
+
+// Reads the start of a createBuffer buffer through a staging buffer
+inline void readBuffer(BenchContext &context, vinkan::Buffer &buffer,
+                       void *data, VkDeviceSize size) {
+  vinkan::Buffer staging = createStagingBuffer(context, size);
+  context.copyBuffer(buffer.getHandle(), staging.getHandle(), size);
+  staging.map();
+  std::memcpy(data, staging.getMappedMemory(), size);
+  staging.unmap();
+}
+
+// Submits a recorded command buffer and waits for its fence, returns the
+// microseconds from the submission to the fence
+template <typename CommandCoordinatorT>
+double submitAndWait(BenchContext &context, CommandCoordinatorT &coordinator,
+                     VkCommandBuffer commandBuffer, VkFence fence) {
+  VkDevice device = context.device->getHandle();
+  BenchTimer timer;
+  coordinator.submitCommandBuffer(
+      commandBuffer, vinkan::SubmitCommandBufferInfo{.signalFence = fence,
+                                                     .queue = context.queue});
+  vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+  double elapsedUs = timer.elapsedUs();
+  vkResetFences(device, 1, &fence);
+  return elapsedUs;
+}
+
+// Kernel benchmarks record a command buffer once and resubmit it, a sample is
+// one submission up to its fence. Returns the samples in microseconds, the
+// warmup submissions are dropped.
+template <typename CommandCoordinatorT>
+std::vector<double> timeSubmissions(BenchContext &context,
+                                    CommandCoordinatorT &coordinator,
+                                    VkCommandBuffer commandBuffer,
+                                    VkFence fence, uint32_t warmupIterations,
+                                    uint32_t iterations) {
+  std::vector<double> samples{};
+  for (uint32_t i = 0; i < warmupIterations + iterations; ++i) {
+    double elapsedUs =
+        submitAndWait(context, coordinator, commandBuffer, fence);
+    if (i >= warmupIterations) {
+      samples.push_back(elapsedUs);
+    }
+  }
+  return samples;
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef VINKAN_BENCH_STATS_HPP
+#define VINKAN_BENCH_STATS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <string>
+#include <vector>
+
+struct BenchStats {
+  double min;
+  double mean;
+  double p50;
+  double p99;
+  double max;
+};
+
+inline BenchStats computeStats(std::vector<double> samples) {
+  if (samples.empty()) {
+    return {};
+  }
+  std::sort(samples.begin(), samples.end());
+  auto percentile = [&](double p) {
+    auto index = static_cast<size_t>(p * (samples.size() - 1));
+    return samples[index];
+  };
+  double sum = std::accumulate(samples.begin(), samples.end(), 0.);
+  return {.min = samples.front(),
+          .mean = sum / samples.size(),
+          .p50 = percentile(0.5),
+          .p99 = percentile(0.99),
+          .max = samples.back()};
+}
+
+// Work done per microsecond in each sample, e.g. elements per microsecond are
+// millions of elements per second
+inline std::vector<double> perMicrosecond(std::vector<double> samplesUs,
+                                          double work) {
+  for (auto &sample : samplesUs) {
+    sample = work / sample;
+  }
+  return samplesUs;
+}
+
+inline void printStats(const std::string &name, const BenchStats &stats,
+                       const char *unit) {
+  std::printf("%-40s min %10.2f  mean %10.2f  p50 %10.2f  p99 %10.2f  (%s)\n",
+              name.c_str(), stats.min, stats.mean, stats.p50, stats.p99, unit);
+}
+
+class BenchTimer {
+ public:
+  BenchTimer() : start_(std::chrono::steady_clock::now()) {}
+  double elapsedUs() const {
+    return std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now() - start_)
+        .count();
+  }
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+};
+
+#endif
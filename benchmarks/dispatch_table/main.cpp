@@ -0,0 +1,108 @@
+#include <functional>
+#include <vector>
+#include <vinkan/commands/command_recorder.hpp>
+#include <vinkan/wrappers/device_dispatch.hpp>
+
+#include "bench_context.hpp"
+#include "bench_stats.hpp"
+
+// CPU cost of recording a command through the loader entry points vs
+// through the device dispatch table.
+//
+// Each iteration records COMMAND_COUNT commands in a command buffer that is
+// never submitted, we report the time per command.
+
+constexpr uint32_t WARMUP_ITERATIONS = 20;
+constexpr uint32_t ITERATIONS = 200;
+constexpr uint32_t COMMAND_COUNT = 4096;
+
+std::vector<double> runBenchmark(
+    VkCommandBuffer commandBuffer,
+    const std::function<void(VkCommandBuffer)> &record) {
+  std::vector<double> nsPerCommand{};
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  for (uint32_t i = 0; i < WARMUP_ITERATIONS + ITERATIONS; ++i) {
+    vkResetCommandBuffer(commandBuffer, 0);
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    BenchTimer timer;
+    record(commandBuffer);
+    double elapsedUs = timer.elapsedUs();
+    vkEndCommandBuffer(commandBuffer);
+    if (i >= WARMUP_ITERATIONS) {
+      nsPerCommand.push_back(elapsedUs * 1e3 / COMMAND_COUNT);
+    }
+  }
+  return nsPerCommand;
+}
+
+int main() {
+  BenchContext context;
+  context.createDevice();
+  VkDevice device = context.device->getHandle();
+  const vinkan::DeviceDispatch &dispatch = context.device->getDispatch();
+
+  VkCommandPoolCreateInfo poolInfo{};
+  poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  poolInfo.queueFamilyIndex = context.queueFamilyIndex;
+  VkCommandPool commandPool;
+  vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool);
+  VkCommandBufferAllocateInfo allocInfo{};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.commandPool = commandPool;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandBufferCount = 1;
+  VkCommandBuffer commandBuffer;
+  vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
+
+  vinkan::BufferInfo bufferInfo{
+      .instanceSize = 256,
+      .instanceCount = 1,
+      .usageFlags =
+          VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+      .sharingMode = {.value = VK_SHARING_MODE_EXCLUSIVE},
+      .memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT};
+  auto memoryProperties = context.physicalDevice->getMemoryProperties();
+  vinkan::Buffer srcBuffer(device, memoryProperties, bufferInfo);
+  vinkan::Buffer dstBuffer(device, memoryProperties, bufferInfo);
+  VkBuffer dstHandle = dstBuffer.getHandle();
+
+  auto loaderFill = runBenchmark(commandBuffer, [&](VkCommandBuffer cmd) {
+    for (uint32_t i = 0; i < COMMAND_COUNT; ++i) {
+      vkCmdFillBuffer(cmd, dstHandle, 0, 256, i);
+    }
+  });
+  auto tableFill = runBenchmark(commandBuffer, [&](VkCommandBuffer cmd) {
+    for (uint32_t i = 0; i < COMMAND_COUNT; ++i) {
+      dispatch.vkCmdFillBuffer(cmd, dstHandle, 0, 256, i);
+    }
+  });
+
+  // Same wrapper code, only the table it calls through changes
+  auto recordCopies = [&](VkCommandBuffer cmd) {
+    vinkan::CommandRecorder recorder(cmd, false);
+    for (uint32_t i = 0; i < COMMAND_COUNT; ++i) {
+      recorder.copyBuffer(srcBuffer, dstBuffer,
+                          VkBufferCopy{.srcOffset = 0,
+                                       .dstOffset = 0,
+                                       .size = 256});
+    }
+  };
+  auto loaderCopy = runBenchmark(commandBuffer, recordCopies);
+  vinkan::installDeviceDispatch(dispatch);
+  auto tableCopy = runBenchmark(commandBuffer, recordCopies);
+  vinkan::uninstallDeviceDispatch(device);
+
+  printStats("vkCmdFillBuffer, loader", computeStats(loaderFill),
+             "ns per command");
+  printStats("vkCmdFillBuffer, device table", computeStats(tableFill),
+             "ns per command");
+  printStats("CommandRecorder::copyBuffer, loader", computeStats(loaderCopy),
+             "ns per command");
+  printStats("CommandRecorder::copyBuffer, device table",
+             computeStats(tableCopy), "ns per command");
+
+  vkDestroyCommandPool(device, commandPool, nullptr);
+}
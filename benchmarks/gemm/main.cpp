@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <span>
+#include <vector>
+#include <vinkan/kernels/gpu_gemm.hpp>
+
+#include "bench_context.hpp"
+#include "bench_stats.hpp"
+
+// Throughput of the GEMM kernels in GFLOP/s, 2 * m * n * k flops per matrix
+// of the batch, with the record API.
+//
+// The host API is checked against a CPU reference first, and a few entries of
+// every benchmarked product are checked afterwards.
+
+enum class BenchCommandBuffer { GEMM };
+enum class BenchCommandPool { POOL };
+enum class BenchFence { FENCE };
+enum class BenchSemaphore {};
+
+constexpr uint32_t WARMUP_ITERATIONS = 3;
+constexpr uint32_t ITERATIONS = 20;
+// Entries of a benchmarked product checked against the CPU
+constexpr uint32_t SAMPLED_ENTRIES = 64;
+constexpr float TOLERANCE = 1e-3f;
+// 1.0 in f16
+constexpr uint16_t HALF_ONE = 0x3c00;
+
+// Normal f16 values only
+float halfToFloat(uint16_t value) {
+  int exponent = (value >> 10) & 0x1f;
+  float mantissa = 1.f + (value & 0x3ff) / 1024.f;
+  float magnitude = std::ldexp(mantissa, exponent - 15);
+  return (value & 0x8000) != 0 ? -magnitude : magnitude;
+}
+
+std::vector<float> randomMatrix(size_t size, std::mt19937 &generator) {
+  std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+  std::vector<float> values(size);
+  for (auto &value : values) {
+    value = distribution(generator);
+  }
+  return values;
+}
+
+// Entry (row, column) of the matrix `batch` of the product, the default
+// leading dimensions only
+float referenceEntry(const vinkan::GemmInfo &info, std::span<const float> a,
+                     std::span<const float> b, std::span<const float> bias,
+                     std::span<const float> c, uint32_t batch, uint32_t row,
+                     uint32_t column) {
+  const float *batchA = a.data() + batch * info.strideA;
+  const float *batchB = b.data() + batch * info.strideB;
+  double sum = 0.;
+  for (uint32_t i = 0; i < info.k; ++i) {
+    float valueA = info.transposeA ? batchA[i * info.m + row]
+                                   : batchA[row * info.k + i];
+    float valueB = info.transposeB ? batchB[column * info.k + i]
+                                   : batchB[i * info.n + column];
+    sum += static_cast<double>(valueA) * valueB;
+  }
+  double value = info.alpha * sum;
+  if (info.beta != 0.f) {
+    value += info.beta * c[batch * info.strideC + row * info.n + column];
+  }
+  if (!bias.empty()) {
+    value += bias[column];
+  }
+  if (info.relu) {
+    value = std::max(value, 0.);
+  }
+  return static_cast<float>(value);
+}
+
+bool isClose(float value, float expected) {
+  return std::abs(value - expected) <= TOLERANCE * (1.f + std::abs(expected));
+}
+
+bool checkHostApi(vinkan::GpuGemm &gemm) {
+  std::mt19937 generator(42);
+  struct Case {
+    const char *name;
+    vinkan::GemmInfo info;
+    bool bias;
+  };
+  // Odd sizes so that the tiles hang past the matrices
+  Case cases[] = {
+      {"plain", {.m = 67, .n = 45, .k = 33}, false},
+      {"transposed A", {.m = 67, .n = 45, .k = 33, .transposeA = true}, false},
+      {"transposed B", {.m = 67, .n = 45, .k = 33, .transposeB = true}, false},
+      {"batched",
+       {.m = 31,
+        .n = 17,
+        .k = 70,
+        .batchCount = 3,
+        .strideA = 31 * 70,
+        .strideB = 17 * 70,
+        .strideC = 31 * 17,
+        .tile = vinkan::GemmTile::SMALL},
+       false},
+      {"bias and ReLU",
+       {.m = 130, .n = 129, .k = 20, .relu = true,
+        .tile = vinkan::GemmTile::LARGE},
+       true},
+      {"alpha and beta",
+       {.m = 50, .n = 70, .k = 40, .alpha = 0.5f, .beta = -2.f,
+        .tile = vinkan::GemmTile::MEDIUM},
+       false},
+  };
+  bool success = true;
+  for (const auto &[name, info, hasBias] : cases) {
+    uint32_t batchCount = info.batchCount;
+    auto a = randomMatrix(static_cast<size_t>(info.m) * info.k * batchCount,
+                          generator);
+    auto b = randomMatrix(static_cast<size_t>(info.k) * info.n * batchCount,
+                          generator);
+    auto c = randomMatrix(static_cast<size_t>(info.m) * info.n * batchCount,
+                          generator);
+    auto bias =
+        hasBias ? randomMatrix(info.n, generator) : std::vector<float>{};
+    std::vector<float> result = gemm.multiply(info, a, b, bias, c);
+    bool matches = true;
+    for (uint32_t batch = 0; batch < batchCount && matches; ++batch) {
+      for (uint32_t row = 0; row < info.m && matches; ++row) {
+        for (uint32_t column = 0; column < info.n && matches; ++column) {
+          matches = isClose(
+              result[batch * info.strideC + row * info.n + column],
+              referenceEntry(info, a, b, bias, c, batch, row, column));
+        }
+      }
+    }
+    if (!matches) {
+      std::printf("Unexpected %s GEMM result\n", name);
+      success = false;
+    }
+  }
+  return success;
+}
+
+int main() {
+  BenchContext context;
+  bool float16 = context.physicalDevice->supportsFloat16Compute();
+  context.createDevice([&](vinkan::Device<BenchQueue>::Builder &builder) {
+    builder.enableBufferDeviceAddress();
+    if (float16) {
+      builder.enableFloat16Compute();
+    }
+  });
+  VkDevice device = context.device->getHandle();
+  vinkan::GpuGemm gemm(
+      device, *context.physicalDevice,
+      vinkan::KernelLibraryInfo{.queue = context.queue,
+                                .queueFamilyIndex = context.queueFamilyIndex},
+      float16);
+  if (!checkHostApi(gemm)) {
+    return 1;
+  }
+  if (!float16) {
+    std::printf("No f16 compute support, only the f32 kernels are run\n");
+  }
+
+  vinkan::CommandCoordinator<BenchCommandBuffer, BenchCommandPool> coordinator(
+      device);
+  coordinator.createCommandPool(BenchCommandPool::POOL,
+                                context.queueFamilyIndex, false);
+  coordinator.createLongLivedCommand({BenchCommandBuffer::GEMM},
+                                     BenchCommandPool::POOL);
+  vinkan::SyncMechanisms<BenchFence, BenchSemaphore> syncMechanisms(device);
+  syncMechanisms.createFence(BenchFence::FENCE);
+  VkFence fence = syncMechanisms.getFence(BenchFence::FENCE);
+
+  struct Problem {
+    const char *name;
+    vinkan::GemmElementType elementType;
+    vinkan::GemmInfo info;
+    bool bias;
+  };
+  std::vector<Problem> problems{};
+  for (uint32_t size : {256u, 512u, 1024u, 2048u}) {
+    problems.push_back({"f32", vinkan::GemmElementType::F32,
+                        {.m = size, .n = size, .k = size}, false});
+  }
+  for (auto tile : {vinkan::GemmTile::SMALL, vinkan::GemmTile::MEDIUM,
+                    vinkan::GemmTile::LARGE}) {
+    const char *names[] = {"f32 small tile", "f32 medium tile",
+                           "f32 large tile"};
+    problems.push_back({names[static_cast<uint32_t>(tile)],
+                        vinkan::GemmElementType::F32,
+                        {.m = 1024, .n = 1024, .k = 1024, .tile = tile},
+                        false});
+  }
+  problems.push_back({"f32 transposed B", vinkan::GemmElementType::F32,
+                      {.m = 1024, .n = 1024, .k = 1024, .transposeB = true},
+                      false});
+  problems.push_back({"f32 bias and ReLU", vinkan::GemmElementType::F32,
+                      {.m = 1024, .n = 1024, .k = 1024, .relu = true},
+                      true});
+  problems.push_back({"f32 batch of 64", vinkan::GemmElementType::F32,
+                      {.m = 128,
+                       .n = 128,
+                       .k = 128,
+                       .batchCount = 64,
+                       .strideA = 128 * 128,
+                       .strideB = 128 * 128,
+                       .strideC = 128 * 128},
+                      false});
+  if (float16) {
+    for (uint32_t size : {1024u, 2048u}) {
+      problems.push_back({"f16", vinkan::GemmElementType::F16,
+                          {.m = size, .n = size, .k = size}, false});
+    }
+  }
+
+  std::mt19937 generator(7);
+  for (const auto &[problemName, elementType, info, hasBias] : problems) {
+    bool isHalf = elementType == vinkan::GemmElementType::F16;
+    VkDeviceSize elementSize = isHalf ? sizeof(uint16_t) : sizeof(float);
+    size_t sizeA = static_cast<size_t>(info.m) * info.k * info.batchCount;
+    size_t sizeB = static_cast<size_t>(info.k) * info.n * info.batchCount;
+    size_t sizeC = static_cast<size_t>(info.m) * info.n * info.batchCount;
+    auto bufferA = createBuffer(context, sizeA * elementSize);
+    auto bufferB = createBuffer(context, sizeB * elementSize);
+    auto bufferC = createBuffer(context, sizeC * elementSize);
+    auto bufferBias = createBuffer(context, info.n * elementSize);
+
+    // The f16 inputs are ones, every entry of the product is then k, exact in
+    // f16 for these sizes
+    std::vector<float> a{};
+    std::vector<float> b{};
+    std::vector<float> bias{};
+    if (isHalf) {
+      std::vector<uint16_t> ones(std::max(sizeA, sizeB), HALF_ONE);
+      uploadBuffer(context, *bufferA, ones.data(), sizeA * elementSize);
+      uploadBuffer(context, *bufferB, ones.data(), sizeB * elementSize);
+    } else {
+      a = randomMatrix(sizeA, generator);
+      b = randomMatrix(sizeB, generator);
+      bias = hasBias ? randomMatrix(info.n, generator) : std::vector<float>{};
+      uploadBuffer(context, *bufferA, a.data(), sizeA * elementSize);
+      uploadBuffer(context, *bufferB, b.data(), sizeB * elementSize);
+      if (hasBias) {
+        uploadBuffer(context, *bufferBias, bias.data(), info.n * elementSize);
+      }
+    }
+
+    coordinator.resetCommandBuffer(BenchCommandBuffer::GEMM);
+    VkCommandBuffer commandBuffer =
+        coordinator.beginCommandBuffer(BenchCommandBuffer::GEMM);
+    gemm.recordGemm(commandBuffer, elementType, info,
+                    bufferA->getDeviceAddress(), bufferB->getDeviceAddress(),
+                    bufferC->getDeviceAddress(),
+                    hasBias ? bufferBias->getDeviceAddress() : 0);
+    coordinator.endCommandBuffer(commandBuffer);
+
+    // Thousands of flops per microsecond are GFLOP/s
+    double kiloFlops = 2e-3 * info.m * info.n * info.k * info.batchCount;
+    auto throughput = perMicrosecond(
+        timeSubmissions(context, coordinator, commandBuffer, fence,
+                        WARMUP_ITERATIONS, ITERATIONS),
+        kiloFlops);
+
+    // Sampled entries against the CPU
+    std::uniform_int_distribution<uint32_t> batches(0, info.batchCount - 1);
+    std::uniform_int_distribution<uint32_t> rows(0, info.m - 1);
+    std::uniform_int_distribution<uint32_t> columns(0, info.n - 1);
+    std::vector<uint8_t> resultC(sizeC * elementSize);
+    readBuffer(context, *bufferC, resultC.data(), resultC.size());
+    bool matches = true;
+    for (uint32_t i = 0; i < SAMPLED_ENTRIES && matches; ++i) {
+      uint32_t batch = batches(generator);
+      uint32_t row = rows(generator);
+      uint32_t column = columns(generator);
+      size_t index = batch * info.strideC + row * info.n + column;
+      if (isHalf) {
+        auto *values = reinterpret_cast<const uint16_t *>(resultC.data());
+        matches = halfToFloat(values[index]) == static_cast<float>(info.k);
+      } else {
+        auto *values = reinterpret_cast<const float *>(resultC.data());
+        matches = isClose(values[index], referenceEntry(info, a, b, bias, {},
+                                                        batch, row, column));
+      }
+    }
+    if (!matches) {
+      std::printf("Unexpected %s GEMM result\n", problemName);
+      return 1;
+    }
+
+    char name[64];
+    if (info.batchCount > 1) {
+      std::snprintf(name, sizeof(name), "%s, %ux%ux%u", problemName, info.m,
+                    info.n, info.k);
+    } else {
+      std::snprintf(name, sizeof(name), "%s, %u^3", problemName, info.m);
+    }
+    printStats(name, computeStats(throughput), "GFLOP/s");
+  }
+}
@@ -0,0 +1,166 @@
+#include <cstdio>
+#include <functional>
+#include <numeric>
+#include <span>
+#include <vector>
+#include <vinkan/kernels/gpu_primitives.hpp>
+
+#include "bench_context.hpp"
+#include "bench_stats.hpp"
+
+// Throughput of the GPU primitives on u32 elements, in millions of elements
+// per second, with the record API.
+//
+// The host API is checked against the CPU on a smaller input first.
+
+enum class BenchCommandBuffer { REDUCE, INCLUSIVE_SCAN, COMPACT };
+enum class BenchCommandPool { POOL };
+enum class BenchFence { FENCE };
+enum class BenchSemaphore {};
+
+constexpr uint32_t WARMUP_ITERATIONS = 3;
+constexpr uint32_t ITERATIONS = 20;
+constexpr uint32_t CHECK_COUNT = 100000;
+
+bool checkHostApi(vinkan::GpuPrimitives &primitives) {
+  std::vector<uint32_t> values(CHECK_COUNT);
+  std::vector<uint32_t> flags(CHECK_COUNT);
+  for (uint32_t i = 0; i < CHECK_COUNT; ++i) {
+    values[i] = i % 7;
+    flags[i] = i % 3 == 0 ? 1 : 0;
+  }
+  std::vector<uint32_t> expectedScan(CHECK_COUNT);
+  std::inclusive_scan(values.begin(), values.end(), expectedScan.begin());
+  std::vector<uint32_t> expectedCompact{};
+  for (uint32_t i = 0; i < CHECK_COUNT; ++i) {
+    if (flags[i] != 0) {
+      expectedCompact.push_back(values[i]);
+    }
+  }
+  std::span<const uint32_t> valuesSpan(values);
+  bool success = true;
+  if (primitives.reduce(valuesSpan) != expectedScan.back()) {
+    std::printf("Unexpected reduce result\n");
+    success = false;
+  }
+  if (primitives.reduce(valuesSpan, vinkan::ReduceOperation::MAX) != 6) {
+    std::printf("Unexpected max result\n");
+    success = false;
+  }
+  if (primitives.inclusiveScan(valuesSpan) != expectedScan) {
+    std::printf("Unexpected inclusive scan result\n");
+    success = false;
+  }
+  if (primitives.compact(valuesSpan, std::span<const uint32_t>(flags)) !=
+      expectedCompact) {
+    std::printf("Unexpected compaction result\n");
+    success = false;
+  }
+  std::vector<int32_t> signedValues{3, -5, 7, -2};
+  if (primitives.reduce(std::span<const int32_t>(signedValues),
+                        vinkan::ReduceOperation::MIN) != -5) {
+    std::printf("Unexpected min result\n");
+    success = false;
+  }
+  std::vector<float> floatValues{0.5f, 1.5f, 2.f};
+  if (primitives.exclusiveScan(std::span<const float>(floatValues)) !=
+      std::vector<float>{0.f, 0.5f, 2.f}) {
+    std::printf("Unexpected exclusive scan result\n");
+    success = false;
+  }
+  return success;
+}
+
+int main() {
+  BenchContext context;
+  if (!context.physicalDevice->supportsFullComputeSubgroups()) {
+    std::printf("The GPU primitives kernels need full compute subgroups\n");
+    return 1;
+  }
+  context.createDevice([](vinkan::Device<BenchQueue>::Builder &builder) {
+    builder.enableBufferDeviceAddress();
+    // The benchmark instance is Vulkan 1.2
+    builder.addExtensions({VK_EXT_SUBGROUP_SIZE_CONTROL_EXTENSION_NAME});
+    builder.enableFullComputeSubgroups();
+  });
+  VkDevice device = context.device->getHandle();
+  vinkan::GpuPrimitives primitives(
+      device, *context.physicalDevice,
+      vinkan::KernelLibraryInfo{.queue = context.queue,
+                                .queueFamilyIndex = context.queueFamilyIndex});
+  if (!checkHostApi(primitives)) {
+    return 1;
+  }
+
+  vinkan::CommandCoordinator<BenchCommandBuffer, BenchCommandPool> coordinator(
+      device);
+  coordinator.createCommandPool(BenchCommandPool::POOL,
+                                context.queueFamilyIndex, false);
+  coordinator.createLongLivedCommand(
+      {BenchCommandBuffer::REDUCE, BenchCommandBuffer::INCLUSIVE_SCAN,
+       BenchCommandBuffer::COMPACT},
+      BenchCommandPool::POOL);
+  vinkan::SyncMechanisms<BenchFence, BenchSemaphore> syncMechanisms(device);
+  syncMechanisms.createFence(BenchFence::FENCE);
+  VkFence fence = syncMechanisms.getFence(BenchFence::FENCE);
+
+  for (uint32_t count : {1u << 20, 1u << 24}) {
+    VkDeviceSize size = static_cast<VkDeviceSize>(count) * sizeof(uint32_t);
+    auto input = createBuffer(context, size);
+    auto flags = createBuffer(context, size);
+    auto output = createBuffer(context, size + sizeof(uint32_t));
+    auto scratch =
+        createBuffer(context, vinkan::GpuPrimitives::getScratchSize(count));
+    std::vector<uint32_t> values(count, 1);
+    uploadBuffer(context, *input, values.data(), size);
+    for (uint32_t i = 0; i < count; ++i) {
+      values[i] = i % 2;
+    }
+    uploadBuffer(context, *flags, values.data(), size);
+
+    auto type = vinkan::PrimitiveElementType::U32;
+    VkDeviceAddress inputAddress = input->getDeviceAddress();
+    VkDeviceAddress outputAddress = output->getDeviceAddress();
+    VkDeviceAddress scratchAddress = scratch->getDeviceAddress();
+    std::vector<
+        std::pair<BenchCommandBuffer, std::function<void(VkCommandBuffer)>>>
+        operations{
+            {BenchCommandBuffer::REDUCE,
+             [&](VkCommandBuffer commandBuffer) {
+               primitives.recordReduce(commandBuffer, type,
+                                       vinkan::ReduceOperation::ADD,
+                                       inputAddress, count, outputAddress,
+                                       scratchAddress);
+             }},
+            {BenchCommandBuffer::INCLUSIVE_SCAN,
+             [&](VkCommandBuffer commandBuffer) {
+               primitives.recordInclusiveScan(commandBuffer, type,
+                                              inputAddress, count,
+                                              outputAddress, scratchAddress);
+             }},
+            {BenchCommandBuffer::COMPACT,
+             [&](VkCommandBuffer commandBuffer) {
+               primitives.recordCompact(
+                   commandBuffer, type, inputAddress,
+                   flags->getDeviceAddress(), count, outputAddress,
+                   outputAddress + size, scratchAddress);
+             }},
+        };
+    const char *names[] = {"reduce", "inclusive scan", "compact"};
+    for (size_t i = 0; i < operations.size(); ++i) {
+      auto &[commandIdentifier, record] = operations[i];
+      coordinator.resetCommandBuffer(commandIdentifier);
+      VkCommandBuffer commandBuffer =
+          coordinator.beginCommandBuffer(commandIdentifier);
+      record(commandBuffer);
+      coordinator.endCommandBuffer(commandBuffer);
+
+      auto samples = timeSubmissions(context, coordinator, commandBuffer,
+                                     fence, WARMUP_ITERATIONS, ITERATIONS);
+      char name[64];
+      std::snprintf(name, sizeof(name), "%s, %u elements", names[i], count);
+      printStats(name, computeStats(perMicrosecond(samples, count)),
+                 "M elements/s");
+    }
+  }
+}
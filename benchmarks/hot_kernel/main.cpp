@@ -0,0 +1,176 @@
+#include <cstdio>
+#include <functional>
+#include <vector>
+#include <vinkan/commands/hot_kernel.hpp>
+
+#include "bench_context.hpp"
+#include "bench_stats.hpp"
+
+// End-to-end latency of one tiny dispatch (the addition shader of the compute
+// example on 64 values), from writing the inputs to reading the outputs.
+//
+// The usual path maps, writes and unmaps the buffer, allocates and records a
+// single use command buffer, submits it, blocks on a fence, then maps, reads
+// and unmaps the buffer. The hot kernel path resubmits a prerecorded command
+// buffer on persistently mapped memory and spins before blocking.
+
+enum class BenchBuffer { DATA };
+enum class BenchDescriptorSet { SET };
+enum class BenchDescriptorSetLayout { LAYOUT };
+enum class BenchDescriptorPool { POOL };
+enum class BenchPipeline { ADDITION };
+enum class BenchPipelineLayout { ADDITION_LAYOUT };
+enum class BenchCommandBuffer {};
+enum class BenchCommandPool { SINGLE_USE_POOL };
+enum class BenchFence { FENCE };
+enum class BenchSemaphore {};
+
+struct BenchPC {
+  uint32_t value;
+};
+
+constexpr uint32_t WARMUP_ITERATIONS = 100;
+constexpr uint32_t ITERATIONS = 2000;
+constexpr uint32_t VALUE_COUNT = 64;
+
+std::vector<double> runBenchmark(const std::function<void()> &call) {
+  std::vector<double> latencyUs{};
+  for (uint32_t i = 0; i < WARMUP_ITERATIONS + ITERATIONS; ++i) {
+    BenchTimer timer;
+    call();
+    if (i >= WARMUP_ITERATIONS) {
+      latencyUs.push_back(timer.elapsedUs());
+    }
+  }
+  return latencyUs;
+}
+
+int main() {
+  BenchContext context;
+  context.createDevice([](vinkan::Device<BenchQueue>::Builder &builder) {
+    builder.enableTimelineSemaphore();
+  });
+  VkDevice device = context.device->getHandle();
+
+  vinkan::Resources<BenchBuffer, BenchDescriptorSet, BenchDescriptorSetLayout,
+                    BenchDescriptorPool>
+      resources(device, context.physicalDevice->getMemoryProperties());
+  vinkan::SetLayoutInfo layoutInfo{
+      .nSets = 1,
+      .bindings = {vinkan::DescriptorSetLayoutBinding{
+          .bindingIndex = 0,
+          .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+          .shaderStageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+          .count = 1,
+      }},
+  };
+  resources.createSetLayout(BenchDescriptorSetLayout::LAYOUT, layoutInfo);
+  resources.createPool(BenchDescriptorPool::POOL,
+                       {BenchDescriptorSetLayout::LAYOUT});
+  vinkan::BufferInfo bufferInfo{
+      .instanceSize = VALUE_COUNT * sizeof(uint32_t),
+      .instanceCount = 1,
+      .usageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+      .sharingMode = {.value = VK_SHARING_MODE_EXCLUSIVE},
+      .memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+  };
+  resources.create(BenchBuffer::DATA, bufferInfo);
+  vinkan::Buffer &buffer = resources.get(BenchBuffer::DATA);
+  resources.createSet(
+      BenchDescriptorSet::SET, BenchDescriptorSetLayout::LAYOUT,
+      {vinkan::VinkanBufferBinding<BenchBuffer>{.bindingIndex = 0,
+                                                .buffer = BenchBuffer::DATA}});
+
+  vinkan::Pipelines<BenchPipeline, BenchPipelineLayout> pipelines(device);
+  pipelines.createLayout<BenchPC>(
+      BenchPipelineLayout::ADDITION_LAYOUT,
+      {resources.get(BenchDescriptorSetLayout::LAYOUT)},
+      VK_SHADER_STAGE_COMPUTE_BIT);
+  vinkan::ComputePipelineInfo<BenchPipelineLayout, vinkan::ShaderFileInfo>
+      pipelineInfo{
+          .layoutIdentifier = BenchPipelineLayout::ADDITION_LAYOUT,
+          .shaderInfo = {.shaderFilepath = std::string(COMPILED_SHADERS_DIR) +
+                                           "/addition_shader.spv",
+                         .shaderStage = VK_SHADER_STAGE_COMPUTE_BIT},
+      };
+  pipelines.createComputePipeline(BenchPipeline::ADDITION, pipelineInfo);
+
+  VkPipelineLayout pipelineLayout =
+      pipelines.get(BenchPipelineLayout::ADDITION_LAYOUT);
+  VkDescriptorSet descriptorSet = resources.get(BenchDescriptorSet::SET);
+  auto recordAddition = [&](VkCommandBuffer commandBuffer) {
+    pipelines.bindCmdBuffer(commandBuffer, BenchPipeline::ADDITION);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                            pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+    BenchPC pushConstants{.value = 1};
+    vkCmdPushConstants(commandBuffer, pipelineLayout,
+                       VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BenchPC),
+                       &pushConstants);
+    vkCmdDispatch(commandBuffer, 1, 1, 1);
+  };
+
+  std::vector<uint32_t> input(VALUE_COUNT, 10);
+  std::vector<uint32_t> output(VALUE_COUNT);
+  size_t dataSize = VALUE_COUNT * sizeof(uint32_t);
+
+  // Usual path, as in the compute example
+  vinkan::CommandCoordinator<BenchCommandBuffer, BenchCommandPool> coordinator(
+      device);
+  coordinator.createCommandPool(BenchCommandPool::SINGLE_USE_POOL,
+                                context.queueFamilyIndex, true);
+  vinkan::SyncMechanisms<BenchFence, BenchSemaphore> syncMechanisms(device);
+  syncMechanisms.createFence(BenchFence::FENCE);
+  VkFence fence = syncMechanisms.getFence(BenchFence::FENCE);
+  auto usual = runBenchmark([&]() {
+    buffer.map();
+    buffer.writeToBuffer(input.data(), VK_WHOLE_SIZE, 0);
+    buffer.unmap();
+    VkCommandBuffer commandBuffer = coordinator.createSingleUseCommandBuffer(
+        BenchCommandPool::SINGLE_USE_POOL);
+    coordinator.beginCommandBuffer(commandBuffer);
+    recordAddition(commandBuffer);
+    coordinator.endCommandBuffer(commandBuffer);
+    coordinator.submitCommandBuffer(
+        commandBuffer,
+        vinkan::SubmitCommandBufferInfo{.signalFence = fence,
+                                        .queue = context.queue});
+    vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+    vkResetFences(device, 1, &fence);
+    buffer.map();
+    buffer.readBuffer(output.data());
+    buffer.unmap();
+    coordinator.freeCommandBuffer(BenchCommandPool::SINGLE_USE_POOL,
+                                  commandBuffer);
+  });
+  printStats("usual path", computeStats(usual), "us");
+
+  for (bool useTimelineSemaphore : {true, false}) {
+    for (uint32_t spinDurationUs : {0u, 50u}) {
+      vinkan::HotKernel kernel(
+          device,
+          vinkan::HotKernelInfo{.queue = context.queue,
+                                .queueFamilyIndex = context.queueFamilyIndex,
+                                .input = &buffer,
+                                .output = &buffer,
+                                .useTimelineSemaphore = useTimelineSemaphore,
+                                .spinDurationUs = spinDurationUs},
+          recordAddition);
+      auto hot = runBenchmark([&]() {
+        kernel.run(input.data(), dataSize, output.data(), dataSize);
+      });
+      char name[64];
+      std::snprintf(name, sizeof(name), "hot kernel, %s, spin %uus",
+                    useTimelineSemaphore ? "timeline" : "fence",
+                    spinDurationUs);
+      printStats(name, computeStats(hot), "us");
+      const auto &stats = kernel.getStats();
+      std::printf("%-40s %.1f%% done while spinning\n", name,
+                  100. * stats.spinCompletionCount / stats.runCount);
+    }
+  }
+  if (output[0] != input[0] + 1) {
+    std::printf("Unexpected result %u\n", output[0]);
+    return 1;
+  }
+}
@@ -0,0 +1,450 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <numbers>
+#include <random>
+#include <span>
+#include <vector>
+#include <vinkan/kernels/gpu_image_processing.hpp>
+
+#include "bench_context.hpp"
+#include "bench_stats.hpp"
+
+// Throughput of the image processing kernels in megapixels of the input
+// frame per second, for 1080p and 4K frames, with the record API. The last
+// operation chains the per frame steps of a media pipeline in one command
+// buffer: NV12 to RGB, Gaussian blur, then a Lanczos resize to 720p.
+//
+// The host API is checked against CPU references on small images first.
+
+enum class BenchCommandBuffer { OPERATION };
+enum class BenchCommandPool { POOL };
+enum class BenchFence { FENCE };
+enum class BenchSemaphore {};
+
+constexpr uint32_t WARMUP_ITERATIONS = 3;
+constexpr uint32_t ITERATIONS = 20;
+// Channels can differ by one code from the CPU, rounding ties go either way
+constexpr int TOLERANCE = 1;
+
+using vinkan::GpuImageProcessing;
+using vinkan::ImageBufferView;
+using vinkan::Nv12BufferView;
+using vinkan::PixelFormat;
+using vinkan::ResizeFilter;
+
+// CPU references, with the kernels' conventions
+
+struct Color {
+  float channels[4];
+};
+
+Color unpack(uint32_t pixel) {
+  Color color{};
+  for (int i = 0; i < 4; ++i) {
+    color.channels[i] = ((pixel >> (8 * i)) & 0xff) / 255.f;
+  }
+  return color;
+}
+
+uint32_t pack(const Color &color) {
+  uint32_t pixel = 0;
+  for (int i = 0; i < 4; ++i) {
+    float value = std::clamp(color.channels[i], 0.f, 1.f);
+    pixel |= static_cast<uint32_t>(std::round(value * 255.f)) << (8 * i);
+  }
+  return pixel;
+}
+
+Color loadClamped(std::span<const uint32_t> pixels, uint32_t width,
+                  uint32_t height, int x, int y) {
+  x = std::clamp(x, 0, static_cast<int>(width) - 1);
+  y = std::clamp(y, 0, static_cast<int>(height) - 1);
+  return unpack(pixels[y * width + x]);
+}
+
+std::vector<uint32_t> referenceBlur(std::span<const uint32_t> pixels,
+                                    uint32_t width, uint32_t height,
+                                    uint32_t radius, float sigma) {
+  std::vector<float> weights(radius + 1);
+  float weightSum = 0.f;
+  for (uint32_t i = 0; i <= radius; ++i) {
+    weights[i] = sigma > 0.f ? std::exp(-float(i * i) / (2.f * sigma * sigma))
+                             : 1.f;
+    weightSum += i == 0 ? weights[i] : 2.f * weights[i];
+  }
+  auto convolve = [&](auto load) {
+    Color sum{};
+    for (int tap = -static_cast<int>(radius); tap <= static_cast<int>(radius);
+         ++tap) {
+      Color color = load(tap);
+      for (int c = 0; c < 4; ++c) {
+        sum.channels[c] += weights[std::abs(tap)] * color.channels[c];
+      }
+    }
+    for (auto &channel : sum.channels) {
+      channel /= weightSum;
+    }
+    return sum;
+  };
+  std::vector<Color> temporary(static_cast<size_t>(width) * height);
+  for (uint32_t y = 0; y < height; ++y) {
+    for (uint32_t x = 0; x < width; ++x) {
+      temporary[y * width + x] = convolve([&](int tap) {
+        return loadClamped(pixels, width, height, x + tap, y);
+      });
+    }
+  }
+  std::vector<uint32_t> result(temporary.size());
+  for (uint32_t y = 0; y < height; ++y) {
+    for (uint32_t x = 0; x < width; ++x) {
+      result[y * width + x] = pack(convolve([&](int tap) {
+        int row = std::clamp(static_cast<int>(y) + tap, 0,
+                             static_cast<int>(height) - 1);
+        return temporary[row * width + x];
+      }));
+    }
+  }
+  return result;
+}
+
+float lanczos(float x) {
+  x = std::abs(x);
+  if (x < 1e-5f) {
+    return 1.f;
+  }
+  if (x >= 3.f) {
+    return 0.f;
+  }
+  float piX = std::numbers::pi_v<float> * x;
+  return 3.f * std::sin(piX) * std::sin(piX / 3.f) / (piX * piX);
+}
+
+std::vector<uint32_t> referenceResize(std::span<const uint32_t> pixels,
+                                      uint32_t width, uint32_t height,
+                                      uint32_t outputWidth,
+                                      uint32_t outputHeight,
+                                      ResizeFilter filter) {
+  float scaleX = static_cast<float>(width) / outputWidth;
+  float scaleY = static_cast<float>(height) / outputHeight;
+  // First tap and normalized weights along one axis
+  auto lanczosWeights = [](float center, float scale, int &first) {
+    float filterScale = std::max(scale, 1.f);
+    float support = 3.f * filterScale;
+    first = static_cast<int>(std::floor(center - support)) + 1;
+    int last = static_cast<int>(std::floor(center + support));
+    // At most 24 taps, centered
+    int excess = std::max(last - first + 1 - 24, 0);
+    first += excess / 2;
+    last = first + std::min(last - first, 23);
+    std::vector<float> weights{};
+    float sum = 0.f;
+    for (int i = first; i <= last; ++i) {
+      weights.push_back(lanczos((i - center) / filterScale));
+      sum += weights.back();
+    }
+    for (auto &weight : weights) {
+      weight /= sum;
+    }
+    return weights;
+  };
+  std::vector<uint32_t> result(static_cast<size_t>(outputWidth) *
+                               outputHeight);
+  for (uint32_t y = 0; y < outputHeight; ++y) {
+    for (uint32_t x = 0; x < outputWidth; ++x) {
+      float centerX = (x + 0.5f) * scaleX - 0.5f;
+      float centerY = (y + 0.5f) * scaleY - 0.5f;
+      Color value{};
+      auto accumulate = [&](float weight, int sampleX, int sampleY) {
+        Color color = loadClamped(pixels, width, height, sampleX, sampleY);
+        for (int c = 0; c < 4; ++c) {
+          value.channels[c] += weight * color.channels[c];
+        }
+      };
+      if (filter == ResizeFilter::BILINEAR) {
+        int originX = static_cast<int>(std::floor(centerX));
+        int originY = static_cast<int>(std::floor(centerY));
+        float tx = centerX - originX;
+        float ty = centerY - originY;
+        accumulate((1 - tx) * (1 - ty), originX, originY);
+        accumulate(tx * (1 - ty), originX + 1, originY);
+        accumulate((1 - tx) * ty, originX, originY + 1);
+        accumulate(tx * ty, originX + 1, originY + 1);
+      } else {
+        int firstX;
+        int firstY;
+        auto weightsX = lanczosWeights(centerX, scaleX, firstX);
+        auto weightsY = lanczosWeights(centerY, scaleY, firstY);
+        for (int j = 0; j < static_cast<int>(weightsY.size()); ++j) {
+          for (int i = 0; i < static_cast<int>(weightsX.size()); ++i) {
+            accumulate(weightsY[j] * weightsX[i], firstX + i, firstY + j);
+          }
+        }
+      }
+      result[y * outputWidth + x] = pack(value);
+    }
+  }
+  return result;
+}
+
+// BT.709 limited range
+constexpr float KR = 0.2126f;
+constexpr float KB = 0.0722f;
+constexpr float KG = 1.f - KR - KB;
+
+uint8_t toByte(float value) {
+  return static_cast<uint8_t>(std::clamp(std::round(value), 0.f, 255.f));
+}
+
+std::vector<uint8_t> referenceRgbToNv12(std::span<const uint32_t> pixels,
+                                        uint32_t width, uint32_t height) {
+  std::vector<uint8_t> frame(static_cast<size_t>(width) * height * 3 / 2);
+  uint8_t *chroma = frame.data() + static_cast<size_t>(width) * height;
+  for (uint32_t y = 0; y < height; y += 2) {
+    for (uint32_t x = 0; x < width; x += 2) {
+      float cb = 0.f;
+      float cr = 0.f;
+      for (uint32_t i = 0; i < 4; ++i) {
+        uint32_t pixelX = x + i % 2;
+        uint32_t pixelY = y + i / 2;
+        Color color = unpack(pixels[pixelY * width + pixelX]);
+        float r = color.channels[0];
+        float g = color.channels[1];
+        float b = color.channels[2];
+        float luma = KR * r + KG * g + KB * b;
+        cb += (b - luma) / (2.f * (1.f - KB));
+        cr += (r - luma) / (2.f * (1.f - KR));
+        frame[pixelY * width + pixelX] = toByte(16.f + 219.f * luma);
+      }
+      chroma[y / 2 * width + x] = toByte(128.f + 224.f * cb / 4.f);
+      chroma[y / 2 * width + x + 1] = toByte(128.f + 224.f * cr / 4.f);
+    }
+  }
+  return frame;
+}
+
+std::vector<uint32_t> referenceNv12ToRgb(std::span<const uint8_t> frame,
+                                         uint32_t width, uint32_t height) {
+  const uint8_t *chroma = frame.data() + static_cast<size_t>(width) * height;
+  std::vector<uint32_t> pixels(static_cast<size_t>(width) * height);
+  for (uint32_t y = 0; y < height; ++y) {
+    for (uint32_t x = 0; x < width; ++x) {
+      size_t chromaIndex = y / 2 * width + x / 2 * 2;
+      float luma = (frame[y * width + x] - 16.f) / 219.f;
+      float cb = (chroma[chromaIndex] - 128.f) / 224.f;
+      float cr = (chroma[chromaIndex + 1] - 128.f) / 224.f;
+      float r = luma + 2.f * (1.f - KR) * cr;
+      float b = luma + 2.f * (1.f - KB) * cb;
+      float g = (luma - KR * r - KB * b) / KG;
+      pixels[y * width + x] = pack(Color{{r, g, b, 1.f}});
+    }
+  }
+  return pixels;
+}
+
+template <typename T>
+bool isClose(const std::vector<T> &values, const std::vector<T> &expected,
+             uint32_t channelCount) {
+  if (values.size() != expected.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < values.size(); ++i) {
+    for (uint32_t c = 0; c < channelCount; ++c) {
+      int value = (values[i] >> (8 * c)) & 0xff;
+      int expectedValue = (expected[i] >> (8 * c)) & 0xff;
+      if (std::abs(value - expectedValue) > TOLERANCE) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool checkHostApi(GpuImageProcessing &imageProcessing) {
+  std::mt19937 generator(42);
+  // Odd sizes so that the workgroups hang past the images
+  constexpr uint32_t WIDTH = 37;
+  constexpr uint32_t HEIGHT = 29;
+  std::vector<uint32_t> pixels(WIDTH * HEIGHT);
+  for (auto &pixel : pixels) {
+    pixel = generator();
+  }
+  bool success = true;
+  auto check = [&](bool matches, const char *name) {
+    if (!matches) {
+      std::printf("Unexpected %s result\n", name);
+      success = false;
+    }
+  };
+  check(isClose(imageProcessing.gaussianBlur(pixels, WIDTH, HEIGHT, 1.5f),
+                referenceBlur(pixels, WIDTH, HEIGHT,
+                              GpuImageProcessing::getGaussianRadius(1.5f),
+                              1.5f),
+                4),
+        "Gaussian blur");
+  check(isClose(imageProcessing.boxBlur(pixels, WIDTH, HEIGHT, 3),
+                referenceBlur(pixels, WIDTH, HEIGHT, 3, 0.f), 4),
+        "box blur");
+  for (auto filter : {ResizeFilter::BILINEAR, ResizeFilter::LANCZOS3}) {
+    const char *name =
+        filter == ResizeFilter::BILINEAR ? "bilinear" : "Lanczos";
+    // Up and down on each axis
+    check(isClose(imageProcessing.resize(pixels, WIDTH, HEIGHT, 20, 50, filter),
+                  referenceResize(pixels, WIDTH, HEIGHT, 20, 50, filter), 4),
+          name);
+    check(isClose(imageProcessing.resize(pixels, WIDTH, HEIGHT, 80, 9, filter),
+                  referenceResize(pixels, WIDTH, HEIGHT, 80, 9, filter), 4),
+          name);
+  }
+
+  constexpr uint32_t FRAME_WIDTH = 36;
+  constexpr uint32_t FRAME_HEIGHT = 22;
+  std::vector<uint32_t> framePixels(FRAME_WIDTH * FRAME_HEIGHT);
+  for (auto &pixel : framePixels) {
+    pixel = generator();
+  }
+  std::vector<uint8_t> frame =
+      imageProcessing.rgbToNv12(framePixels, FRAME_WIDTH, FRAME_HEIGHT);
+  check(isClose(frame,
+                referenceRgbToNv12(framePixels, FRAME_WIDTH, FRAME_HEIGHT),
+                1),
+        "RGB to NV12");
+  // Alpha is 1 after the conversion
+  check(isClose(imageProcessing.nv12ToRgb(frame, FRAME_WIDTH, FRAME_HEIGHT),
+                referenceNv12ToRgb(frame, FRAME_WIDTH, FRAME_HEIGHT), 4),
+        "NV12 to RGB");
+  return success;
+}
+
+int main() {
+  BenchContext context;
+  context.createDevice([](vinkan::Device<BenchQueue>::Builder &builder) {
+    builder.enableBufferDeviceAddress();
+  });
+  VkDevice device = context.device->getHandle();
+  GpuImageProcessing imageProcessing(
+      device, *context.physicalDevice,
+      vinkan::KernelLibraryInfo{.queue = context.queue,
+                                .queueFamilyIndex = context.queueFamilyIndex});
+  if (!checkHostApi(imageProcessing)) {
+    return 1;
+  }
+
+  vinkan::CommandCoordinator<BenchCommandBuffer, BenchCommandPool> coordinator(
+      device);
+  coordinator.createCommandPool(BenchCommandPool::POOL,
+                                context.queueFamilyIndex, false);
+  coordinator.createLongLivedCommand({BenchCommandBuffer::OPERATION},
+                                     BenchCommandPool::POOL);
+  vinkan::SyncMechanisms<BenchFence, BenchSemaphore> syncMechanisms(device);
+  syncMechanisms.createFence(BenchFence::FENCE);
+  VkFence fence = syncMechanisms.getFence(BenchFence::FENCE);
+
+  constexpr uint32_t SMALL_WIDTH = 1280;
+  constexpr uint32_t SMALL_HEIGHT = 720;
+  struct FrameSize {
+    const char *name;
+    uint32_t width;
+    uint32_t height;
+  };
+  for (const auto &[frameName, width, height] :
+       {FrameSize{"1080p", 1920, 1080}, FrameSize{"4K", 3840, 2160}}) {
+    VkDeviceSize pixelCount = static_cast<VkDeviceSize>(width) * height;
+    // The timings don't depend on the pixel values, the buffers are left
+    // undefined. Large enough for float RGBA.
+    auto imageA = createBuffer(context, pixelCount * 16);
+    auto imageB = createBuffer(context, pixelCount * 16);
+    auto temporary = createBuffer(
+        context, GpuImageProcessing::getTemporarySize(width, height));
+    auto nv12 = createBuffer(context, pixelCount * 3 / 2);
+    auto small = createBuffer(context, SMALL_WIDTH * SMALL_HEIGHT * 16);
+
+    ImageBufferView a{.address = imageA->getDeviceAddress(),
+                      .width = width,
+                      .height = height};
+    ImageBufferView b{.address = imageB->getDeviceAddress(),
+                      .width = width,
+                      .height = height};
+    ImageBufferView half{.address = imageB->getDeviceAddress(),
+                         .width = width / 2,
+                         .height = height / 2};
+    ImageBufferView smallView{.address = small->getDeviceAddress(),
+                              .width = SMALL_WIDTH,
+                              .height = SMALL_HEIGHT};
+    Nv12BufferView frame{.luma = nv12->getDeviceAddress(),
+                         .chroma = nv12->getDeviceAddress() + pixelCount,
+                         .width = width,
+                         .height = height};
+    VkDeviceAddress temporaryAddress = temporary->getDeviceAddress();
+
+    struct Operation {
+      const char *name;
+      std::function<void(VkCommandBuffer)> record;
+    };
+    std::vector<Operation> operations{
+        {"Gaussian blur sigma 2",
+         [&](VkCommandBuffer commandBuffer) {
+           imageProcessing.recordGaussianBlur(commandBuffer, PixelFormat::RGBA8,
+                                              a, b, temporaryAddress, 2.f);
+         }},
+        {"Gaussian blur sigma 2 f32",
+         [&](VkCommandBuffer commandBuffer) {
+           imageProcessing.recordGaussianBlur(commandBuffer,
+                                              PixelFormat::RGBA32F, a, b,
+                                              temporaryAddress, 2.f);
+         }},
+        {"box blur radius 4",
+         [&](VkCommandBuffer commandBuffer) {
+           imageProcessing.recordBoxBlur(commandBuffer, PixelFormat::RGBA8, a,
+                                         b, temporaryAddress, 4);
+         }},
+        {"bilinear half",
+         [&](VkCommandBuffer commandBuffer) {
+           imageProcessing.recordResize(commandBuffer, PixelFormat::RGBA8, a,
+                                        half, ResizeFilter::BILINEAR);
+         }},
+        {"Lanczos half",
+         [&](VkCommandBuffer commandBuffer) {
+           imageProcessing.recordResize(commandBuffer, PixelFormat::RGBA8, a,
+                                        half, ResizeFilter::LANCZOS3);
+         }},
+        {"NV12 to RGB",
+         [&](VkCommandBuffer commandBuffer) {
+           imageProcessing.recordNv12ToRgb(commandBuffer, PixelFormat::RGBA8,
+                                           frame, a);
+         }},
+        {"RGB to NV12",
+         [&](VkCommandBuffer commandBuffer) {
+           imageProcessing.recordRgbToNv12(commandBuffer, PixelFormat::RGBA8,
+                                           a, frame);
+         }},
+        {"chain NV12 blur 720p",
+         [&](VkCommandBuffer commandBuffer) {
+           imageProcessing.recordNv12ToRgb(commandBuffer, PixelFormat::RGBA8,
+                                           frame, a);
+           vinkan::cmdKernelBarrier(commandBuffer);
+           imageProcessing.recordGaussianBlur(commandBuffer, PixelFormat::RGBA8,
+                                              a, b, temporaryAddress, 1.5f);
+           vinkan::cmdKernelBarrier(commandBuffer);
+           imageProcessing.recordResize(commandBuffer, PixelFormat::RGBA8, b,
+                                        smallView, ResizeFilter::LANCZOS3);
+         }},
+    };
+    for (const auto &[operationName, record] : operations) {
+      coordinator.resetCommandBuffer(BenchCommandBuffer::OPERATION);
+      VkCommandBuffer commandBuffer =
+          coordinator.beginCommandBuffer(BenchCommandBuffer::OPERATION);
+      record(commandBuffer);
+      coordinator.endCommandBuffer(commandBuffer);
+
+      auto samples = timeSubmissions(context, coordinator, commandBuffer,
+                                     fence, WARMUP_ITERATIONS, ITERATIONS);
+      char name[64];
+      std::snprintf(name, sizeof(name), "%s, %s", operationName, frameName);
+      printStats(name, computeStats(perMicrosecond(samples, pixelCount)),
+                 "MP/s");
+    }
+  }
+}
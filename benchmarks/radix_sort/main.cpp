@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <vinkan/kernels/gpu_radix_sort.hpp>
+
+#include "bench_context.hpp"
+#include "bench_stats.hpp"
+
+// GPU radix sort against std::sort, in milliseconds per sort of random keys.
+// The GPU sort uses the record API, the keys are reset from a staging buffer
+// by another submission before each sample. The CPU sorts a copy of the same
+// keys, the copy isn't timed.
+//
+// The host API is checked against std::stable_sort on smaller inputs first.
+
+enum class BenchCommandBuffer { RESET, SORT };
+enum class BenchCommandPool { POOL };
+enum class BenchFence { FENCE };
+enum class BenchSemaphore {};
+enum class BenchBuffer { STAGING, KEYS, VALUES, SCRATCH };
+enum class BenchSet {};
+enum class BenchSetLayout {};
+enum class BenchPool {};
+
+constexpr uint32_t WARMUP_ITERATIONS = 2;
+constexpr uint32_t ITERATIONS = 10;
+constexpr uint32_t CHECK_COUNT = 100000;
+constexpr uint32_t MAX_COUNT = 1u << 24;
+
+template <typename K>
+std::vector<K> randomKeys(uint32_t count, uint32_t seed) {
+  std::mt19937_64 generator(seed);
+  std::vector<K> keys(count);
+  for (auto &key : keys) {
+    if constexpr (std::is_floating_point_v<K>) {
+      key = std::uniform_real_distribution<K>(-1e6, 1e6)(generator);
+    } else {
+      key = static_cast<K>(generator());
+    }
+  }
+  return keys;
+}
+
+// Sorts the keys and values with both APIs and compares them
+template <typename K>
+bool checkSort(vinkan::GpuRadixSort &radixSort, const char *name) {
+  auto keys = randomKeys<K>(CHECK_COUNT, 1);
+  // Few distinct keys, the values check the stability
+  for (auto &key : keys) {
+    key = static_cast<K>(static_cast<int64_t>(key) % 1000);
+  }
+  std::vector<uint32_t> values(CHECK_COUNT);
+  for (uint32_t i = 0; i < CHECK_COUNT; ++i) {
+    values[i] = i;
+  }
+  std::vector<std::pair<K, uint32_t>> expected{};
+  for (uint32_t i = 0; i < CHECK_COUNT; ++i) {
+    expected.push_back({keys[i], values[i]});
+  }
+  std::stable_sort(
+      expected.begin(), expected.end(),
+      [](const auto &a, const auto &b) { return a.first < b.first; });
+
+  radixSort.sort(std::span<K>(keys), std::span<uint32_t>(values));
+  for (uint32_t i = 0; i < CHECK_COUNT; ++i) {
+    if (keys[i] != expected[i].first || values[i] != expected[i].second) {
+      std::printf("Unexpected %s sort result at %u\n", name, i);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool checkSegmentedSort(vinkan::GpuRadixSort &radixSort) {
+  auto keys = randomKeys<uint32_t>(CHECK_COUNT, 2);
+  // Segments of growing sizes, some of them empty
+  std::vector<uint32_t> segmentOffsets{};
+  for (uint32_t offset = 0, size = 0; offset < CHECK_COUNT; offset += size) {
+    segmentOffsets.push_back(offset);
+    size = (size * 7 + 3) % 5000;
+  }
+  auto expected = keys;
+  for (size_t i = 0; i < segmentOffsets.size(); ++i) {
+    uint32_t end =
+        i + 1 < segmentOffsets.size() ? segmentOffsets[i + 1] : CHECK_COUNT;
+    std::sort(expected.begin() + segmentOffsets[i], expected.begin() + end);
+  }
+  radixSort.segmentedSort(std::span<uint32_t>(keys),
+                          std::span<const uint32_t>(segmentOffsets));
+  if (keys != expected) {
+    std::printf("Unexpected segmented sort result\n");
+    return false;
+  }
+  return true;
+}
+
+template <typename K>
+void benchmark(BenchContext &context, vinkan::GpuRadixSort &radixSort,
+               vinkan::Resources<BenchBuffer, BenchSet, BenchSetLayout,
+                                 BenchPool> &resources,
+               vinkan::CommandCoordinator<BenchCommandBuffer,
+                                          BenchCommandPool> &coordinator,
+               VkFence fence, uint32_t count, bool withValues,
+               const char *name) {
+  auto keys = randomKeys<K>(count, 3);
+  VkDeviceSize keysSize = static_cast<VkDeviceSize>(count) * sizeof(K);
+  vinkan::Buffer &staging = resources.get(BenchBuffer::STAGING);
+  std::memcpy(staging.getMappedMemory(), keys.data(), keysSize);
+
+  VkCommandBuffer resetCommand =
+      coordinator.beginCommandBuffer(BenchCommandBuffer::RESET);
+  // After the previous sort and before the next one
+  VkMemoryBarrier barrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                          .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+                          .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT};
+  vkCmdPipelineBarrier(resetCommand, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0,
+                       nullptr, 0, nullptr);
+  VkBufferCopy region{.size = keysSize};
+  vkCmdCopyBuffer(resetCommand, staging.getHandle(),
+                  resources.get(BenchBuffer::KEYS).getHandle(), 1, &region);
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  vkCmdPipelineBarrier(resetCommand, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0,
+                       nullptr, 0, nullptr);
+  coordinator.endCommandBuffer(resetCommand);
+  VkCommandBuffer sortCommand =
+      coordinator.beginCommandBuffer(BenchCommandBuffer::SORT);
+  radixSort.recordSort(sortCommand, vinkan::getSortKeyType<K>(),
+                       resources.get(BenchBuffer::KEYS),
+                       withValues ? &resources.get(BenchBuffer::VALUES)
+                                  : nullptr,
+                       count, resources.get(BenchBuffer::SCRATCH));
+  coordinator.endCommandBuffer(sortCommand);
+
+  std::vector<double> gpuTimes{};
+  std::vector<double> cpuTimes{};
+  std::vector<std::pair<K, uint32_t>> pairs(withValues ? count : 0);
+  for (uint32_t i = 0; i < WARMUP_ITERATIONS + ITERATIONS; ++i) {
+    submitAndWait(context, coordinator, resetCommand, fence);
+    double gpuTime =
+        submitAndWait(context, coordinator, sortCommand, fence) / 1000.;
+
+    double cpuTime = 0.;
+    if (withValues) {
+      for (uint32_t j = 0; j < count; ++j) {
+        pairs[j] = {keys[j], j};
+      }
+      BenchTimer cpuTimer;
+      std::sort(pairs.begin(), pairs.end(), [](const auto &a, const auto &b) {
+        return a.first < b.first;
+      });
+      cpuTime = cpuTimer.elapsedUs() / 1000.;
+    } else {
+      auto copy = keys;
+      BenchTimer cpuTimer;
+      std::sort(copy.begin(), copy.end());
+      cpuTime = cpuTimer.elapsedUs() / 1000.;
+    }
+    if (i >= WARMUP_ITERATIONS) {
+      gpuTimes.push_back(gpuTime);
+      cpuTimes.push_back(cpuTime);
+    }
+  }
+  auto gpuStats = computeStats(gpuTimes);
+  auto cpuStats = computeStats(cpuTimes);
+  char label[64];
+  std::snprintf(label, sizeof(label), "radix sort %s, %u", name, count);
+  printStats(label, gpuStats, "ms");
+  std::snprintf(label, sizeof(label), "std::sort %s, %u", name, count);
+  printStats(label, cpuStats, "ms");
+  std::printf("%-40s %.2fx\n", "speedup (p50)", cpuStats.p50 / gpuStats.p50);
+}
+
+int main() {
+  BenchContext context;
+  if (!context.physicalDevice->supportsFullComputeSubgroups()) {
+    std::printf("The radix sort kernels need full compute subgroups\n");
+    return 1;
+  }
+  context.createDevice([](vinkan::Device<BenchQueue>::Builder &builder) {
+    builder.enableBufferDeviceAddress();
+    // The benchmark instance is Vulkan 1.2
+    builder.addExtensions({VK_EXT_SUBGROUP_SIZE_CONTROL_EXTENSION_NAME});
+    builder.enableFullComputeSubgroups();
+  });
+  VkDevice device = context.device->getHandle();
+  vinkan::KernelLibraryInfo kernelsInfo{
+      .queue = context.queue, .queueFamilyIndex = context.queueFamilyIndex};
+  vinkan::GpuPrimitives primitives(device, *context.physicalDevice,
+                                   kernelsInfo);
+  vinkan::GpuRadixSort radixSort(device, *context.physicalDevice, primitives,
+                                 kernelsInfo);
+  if (!checkSort<uint32_t>(radixSort, "u32") ||
+      !checkSort<int32_t>(radixSort, "i32") ||
+      !checkSort<float>(radixSort, "f32") ||
+      !checkSort<uint64_t>(radixSort, "u64") ||
+      !checkSort<int64_t>(radixSort, "i64") ||
+      !checkSort<double>(radixSort, "f64") || !checkSegmentedSort(radixSort)) {
+    return 1;
+  }
+
+  // Sized for the largest sort, smaller ones use the start of the buffers
+  vinkan::Resources<BenchBuffer, BenchSet, BenchSetLayout, BenchPool>
+      resources(device, context.physicalDevice->getMemoryProperties());
+  VkDeviceSize maxKeysSize =
+      static_cast<VkDeviceSize>(MAX_COUNT) * sizeof(uint64_t);
+  VkBufferUsageFlags storageUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                    VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+  resources.create(
+      BenchBuffer::STAGING,
+      vinkan::BufferInfo{
+          .instanceSize = maxKeysSize,
+          .instanceCount = 1,
+          .usageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+          .sharingMode = {.value = VK_SHARING_MODE_EXCLUSIVE},
+          .memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT});
+  resources.get(BenchBuffer::STAGING).map();
+  resources.create(
+      BenchBuffer::KEYS,
+      vinkan::BufferInfo{
+          .instanceSize = maxKeysSize,
+          .instanceCount = 1,
+          .usageFlags = storageUsage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+          .sharingMode = {.value = VK_SHARING_MODE_EXCLUSIVE},
+          .memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT});
+  resources.create(
+      BenchBuffer::VALUES,
+      vinkan::BufferInfo{
+          .instanceSize = MAX_COUNT * sizeof(uint32_t),
+          .instanceCount = 1,
+          .usageFlags = storageUsage,
+          .sharingMode = {.value = VK_SHARING_MODE_EXCLUSIVE},
+          .memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT});
+  resources.create(BenchBuffer::SCRATCH,
+                   vinkan::GpuRadixSort::getScratchBufferInfo(
+                       vinkan::GpuRadixSort::getScratchSize(
+                           vinkan::SortKeyType::U64, MAX_COUNT, true)));
+
+  vinkan::CommandCoordinator<BenchCommandBuffer, BenchCommandPool> coordinator(
+      device);
+  coordinator.createCommandPool(BenchCommandPool::POOL,
+                                context.queueFamilyIndex, false);
+  coordinator.createLongLivedCommand(
+      {BenchCommandBuffer::RESET, BenchCommandBuffer::SORT},
+      BenchCommandPool::POOL);
+  vinkan::SyncMechanisms<BenchFence, BenchSemaphore> syncMechanisms(device);
+  syncMechanisms.createFence(BenchFence::FENCE);
+  VkFence fence = syncMechanisms.getFence(BenchFence::FENCE);
+
+  for (uint32_t count : {1u << 16, 1u << 20, 1u << 22, MAX_COUNT}) {
+    coordinator.resetCommandBuffer(BenchCommandBuffer::RESET);
+    coordinator.resetCommandBuffer(BenchCommandBuffer::SORT);
+    benchmark<uint32_t>(context, radixSort, resources, coordinator, fence,
+                        count, false, "u32 keys");
+    coordinator.resetCommandBuffer(BenchCommandBuffer::RESET);
+    coordinator.resetCommandBuffer(BenchCommandBuffer::SORT);
+    benchmark<uint32_t>(context, radixSort, resources, coordinator, fence,
+                        count, true, "u32 pairs");
+    coordinator.resetCommandBuffer(BenchCommandBuffer::RESET);
+    coordinator.resetCommandBuffer(BenchCommandBuffer::SORT);
+    benchmark<uint64_t>(context, radixSort, resources, coordinator, fence,
+                        count, false, "u64 keys");
+  }
+}
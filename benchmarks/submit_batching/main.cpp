@@ -0,0 +1,106 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <vinkan/commands/submit_batch.hpp>
+
+#include "bench_context.hpp"
+#include "bench_stats.hpp"
+
+// Compares N calls to CommandCoordinator::submitCommandBuffer against one
+// SubmitBatch flush of the same N submissions.
+//
+// For each iteration we report the CPU time spent submitting and the time
+// until the fence of the last submission is signaled.
+
+enum class BenchCommandBuffer {};
+enum class BenchCommandPool { SINGLE_USE_POOL };
+
+constexpr uint32_t WARMUP_ITERATIONS = 20;
+constexpr uint32_t ITERATIONS = 200;
+
+struct BenchResult {
+  std::vector<double> submitUs;
+  std::vector<double> completionUs;
+};
+
+template <typename SubmitFn>
+BenchResult runBenchmark(VkDevice device, VkFence fence, SubmitFn submit) {
+  BenchResult result;
+  for (uint32_t i = 0; i < WARMUP_ITERATIONS + ITERATIONS; ++i) {
+    BenchTimer timer;
+    submit();
+    double submitUs = timer.elapsedUs();
+    vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+    double completionUs = timer.elapsedUs();
+    vkResetFences(device, 1, &fence);
+    if (i >= WARMUP_ITERATIONS) {
+      result.submitUs.push_back(submitUs);
+      result.completionUs.push_back(completionUs);
+    }
+  }
+  return result;
+}
+
+int main() {
+  BenchContext context;
+  context.createDevice();
+  VkDevice device = context.device->getHandle();
+
+  vinkan::CommandCoordinator<BenchCommandBuffer, BenchCommandPool> coordinator(
+      device);
+  coordinator.createCommandPool(BenchCommandPool::SINGLE_USE_POOL,
+                                context.queueFamilyIndex, true);
+
+  enum class BenchFence { FENCE };
+  enum class BenchSemaphore {};
+  vinkan::SyncMechanisms<BenchFence, BenchSemaphore> syncMechanisms(device);
+  syncMechanisms.createFence(BenchFence::FENCE);
+  VkFence fence = syncMechanisms.getFence(BenchFence::FENCE);
+
+  for (uint32_t submitCount : {1u, 8u, 32u, 128u}) {
+    // Empty command buffers, we only measure the submission cost
+    std::vector<VkCommandBuffer> commandBuffers;
+    for (uint32_t i = 0; i < submitCount; ++i) {
+      auto commandBuffer = coordinator.createSingleUseCommandBuffer(
+          BenchCommandPool::SINGLE_USE_POOL);
+      coordinator.beginCommandBuffer(commandBuffer);
+      coordinator.endCommandBuffer(commandBuffer);
+      commandBuffers.push_back(commandBuffer);
+    }
+
+    auto individual = runBenchmark(device, fence, [&]() {
+      for (uint32_t i = 0; i < submitCount; ++i) {
+        vinkan::SubmitCommandBufferInfo submitInfo{
+            .signalFence = i + 1 == submitCount ? fence : VK_NULL_HANDLE,
+            .queue = context.queue};
+        coordinator.submitCommandBuffer(commandBuffers[i], submitInfo);
+      }
+    });
+
+    vinkan::SubmitBatch batch(context.queue);
+    auto batched = runBenchmark(device, fence, [&]() {
+      for (uint32_t i = 0; i < submitCount; ++i) {
+        batch.add(commandBuffers[i], vinkan::SubmitCommandBufferInfo{});
+      }
+      batch.flush(fence);
+    });
+
+    std::string suffix = " x" + std::to_string(submitCount);
+    printStats("individual submit" + suffix, computeStats(individual.submitUs),
+               "us, cpu");
+    printStats("batched submit" + suffix, computeStats(batched.submitUs),
+               "us, cpu");
+    printStats("individual completion" + suffix,
+               computeStats(individual.completionUs), "us");
+    printStats("batched completion" + suffix,
+               computeStats(batched.completionUs), "us");
+    std::printf("%-40s %.1f submits per vkQueueSubmit\n",
+                ("batched" + suffix).c_str(),
+                batch.getStats().averageSubmitsPerFlush());
+
+    for (auto commandBuffer : commandBuffers) {
+      coordinator.freeCommandBuffer(BenchCommandPool::SINGLE_USE_POOL,
+                                    commandBuffer);
+    }
+  }
+}
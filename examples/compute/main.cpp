@@ -36,6 +36,9 @@ using MyAppResources =
                       MyAppDescriptorSetLayout, MyAppDescriptorPool>;
 
 int main() {
+  // Accounts the driver host allocations, declared first to outlive everything
+  vinkan::HostAllocator hostAllocator;
+
   // Create the instance
   std::vector<const char *> extraExtensions{};
   vinkan::InstanceInfo instanceInfo{
@@ -47,7 +50,8 @@ int main() {
       .apiVersion = VK_API_VERSION_1_2,
       .validationLayers = MyAppValidationLayers,
       .includePortabilityExtensions = NEED_PORTABILITY_EXTENSIONS,
-      .extraVkExtensions = extraExtensions};
+      .extraVkExtensions = extraExtensions,
+      .allocator = hostAllocator.getCallbacks()};
   vinkan::Instance instance(instanceInfo);
 
   // Create the physical device
@@ -62,6 +66,7 @@ int main() {
   vinkan::Device<MyAppQueue>::Builder deviceBuilder(physicalDevice.getHandle(),
                                                     physicalDevice.getQueues());
   deviceBuilder.addExtensions(DEVICE_EXTENSIONS);
+  deviceBuilder.setAllocator(hostAllocator.getCallbacks());
   vinkan::QueueFamilyRequest<MyAppQueue> queueRequest{
       .queueFamilyIdentifier = MyAppQueue::COMPUTE_QUEUE,
       .flagsRequested = VK_QUEUE_COMPUTE_BIT,
@@ -74,9 +79,14 @@ int main() {
   assert(success);
   auto device = deviceBuilder.build();
 
+  // Name the objects after their identifier in the validation messages
+  vinkan::DebugUtils debugUtils(instance.getHandle(), device->getHandle());
+
   // Initialize the resources
   MyAppResources resources(device->getHandle(),
-                           physicalDevice.getMemoryProperties());
+                           physicalDevice.getMemoryProperties(),
+                           device->getAllocator());
+  resources.setDebugUtils(&debugUtils);
   // Create a set layout with one storage buffer on binding 0
   vinkan::SetLayoutInfo layoutInfo{
       .nSets = 1,
@@ -125,7 +135,8 @@ int main() {
 
   // Initialize the pipelines
   vinkan::Pipelines<MyAppPipeline, MyAppPipelineLayout> pipelines_(
-      device->getHandle());
+      device->getHandle(), device->getAllocator());
+  pipelines_.setDebugUtils(&debugUtils);
   // Create a pipeline layout
   pipelines_.createLayout<MyAppPC>(
       MyAppPipelineLayout::COMPUTE_PIP_LAYOUT,
@@ -147,13 +158,13 @@ int main() {
 
   // Create a fence
   vinkan::SyncMechanisms<MyAppFence, MyAppSemaphore> syncMechanisms(
-      device->getHandle());
+      device->getHandle(), device->getAllocator());
   syncMechanisms.createFence(MyAppFence::COMPUTE_FENCE);
   auto fence = syncMechanisms.getFence(MyAppFence::COMPUTE_FENCE);
 
   // Initialize commands
   vinkan::CommandCoordinator<MyAppCommandBuffer, MyAppCommandPool> coordinator(
-      device->getHandle());
+      device->getHandle(), false, device->getAllocator());
   // Create a single use pool
   coordinator.createCommandPool(
       MyAppCommandPool::SINGLE_USE_COMPUTE_POOL,
@@ -165,6 +176,7 @@ int main() {
 
   // Begin and record command
   coordinator.beginCommandBuffer(commandBuffer);
+  debugUtils.beginLabel(commandBuffer, "Addition");
   pipelines_.bindCmdBuffer(commandBuffer, MyAppPipeline::COMPUTE_PIPELINE);
   VkDescriptorSet descSet =
       resources.get(MyAppDescriptorSet::SIMPLE_DESCRIPTOR_SET);
@@ -177,7 +189,13 @@ int main() {
   vkCmdPushConstants(
       commandBuffer, pipelines_.get(MyAppPipelineLayout::COMPUTE_PIP_LAYOUT),
       VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(MyAppPC), &pushConstants);
-  vkCmdDispatch(commandBuffer, 1, 1, 1);
+  // One invocation per value, the group count comes from the shader's
+  // workgroup size
+  vinkan::cmdDispatchExtent(
+      commandBuffer, vinkan::DispatchExtent{.x = bufferData.size()},
+      pipelines_.getWorkgroupSize(MyAppPipeline::COMPUTE_PIPELINE),
+      physicalDevice.getLimits());
+  debugUtils.endLabel(commandBuffer);
   coordinator.endCommandBuffer(commandBuffer);
 
   // Submit the command
@@ -194,4 +212,9 @@ int main() {
   buffer.readBuffer(bufferData.data());
   buffer.unmap();
   std::cout << "Finished, first element: " << bufferData[0] << std::endl;
+
+  for (auto &warning : instance.getDiagnostics().takePerformanceWarnings()) {
+    std::cout << "Performance warning: " << warning.text << std::endl;
+  }
+  hostAllocator.logStats();
 }
@@ -20,10 +20,8 @@ enum class MyAppPipeline { GRAPHICS_PIPELINE };
 enum class MyAppAttachment { SWAPCHAIN_ATTACHMENT };
 
 // Command buffers
-enum class MyAppCommandBuffer { GRAPHICS_CMD_1, GRAPHICS_CMD_2, TRANSFER_CMD };
+enum class MyAppCommandBuffer { TRANSFER_CMD };
 enum class MyAppCommandPool { GRAPHICS_POOL };
-enum class MyAppFence { GRAPHICS_FENCE };
-enum class MyAppSemaphore { IMG_AVAILABLE, DRAW_FINISH };
 
 // Push constants
 struct MyAppPC {
@@ -143,24 +143,17 @@ int main() {
                             fragmentShaderFileInfo, renderPass->getHandle(),
                             bindingDescription, attributeDescriptions);
 
+  // The swapchain can create more images than requested, one framebuffer is
+  // needed per image
+  auto swapchainImageViews = swapchain.getImageViews();
   vinkan::RenderStage::Builder<MyAppAttachment> builder(
-      *renderPass, device->getHandle(), imageCount);
+      *renderPass, device->getHandle(),
+      static_cast<uint32_t>(swapchainImageViews.size()));
   builder.defineAttachment(MyAppAttachment::SWAPCHAIN_ATTACHMENT,
-                           swapchain.getImageViews());
+                           swapchainImageViews);
   std::unique_ptr<vinkan::RenderStage> renderStage =
       builder.build(swapchain.getSwapchainInfo().imageExtent);
 
-  vinkan::SyncMechanisms<MyAppFence, MyAppSemaphore> syncMechanisms(
-      device->getHandle());
-  syncMechanisms.createFence(MyAppFence::GRAPHICS_FENCE, true);
-  syncMechanisms.createSemaphore(MyAppSemaphore::IMG_AVAILABLE);
-  syncMechanisms.createSemaphore(MyAppSemaphore::DRAW_FINISH);
-  VkFence gfxFence = syncMechanisms.getFence(MyAppFence::GRAPHICS_FENCE);
-  VkSemaphore imgAvailableS =
-      syncMechanisms.getSemaphore(MyAppSemaphore::IMG_AVAILABLE);
-  VkSemaphore drawFinish =
-      syncMechanisms.getSemaphore(MyAppSemaphore::DRAW_FINISH);
-
   // Initialize commands
   vinkan::CommandCoordinator<MyAppCommandBuffer, MyAppCommandPool> coordinator(
       device->getHandle());
@@ -169,11 +162,7 @@ int main() {
       MyAppCommandPool::GRAPHICS_POOL,
       device->getQueueFamilyIndex(MyAppQueue::GRAPHICS_AND_PRESENT_QUEUE),
       false);
-  // Create 2 commands
-  coordinator.createLongLivedCommand(MyAppCommandBuffer::GRAPHICS_CMD_1,
-                                     MyAppCommandPool::GRAPHICS_POOL);
-  coordinator.createLongLivedCommand(MyAppCommandBuffer::GRAPHICS_CMD_2,
-                                     MyAppCommandPool::GRAPHICS_POOL);
+  // Create the transfer command (the frame manager owns the frame commands)
   coordinator.createLongLivedCommand(MyAppCommandBuffer::TRANSFER_CMD,
                                      MyAppCommandPool::GRAPHICS_POOL);
 
@@ -196,54 +185,47 @@ int main() {
       device->getQueue(MyAppQueue::GRAPHICS_AND_PRESENT_QUEUE, 0);
   triangle.transferModelToDevice(transferCmd, triangleData, transferQueue);
 
+  // 2 frames in flight, the CPU records a frame while the GPU renders the
+  // previous one
+  vinkan::FrameManager frameManager(
+      device->getHandle(), swapchain,
+      device->getQueueFamilyIndex(MyAppQueue::GRAPHICS_AND_PRESENT_QUEUE), 2);
+  VkQueue queue = device->getQueue(MyAppQueue::GRAPHICS_AND_PRESENT_QUEUE, 0);
+
+  // The scene never changes, each swapchain image gets a command buffer
+  // recorded once and resubmitted every frame. beginFrame waits for the last
+  // frame that used the image so its command buffer can be recorded again.
+  vinkan::StaticCommandCache sceneCommands(
+      device->getHandle(),
+      device->getQueueFamilyIndex(MyAppQueue::GRAPHICS_AND_PRESENT_QUEUE),
+      frameManager.getImageCount(),
+      [&](VkCommandBuffer commandBuffer, uint32_t imageIndex) {
+        renderStage->beginRenderPass(commandBuffer, imageIndex);
+        pipelines.bindCmdBuffer(commandBuffer,
+                                MyAppPipeline::GRAPHICS_PIPELINE);
+        triangle.draw(commandBuffer);
+        vkCmdEndRenderPass(commandBuffer);
+      });
+
   while (!glfwWindowShouldClose(window)) {
     glfwPollEvents();
 
-    // Wait for previous frame
-    vkWaitForFences(device->getHandle(), 1, &gfxFence, VK_TRUE, UINT64_MAX);
-    vkResetFences(device->getHandle(), 1, &gfxFence);
-
-    // Acquire next image
-    auto imageNumberOpt =
-        swapchain.acquireNextImageIndex(imgAvailableS, VK_NULL_HANDLE);
-    if (!imageNumberOpt.has_value()) {
+    // Wait for the frame slot and acquire the next image
+    auto frameOpt = frameManager.beginFrame();
+    if (!frameOpt.has_value()) {
       throw std::runtime_error("No support for resizing");
     }
-    auto imageNumber = imageNumberOpt.value();
-
-    // Select command buffer (alternate between the two)
-    MyAppCommandBuffer currentCmd = (imageNumber % 2 == 0)
-                                        ? MyAppCommandBuffer::GRAPHICS_CMD_1
-                                        : MyAppCommandBuffer::GRAPHICS_CMD_2;
-
-    // Record command buffer
-    coordinator.resetCommandBuffer(currentCmd);
-    auto commandBuffer = coordinator.beginCommandBuffer(currentCmd);
-
-    // Begin render pass
-    renderStage->beginRenderPass(commandBuffer, imageNumber);
-
-    // Bind pipeline
-    pipelines.bindCmdBuffer(commandBuffer, MyAppPipeline::GRAPHICS_PIPELINE);
-    // Draw triangle
-    triangle.draw(commandBuffer);
-
-    // End render pass
-    vkCmdEndRenderPass(commandBuffer);
-    coordinator.endCommandBuffer(commandBuffer);
-
-    // Submit
-    VkQueue queue = device->getQueue(MyAppQueue::GRAPHICS_AND_PRESENT_QUEUE, 0);
-    vinkan::SubmitCommandBufferInfo submitInfo{
-        .waitSemaphores = {imgAvailableS},
-        .waitDstStages = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT},
-        .signalSemaphores = {drawFinish},
-        .signalFence = gfxFence,
-        .queue = device->getQueue(MyAppQueue::GRAPHICS_AND_PRESENT_QUEUE, 0)};
-    coordinator.submitCommandBuffer(commandBuffer, submitInfo);
-
-    // Present
-    swapchain.present(imageNumber, queue, drawFinish);
+    auto frame = frameOpt.value();
+
+    // Only recorded again if the pipeline or the framebuffer changed
+    vinkan::StaticCommandInputs sceneInputs{
+        .pipeline = pipelines.getPipeline(MyAppPipeline::GRAPHICS_PIPELINE),
+        .framebuffer = renderStage->getFramebuffer(frame.imageIndex)};
+    frameManager.submitWithFrame(
+        sceneCommands.get(frame.imageIndex, sceneInputs));
+
+    // Submit and present
+    frameManager.endFrame(queue);
   }
 
   vkDeviceWaitIdle(device->getHandle());
@@ -0,0 +1,68 @@
+# Compiles the kernels of the kernel libraries to <kernel>_<variant>.spv in
+# VINKAN_KERNELS_DIR, one variant per element or key type
+set(VINKAN_KERNELS_DIR ${CMAKE_CURRENT_BINARY_DIR}/kernels)
+set(VINKAN_KERNELS_SOURCE_DIR
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/vinkan/kernels/shaders)
+
+set(VINKAN_KERNEL_INCLUDES
+    ${VINKAN_KERNELS_SOURCE_DIR}/primitives_common.slang
+    ${VINKAN_KERNELS_SOURCE_DIR}/radix_common.slang
+    ${VINKAN_KERNELS_SOURCE_DIR}/image_common.slang
+)
+
+set(VINKAN_KERNEL_FILES)
+# Extra arguments are passed to slangc
+function(vinkan_add_kernel kernel variant)
+    set(kernelFile ${VINKAN_KERNELS_DIR}/${kernel}_${variant}.spv)
+    add_custom_command(
+        OUTPUT ${kernelFile}
+        COMMAND ${CMAKE_COMMAND} -E make_directory ${VINKAN_KERNELS_DIR}
+        COMMAND ${SLANGC_EXECUTABLE}
+            ${VINKAN_KERNELS_SOURCE_DIR}/${kernel}.slang
+            -target spirv -profile spirv_1_5
+            -entry main -stage compute
+            -I ${VINKAN_KERNELS_SOURCE_DIR}
+            ${ARGN}
+            -o ${kernelFile}
+        DEPENDS
+            ${VINKAN_KERNELS_SOURCE_DIR}/${kernel}.slang
+            ${VINKAN_KERNEL_INCLUDES}
+        COMMENT "Compiling the ${kernel} kernel for ${variant}"
+        VERBATIM
+    )
+    set(VINKAN_KERNEL_FILES ${VINKAN_KERNEL_FILES} ${kernelFile} PARENT_SCOPE)
+endfunction()
+
+# GpuPrimitives
+foreach(kernel reduce scan compact)
+    foreach(type u32 i32 f32)
+        string(TOUPPER ${type} typeDefine)
+        vinkan_add_kernel(${kernel} ${type} -DVINKAN_ELEMENT_${typeDefine})
+    endforeach()
+endforeach()
+
+# GpuRadixSort, the 64 bits keys are pairs of 32 bits words
+foreach(kernel radix_histogram radix_scatter)
+    foreach(bits 32 64)
+        vinkan_add_kernel(${kernel} k${bits} -DVINKAN_KEY_${bits})
+    endforeach()
+endforeach()
+vinkan_add_kernel(radix_segments pack -DVINKAN_SEGMENTS_PACK)
+vinkan_add_kernel(radix_segments unpack -DVINKAN_SEGMENTS_UNPACK)
+
+# GpuGemm
+vinkan_add_kernel(gemm f32)
+vinkan_add_kernel(gemm f16 -DVINKAN_GEMM_F16)
+
+# GpuImageProcessing, one variant per pixel format and conversion direction
+foreach(format rgba8 rgba32f)
+    string(TOUPPER ${format} formatDefine)
+    set(formatArgument -DVINKAN_PIXEL_${formatDefine})
+    vinkan_add_kernel(image_convolve ${format} ${formatArgument})
+    vinkan_add_kernel(image_resize ${format} ${formatArgument})
+    vinkan_add_kernel(image_color to_rgb_${format} ${formatArgument})
+    vinkan_add_kernel(image_color to_nv12_${format} ${formatArgument}
+        -DVINKAN_TO_NV12)
+endforeach()
+
+add_custom_target(VinkanKernels DEPENDS ${VINKAN_KERNEL_FILES})
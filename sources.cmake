@@ -6,19 +6,59 @@ list(APPEND VINKAN_SOURCES
     src/vinkan/wrappers/physical_device.cpp
     src/vinkan/wrappers/swapchain.cpp
 		src/vinkan/wrappers/buffer.cpp
+		src/vinkan/wrappers/device_dispatch.cpp
 
 		src/vinkan/wrappers/descriptors/descriptor_pool.cpp
 		src/vinkan/wrappers/descriptors/descriptor_set_layout.cpp
 		src/vinkan/wrappers/descriptors/descriptor_set.cpp
 
+		src/vinkan/coroutines/gpu_reactor.cpp
+
+		src/vinkan/jobs/job_system.cpp
+
+		src/vinkan/kernels/gpu_gemm.cpp
+		src/vinkan/kernels/gpu_image_processing.cpp
+		src/vinkan/kernels/gpu_primitives.cpp
+		src/vinkan/kernels/gpu_radix_sort.cpp
+		src/vinkan/kernels/kernel_commands.cpp
+		src/vinkan/kernels/kernel_host_runner.cpp
+
+		src/vinkan/logging/chrome_trace.cpp
+		src/vinkan/logging/debug_utils.cpp
+		src/vinkan/logging/diagnostics.cpp
+		src/vinkan/logging/tracer.cpp
+
+		src/vinkan/memory/host_allocator.cpp
+
 		src/vinkan/pipelines/shader_module_maker.cpp
+		src/vinkan/pipelines/spirv_reflection.cpp
+
+		src/vinkan/profiling/gpu_profiler.cpp
+		src/vinkan/profiling/pipeline_executable_report.cpp
+
+		src/vinkan/sync/barriers.cpp
+		src/vinkan/sync/fence_pool.cpp
+		src/vinkan/sync/in_flight_tracker.cpp
+		src/vinkan/sync/queue_dependency.cpp
+		src/vinkan/sync/resource_state.cpp
+
+		src/vinkan/commands/command_recorder.cpp
+		src/vinkan/commands/dispatch_sizing.cpp
+		src/vinkan/commands/hot_kernel.cpp
+		src/vinkan/commands/queue_scheduler.cpp
+		src/vinkan/commands/static_command_cache.cpp
+		src/vinkan/commands/submit_batch.cpp
+
+		src/vinkan/render/frame_manager.cpp
 )
 list(APPEND VINKAN_HEADERS
     src/vinkan/wrappers/instance.hpp
     src/vinkan/wrappers/device.hpp
+    src/vinkan/wrappers/device_dispatch.hpp
     src/vinkan/wrappers/swapchain.hpp
     src/vinkan/wrappers/render_pass.hpp
 		src/vinkan/wrappers/buffer.hpp
+		src/vinkan/wrappers/indirect_buffer.hpp
 		src/vinkan/resources/resources.hpp
 		src/vinkan/resources/resources_binder.hpp
 
@@ -26,8 +66,50 @@ list(APPEND VINKAN_HEADERS
 		src/vinkan/wrappers/descriptors/descriptor_set_layout.hpp
 		src/vinkan/wrappers/descriptors/descriptor_set.hpp
 
+		src/vinkan/coroutines/gpu_reactor.hpp
+		src/vinkan/coroutines/task.hpp
+		src/vinkan/generics/enum_name.hpp
+		src/vinkan/generics/macros.hpp
+		src/vinkan/jobs/job_system.hpp
+		src/vinkan/kernels/gpu_gemm.hpp
+		src/vinkan/kernels/gpu_image_processing.hpp
+		src/vinkan/kernels/gpu_primitives.hpp
+		src/vinkan/kernels/gpu_radix_sort.hpp
+		src/vinkan/kernels/kernel_commands.hpp
+		src/vinkan/kernels/kernel_host_runner.hpp
+		src/vinkan/kernels/kernel_library_info.hpp
+		src/vinkan/logging/chrome_trace.hpp
+		src/vinkan/logging/debug_utils.hpp
+		src/vinkan/logging/diagnostics.hpp
+		src/vinkan/logging/logger.hpp
+		src/vinkan/logging/tracer.hpp
+
+		src/vinkan/memory/host_allocator.hpp
+
 		src/vinkan/pipelines/pipelines.hpp
 		src/vinkan/pipelines/shader_module_maker.hpp
+		src/vinkan/pipelines/spirv_reflection.hpp
+
+		src/vinkan/profiling/gpu_profiler.hpp
+		src/vinkan/profiling/pipeline_executable_report.hpp
+		src/vinkan/profiling/pipeline_statistics.hpp
+
+		src/vinkan/sync/barriers.hpp
+		src/vinkan/sync/fence_pool.hpp
+		src/vinkan/sync/in_flight_tracker.hpp
+		src/vinkan/sync/queue_dependency.hpp
+		src/vinkan/sync/resource_state.hpp
+
+		src/vinkan/commands/command_recorder.hpp
+		src/vinkan/commands/compute_coalescer.hpp
+		src/vinkan/commands/dispatch_sizing.hpp
+		src/vinkan/commands/hot_kernel.hpp
+		src/vinkan/commands/queue_scheduler.hpp
+		src/vinkan/commands/static_command_cache.hpp
+		src/vinkan/commands/submit_batch.hpp
+
+		src/vinkan/render/frame_manager.hpp
+		src/vinkan/render/render_graph.hpp
 )
 
 if(VINKAN_WITH_GLFW)
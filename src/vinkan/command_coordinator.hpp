@@ -3,12 +3,18 @@
 
 #include <vulkan/vulkan.h>
 
+#include <functional>
 #include <map>
 #include <set>
 #include <vector>
 #include <vinkan/logging/logger.hpp>
 
 #include "vinkan/generics/concepts.hpp"
+#include "vinkan/jobs/job_system.hpp"
+#include "vinkan/logging/tracer.hpp"
+#include "vinkan/sync/barriers.hpp"
+#include "vinkan/sync/in_flight_tracker.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
 
 namespace vinkan {
 
@@ -20,6 +26,21 @@ struct SubmitCommandBufferInfo {
   VkQueue queue;
 };
 
+struct SemaphoreSubmit {
+  VkSemaphore semaphore;
+  VkPipelineStageFlags2 stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+  uint64_t value = 0;  // Only used by timeline semaphores
+};
+
+// Submission info for the synchronization2 path, every semaphore carries its
+// own stage mask so the driver only waits (or signals) where it's needed.
+struct SubmitCommandBufferInfo2 {
+  std::vector<SemaphoreSubmit> waitSemaphores{};
+  std::vector<SemaphoreSubmit> signalSemaphores{};
+  VkFence signalFence = VK_NULL_HANDLE;
+  VkQueue queue;
+};
+
 template <EnumType CommandT, EnumType CommandPoolT>
 class CommandCoordinator {
  public:
@@ -28,28 +49,40 @@ class CommandCoordinator {
     return commandBuffers_.at(commandIdentifier);
   }
 
-  CommandCoordinator(VkDevice device) : device_(device) {}
+  // synchronization2 must only be set if the feature has been enabled on the
+  // device, otherwise the legacy submission path is used.
+  CommandCoordinator(VkDevice device, bool synchronization2 = false,
+                     const VkAllocationCallbacks* allocator = nullptr)
+      : device_(device),
+        synchronization2_(synchronization2),
+        allocator_(allocator) {}
   ~CommandCoordinator() {
     for (auto& [identifier, pool] : commandPools_) {
-      vkDestroyCommandPool(device_, pool, nullptr);
+      vkDestroyCommandPool(device_, pool, allocator_);
     }
   }
 
   CommandCoordinator(const CommandCoordinator&) = delete;
   CommandCoordinator& operator=(const CommandCoordinator&) = delete;
 
+  // recordCommandBuffers then records in parallel
+  void setJobSystem(JobSystem* jobSystem) { jobSystem_ = jobSystem; }
+
   void createCommandPool(CommandPoolT commandPoolIdentifier,
                          uint32_t queueFamilyIndex, bool singleUsagePool) {
     assert(!commandPools_.contains(commandPoolIdentifier));
     VkCommandPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    // Single use buffers can be reset individually so that they're recycled
     poolInfo.flags = singleUsagePool
-                         ? VK_COMMAND_POOL_CREATE_TRANSIENT_BIT
+                         ? VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |
+                               VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT
                          : VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
     poolInfo.queueFamilyIndex = queueFamilyIndex;
 
     VkCommandPool pool;
-    if (vkCreateCommandPool(device_, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+    if (vkCreateCommandPool(device_, &poolInfo, allocator_, &pool) !=
+        VK_SUCCESS) {
       throw std::runtime_error("Failed to create command pool");
     }
     if (singleUsagePool) {
@@ -61,8 +94,8 @@ class CommandCoordinator {
   void resetCommandBuffer(CommandT commandIdentifier) {
     assert(commandBuffers_.contains(commandIdentifier));
 
-    if (vkResetCommandBuffer(commandBuffers_[commandIdentifier], 0) !=
-        VK_SUCCESS) {
+    if (deviceDispatch.vkResetCommandBuffer(commandBuffers_[commandIdentifier],
+                                            0) != VK_SUCCESS) {
       throw std::runtime_error("Failed to reset command buffer");
     }
     SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Command buffer reset");
@@ -81,8 +114,8 @@ class CommandCoordinator {
         static_cast<uint32_t>(commandIdentifiers.size());
 
     std::vector<VkCommandBuffer> commandBuffers(commandIdentifiers.size());
-    if (vkAllocateCommandBuffers(device_, &allocInfo, commandBuffers.data()) !=
-        VK_SUCCESS) {
+    if (deviceDispatch.vkAllocateCommandBuffers(
+            device_, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
       throw std::runtime_error("Failed to allocate command buffers");
     }
 
@@ -106,6 +139,16 @@ class CommandCoordinator {
     assert(singleUsePools_.contains(commandPoolIdentifier));
     auto commandPool = commandPools_[commandPoolIdentifier];
 
+    // The buffer is implicitly reset when it begins recording again
+    auto& freeBuffers = freeSingleUseBuffers_[commandPoolIdentifier];
+    if (!freeBuffers.empty()) {
+      VkCommandBuffer commandBuffer = freeBuffers.back();
+      freeBuffers.pop_back();
+      SPDLOG_LOGGER_TRACE(get_vinkan_logger(),
+                          "Single use command buffer recycled");
+      return commandBuffer;
+    }
+
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     allocInfo.commandPool = commandPool;
@@ -113,8 +156,8 @@ class CommandCoordinator {
     allocInfo.commandBufferCount = 1;
 
     VkCommandBuffer commandBuffer;
-    if (vkAllocateCommandBuffers(device_, &allocInfo, &commandBuffer) !=
-        VK_SUCCESS) {
+    if (deviceDispatch.vkAllocateCommandBuffers(device_, &allocInfo,
+                                                &commandBuffer) != VK_SUCCESS) {
       throw std::runtime_error("Failed to allocate single use command buffer");
     }
 
@@ -129,7 +172,8 @@ class CommandCoordinator {
 
     auto commandPool = commandToPool_[commandIdentifier];
     VkCommandBuffer commandBuffer = commandBuffers_[commandIdentifier];
-    freeCommandBuffer(commandPool, commandBuffer);
+    deviceDispatch.vkFreeCommandBuffers(device_, commandPool, 1,
+                                        &commandBuffer);
     commandBuffers_.erase(commandIdentifier);
     commandToPool_.erase(commandIdentifier);
   }
@@ -139,16 +183,48 @@ class CommandCoordinator {
     assert(commandPools_.contains(commandPoolIdentifier));
     auto commandPool = commandPools_[commandPoolIdentifier];
 
-    vkFreeCommandBuffers(device_, commandPool, 1, &commandBuffer);
+    deviceDispatch.vkFreeCommandBuffers(device_, commandPool, 1,
+                                        &commandBuffer);
     SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Command buffer freed");
   }
 
+  // Gives a single use command buffer back to its pool, the next
+  // createSingleUseCommandBuffer on this pool returns it instead of allocating.
+  // It must not be pending execution anymore.
+  void recycleCommandBuffer(CommandPoolT commandPoolIdentifier,
+                            VkCommandBuffer commandBuffer) {
+    assert(singleUsePools_.contains(commandPoolIdentifier));
+    freeSingleUseBuffers_[commandPoolIdentifier].push_back(commandBuffer);
+  }
+
+  // Submits a single use command buffer with a fence of the tracker, the
+  // command buffer is recycled once the tracker sees the fence signaled.
+  void submitSingleUseCommandBuffer(CommandPoolT commandPoolIdentifier,
+                                    VkCommandBuffer commandBuffer,
+                                    SubmitCommandBufferInfo submitBufferInfo,
+                                    InFlightTracker& tracker) {
+    assert(submitBufferInfo.signalFence == VK_NULL_HANDLE &&
+           "The fence is provided by the tracker");
+    submitBufferInfo.signalFence = tracker.acquireFence();
+    try {
+      submitCommandBuffer(commandBuffer, submitBufferInfo);
+    } catch (...) {
+      tracker.releaseFence(submitBufferInfo.signalFence);
+      throw;
+    }
+    tracker.track(submitBufferInfo.signalFence,
+                  [this, commandPoolIdentifier, commandBuffer]() {
+                    recycleCommandBuffer(commandPoolIdentifier, commandBuffer);
+                  });
+  }
+
   void beginCommandBuffer(VkCommandBuffer commandBuffer) {
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = 0;
     beginInfo.pInheritanceInfo = nullptr;
-    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+    if (deviceDispatch.vkBeginCommandBuffer(commandBuffer, &beginInfo) !=
+        VK_SUCCESS) {
       throw std::runtime_error("Failed to begin recording command buffer");
     }
   }
@@ -161,7 +237,43 @@ class CommandCoordinator {
   }
 
   void endCommandBuffer(VkCommandBuffer commandBuffer) {
-    vkEndCommandBuffer(commandBuffer);
+    deviceDispatch.vkEndCommandBuffer(commandBuffer);
+  }
+
+  // Begins, records and ends long lived command buffers. A pool can't be used
+  // by two threads at once, so each job records the buffers of one pool: put
+  // the buffers in different pools to record them in parallel.
+  void recordCommandBuffers(
+      const std::map<CommandT, std::function<void(VkCommandBuffer)>>&
+          recorders) {
+    VINKAN_TRACE_SCOPE("CommandCoordinator::recordCommandBuffers");
+    std::map<VkCommandPool, std::vector<CommandT>> commandsByPool;
+    for (auto& [commandIdentifier, recorder] : recorders) {
+      assert(commandToPool_.contains(commandIdentifier));
+      commandsByPool[commandToPool_.at(commandIdentifier)].push_back(
+          commandIdentifier);
+    }
+    std::vector<std::vector<CommandT>> poolCommands{};
+    for (auto& [pool, commandIdentifiers] : commandsByPool) {
+      poolCommands.push_back(commandIdentifiers);
+    }
+
+    auto recordPools = [&](uint32_t begin, uint32_t end) {
+      for (uint32_t i = begin; i < end; ++i) {
+        for (auto commandIdentifier : poolCommands[i]) {
+          VkCommandBuffer commandBuffer = commandBuffers_.at(commandIdentifier);
+          beginCommandBuffer(commandBuffer);
+          recorders.at(commandIdentifier)(commandBuffer);
+          endCommandBuffer(commandBuffer);
+        }
+      }
+    };
+    auto poolCount = static_cast<uint32_t>(poolCommands.size());
+    if (jobSystem_ != nullptr) {
+      jobSystem_->parallelFor(poolCount, 1, recordPools);
+    } else {
+      recordPools(0, poolCount);
+    }
   }
 
   void submitCommandBuffer(std::vector<VkCommandBuffer> commandBuffers,
@@ -181,8 +293,9 @@ class CommandCoordinator {
         static_cast<uint32_t>(submitBufferInfo.signalSemaphores.size());
     submitInfo.pSignalSemaphores = submitBufferInfo.signalSemaphores.data();
 
-    if (vkQueueSubmit(submitBufferInfo.queue, 1, &submitInfo,
-                      submitBufferInfo.signalFence) != VK_SUCCESS) {
+    if (deviceDispatch.vkQueueSubmit(submitBufferInfo.queue, 1, &submitInfo,
+                                     submitBufferInfo.signalFence) !=
+        VK_SUCCESS) {
       throw std::runtime_error("Failed to submit command buffer");
     }
     SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Command buffer submitted");
@@ -194,13 +307,131 @@ class CommandCoordinator {
                         submitBufferInfo);
   }
 
+  void submitCommandBuffer(std::vector<VkCommandBuffer> commandBuffers,
+                           SubmitCommandBufferInfo2 submitBufferInfo) {
+    if (!synchronization2_) {
+      submitLegacy_(commandBuffers, submitBufferInfo);
+      return;
+    }
+    auto toSemaphoreInfos = [](const std::vector<SemaphoreSubmit>& submits) {
+      std::vector<VkSemaphoreSubmitInfo> semaphoreInfos{};
+      for (auto& submit : submits) {
+        VkSemaphoreSubmitInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        semaphoreInfo.semaphore = submit.semaphore;
+        semaphoreInfo.value = submit.value;
+        semaphoreInfo.stageMask = submit.stageMask;
+        semaphoreInfos.push_back(semaphoreInfo);
+      }
+      return semaphoreInfos;
+    };
+    auto waitInfos = toSemaphoreInfos(submitBufferInfo.waitSemaphores);
+    auto signalInfos = toSemaphoreInfos(submitBufferInfo.signalSemaphores);
+
+    std::vector<VkCommandBufferSubmitInfo> commandBufferInfos{};
+    for (auto commandBuffer : commandBuffers) {
+      VkCommandBufferSubmitInfo commandBufferInfo{};
+      commandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+      commandBufferInfo.commandBuffer = commandBuffer;
+      commandBufferInfos.push_back(commandBufferInfo);
+    }
+
+    VkSubmitInfo2 submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+    submitInfo.waitSemaphoreInfoCount = static_cast<uint32_t>(waitInfos.size());
+    submitInfo.pWaitSemaphoreInfos = waitInfos.data();
+    submitInfo.commandBufferInfoCount =
+        static_cast<uint32_t>(commandBufferInfos.size());
+    submitInfo.pCommandBufferInfos = commandBufferInfos.data();
+    submitInfo.signalSemaphoreInfoCount =
+        static_cast<uint32_t>(signalInfos.size());
+    submitInfo.pSignalSemaphoreInfos = signalInfos.data();
+
+    if (deviceDispatch.vkQueueSubmit2(submitBufferInfo.queue, 1, &submitInfo,
+                                      submitBufferInfo.signalFence) !=
+        VK_SUCCESS) {
+      throw std::runtime_error("Failed to submit command buffer");
+    }
+    SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Command buffer submitted");
+  }
+
+  void submitCommandBuffer(VkCommandBuffer commandBuffer,
+                           SubmitCommandBufferInfo2 submitBufferInfo) {
+    submitCommandBuffer(std::vector<VkCommandBuffer>{commandBuffer},
+                        submitBufferInfo);
+  }
+
+  bool usesSynchronization2() const { return synchronization2_; }
+
  private:
   VkDevice device_;
+  bool synchronization2_;
+  const VkAllocationCallbacks* allocator_;
+  JobSystem* jobSystem_ = nullptr;
 
   std::set<CommandPoolT> singleUsePools_;
   std::map<CommandPoolT, VkCommandPool> commandPools_;
   std::map<CommandT, VkCommandBuffer> commandBuffers_;
   std::map<CommandT, VkCommandPool> commandToPool_;
+  std::map<CommandPoolT, std::vector<VkCommandBuffer>> freeSingleUseBuffers_;
+
+  // Fallback when synchronization2 isn't available, the stage masks are folded
+  // to legacy flags and the signal stages are ignored (legacy signals once
+  // every command has completed).
+  void submitLegacy_(std::vector<VkCommandBuffer>& commandBuffers,
+                     SubmitCommandBufferInfo2& submitBufferInfo) {
+    std::vector<VkSemaphore> waitSemaphores{};
+    std::vector<VkPipelineStageFlags> waitDstStages{};
+    std::vector<uint64_t> waitValues{};
+    bool hasTimelineValues = false;
+    for (auto& wait : submitBufferInfo.waitSemaphores) {
+      waitSemaphores.push_back(wait.semaphore);
+      // A zero wait stage is only valid with synchronization2
+      VkPipelineStageFlags waitStage = toLegacyStageFlags(wait.stageMask);
+      waitDstStages.push_back(waitStage != 0
+                                  ? waitStage
+                                  : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+      waitValues.push_back(wait.value);
+      hasTimelineValues |= wait.value != 0;
+    }
+    std::vector<VkSemaphore> signalSemaphores{};
+    std::vector<uint64_t> signalValues{};
+    for (auto& signal : submitBufferInfo.signalSemaphores) {
+      signalSemaphores.push_back(signal.semaphore);
+      signalValues.push_back(signal.value);
+      hasTimelineValues |= signal.value != 0;
+    }
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount =
+        static_cast<uint32_t>(waitValues.size());
+    timelineInfo.pWaitSemaphoreValues = waitValues.data();
+    timelineInfo.signalSemaphoreValueCount =
+        static_cast<uint32_t>(signalValues.size());
+    timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = hasTimelineValues ? &timelineInfo : nullptr;
+    submitInfo.waitSemaphoreCount =
+        static_cast<uint32_t>(waitSemaphores.size());
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = waitDstStages.data();
+    submitInfo.commandBufferCount =
+        static_cast<uint32_t>(commandBuffers.size());
+    submitInfo.pCommandBuffers = commandBuffers.data();
+    submitInfo.signalSemaphoreCount =
+        static_cast<uint32_t>(signalSemaphores.size());
+    submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+    if (deviceDispatch.vkQueueSubmit(submitBufferInfo.queue, 1, &submitInfo,
+                                     submitBufferInfo.signalFence) !=
+        VK_SUCCESS) {
+      throw std::runtime_error("Failed to submit command buffer");
+    }
+    SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Command buffer submitted");
+  }
 };
 
 }  // namespace vinkan
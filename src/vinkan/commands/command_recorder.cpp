@@ -0,0 +1,221 @@
+#include "command_recorder.hpp"
+
+#include <cassert>
+
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
+
+namespace vinkan {
+
+CommandRecorder::CommandRecorder(VkCommandBuffer commandBuffer,
+                                 bool synchronization2,
+                                 uint32_t queueFamilyIndex)
+    : commandBuffer_(commandBuffer),
+      synchronization2_(synchronization2),
+      queueFamilyIndex_(queueFamilyIndex) {}
+
+CommandRecorder::~CommandRecorder() {
+  assert(pendingBarriers_.empty() &&
+         "Resources were declared without any command using them");
+}
+
+CommandRecorder &CommandRecorder::useBuffer(Buffer &buffer,
+                                            VkPipelineStageFlags2 stageMask,
+                                            VkAccessFlags2 accessMask) {
+  auto &state = buffer.getAccessState();
+#ifdef VINKAN_HAZARD_CHECKS
+  checkOwnership_(state);
+#endif
+  auto barrier =
+      trackAccess(state, stageMask, accessMask, isWriteAccess(accessMask));
+  if (!barrier.has_value()) {
+    elidedBarrierCount_++;
+    return *this;
+  }
+  pendingBarriers_.addBufferBarrier(
+      buffer, BufferBarrierInfo{.srcStageMask = barrier->srcStageMask,
+                                .srcAccessMask = barrier->srcAccessMask,
+                                .dstStageMask = barrier->dstStageMask,
+                                .dstAccessMask = barrier->dstAccessMask});
+  barrierCount_++;
+  return *this;
+}
+
+CommandRecorder &CommandRecorder::setImageLayout(VkImage image,
+                                                 VkImageLayout layout) {
+  imageStates_[image].accessState.layout = layout;
+  return *this;
+}
+
+CommandRecorder &CommandRecorder::useImage(
+    VkImage image, VkPipelineStageFlags2 stageMask, VkAccessFlags2 accessMask,
+    VkImageLayout layout, VkImageSubresourceRange subresourceRange) {
+  auto &imageState = imageStates_[image];
+  imageState.subresourceRange = subresourceRange;
+  auto &state = imageState.accessState;
+#ifdef VINKAN_HAZARD_CHECKS
+  checkOwnership_(state);
+  bool readsUndefined = state.layout == VK_IMAGE_LAYOUT_UNDEFINED &&
+                        !isWriteAccess(accessMask);
+  if (readsUndefined) {
+    SPDLOG_LOGGER_WARN(get_vinkan_logger(),
+                       "Hazard: image read before anything was written to it");
+  }
+#endif
+  auto barrier = trackAccess(state, stageMask, accessMask,
+                             isWriteAccess(accessMask), layout);
+  if (!barrier.has_value()) {
+    elidedBarrierCount_++;
+    return *this;
+  }
+  pendingBarriers_.addImageBarrier(
+      image, ImageBarrierInfo{.srcStageMask = barrier->srcStageMask,
+                              .srcAccessMask = barrier->srcAccessMask,
+                              .dstStageMask = barrier->dstStageMask,
+                              .dstAccessMask = barrier->dstAccessMask,
+                              .oldLayout = barrier->oldLayout,
+                              .newLayout = barrier->newLayout,
+                              .subresourceRange = subresourceRange});
+  barrierCount_++;
+  return *this;
+}
+
+void CommandRecorder::releaseBuffer(Buffer &buffer,
+                                    uint32_t dstQueueFamilyIndex) {
+  assert(queueFamilyIndex_ != VK_QUEUE_FAMILY_IGNORED &&
+         "The recorder queue family is needed for ownership transfers");
+  auto &state = buffer.getAccessState();
+#ifdef VINKAN_HAZARD_CHECKS
+  checkOwnership_(state);
+#endif
+  pendingBarriers_.addBufferRelease(
+      buffer,
+      QueueOwnershipTransferInfo{
+          .srcQueueFamilyIndex = queueFamilyIndex_,
+          .dstQueueFamilyIndex = dstQueueFamilyIndex,
+          .srcStageMask = state.writeStages | state.readStages,
+          .srcAccessMask = state.writeAccess,
+          .dstStageMask = VK_PIPELINE_STAGE_2_NONE,
+          .dstAccessMask = VK_ACCESS_2_NONE});
+  barrierCount_++;
+  flushBarriers();
+  // The semaphore between the two queues orders the accesses from now on
+  state = ResourceAccessState{.queueFamilyIndex = dstQueueFamilyIndex};
+}
+
+void CommandRecorder::acquireBuffer(Buffer &buffer,
+                                    uint32_t srcQueueFamilyIndex,
+                                    VkPipelineStageFlags2 dstStageMask,
+                                    VkAccessFlags2 dstAccessMask) {
+  assert(queueFamilyIndex_ != VK_QUEUE_FAMILY_IGNORED &&
+         "The recorder queue family is needed for ownership transfers");
+  pendingBarriers_.addBufferAcquire(
+      buffer, QueueOwnershipTransferInfo{
+                  .srcQueueFamilyIndex = srcQueueFamilyIndex,
+                  .dstQueueFamilyIndex = queueFamilyIndex_,
+                  .srcStageMask = VK_PIPELINE_STAGE_2_NONE,
+                  .srcAccessMask = VK_ACCESS_2_NONE,
+                  .dstStageMask = dstStageMask,
+                  .dstAccessMask = dstAccessMask});
+  barrierCount_++;
+  buffer.getAccessState() =
+      ResourceAccessState{.queueFamilyIndex = queueFamilyIndex_};
+}
+
+void CommandRecorder::flushBarriers() {
+  if (pendingBarriers_.empty()) {
+    return;
+  }
+  pendingBarriers_.record(commandBuffer_, synchronization2_);
+  barrierFlushCount_++;
+}
+
+void CommandRecorder::dispatch(uint32_t groupCountX, uint32_t groupCountY,
+                               uint32_t groupCountZ) {
+  flushBarriers();
+  deviceDispatch.vkCmdDispatch(commandBuffer_, groupCountX, groupCountY,
+                               groupCountZ);
+}
+
+uint32_t CommandRecorder::dispatchExtent(const DispatchExtent &extent,
+                                        const WorkgroupSize &workgroupSize,
+                                        const VkPhysicalDeviceLimits &limits,
+                                        const DispatchBaseCallback &setBase) {
+  flushBarriers();
+  return cmdDispatchExtent(commandBuffer_, extent, workgroupSize, limits,
+                           setBase);
+}
+
+void CommandRecorder::dispatchIndirect(Buffer &buffer, VkDeviceSize offset) {
+  useBuffer(buffer, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+            VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+  flushBarriers();
+  deviceDispatch.vkCmdDispatchIndirect(commandBuffer_, buffer.getHandle(),
+                                       offset);
+}
+
+void CommandRecorder::draw(uint32_t vertexCount, uint32_t instanceCount,
+                           uint32_t firstVertex, uint32_t firstInstance) {
+  flushBarriers();
+  deviceDispatch.vkCmdDraw(commandBuffer_, vertexCount, instanceCount,
+                           firstVertex, firstInstance);
+}
+
+void CommandRecorder::drawIndexed(uint32_t indexCount, uint32_t instanceCount,
+                                  uint32_t firstIndex, int32_t vertexOffset,
+                                  uint32_t firstInstance) {
+  flushBarriers();
+  deviceDispatch.vkCmdDrawIndexed(commandBuffer_, indexCount, instanceCount,
+                                  firstIndex, vertexOffset, firstInstance);
+}
+
+void CommandRecorder::drawIndexedIndirect(Buffer &buffer, VkDeviceSize offset,
+                                          uint32_t drawCount,
+                                          uint32_t stride) {
+  useBuffer(buffer, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+            VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+  flushBarriers();
+  deviceDispatch.vkCmdDrawIndexedIndirect(commandBuffer_, buffer.getHandle(),
+                                          offset, drawCount, stride);
+}
+
+void CommandRecorder::drawIndexedIndirectCount(
+    Buffer &buffer, VkDeviceSize offset, Buffer &countBuffer,
+    VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride) {
+  useBuffer(buffer, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+            VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+  useBuffer(countBuffer, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+            VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+  flushBarriers();
+  deviceDispatch.vkCmdDrawIndexedIndirectCount(
+      commandBuffer_, buffer.getHandle(), offset, countBuffer.getHandle(),
+      countBufferOffset, maxDrawCount, stride);
+}
+
+void CommandRecorder::copyBuffer(Buffer &srcBuffer, Buffer &dstBuffer,
+                                 VkBufferCopy region) {
+  useBuffer(srcBuffer, VK_PIPELINE_STAGE_2_COPY_BIT,
+            VK_ACCESS_2_TRANSFER_READ_BIT);
+  useBuffer(dstBuffer, VK_PIPELINE_STAGE_2_COPY_BIT,
+            VK_ACCESS_2_TRANSFER_WRITE_BIT);
+  flushBarriers();
+  deviceDispatch.vkCmdCopyBuffer(commandBuffer_, srcBuffer.getHandle(),
+                                 dstBuffer.getHandle(), 1, &region);
+}
+
+#ifdef VINKAN_HAZARD_CHECKS
+void CommandRecorder::checkOwnership_(const ResourceAccessState &state) const {
+  bool ownedElsewhere = state.queueFamilyIndex != VK_QUEUE_FAMILY_IGNORED &&
+                        queueFamilyIndex_ != VK_QUEUE_FAMILY_IGNORED &&
+                        state.queueFamilyIndex != queueFamilyIndex_;
+  if (ownedElsewhere) {
+    SPDLOG_LOGGER_ERROR(get_vinkan_logger(),
+                        "Hazard: resource owned by queue family {} used on "
+                        "queue family {} without being acquired",
+                        state.queueFamilyIndex, queueFamilyIndex_);
+  }
+  assert(!ownedElsewhere && "Resource used without ownership");
+}
+#endif
+
+}  // namespace vinkan
@@ -0,0 +1,113 @@
+#ifndef VINKAN_COMMAND_RECORDER_HPP
+#define VINKAN_COMMAND_RECORDER_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <map>
+
+#include "vinkan/commands/dispatch_sizing.hpp"
+#include "vinkan/sync/barriers.hpp"
+#include "vinkan/sync/resource_state.hpp"
+#include "vinkan/wrappers/buffer.hpp"
+
+// Hazard checks follow the asserts, they're compiled out with NDEBUG
+#ifndef NDEBUG
+#define VINKAN_HAZARD_CHECKS
+#endif
+
+namespace vinkan {
+
+// Records commands while tracking the state of the resources they use.
+//
+// Resources are declared with use* before the command using them, only the
+// barriers that are needed are queued and they're all emitted in a single
+// pipeline barrier right before the next dispatch, draw or copy.
+class CommandRecorder {
+ public:
+  // queueFamilyIndex is the family the command buffer is submitted to, it's
+  // only needed for queue family ownership transfers
+  CommandRecorder(VkCommandBuffer commandBuffer, bool synchronization2,
+                  uint32_t queueFamilyIndex = VK_QUEUE_FAMILY_IGNORED);
+  ~CommandRecorder();
+
+  CommandRecorder(const CommandRecorder &) = delete;
+  CommandRecorder &operator=(const CommandRecorder &) = delete;
+
+  CommandRecorder &useBuffer(Buffer &buffer, VkPipelineStageFlags2 stageMask,
+                             VkAccessFlags2 accessMask);
+  // Images aren't owned by Vinkan so their state lives in the recorder, an
+  // image starts in the layout given here (undefined if never set).
+  CommandRecorder &setImageLayout(VkImage image, VkImageLayout layout);
+  CommandRecorder &useImage(VkImage image, VkPipelineStageFlags2 stageMask,
+                            VkAccessFlags2 accessMask, VkImageLayout layout,
+                            VkImageSubresourceRange subresourceRange = {
+                                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                .baseMipLevel = 0,
+                                .levelCount = VK_REMAINING_MIP_LEVELS,
+                                .baseArrayLayer = 0,
+                                .layerCount = VK_REMAINING_ARRAY_LAYERS});
+
+  // Queue family ownership transfer of an exclusive buffer, the release is
+  // recorded on the source queue and the acquire on the destination queue.
+  void releaseBuffer(Buffer &buffer, uint32_t dstQueueFamilyIndex);
+  void acquireBuffer(Buffer &buffer, uint32_t srcQueueFamilyIndex,
+                     VkPipelineStageFlags2 dstStageMask,
+                     VkAccessFlags2 dstAccessMask);
+
+  // Emits the pending barriers, done automatically before every command
+  void flushBarriers();
+
+  void dispatch(uint32_t groupCountX, uint32_t groupCountY = 1,
+                uint32_t groupCountZ = 1);
+  // Group counts computed from the extent, split over the device limits (see
+  // cmdDispatchExtent). Returns the number of dispatches recorded.
+  uint32_t dispatchExtent(const DispatchExtent &extent,
+                          const WorkgroupSize &workgroupSize,
+                          const VkPhysicalDeviceLimits &limits,
+                          const DispatchBaseCallback &setBase = nullptr);
+  void dispatchIndirect(Buffer &buffer, VkDeviceSize offset = 0);
+  void draw(uint32_t vertexCount, uint32_t instanceCount = 1,
+            uint32_t firstVertex = 0, uint32_t firstInstance = 0);
+  void drawIndexed(uint32_t indexCount, uint32_t instanceCount = 1,
+                   uint32_t firstIndex = 0, int32_t vertexOffset = 0,
+                   uint32_t firstInstance = 0);
+  // Pass sizeof(VkDrawIndexedIndirectCommand) as stride for packed commands
+  void drawIndexedIndirect(Buffer &buffer, VkDeviceSize offset,
+                           uint32_t drawCount, uint32_t stride);
+  void drawIndexedIndirectCount(Buffer &buffer, VkDeviceSize offset,
+                                Buffer &countBuffer,
+                                VkDeviceSize countBufferOffset,
+                                uint32_t maxDrawCount, uint32_t stride);
+  void copyBuffer(Buffer &srcBuffer, Buffer &dstBuffer, VkBufferCopy region);
+
+  VkCommandBuffer getCommandBuffer() const { return commandBuffer_; }
+  // Barriers emitted vs accesses that didn't need one
+  uint32_t getBarrierCount() const { return barrierCount_; }
+  uint32_t getElidedBarrierCount() const { return elidedBarrierCount_; }
+  uint32_t getBarrierFlushCount() const { return barrierFlushCount_; }
+
+ private:
+  struct ImageState_ {
+    ResourceAccessState accessState{};
+    VkImageSubresourceRange subresourceRange{};
+  };
+
+  VkCommandBuffer commandBuffer_;
+  bool synchronization2_;
+  uint32_t queueFamilyIndex_;
+
+  BarrierBatch pendingBarriers_{};
+  std::map<VkImage, ImageState_> imageStates_{};
+
+  uint32_t barrierCount_ = 0;
+  uint32_t elidedBarrierCount_ = 0;
+  uint32_t barrierFlushCount_ = 0;
+
+#ifdef VINKAN_HAZARD_CHECKS
+  void checkOwnership_(const ResourceAccessState &state) const;
+#endif
+};
+
+}  // namespace vinkan
+
+#endif
@@ -0,0 +1,303 @@
+#ifndef VINKAN_COMPUTE_COALESCER_HPP
+#define VINKAN_COMPUTE_COALESCER_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "vinkan/command_coordinator.hpp"
+#include "vinkan/generics/concepts.hpp"
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/logging/tracer.hpp"
+#include "vinkan/pipelines/pipelines.hpp"
+#include "vinkan/sync/fence_pool.hpp"
+#include "vinkan/sync/in_flight_tracker.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
+
+namespace vinkan {
+
+// One independent compute job, dispatched with its own descriptor sets and
+// push constants
+template <EnumType PipelineT, EnumType PipelineLayoutT>
+struct CoalescedDispatch {
+  PipelineT pipeline;
+  PipelineLayoutT layout;
+  // Bound from set 0
+  std::vector<VkDescriptorSet> descriptorSets{};
+  std::vector<uint32_t> dynamicOffsets{};
+  // Pushed at offset 0 for the compute stage
+  std::vector<uint8_t> pushConstants{};
+  uint32_t groupCountX = 1;
+  uint32_t groupCountY = 1;
+  uint32_t groupCountZ = 1;
+};
+
+struct ComputeCoalescerInfo {
+  VkQueue queue;
+  // The pending jobs are flushed once there are this many of them...
+  uint32_t maxBatchSize = 256;
+  // ...or once the oldest one has waited this long (checked by poll)
+  uint32_t maxDelayUs = 500;
+};
+
+struct ComputeCoalescerStats {
+  uint64_t batchCount = 0;
+  uint64_t jobCount = 0;
+  uint32_t maxJobsPerBatch = 0;
+
+  double averageJobsPerBatch() const {
+    if (batchCount == 0) {
+      return 0.;
+    }
+    return static_cast<double>(jobCount) / static_cast<double>(batchCount);
+  }
+};
+
+// Gathers many small independent compute jobs and submits them together: a
+// batch is one command buffer with a dispatch per job (sorted by pipeline to
+// save binds) and one vkQueueSubmit. Each job gets a future completed when
+// its batch is done, the device writes are then visible to the host.
+//
+// submit is thread safe. Nothing runs in the background, poll must be called
+// regularly (e.g. from the service loop) to flush the batches that waited too
+// long and to complete the futures.
+template <EnumType PipelineT, EnumType PipelineLayoutT, EnumType CommandT,
+          EnumType CommandPoolT>
+class ComputeCoalescer {
+ public:
+  using Dispatch = CoalescedDispatch<PipelineT, PipelineLayoutT>;
+
+  // The command pool must be a single use pool of a family of the queue, only
+  // used by the coalescer. The queue must not be used by another thread while
+  // a coalescer call is running.
+  ComputeCoalescer(VkDevice device,
+                   Pipelines<PipelineT, PipelineLayoutT>& pipelines,
+                   CommandCoordinator<CommandT, CommandPoolT>& coordinator,
+                   CommandPoolT commandPool, const ComputeCoalescerInfo& info,
+                   const VkAllocationCallbacks* allocator = nullptr)
+      : device_(device),
+        pipelines_(pipelines),
+        coordinator_(coordinator),
+        commandPool_(commandPool),
+        info_(info),
+        fencePool_(device, 0, allocator),
+        tracker_(device, fencePool_) {
+    assert(info_.maxBatchSize > 0);
+  }
+  // Flushes the pending jobs and waits for every batch. A failed flush is
+  // logged, the futures of its jobs hold the exception.
+  ~ComputeCoalescer() {
+    std::lock_guard lock(mutex_);
+    try {
+      if (!pending_.empty()) {
+        flush_();
+      }
+      tracker_.waitIdle();
+    } catch (const std::exception& e) {
+      SPDLOG_LOGGER_ERROR(get_vinkan_logger(),
+                          "Compute coalescer flush failed: {}", e.what());
+    }
+  }
+
+  ComputeCoalescer(const ComputeCoalescer&) = delete;
+  ComputeCoalescer& operator=(const ComputeCoalescer&) = delete;
+
+  // The descriptor sets and buffers of the job must stay alive until its
+  // future is ready. The future holds an exception if its batch failed.
+  std::future<void> submit(Dispatch dispatch) {
+    std::lock_guard lock(mutex_);
+    if (pending_.empty()) {
+      oldestPendingTime_ = std::chrono::steady_clock::now();
+    }
+    pending_.push_back(PendingJob_{.dispatch = std::move(dispatch)});
+    auto future = pending_.back().promise.get_future();
+    if (pending_.size() >= info_.maxBatchSize) {
+      flush_();
+    }
+    return future;
+  }
+
+  // Flushes the pending jobs if the oldest one has waited long enough, then
+  // completes the futures of the finished batches
+  void poll() {
+    std::lock_guard lock(mutex_);
+    auto maxDelay = std::chrono::microseconds(info_.maxDelayUs);
+    if (!pending_.empty() &&
+        std::chrono::steady_clock::now() - oldestPendingTime_ >= maxDelay) {
+      flush_();
+    }
+    tracker_.poll();
+  }
+
+  // Submits the pending jobs right away
+  void flush() {
+    std::lock_guard lock(mutex_);
+    if (!pending_.empty()) {
+      flush_();
+    }
+  }
+
+  // Flushes then blocks until every batch is done
+  void waitIdle() {
+    std::lock_guard lock(mutex_);
+    if (!pending_.empty()) {
+      flush_();
+    }
+    tracker_.waitIdle();
+  }
+
+  uint32_t getPendingCount() const {
+    std::lock_guard lock(mutex_);
+    return static_cast<uint32_t>(pending_.size());
+  }
+  uint32_t getInFlightBatchCount() const {
+    std::lock_guard lock(mutex_);
+    return tracker_.getInFlightCount();
+  }
+  ComputeCoalescerStats getStats() const {
+    std::lock_guard lock(mutex_);
+    return stats_;
+  }
+
+ private:
+  struct PendingJob_ {
+    Dispatch dispatch;
+    std::promise<void> promise{};
+  };
+  using Promises_ = std::vector<std::promise<void>>;
+
+  VkDevice device_;
+  Pipelines<PipelineT, PipelineLayoutT>& pipelines_;
+  CommandCoordinator<CommandT, CommandPoolT>& coordinator_;
+  CommandPoolT commandPool_;
+  ComputeCoalescerInfo info_;
+
+  FencePool fencePool_;
+  InFlightTracker tracker_;
+
+  mutable std::mutex mutex_;
+  std::vector<PendingJob_> pending_{};
+  std::chrono::steady_clock::time_point oldestPendingTime_{};
+  ComputeCoalescerStats stats_{};
+
+  void flush_() {
+    VINKAN_TRACE_SCOPE("ComputeCoalescer::flush");
+    // Promises outlive the batch through the completion callback, which has
+    // to be copyable
+    auto promises = std::make_shared<Promises_>();
+    promises->reserve(pending_.size());
+    std::vector<Dispatch> dispatches{};
+    dispatches.reserve(pending_.size());
+    for (auto& job : pending_) {
+      dispatches.push_back(std::move(job.dispatch));
+      promises->push_back(std::move(job.promise));
+    }
+    pending_.clear();
+
+    try {
+      submitBatch_(dispatches, promises);
+    } catch (...) {
+      for (auto& promise : *promises) {
+        promise.set_exception(std::current_exception());
+      }
+      throw;
+    }
+
+    auto jobCount = static_cast<uint32_t>(dispatches.size());
+    stats_.batchCount++;
+    stats_.jobCount += jobCount;
+    stats_.maxJobsPerBatch = std::max(stats_.maxJobsPerBatch, jobCount);
+    SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "{} compute jobs coalesced",
+                        jobCount);
+  }
+
+  void submitBatch_(std::vector<Dispatch>& dispatches,
+                    const std::shared_ptr<Promises_>& promises) {
+    // Independent jobs, only the pipeline order matters to save binds
+    std::vector<uint32_t> order(dispatches.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&dispatches](uint32_t a, uint32_t b) {
+                       return dispatches[a].pipeline < dispatches[b].pipeline;
+                     });
+
+    VkCommandBuffer commandBuffer =
+        coordinator_.createSingleUseCommandBuffer(commandPool_);
+    VkFence fence = VK_NULL_HANDLE;
+    try {
+      coordinator_.beginCommandBuffer(commandBuffer);
+      for (uint32_t i = 0; i < order.size(); ++i) {
+        auto& dispatch = dispatches[order[i]];
+        if (i == 0 ||
+            dispatch.pipeline != dispatches[order[i - 1]].pipeline) {
+          pipelines_.bindCmdBuffer(commandBuffer, dispatch.pipeline);
+        }
+        recordDispatch_(commandBuffer, dispatch);
+      }
+      // Makes the results visible to the host once the futures are ready
+      VkMemoryBarrier hostReadBarrier{};
+      hostReadBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+      hostReadBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+      hostReadBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+      deviceDispatch.vkCmdPipelineBarrier(
+          commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+          VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &hostReadBarrier, 0, nullptr, 0,
+          nullptr);
+      coordinator_.endCommandBuffer(commandBuffer);
+
+      fence = tracker_.acquireFence();
+      coordinator_.submitCommandBuffer(
+          commandBuffer, SubmitCommandBufferInfo{.signalFence = fence,
+                                                 .queue = info_.queue});
+    } catch (...) {
+      // Nothing was submitted, the fence is still unsignaled and the command
+      // buffer may be left recording. flush_ fails the promises.
+      if (fence != VK_NULL_HANDLE) {
+        fencePool_.release(fence);
+      }
+      deviceDispatch.vkResetCommandBuffer(commandBuffer, 0);
+      coordinator_.recycleCommandBuffer(commandPool_, commandBuffer);
+      throw;
+    }
+    tracker_.track(fence, [this, commandBuffer, promises]() {
+      coordinator_.recycleCommandBuffer(commandPool_, commandBuffer);
+      for (auto& promise : *promises) {
+        promise.set_value();
+      }
+    });
+  }
+
+  void recordDispatch_(VkCommandBuffer commandBuffer,
+                       const Dispatch& dispatch) {
+    VkPipelineLayout layout = pipelines_.get(dispatch.layout);
+    if (!dispatch.descriptorSets.empty()) {
+      deviceDispatch.vkCmdBindDescriptorSets(
+          commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0,
+          static_cast<uint32_t>(dispatch.descriptorSets.size()),
+          dispatch.descriptorSets.data(),
+          static_cast<uint32_t>(dispatch.dynamicOffsets.size()),
+          dispatch.dynamicOffsets.data());
+    }
+    if (!dispatch.pushConstants.empty()) {
+      deviceDispatch.vkCmdPushConstants(
+          commandBuffer, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+          static_cast<uint32_t>(dispatch.pushConstants.size()),
+          dispatch.pushConstants.data());
+    }
+    deviceDispatch.vkCmdDispatch(commandBuffer, dispatch.groupCountX,
+                                 dispatch.groupCountY, dispatch.groupCountZ);
+  }
+};
+
+}  // namespace vinkan
+
+#endif
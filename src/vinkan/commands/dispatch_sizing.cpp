@@ -0,0 +1,91 @@
+#include "dispatch_sizing.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
+
+namespace vinkan {
+
+namespace {
+
+uint32_t getGroupCount(uint64_t invocationCount, uint32_t workgroupSize) {
+  assert(workgroupSize > 0);
+  uint64_t groupCount = (invocationCount + workgroupSize - 1) / workgroupSize;
+  if (groupCount > UINT32_MAX) {
+    throw std::runtime_error("Dispatch too large, more than 2^32 - 1 groups");
+  }
+  return static_cast<uint32_t>(groupCount);
+}
+
+}  // namespace
+
+std::vector<DispatchChunk> planDispatch(const DispatchExtent &extent,
+                                        const WorkgroupSize &workgroupSize,
+                                        const VkPhysicalDeviceLimits &limits) {
+  uint32_t groupCounts[3] = {getGroupCount(extent.x, workgroupSize.x),
+                             getGroupCount(extent.y, workgroupSize.y),
+                             getGroupCount(extent.z, workgroupSize.z)};
+  std::vector<DispatchChunk> chunks{};
+  if (groupCounts[0] == 0 || groupCounts[1] == 0 || groupCounts[2] == 0) {
+    return chunks;
+  }
+  const uint32_t *maxGroupCounts = limits.maxComputeWorkGroupCount;
+  assert(maxGroupCounts[0] > 0 && maxGroupCounts[1] > 0 &&
+         maxGroupCounts[2] > 0);
+  for (uint32_t z = 0; z < groupCounts[2]; z += maxGroupCounts[2]) {
+    for (uint32_t y = 0; y < groupCounts[1]; y += maxGroupCounts[1]) {
+      for (uint32_t x = 0; x < groupCounts[0]; x += maxGroupCounts[0]) {
+        chunks.push_back(DispatchChunk{
+            .baseGroupX = x,
+            .baseGroupY = y,
+            .baseGroupZ = z,
+            .groupCountX = std::min(maxGroupCounts[0], groupCounts[0] - x),
+            .groupCountY = std::min(maxGroupCounts[1], groupCounts[1] - y),
+            .groupCountZ = std::min(maxGroupCounts[2], groupCounts[2] - z)});
+        // The last chunk of a dimension can end exactly at 2^32 - 1
+        if (groupCounts[0] - x <= maxGroupCounts[0]) {
+          break;
+        }
+      }
+      if (groupCounts[1] - y <= maxGroupCounts[1]) {
+        break;
+      }
+    }
+    if (groupCounts[2] - z <= maxGroupCounts[2]) {
+      break;
+    }
+  }
+  return chunks;
+}
+
+uint32_t cmdDispatchExtent(VkCommandBuffer commandBuffer,
+                           const DispatchExtent &extent,
+                           const WorkgroupSize &workgroupSize,
+                           const VkPhysicalDeviceLimits &limits,
+                           const DispatchBaseCallback &setBase) {
+  auto chunks = planDispatch(extent, workgroupSize, limits);
+  if (chunks.size() > 1) {
+    // vkCmdDispatchBase can't help, the base plus the group count is bounded
+    // by the limits too
+    if (!setBase) {
+      throw std::runtime_error(
+          "Dispatch over the device limits needs a base group callback");
+    }
+    SPDLOG_LOGGER_TRACE(get_vinkan_logger(),
+                        "Dispatch over the device limits split in {} chunks",
+                        chunks.size());
+  }
+  for (const auto &chunk : chunks) {
+    if (setBase) {
+      setBase(commandBuffer, chunk);
+    }
+    deviceDispatch.vkCmdDispatch(commandBuffer, chunk.groupCountX,
+                                 chunk.groupCountY, chunk.groupCountZ);
+  }
+  return static_cast<uint32_t>(chunks.size());
+}
+
+}  // namespace vinkan
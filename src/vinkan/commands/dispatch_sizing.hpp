@@ -0,0 +1,58 @@
+#ifndef VINKAN_DISPATCH_SIZING_HPP
+#define VINKAN_DISPATCH_SIZING_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "vinkan/pipelines/spirv_reflection.hpp"
+
+namespace vinkan {
+
+// Size of a compute problem in invocations, e.g. one per element
+struct DispatchExtent {
+  uint64_t x = 1;
+  uint64_t y = 1;
+  uint64_t z = 1;
+};
+
+// One dispatch of a split problem, its workgroups start at the base group
+struct DispatchChunk {
+  uint32_t baseGroupX = 0;
+  uint32_t baseGroupY = 0;
+  uint32_t baseGroupZ = 0;
+  uint32_t groupCountX = 0;
+  uint32_t groupCountY = 0;
+  uint32_t groupCountZ = 0;
+};
+
+// Workgroups covering the extent, split in as few dispatches as the
+// maxComputeWorkGroupCount limits allow. The last workgroups can go past the
+// extent, the shader has to check its bounds.
+//
+// Throws if a dimension needs more than 2^32 - 1 workgroups, the base group
+// wouldn't fit anymore.
+std::vector<DispatchChunk> planDispatch(const DispatchExtent &extent,
+                                        const WorkgroupSize &workgroupSize,
+                                        const VkPhysicalDeviceLimits &limits);
+
+// Gives its base group to the shader before each dispatch of a split
+// problem, e.g. through push constants
+using DispatchBaseCallback =
+    std::function<void(VkCommandBuffer commandBuffer,
+                       const DispatchChunk &chunk)>;
+
+// Records the dispatches of planDispatch. Throws if the problem is split and
+// there is no callback, the workgroups of every chunk would start at 0.
+// Returns the number of dispatches recorded.
+uint32_t cmdDispatchExtent(VkCommandBuffer commandBuffer,
+                           const DispatchExtent &extent,
+                           const WorkgroupSize &workgroupSize,
+                           const VkPhysicalDeviceLimits &limits,
+                           const DispatchBaseCallback &setBase = nullptr);
+
+}  // namespace vinkan
+
+#endif
@@ -0,0 +1,254 @@
+#include "hot_kernel.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/logging/tracer.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
+
+namespace vinkan {
+
+HotKernel::HotKernel(VkDevice device, const HotKernelInfo &info,
+                     RecordFunction record,
+                     const VkAllocationCallbacks *allocator)
+    : device_(device),
+      allocator_(allocator),
+      queue_(info.queue),
+      input_(info.input),
+      output_(info.output),
+      spinDurationUs_(info.spinDurationUs) {
+  // The destructor doesn't run when the constructor throws
+  try {
+    init_(info, record);
+  } catch (...) {
+    destroy_();
+    throw;
+  }
+  SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Hot kernel created ({})",
+                      info.useTimelineSemaphore ? "timeline semaphore"
+                                                : "fence");
+}
+
+HotKernel::~HotKernel() {
+  if (pending_) {
+    try {
+      blockingWait_();
+    } catch (const std::exception &e) {
+      SPDLOG_LOGGER_WARN(get_vinkan_logger(), "{}", e.what());
+    }
+  }
+  destroy_();
+}
+
+void HotKernel::run(const void *input, size_t inputSize, void *output,
+                    size_t outputSize) {
+  assert(inputSize == 0 || inputMemory_ != nullptr);
+  assert(inputSize == 0 || inputSize <= input_->getBufferSize());
+  assert(outputSize == 0 || outputMemory_ != nullptr);
+  assert(outputSize == 0 || outputSize <= output_->getBufferSize());
+  if (inputSize > 0) {
+    std::memcpy(inputMemory_, input, inputSize);
+  }
+  run();
+  if (outputSize > 0) {
+    std::memcpy(output, outputMemory_, outputSize);
+  }
+}
+
+void HotKernel::run() {
+  submit();
+  wait();
+}
+
+void HotKernel::submit() {
+  assert(!pending_ && "The previous run must be waited first");
+  if (flushInput_ && input_->flush() != VK_SUCCESS) {
+    throw std::runtime_error("Failed to flush the hot kernel input");
+  }
+
+  // Everything on the stack, nothing is allocated per run
+  uint64_t signalValue = submittedValue_ + 1;
+  VkTimelineSemaphoreSubmitInfo timelineInfo{};
+  timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+  timelineInfo.signalSemaphoreValueCount = 1;
+  timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &commandBuffer_;
+  if (timelineSemaphore_ != VK_NULL_HANDLE) {
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &timelineSemaphore_;
+  }
+  if (deviceDispatch.vkQueueSubmit(queue_, 1, &submitInfo, fence_) !=
+      VK_SUCCESS) {
+    throw std::runtime_error("Failed to submit the hot kernel");
+  }
+  submittedValue_ = signalValue;
+  pending_ = true;
+}
+
+void HotKernel::wait() {
+  assert(pending_ && "Nothing submitted to wait for");
+  VINKAN_TRACE_SCOPE("HotKernel::wait");
+  // Spin first, a blocking wait costs a sleep and a wake up
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::microseconds(spinDurationUs_);
+  bool complete = isComplete_();
+  while (!complete && std::chrono::steady_clock::now() < deadline) {
+    complete = isComplete_();
+  }
+  if (complete) {
+    stats_.spinCompletionCount++;
+  } else {
+    blockingWait_();
+    stats_.blockingWaitCount++;
+  }
+  pending_ = false;
+  stats_.runCount++;
+
+  if (fence_ != VK_NULL_HANDLE &&
+      deviceDispatch.vkResetFences(device_, 1, &fence_) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to reset the hot kernel fence");
+  }
+  if (invalidateOutput_ && output_->invalidate() != VK_SUCCESS) {
+    throw std::runtime_error("Failed to invalidate the hot kernel output");
+  }
+}
+
+void HotKernel::init_(const HotKernelInfo &info,
+                      const RecordFunction &record) {
+  if (input_ != nullptr) {
+    inputMemory_ = mapBuffer_(input_, flushInput_);
+  }
+  if (output_ != nullptr) {
+    outputMemory_ = mapBuffer_(output_, invalidateOutput_);
+  }
+
+  VkCommandPoolCreateInfo poolInfo{};
+  poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  poolInfo.queueFamilyIndex = info.queueFamilyIndex;
+  if (vkCreateCommandPool(device_, &poolInfo, allocator_, &commandPool_) !=
+      VK_SUCCESS) {
+    throw std::runtime_error("Failed to create the hot kernel command pool");
+  }
+  VkCommandBufferAllocateInfo allocInfo{};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.commandPool = commandPool_;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandBufferCount = 1;
+  if (deviceDispatch.vkAllocateCommandBuffers(device_, &allocInfo,
+                                              &commandBuffer_) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to allocate a hot kernel command buffer");
+  }
+
+  // Recorded once, resubmitted as is by every run
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  if (deviceDispatch.vkBeginCommandBuffer(commandBuffer_, &beginInfo) !=
+      VK_SUCCESS) {
+    throw std::runtime_error("Failed to begin the hot kernel command buffer");
+  }
+  record(commandBuffer_);
+  // The host writes are visible to the device at submission, the other way
+  // around needs a barrier
+  VkMemoryBarrier hostReadBarrier{};
+  hostReadBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  hostReadBarrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+  hostReadBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+  deviceDispatch.vkCmdPipelineBarrier(
+      commandBuffer_, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+      VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &hostReadBarrier, 0, nullptr, 0,
+      nullptr);
+  if (deviceDispatch.vkEndCommandBuffer(commandBuffer_) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to record the hot kernel command buffer");
+  }
+
+  if (info.useTimelineSemaphore) {
+    VkSemaphoreTypeCreateInfo typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+    if (vkCreateSemaphore(device_, &semaphoreInfo, allocator_,
+                          &timelineSemaphore_) != VK_SUCCESS) {
+      throw std::runtime_error("Failed to create hot kernel semaphore");
+    }
+  } else {
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    if (vkCreateFence(device_, &fenceInfo, allocator_, &fence_) != VK_SUCCESS) {
+      throw std::runtime_error("Failed to create the hot kernel fence");
+    }
+  }
+}
+
+void HotKernel::destroy_() {
+  if (timelineSemaphore_ != VK_NULL_HANDLE) {
+    vkDestroySemaphore(device_, timelineSemaphore_, allocator_);
+  }
+  if (fence_ != VK_NULL_HANDLE) {
+    vkDestroyFence(device_, fence_, allocator_);
+  }
+  if (commandPool_ != VK_NULL_HANDLE) {
+    vkDestroyCommandPool(device_, commandPool_, allocator_);
+  }
+  for (auto buffer : mappedBuffers_) {
+    buffer->unmap();
+  }
+}
+
+void *HotKernel::mapBuffer_(Buffer *buffer, bool &nonCoherent) {
+  nonCoherent = (buffer->getMemoryPropertyFlags() &
+                 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0;
+  if (buffer->getMappedMemory() == nullptr) {
+    if (buffer->map() != VK_SUCCESS) {
+      throw std::runtime_error("Failed to map a hot kernel buffer");
+    }
+    mappedBuffers_.push_back(buffer);
+  }
+  return buffer->getMappedMemory();
+}
+
+bool HotKernel::isComplete_() const {
+  if (fence_ != VK_NULL_HANDLE) {
+    VkResult result = deviceDispatch.vkGetFenceStatus(device_, fence_);
+    if (result != VK_SUCCESS && result != VK_NOT_READY) {
+      throw std::runtime_error("Failed to get the hot kernel fence status");
+    }
+    return result == VK_SUCCESS;
+  }
+  uint64_t value = 0;
+  if (deviceDispatch.vkGetSemaphoreCounterValue(device_, timelineSemaphore_,
+                                                &value) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to get the hot kernel semaphore value");
+  }
+  return value >= submittedValue_;
+}
+
+void HotKernel::blockingWait_() {
+  VkResult result;
+  if (fence_ != VK_NULL_HANDLE) {
+    result = deviceDispatch.vkWaitForFences(device_, 1, &fence_, VK_TRUE,
+                                            UINT64_MAX);
+  } else {
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &timelineSemaphore_;
+    waitInfo.pValues = &submittedValue_;
+    result = deviceDispatch.vkWaitSemaphores(device_, &waitInfo, UINT64_MAX);
+  }
+  if (result != VK_SUCCESS) {
+    throw std::runtime_error("Failed to wait for the hot kernel");
+  }
+}
+
+}  // namespace vinkan
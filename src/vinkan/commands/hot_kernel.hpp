@@ -0,0 +1,106 @@
+#ifndef VINKAN_HOT_KERNEL_HPP
+#define VINKAN_HOT_KERNEL_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "vinkan/wrappers/buffer.hpp"
+
+namespace vinkan {
+
+struct HotKernelInfo {
+  VkQueue queue;
+  uint32_t queueFamilyIndex;
+  // Host visible buffers the kernel reads and writes, they can be the same.
+  // They stay mapped for the lifetime of the kernel, the ones mapped by it are
+  // unmapped on destruction.
+  Buffer *input = nullptr;
+  Buffer *output = nullptr;
+  // Completion is tracked with a timeline semaphore, which the device must
+  // have enabled, or with a fence otherwise
+  bool useTimelineSemaphore = true;
+  // Polling time before falling back to a blocking wait. Tiny kernels are
+  // usually done before a blocked thread would even be woken up.
+  uint32_t spinDurationUs = 50;
+};
+
+struct HotKernelStats {
+  uint64_t runCount = 0;
+  // Runs done within the spin duration, the others blocked
+  uint64_t spinCompletionCount = 0;
+  uint64_t blockingWaitCount = 0;
+};
+
+// Synchronous path for tiny compute dispatches, where the overhead around the
+// dispatch dominates the latency.
+//
+// The command buffer is recorded once, the inputs and outputs stay mapped and
+// a run only writes the inputs, submits, waits and reads the outputs back,
+// without allocating anything. A barrier making the writes visible to the
+// host is recorded after the commands.
+//
+// Not thread safe, one run at a time.
+class HotKernel {
+ public:
+  using RecordFunction = std::function<void(VkCommandBuffer commandBuffer)>;
+
+  HotKernel(VkDevice device, const HotKernelInfo &info, RecordFunction record,
+            const VkAllocationCallbacks *allocator = nullptr);
+  ~HotKernel();
+
+  HotKernel(const HotKernel &) = delete;
+  HotKernel &operator=(const HotKernel &) = delete;
+
+  // Copies the input to the start of the input buffer, runs the kernel and
+  // copies the start of the output buffer to output
+  void run(const void *input, size_t inputSize, void *output,
+           size_t outputSize);
+  // Same without copies, the mapped memory is written and read in place
+  void run();
+
+  // Split version of run(), e.g. to prepare the next inputs meanwhile. The
+  // inputs must not be written until wait() returns.
+  void submit();
+  void wait();
+
+  void *getInputMemory() const { return inputMemory_; }
+  void *getOutputMemory() const { return outputMemory_; }
+  const HotKernelStats &getStats() const { return stats_; }
+
+ private:
+  VkDevice device_;
+  const VkAllocationCallbacks *allocator_;
+  VkQueue queue_;
+  Buffer *input_;
+  Buffer *output_;
+  void *inputMemory_ = nullptr;
+  void *outputMemory_ = nullptr;
+  bool flushInput_ = false;
+  bool invalidateOutput_ = false;
+  std::vector<Buffer *> mappedBuffers_{};
+  uint32_t spinDurationUs_;
+
+  VkCommandPool commandPool_ = VK_NULL_HANDLE;
+  VkCommandBuffer commandBuffer_ = VK_NULL_HANDLE;
+
+  VkSemaphore timelineSemaphore_ = VK_NULL_HANDLE;
+  uint64_t submittedValue_ = 0;
+  VkFence fence_ = VK_NULL_HANDLE;
+  bool pending_ = false;
+
+  HotKernelStats stats_{};
+
+  void init_(const HotKernelInfo &info, const RecordFunction &record);
+  void destroy_();
+  void *mapBuffer_(Buffer *buffer, bool &nonCoherent);
+  bool isComplete_() const;
+  void blockingWait_();
+};
+
+}  // namespace vinkan
+
+#endif
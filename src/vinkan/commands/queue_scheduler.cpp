@@ -0,0 +1,184 @@
+#include "queue_scheduler.hpp"
+
+#include <cassert>
+#include <stdexcept>
+
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/logging/tracer.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
+
+namespace vinkan {
+
+QueueScheduler::QueueScheduler(VkDevice device, std::vector<VkQueue> queues,
+                               QueueSchedulingPolicy policy,
+                               const VkAllocationCallbacks *allocator)
+    : device_(device), allocator_(allocator), policy_(policy) {
+  assert(!queues.empty());
+  VkSemaphoreTypeCreateInfo typeInfo{};
+  typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+  typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+  typeInfo.initialValue = 0;
+  VkSemaphoreCreateInfo semaphoreInfo{};
+  semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+  semaphoreInfo.pNext = &typeInfo;
+
+  for (auto queue : queues) {
+    auto scheduledQueue = std::make_unique<ScheduledQueue_>();
+    scheduledQueue->queue = queue;
+    if (vkCreateSemaphore(device_, &semaphoreInfo, allocator_,
+                          &scheduledQueue->timelineSemaphore) != VK_SUCCESS) {
+      throw std::runtime_error("Failed to create queue timeline semaphore");
+    }
+    queues_.push_back(std::move(scheduledQueue));
+  }
+  SPDLOG_LOGGER_INFO(get_vinkan_logger(),
+                     "Queue scheduler created with {} queues", queues_.size());
+}
+
+QueueScheduler::~QueueScheduler() {
+  waitIdle();
+  for (auto &scheduledQueue : queues_) {
+    vkDestroySemaphore(device_, scheduledQueue->timelineSemaphore, allocator_);
+  }
+}
+
+QueueTicket QueueScheduler::submit(
+    const std::vector<VkCommandBuffer> &commandBuffers,
+    const ScheduledSubmitInfo &submitInfo) {
+  VINKAN_TRACE_SCOPE("QueueScheduler::submit");
+  assert(submitInfo.waitDstStages.size() == submitInfo.waitSemaphores.size());
+  // Only selects a queue when none is given, selecting advances the round
+  // robin and reads the semaphores
+  uint32_t queueIndex =
+      submitInfo.queueIndex ? *submitInfo.queueIndex : selectQueue_();
+  assert(queueIndex < queues_.size());
+  auto &scheduledQueue = *queues_[queueIndex];
+
+  std::vector<VkSemaphore> waitSemaphores = submitInfo.waitSemaphores;
+  std::vector<VkPipelineStageFlags> waitDstStages = submitInfo.waitDstStages;
+  // Binary semaphores ignore their value
+  std::vector<uint64_t> waitValues(waitSemaphores.size(), 0);
+  for (auto &dependency : submitInfo.dependencies) {
+    assert(dependency.queueIndex < queues_.size());
+    if (getCompletedValue_(dependency.queueIndex) >= dependency.value) {
+      continue;
+    }
+    waitSemaphores.push_back(
+        queues_[dependency.queueIndex]->timelineSemaphore);
+    waitDstStages.push_back(submitInfo.dependencyWaitStage);
+    waitValues.push_back(dependency.value);
+  }
+  std::vector<VkSemaphore> signalSemaphores = submitInfo.signalSemaphores;
+  signalSemaphores.push_back(scheduledQueue.timelineSemaphore);
+  std::vector<uint64_t> signalValues(signalSemaphores.size(), 0);
+
+  // The value is taken under the lock so that the values signaled by a queue
+  // increase in submission order
+  std::lock_guard<std::mutex> lock(scheduledQueue.mutex);
+  uint64_t value = scheduledQueue.submittedValue.load() + 1;
+  signalValues.back() = value;
+
+  VkTimelineSemaphoreSubmitInfo timelineInfo{};
+  timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+  timelineInfo.waitSemaphoreValueCount =
+      static_cast<uint32_t>(waitValues.size());
+  timelineInfo.pWaitSemaphoreValues = waitValues.data();
+  timelineInfo.signalSemaphoreValueCount =
+      static_cast<uint32_t>(signalValues.size());
+  timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+  VkSubmitInfo vkSubmitInfo{};
+  vkSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  vkSubmitInfo.pNext = &timelineInfo;
+  vkSubmitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+  vkSubmitInfo.pWaitSemaphores = waitSemaphores.data();
+  vkSubmitInfo.pWaitDstStageMask = waitDstStages.data();
+  vkSubmitInfo.commandBufferCount =
+      static_cast<uint32_t>(commandBuffers.size());
+  vkSubmitInfo.pCommandBuffers = commandBuffers.data();
+  vkSubmitInfo.signalSemaphoreCount =
+      static_cast<uint32_t>(signalSemaphores.size());
+  vkSubmitInfo.pSignalSemaphores = signalSemaphores.data();
+
+  if (deviceDispatch.vkQueueSubmit(scheduledQueue.queue, 1, &vkSubmitInfo,
+                                   submitInfo.signalFence) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to submit to the scheduled queue");
+  }
+  scheduledQueue.submittedValue.store(value);
+  SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Submitted to scheduled queue {}",
+                      queueIndex);
+  return QueueTicket{.queueIndex = queueIndex, .value = value};
+}
+
+QueueTicket QueueScheduler::submit(VkCommandBuffer commandBuffer,
+                                   const ScheduledSubmitInfo &submitInfo) {
+  return submit(std::vector<VkCommandBuffer>{commandBuffer}, submitInfo);
+}
+
+bool QueueScheduler::isComplete(QueueTicket ticket) const {
+  return getCompletedValue_(ticket.queueIndex) >= ticket.value;
+}
+
+bool QueueScheduler::wait(QueueTicket ticket, uint64_t timeout) const {
+  assert(ticket.queueIndex < queues_.size());
+  VkSemaphoreWaitInfo waitInfo{};
+  waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+  waitInfo.semaphoreCount = 1;
+  waitInfo.pSemaphores = &queues_[ticket.queueIndex]->timelineSemaphore;
+  waitInfo.pValues = &ticket.value;
+  VkResult result =
+      deviceDispatch.vkWaitSemaphores(device_, &waitInfo, timeout);
+  if (result != VK_SUCCESS && result != VK_TIMEOUT) {
+    throw std::runtime_error("Failed to wait for a scheduled submission");
+  }
+  return result == VK_SUCCESS;
+}
+
+void QueueScheduler::waitIdle() const {
+  for (uint32_t i = 0; i < queues_.size(); ++i) {
+    wait(QueueTicket{.queueIndex = i,
+                     .value = queues_[i]->submittedValue.load()});
+  }
+}
+
+uint64_t QueueScheduler::getPendingCount(uint32_t queueIndex) const {
+  assert(queueIndex < queues_.size());
+  uint64_t submitted = queues_[queueIndex]->submittedValue.load();
+  uint64_t completed = getCompletedValue_(queueIndex);
+  return submitted > completed ? submitted - completed : 0;
+}
+
+uint32_t QueueScheduler::selectQueue_() {
+  auto queueCount = static_cast<uint32_t>(queues_.size());
+  // Round robin also breaks the ties of the least loaded policy
+  uint32_t start = nextQueue_.fetch_add(1) % queueCount;
+  if (policy_ == QueueSchedulingPolicy::ROUND_ROBIN) {
+    return start;
+  }
+  uint32_t selected = start;
+  uint64_t minPending = UINT64_MAX;
+  for (uint32_t n = 0; n < queueCount; ++n) {
+    uint32_t queueIndex = (start + n) % queueCount;
+    uint64_t pending = getPendingCount(queueIndex);
+    if (pending < minPending) {
+      minPending = pending;
+      selected = queueIndex;
+      if (pending == 0) {
+        break;
+      }
+    }
+  }
+  return selected;
+}
+
+uint64_t QueueScheduler::getCompletedValue_(uint32_t queueIndex) const {
+  uint64_t value = 0;
+  if (deviceDispatch.vkGetSemaphoreCounterValue(
+          device_, queues_[queueIndex]->timelineSemaphore, &value) !=
+      VK_SUCCESS) {
+    throw std::runtime_error("Failed to read a queue timeline semaphore");
+  }
+  return value;
+}
+
+}  // namespace vinkan
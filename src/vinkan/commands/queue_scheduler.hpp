@@ -0,0 +1,93 @@
+#ifndef VINKAN_QUEUE_SCHEDULER_HPP
+#define VINKAN_QUEUE_SCHEDULER_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace vinkan {
+
+enum class QueueSchedulingPolicy { ROUND_ROBIN, LEAST_LOADED };
+
+// Identifies a scheduled submission, it's complete once the timeline
+// semaphore of its queue reaches the value.
+struct QueueTicket {
+  uint32_t queueIndex;
+  uint64_t value;
+};
+
+struct ScheduledSubmitInfo {
+  // Submissions (possibly on other queues) that must complete first
+  std::vector<QueueTicket> dependencies{};
+  VkPipelineStageFlags dependencyWaitStage =
+      VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+  std::vector<VkSemaphore> waitSemaphores{};
+  std::vector<VkPipelineStageFlags> waitDstStages{};
+  std::vector<VkSemaphore> signalSemaphores{};
+  VkFence signalFence = VK_NULL_HANDLE;
+  // Forces the queue instead of letting the policy choose
+  std::optional<uint32_t> queueIndex = std::nullopt;
+};
+
+// Distributes submissions over the queues of one family. Each queue has its
+// own lock and timeline semaphore, so submissions to different queues from
+// different threads don't contend, and the semaphore values give both the
+// load of each queue and the dependencies between submissions.
+//
+// The device must have been created with timeline semaphores enabled.
+class QueueScheduler {
+ public:
+  QueueScheduler(VkDevice device, std::vector<VkQueue> queues,
+                 QueueSchedulingPolicy policy =
+                     QueueSchedulingPolicy::LEAST_LOADED,
+                 const VkAllocationCallbacks *allocator = nullptr);
+  ~QueueScheduler();
+
+  QueueScheduler(const QueueScheduler &) = delete;
+  QueueScheduler &operator=(const QueueScheduler &) = delete;
+
+  // Thread safe
+  QueueTicket submit(const std::vector<VkCommandBuffer> &commandBuffers,
+                     const ScheduledSubmitInfo &submitInfo = {});
+  QueueTicket submit(VkCommandBuffer commandBuffer,
+                     const ScheduledSubmitInfo &submitInfo = {});
+
+  bool isComplete(QueueTicket ticket) const;
+  // Returns false on timeout
+  bool wait(QueueTicket ticket, uint64_t timeout = UINT64_MAX) const;
+  void waitIdle() const;
+
+  // Submissions not completed yet on the queue
+  uint64_t getPendingCount(uint32_t queueIndex) const;
+  uint32_t getQueueCount() const {
+    return static_cast<uint32_t>(queues_.size());
+  }
+  VkSemaphore getTimelineSemaphore(uint32_t queueIndex) const {
+    return queues_[queueIndex]->timelineSemaphore;
+  }
+
+ private:
+  struct ScheduledQueue_ {
+    VkQueue queue;
+    VkSemaphore timelineSemaphore;
+    std::mutex mutex;
+    std::atomic<uint64_t> submittedValue{0};
+  };
+
+  VkDevice device_;
+  const VkAllocationCallbacks *allocator_;
+  QueueSchedulingPolicy policy_;
+  std::vector<std::unique_ptr<ScheduledQueue_>> queues_{};
+  std::atomic<uint32_t> nextQueue_{0};
+
+  uint32_t selectQueue_();
+  uint64_t getCompletedValue_(uint32_t queueIndex) const;
+};
+
+}  // namespace vinkan
+
+#endif
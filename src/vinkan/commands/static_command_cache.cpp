@@ -0,0 +1,112 @@
+#include "static_command_cache.hpp"
+
+#include <cassert>
+#include <stdexcept>
+
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/logging/tracer.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
+
+namespace vinkan {
+
+StaticCommandCache::StaticCommandCache(VkDevice device,
+                                       uint32_t queueFamilyIndex,
+                                       uint32_t slotCount,
+                                       RecordFunction record,
+                                       bool simultaneousUse,
+                                       const VkAllocationCallbacks *allocator)
+    : device_(device),
+      allocator_(allocator),
+      record_(std::move(record)),
+      simultaneousUse_(simultaneousUse) {
+  assert(slotCount > 0);
+
+  // Not transient, the buffers are meant to live long
+  VkCommandPoolCreateInfo poolInfo{};
+  poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  poolInfo.queueFamilyIndex = queueFamilyIndex;
+  if (vkCreateCommandPool(device_, &poolInfo, allocator_, &commandPool_) !=
+      VK_SUCCESS) {
+    throw std::runtime_error("Failed to create the static commands pool");
+  }
+
+  std::vector<VkCommandBuffer> commandBuffers(slotCount);
+  VkCommandBufferAllocateInfo allocInfo{};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.commandPool = commandPool_;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandBufferCount = slotCount;
+  if (deviceDispatch.vkAllocateCommandBuffers(
+          device_, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to allocate the static command buffers");
+  }
+  slots_.resize(slotCount);
+  for (uint32_t i = 0; i < slotCount; ++i) {
+    slots_[i].commandBuffer = commandBuffers[i];
+  }
+  SPDLOG_LOGGER_TRACE(get_vinkan_logger(),
+                      "Static command cache created with {} slots", slotCount);
+}
+
+StaticCommandCache::~StaticCommandCache() {
+  // Frees the command buffers, they must not be pending anymore
+  vkDestroyCommandPool(device_, commandPool_, allocator_);
+}
+
+VkCommandBuffer StaticCommandCache::get(uint32_t slot,
+                                        const StaticCommandInputs &inputs) {
+  assert(slot < slots_.size());
+  auto &cached = slots_[slot];
+  if (!isDirty(slot, inputs)) {
+    reuseCount_++;
+    return cached.commandBuffer;
+  }
+  cached.inputs = inputs;
+  recordSlot_(slot);
+  return cached.commandBuffer;
+}
+
+void StaticCommandCache::invalidate(uint32_t slot) {
+  assert(slot < slots_.size());
+  slots_[slot].recorded = false;
+}
+
+void StaticCommandCache::invalidateAll() {
+  for (auto &slot : slots_) {
+    slot.recorded = false;
+  }
+}
+
+bool StaticCommandCache::isDirty(uint32_t slot,
+                                 const StaticCommandInputs &inputs) const {
+  assert(slot < slots_.size());
+  return !slots_[slot].recorded || slots_[slot].inputs != inputs;
+}
+
+void StaticCommandCache::recordSlot_(uint32_t slot) {
+  VINKAN_TRACE_SCOPE("StaticCommandCache::record");
+  auto &cached = slots_[slot];
+  if (deviceDispatch.vkResetCommandBuffer(cached.commandBuffer, 0) !=
+      VK_SUCCESS) {
+    throw std::runtime_error("Failed to reset a static command buffer");
+  }
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags =
+      simultaneousUse_ ? VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT : 0;
+  if (deviceDispatch.vkBeginCommandBuffer(cached.commandBuffer, &beginInfo) !=
+      VK_SUCCESS) {
+    throw std::runtime_error("Failed to begin a static command buffer");
+  }
+  record_(cached.commandBuffer, slot);
+  if (deviceDispatch.vkEndCommandBuffer(cached.commandBuffer) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to record a static command buffer");
+  }
+  cached.recorded = true;
+  recordCount_++;
+  SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Static command slot {} recorded",
+                      slot);
+}
+
+}  // namespace vinkan
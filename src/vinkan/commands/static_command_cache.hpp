@@ -0,0 +1,83 @@
+#ifndef VINKAN_STATIC_COMMAND_CACHE_HPP
+#define VINKAN_STATIC_COMMAND_CACHE_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace vinkan {
+
+// What a static command buffer is recorded with, it's re-recorded as soon as
+// one of them changes
+struct StaticCommandInputs {
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  std::vector<VkDescriptorSet> descriptorSets{};
+  std::vector<VkBuffer> buffers{};
+  VkFramebuffer framebuffer = VK_NULL_HANDLE;
+  // Bump it for state that isn't a handle (push constants, draw counts...)
+  uint64_t version = 0;
+
+  bool operator==(const StaticCommandInputs &) const = default;
+};
+
+// Command buffers recorded once and resubmitted unchanged until their inputs
+// change, e.g. one slot per swapchain image for a static scene or a single
+// slot for a fixed compute pipeline.
+//
+// A slot must not be pending execution when its inputs change. With
+// simultaneousUse, an unchanged slot can be submitted again while it's still
+// pending (e.g. the same compute work in every frame in flight).
+class StaticCommandCache {
+ public:
+  using RecordFunction =
+      std::function<void(VkCommandBuffer commandBuffer, uint32_t slot)>;
+
+  StaticCommandCache(VkDevice device, uint32_t queueFamilyIndex,
+                     uint32_t slotCount, RecordFunction record,
+                     bool simultaneousUse = false,
+                     const VkAllocationCallbacks *allocator = nullptr);
+  ~StaticCommandCache();
+
+  StaticCommandCache(const StaticCommandCache &) = delete;
+  StaticCommandCache &operator=(const StaticCommandCache &) = delete;
+
+  // Returns the recorded command buffer of the slot, recording it first if it
+  // has never been recorded, was invalidated or its inputs changed.
+  VkCommandBuffer get(uint32_t slot, const StaticCommandInputs &inputs);
+
+  // Forces the next get to record again
+  void invalidate(uint32_t slot);
+  void invalidateAll();
+
+  bool isDirty(uint32_t slot, const StaticCommandInputs &inputs) const;
+  uint32_t getSlotCount() const {
+    return static_cast<uint32_t>(slots_.size());
+  }
+  uint64_t getRecordCount() const { return recordCount_; }
+  uint64_t getReuseCount() const { return reuseCount_; }
+
+ private:
+  struct Slot_ {
+    VkCommandBuffer commandBuffer;
+    bool recorded = false;
+    StaticCommandInputs inputs{};
+  };
+
+  VkDevice device_;
+  const VkAllocationCallbacks *allocator_;
+  VkCommandPool commandPool_;
+  RecordFunction record_;
+  bool simultaneousUse_;
+  std::vector<Slot_> slots_{};
+
+  uint64_t recordCount_ = 0;
+  uint64_t reuseCount_ = 0;
+
+  void recordSlot_(uint32_t slot);
+};
+
+}  // namespace vinkan
+
+#endif
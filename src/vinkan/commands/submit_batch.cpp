@@ -0,0 +1,108 @@
+#include "submit_batch.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/logging/tracer.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
+
+namespace vinkan {
+
+SubmitBatch::SubmitBatch(VkQueue queue, uint32_t autoFlushThreshold)
+    : queue_(queue), autoFlushThreshold_(autoFlushThreshold) {}
+
+SubmitBatch::~SubmitBatch() {
+  assert(pendingSubmits_.empty() &&
+         "The submit batch is destroyed with pending submissions");
+}
+
+void SubmitBatch::add(const std::vector<VkCommandBuffer> &commandBuffers,
+                      const SubmitCommandBufferInfo &submitInfo) {
+  assert(submitInfo.waitDstStages.size() == submitInfo.waitSemaphores.size());
+  assert(submitInfo.signalFence == VK_NULL_HANDLE &&
+         "The fence of a batch is given to flush");
+  assert((submitInfo.queue == VK_NULL_HANDLE || submitInfo.queue == queue_) &&
+         "A batch only submits to its own queue");
+
+  PendingSubmit_ pendingSubmit{
+      .waitOffset = static_cast<uint32_t>(waitSemaphores_.size()),
+      .waitCount = static_cast<uint32_t>(submitInfo.waitSemaphores.size()),
+      .commandBufferOffset = static_cast<uint32_t>(commandBuffers_.size()),
+      .commandBufferCount = static_cast<uint32_t>(commandBuffers.size()),
+      .signalOffset = static_cast<uint32_t>(signalSemaphores_.size()),
+      .signalCount = static_cast<uint32_t>(submitInfo.signalSemaphores.size()),
+  };
+  waitSemaphores_.insert(waitSemaphores_.end(),
+                         submitInfo.waitSemaphores.begin(),
+                         submitInfo.waitSemaphores.end());
+  waitDstStages_.insert(waitDstStages_.end(), submitInfo.waitDstStages.begin(),
+                        submitInfo.waitDstStages.end());
+  commandBuffers_.insert(commandBuffers_.end(), commandBuffers.begin(),
+                         commandBuffers.end());
+  signalSemaphores_.insert(signalSemaphores_.end(),
+                           submitInfo.signalSemaphores.begin(),
+                           submitInfo.signalSemaphores.end());
+  pendingSubmits_.push_back(pendingSubmit);
+
+  if (autoFlushThreshold_ > 0 &&
+      pendingSubmits_.size() >= autoFlushThreshold_) {
+    flush();
+  }
+}
+
+void SubmitBatch::add(VkCommandBuffer commandBuffer,
+                      const SubmitCommandBufferInfo &submitInfo) {
+  add(std::vector<VkCommandBuffer>{commandBuffer}, submitInfo);
+}
+
+void SubmitBatch::flush(VkFence fence) {
+  VINKAN_TRACE_SCOPE("SubmitBatch::flush");
+  if (pendingSubmits_.empty() && fence == VK_NULL_HANDLE) {
+    return;
+  }
+
+  submitInfos_.clear();
+  for (auto &pendingSubmit : pendingSubmits_) {
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.waitSemaphoreCount = pendingSubmit.waitCount;
+    submitInfo.pWaitSemaphores =
+        waitSemaphores_.data() + pendingSubmit.waitOffset;
+    submitInfo.pWaitDstStageMask =
+        waitDstStages_.data() + pendingSubmit.waitOffset;
+    submitInfo.commandBufferCount = pendingSubmit.commandBufferCount;
+    submitInfo.pCommandBuffers =
+        commandBuffers_.data() + pendingSubmit.commandBufferOffset;
+    submitInfo.signalSemaphoreCount = pendingSubmit.signalCount;
+    submitInfo.pSignalSemaphores =
+        signalSemaphores_.data() + pendingSubmit.signalOffset;
+    submitInfos_.push_back(submitInfo);
+  }
+
+  auto submitCount = static_cast<uint32_t>(submitInfos_.size());
+  VkResult result =
+      deviceDispatch.vkQueueSubmit(queue_, submitCount, submitInfos_.data(),
+                                   fence);
+  clear_();
+  if (result != VK_SUCCESS) {
+    throw std::runtime_error("Failed to submit the batch");
+  }
+
+  stats_.flushCount++;
+  stats_.submitCount += submitCount;
+  stats_.maxSubmitsPerFlush = std::max(stats_.maxSubmitsPerFlush, submitCount);
+  SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Submit batch flushed");
+}
+
+void SubmitBatch::clear_() {
+  // Clearing keeps the capacity, a steady state batch doesn't allocate
+  pendingSubmits_.clear();
+  waitSemaphores_.clear();
+  waitDstStages_.clear();
+  commandBuffers_.clear();
+  signalSemaphores_.clear();
+}
+
+}  // namespace vinkan
@@ -0,0 +1,87 @@
+#ifndef VINKAN_SUBMIT_BATCH_HPP
+#define VINKAN_SUBMIT_BATCH_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "vinkan/command_coordinator.hpp"
+
+namespace vinkan {
+
+struct SubmitBatchStats {
+  uint64_t flushCount = 0;
+  uint64_t submitCount = 0;
+  uint32_t maxSubmitsPerFlush = 0;
+
+  double averageSubmitsPerFlush() const {
+    if (flushCount == 0) {
+      return 0.;
+    }
+    return static_cast<double>(submitCount) / static_cast<double>(flushCount);
+  }
+};
+
+// Accumulates several submissions (each with their own wait and signal
+// semaphores) and sends them to the queue in a single vkQueueSubmit.
+//
+// The submission order is kept, so a submission can wait on a semaphore
+// signaled by a previous one of the same batch.
+class SubmitBatch {
+ public:
+  // If autoFlushThreshold is not 0, the batch is flushed (without fence) as
+  // soon as it holds this many submissions.
+  SubmitBatch(VkQueue queue, uint32_t autoFlushThreshold = 0);
+  ~SubmitBatch();
+
+  SubmitBatch(const SubmitBatch &) = delete;
+  SubmitBatch &operator=(const SubmitBatch &) = delete;
+
+  // The queue of the info must be the batch queue (or null) and the fence
+  // must be null, the fence is given to flush instead.
+  void add(const std::vector<VkCommandBuffer> &commandBuffers,
+           const SubmitCommandBufferInfo &submitInfo);
+  void add(VkCommandBuffer commandBuffer,
+           const SubmitCommandBufferInfo &submitInfo);
+
+  // Submit every pending submission. The fence is signaled once all of them
+  // have completed, it's still submitted when nothing is pending.
+  void flush(VkFence fence = VK_NULL_HANDLE);
+
+  uint32_t getPendingCount() const {
+    return static_cast<uint32_t>(pendingSubmits_.size());
+  }
+  VkQueue getQueue() const { return queue_; }
+  const SubmitBatchStats &getStats() const { return stats_; }
+  void resetStats() { stats_ = {}; }
+
+ private:
+  // Offsets in the flat arrays below, the VkSubmitInfo pointers are only
+  // resolved at flush time since the arrays can grow until then.
+  struct PendingSubmit_ {
+    uint32_t waitOffset;
+    uint32_t waitCount;
+    uint32_t commandBufferOffset;
+    uint32_t commandBufferCount;
+    uint32_t signalOffset;
+    uint32_t signalCount;
+  };
+
+  VkQueue queue_;
+  uint32_t autoFlushThreshold_;
+  SubmitBatchStats stats_{};
+
+  std::vector<PendingSubmit_> pendingSubmits_{};
+  std::vector<VkSemaphore> waitSemaphores_{};
+  std::vector<VkPipelineStageFlags> waitDstStages_{};
+  std::vector<VkCommandBuffer> commandBuffers_{};
+  std::vector<VkSemaphore> signalSemaphores_{};
+  std::vector<VkSubmitInfo> submitInfos_{};
+
+  void clear_();
+};
+
+}  // namespace vinkan
+
+#endif
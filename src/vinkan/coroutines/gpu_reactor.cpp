@@ -0,0 +1,268 @@
+#include "gpu_reactor.hpp"
+
+#include <stdexcept>
+
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/logging/tracer.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
+
+namespace vinkan {
+
+///////////////
+// AWAITABLE //
+///////////////
+
+bool GpuAwaitable::await_ready() {
+  VkDevice device = reactor_->getDevice();
+  if (fence_ != VK_NULL_HANDLE) {
+    return deviceDispatch.vkGetFenceStatus(device, fence_) == VK_SUCCESS;
+  }
+  uint64_t currentValue = 0;
+  return deviceDispatch.vkGetSemaphoreCounterValue(
+             device, timelineSemaphore_, &currentValue) == VK_SUCCESS &&
+         currentValue >= value_;
+}
+
+void GpuAwaitable::await_suspend(std::coroutine_handle<> coroutine) {
+  // The awaitable lives in the coroutine frame until it's resumed
+  auto resume = [this, coroutine](VkResult result) {
+    result_ = result;
+    coroutine.resume();
+  };
+  if (fence_ != VK_NULL_HANDLE) {
+    reactor_->onComplete(fence_, resume);
+  } else {
+    reactor_->onComplete(timelineSemaphore_, value_, resume);
+  }
+}
+
+void GpuAwaitable::await_resume() const {
+  if (result_ != VK_SUCCESS) {
+    throw std::runtime_error("Failed to wait for the GPU work");
+  }
+}
+
+/////////////
+// REACTOR //
+/////////////
+
+GpuReactor::GpuReactor(VkDevice device, JobExecutor *executor,
+                       uint64_t fencePollIntervalUs,
+                       const VkAllocationCallbacks *allocator)
+    : device_(device),
+      allocator_(allocator),
+      executor_(executor),
+      fencePollIntervalNs_(fencePollIntervalUs * 1000) {
+  VkSemaphoreTypeCreateInfo typeInfo{};
+  typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+  typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+  typeInfo.initialValue = 0;
+  VkSemaphoreCreateInfo semaphoreInfo{};
+  semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+  semaphoreInfo.pNext = &typeInfo;
+  if (vkCreateSemaphore(device_, &semaphoreInfo, allocator_,
+                        &wakeUpSemaphore_) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to create reactor timeline semaphore");
+  }
+  thread_ = std::thread([this]() { run_(); });
+  SPDLOG_LOGGER_DEBUG(get_vinkan_logger(), "GPU reactor started");
+}
+
+GpuReactor::~GpuReactor() {
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+    wakeUp_();
+  }
+  thread_.join();
+
+  std::vector<PendingCallback_> completed{};
+  {
+    std::lock_guard lock(mutex_);
+    collectAll_(VK_INCOMPLETE, completed);
+  }
+  // Called here even with an executor, which may not outlive the reactor
+  for (auto &pending : completed) {
+    pending.callback(pending.result);
+  }
+  vkDestroySemaphore(device_, wakeUpSemaphore_, allocator_);
+}
+
+void GpuReactor::onComplete(VkSemaphore timelineSemaphore, uint64_t value,
+                            Callback callback) {
+  VkResult deviceResult;
+  {
+    std::lock_guard lock(mutex_);
+    deviceResult = deviceResult_;
+    if (deviceResult == VK_SUCCESS) {
+      timelineWaits_[timelineSemaphore].emplace(value, std::move(callback));
+      pendingCount_++;
+      wakeUp_();
+      return;
+    }
+  }
+  // The device is lost, nothing will complete anymore
+  std::vector<PendingCallback_> completed{{std::move(callback), deviceResult}};
+  dispatch_(completed);
+}
+
+void GpuReactor::onComplete(VkFence fence, Callback callback) {
+  VkResult deviceResult;
+  {
+    std::lock_guard lock(mutex_);
+    deviceResult = deviceResult_;
+    if (deviceResult == VK_SUCCESS) {
+      fenceWaits_[fence].push_back(std::move(callback));
+      pendingCount_++;
+      wakeUp_();
+      return;
+    }
+  }
+  std::vector<PendingCallback_> completed{{std::move(callback), deviceResult}};
+  dispatch_(completed);
+}
+
+size_t GpuReactor::getPendingCount() const {
+  std::lock_guard lock(mutex_);
+  return pendingCount_;
+}
+
+void GpuReactor::wakeUp_() {
+  // Under the mutex so that the signaled values increase
+  wakeUpValue_++;
+  VkSemaphoreSignalInfo signalInfo{};
+  signalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO;
+  signalInfo.semaphore = wakeUpSemaphore_;
+  signalInfo.value = wakeUpValue_;
+  deviceDispatch.vkSignalSemaphore(device_, &signalInfo);
+}
+
+void GpuReactor::run_() {
+  std::vector<VkSemaphore> semaphores{};
+  std::vector<uint64_t> values{};
+  std::vector<VkFence> fences{};
+  std::vector<PendingCallback_> completed{};
+  while (true) {
+    semaphores.clear();
+    values.clear();
+    fences.clear();
+    {
+      std::lock_guard lock(mutex_);
+      if (stopping_) {
+        return;
+      }
+      // Waiting for the earliest value of each semaphore is enough, the
+      // later ones are checked once it's reached
+      for (auto &[semaphore, waits] : timelineWaits_) {
+        semaphores.push_back(semaphore);
+        values.push_back(waits.begin()->first);
+      }
+      for (auto &[fence, waits] : fenceWaits_) {
+        fences.push_back(fence);
+      }
+      semaphores.push_back(wakeUpSemaphore_);
+      values.push_back(wakeUpValue_ + 1);
+    }
+
+    VkResult result;
+    if (fences.empty() || semaphores.size() > 1) {
+      VkSemaphoreWaitInfo waitInfo{};
+      waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+      waitInfo.flags = VK_SEMAPHORE_WAIT_ANY_BIT;
+      waitInfo.semaphoreCount = static_cast<uint32_t>(semaphores.size());
+      waitInfo.pSemaphores = semaphores.data();
+      waitInfo.pValues = values.data();
+      result = deviceDispatch.vkWaitSemaphores(
+          device_, &waitInfo,
+          fences.empty() ? UINT64_MAX : fencePollIntervalNs_);
+    } else {
+      // Only fences, the ones signaled first end the wait right away
+      result = deviceDispatch.vkWaitForFences(
+          device_, static_cast<uint32_t>(fences.size()), fences.data(),
+          VK_FALSE, fencePollIntervalNs_);
+    }
+
+    bool failed = result != VK_SUCCESS && result != VK_TIMEOUT;
+    {
+      VINKAN_TRACE_SCOPE("GpuReactor::collect");
+      std::lock_guard lock(mutex_);
+      if (failed) {
+        SPDLOG_LOGGER_WARN(get_vinkan_logger(),
+                           "GPU reactor wait failed ({}), completing the {} "
+                           "pending waits",
+                           static_cast<int32_t>(result), pendingCount_);
+        deviceResult_ = result;
+        collectAll_(result, completed);
+      } else {
+        collectCompleted_(completed);
+      }
+    }
+    dispatch_(completed);
+    // The next waits would fail right away, the new ones complete with
+    // deviceResult_ without the thread
+    if (failed) {
+      return;
+    }
+  }
+}
+
+void GpuReactor::collectCompleted_(std::vector<PendingCallback_> &completed) {
+  for (auto it = timelineWaits_.begin(); it != timelineWaits_.end();) {
+    auto &[semaphore, waits] = *it;
+    uint64_t currentValue = 0;
+    VkResult result = deviceDispatch.vkGetSemaphoreCounterValue(
+        device_, semaphore, &currentValue);
+    auto end = result == VK_SUCCESS ? waits.upper_bound(currentValue)
+                                    : waits.end();
+    for (auto wait = waits.begin(); wait != end; ++wait) {
+      completed.push_back({std::move(wait->second), result});
+    }
+    waits.erase(waits.begin(), end);
+    it = waits.empty() ? timelineWaits_.erase(it) : std::next(it);
+  }
+  for (auto it = fenceWaits_.begin(); it != fenceWaits_.end();) {
+    VkResult result = deviceDispatch.vkGetFenceStatus(device_, it->first);
+    if (result == VK_NOT_READY) {
+      ++it;
+      continue;
+    }
+    for (auto &callback : it->second) {
+      completed.push_back({std::move(callback), result});
+    }
+    it = fenceWaits_.erase(it);
+  }
+  pendingCount_ -= completed.size();
+}
+
+void GpuReactor::collectAll_(VkResult result,
+                             std::vector<PendingCallback_> &completed) {
+  for (auto &[semaphore, waits] : timelineWaits_) {
+    for (auto &[value, callback] : waits) {
+      completed.push_back({std::move(callback), result});
+    }
+  }
+  for (auto &[fence, waits] : fenceWaits_) {
+    for (auto &callback : waits) {
+      completed.push_back({std::move(callback), result});
+    }
+  }
+  timelineWaits_.clear();
+  fenceWaits_.clear();
+  pendingCount_ = 0;
+}
+
+void GpuReactor::dispatch_(std::vector<PendingCallback_> &completed) {
+  for (auto &pending : completed) {
+    if (executor_ != nullptr) {
+      executor_->execute(
+          [callback = std::move(pending.callback), result = pending.result]() {
+            callback(result);
+          });
+    } else {
+      pending.callback(pending.result);
+    }
+  }
+  completed.clear();
+}
+
+}  // namespace vinkan
@@ -0,0 +1,124 @@
+#ifndef VINKAN_GPU_REACTOR_HPP
+#define VINKAN_GPU_REACTOR_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "vinkan/commands/queue_scheduler.hpp"
+#include "vinkan/jobs/job_system.hpp"
+
+namespace vinkan {
+
+class GpuReactor;
+
+// co_await on a fence or a timeline semaphore value, see GpuReactor::wait.
+// Throws a std::runtime_error when the wait fails (e.g. device lost).
+class GpuAwaitable {
+ public:
+  bool await_ready();
+  void await_suspend(std::coroutine_handle<> coroutine);
+  void await_resume() const;
+
+ private:
+  GpuReactor *reactor_;
+  VkFence fence_ = VK_NULL_HANDLE;
+  VkSemaphore timelineSemaphore_ = VK_NULL_HANDLE;
+  uint64_t value_ = 0;
+  VkResult result_ = VK_SUCCESS;
+
+  GpuAwaitable(GpuReactor *reactor, VkFence fence)
+      : reactor_(reactor), fence_(fence) {}
+  GpuAwaitable(GpuReactor *reactor, VkSemaphore timelineSemaphore,
+               uint64_t value)
+      : reactor_(reactor), timelineSemaphore_(timelineSemaphore),
+        value_(value) {}
+
+  friend class GpuReactor;
+};
+
+// Completion reactor: a single thread waits on all the pending timeline
+// semaphores at once (vkWaitSemaphores with VK_SEMAPHORE_WAIT_ANY_BIT) and
+// runs the callbacks of the completed waits on the executor, or on the
+// reactor thread without one. Thousands of waits can be pending without a
+// blocked thread per wait.
+//
+// Fences can't be waited together with semaphores, while fences are pending
+// the reactor wakes up every fencePollIntervalUs to check them.
+//
+// The device must have been created with timeline semaphores enabled.
+class GpuReactor {
+ public:
+  using Callback = std::function<void(VkResult)>;
+
+  explicit GpuReactor(VkDevice device, JobExecutor *executor = nullptr,
+                      uint64_t fencePollIntervalUs = 100,
+                      const VkAllocationCallbacks *allocator = nullptr);
+  // Pending callbacks are called with VK_INCOMPLETE
+  ~GpuReactor();
+
+  GpuReactor(const GpuReactor &) = delete;
+  GpuReactor &operator=(const GpuReactor &) = delete;
+
+  // Thread safe. The callback gets VK_SUCCESS once the semaphore reaches the
+  // value (or the fence is signaled), an error otherwise.
+  void onComplete(VkSemaphore timelineSemaphore, uint64_t value,
+                  Callback callback);
+  void onComplete(VkFence fence, Callback callback);
+
+  // Awaitables resuming the coroutine on the executor once the work is done,
+  // without suspending if it's already done
+  GpuAwaitable wait(VkSemaphore timelineSemaphore, uint64_t value) {
+    return GpuAwaitable(this, timelineSemaphore, value);
+  }
+  GpuAwaitable wait(VkFence fence) { return GpuAwaitable(this, fence); }
+  GpuAwaitable wait(const QueueScheduler &scheduler, QueueTicket ticket) {
+    return wait(scheduler.getTimelineSemaphore(ticket.queueIndex),
+                ticket.value);
+  }
+
+  // Waits registered and not completed yet
+  size_t getPendingCount() const;
+  VkDevice getDevice() const { return device_; }
+
+ private:
+  struct PendingCallback_ {
+    Callback callback;
+    VkResult result;
+  };
+
+  VkDevice device_;
+  const VkAllocationCallbacks *allocator_;
+  JobExecutor *executor_;
+  uint64_t fencePollIntervalNs_;
+
+  // Signaled from the host to wake the reactor up when a wait is added
+  VkSemaphore wakeUpSemaphore_ = VK_NULL_HANDLE;
+  uint64_t wakeUpValue_ = 0;
+
+  mutable std::mutex mutex_;
+  std::map<VkSemaphore, std::multimap<uint64_t, Callback>> timelineWaits_{};
+  std::map<VkFence, std::vector<Callback>> fenceWaits_{};
+  size_t pendingCount_ = 0;
+  bool stopping_ = false;
+  // Error of the first failed wait, the reactor thread stops there
+  VkResult deviceResult_ = VK_SUCCESS;
+
+  std::thread thread_;
+
+  void run_();
+  void wakeUp_();
+  void collectCompleted_(std::vector<PendingCallback_> &completed);
+  void collectAll_(VkResult result, std::vector<PendingCallback_> &completed);
+  void dispatch_(std::vector<PendingCallback_> &completed);
+};
+
+}  // namespace vinkan
+
+#endif
@@ -0,0 +1,203 @@
+#ifndef VINKAN_TASK_HPP
+#define VINKAN_TASK_HPP
+
+#include <cassert>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace vinkan {
+
+template <typename T>
+class Task;
+
+namespace detail {
+
+struct TaskPromiseBase {
+  std::mutex mutex;
+  std::condition_variable doneCondition;
+  bool started = false;
+  bool done = false;
+  // Coroutine awaiting the task, resumed when it's done
+  std::coroutine_handle<> continuation{};
+  std::exception_ptr error{};
+
+  std::suspend_always initial_suspend() noexcept { return {}; }
+
+  struct FinalAwaiter {
+    bool await_ready() noexcept { return false; }
+    template <typename PromiseT>
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<PromiseT> handle) noexcept {
+      auto &promise = handle.promise();
+      std::coroutine_handle<> continuation;
+      {
+        std::lock_guard lock(promise.mutex);
+        promise.done = true;
+        continuation = promise.continuation;
+        promise.doneCondition.notify_all();
+      }
+      // The frame may already be destroyed by a thread waiting on the task
+      return continuation ? continuation : std::noop_coroutine();
+    }
+    void await_resume() noexcept {}
+  };
+  FinalAwaiter final_suspend() noexcept { return {}; }
+
+  void unhandled_exception() { error = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+  std::optional<T> value{};
+
+  Task<T> get_return_object();
+  template <typename U>
+  void return_value(U &&result) {
+    value.emplace(std::forward<U>(result));
+  }
+  T takeResult() {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return std::move(*value);
+  }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+  Task<void> get_return_object();
+  void return_void() {}
+  void takeResult() {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+};
+
+}  // namespace detail
+
+// Lazy coroutine, its body starts when it's awaited or started.
+//
+// A coroutine awaiting GPU work (see GpuReactor) is resumed on the reactor
+// executor, so a task can finish on another thread than the one that started
+// it. The task must be done (or never started) when it's destroyed.
+template <typename T = void>
+class Task {
+ public:
+  using promise_type = detail::TaskPromise<T>;
+  using Handle = std::coroutine_handle<promise_type>;
+
+  Task() = default;
+  Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+  Task &operator=(Task &&other) noexcept {
+    if (this != &other) {
+      destroy_();
+      handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+  }
+  ~Task() { destroy_(); }
+
+  Task(const Task &) = delete;
+  Task &operator=(const Task &) = delete;
+
+  // Runs the task until its first suspension, without waiting for it
+  void start() {
+    assert(handle_);
+    {
+      std::lock_guard lock(handle_.promise().mutex);
+      assert(!handle_.promise().started);
+      handle_.promise().started = true;
+    }
+    handle_.resume();
+  }
+
+  bool isDone() const {
+    assert(handle_);
+    std::lock_guard lock(handle_.promise().mutex);
+    return handle_.promise().done;
+  }
+
+  // Blocks the calling thread until the task is done (starting it if
+  // needed), then returns its result or rethrows its exception
+  T wait() {
+    assert(handle_);
+    bool started;
+    {
+      std::lock_guard lock(handle_.promise().mutex);
+      started = handle_.promise().started;
+    }
+    if (!started) {
+      start();
+    }
+    {
+      auto &promise = handle_.promise();
+      std::unique_lock lock(promise.mutex);
+      promise.doneCondition.wait(lock, [&promise]() { return promise.done; });
+    }
+    return handle_.promise().takeResult();
+  }
+
+  auto operator co_await() && noexcept { return Awaiter_{handle_}; }
+  auto operator co_await() & noexcept { return Awaiter_{handle_}; }
+
+ private:
+  Handle handle_{};
+
+  explicit Task(Handle handle) : handle_(handle) {}
+
+  struct Awaiter_ {
+    Handle handle;
+
+    bool await_ready() noexcept { return false; }
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<> awaitingCoroutine) noexcept {
+      auto &promise = handle.promise();
+      std::lock_guard lock(promise.mutex);
+      if (promise.done) {
+        return awaitingCoroutine;
+      }
+      promise.continuation = awaitingCoroutine;
+      if (promise.started) {
+        return std::noop_coroutine();
+      }
+      // Symmetric transfer, the task starts right away on this thread
+      promise.started = true;
+      return handle;
+    }
+    T await_resume() { return handle.promise().takeResult(); }
+  };
+
+  void destroy_() {
+    if (handle_) {
+      assert((!handle_.promise().started || handle_.promise().done) &&
+             "Destroying a running task");
+      handle_.destroy();
+      handle_ = {};
+    }
+  }
+
+  friend struct detail::TaskPromise<T>;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+  return Task<T>(Task<T>::Handle::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+  return Task<void>(Task<void>::Handle::from_promise(*this));
+}
+
+}  // namespace detail
+
+}  // namespace vinkan
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef VINKAN_ENUM_NAME_HPP
+#define VINKAN_ENUM_NAME_HPP
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "vinkan/generics/concepts.hpp"
+
+namespace vinkan {
+
+// Values of scoped enums in [0, VINKAN_ENUM_NAME_MAX[ get their identifier as
+// name, the others their numeric value (an unscoped enum may not be able to
+// hold every value of the range)
+#ifndef VINKAN_ENUM_NAME_MAX
+#define VINKAN_ENUM_NAME_MAX 128
+#endif
+
+namespace detail {
+
+// The compiler spells the value in the function signature, e.g.
+// "... [with auto Value = Pipeline::COMPUTE]". Values without an enumerator
+// are spelled as a cast ("(Pipeline)5") or a number.
+template <auto Value>
+constexpr std::string_view enumValueName_() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  std::string_view signature = __FUNCSIG__;
+  auto end = signature.rfind(">(void)");
+  auto start = signature.rfind('<', end) + 1;
+#else
+  std::string_view signature = __PRETTY_FUNCTION__;
+  auto start = signature.find("Value = ") + 8;
+  auto end = signature.find_first_of(";]", start);
+#endif
+  auto name = signature.substr(start, end - start);
+  auto scope = name.rfind("::");
+  if (scope != std::string_view::npos) {
+    name = name.substr(scope + 2);
+  }
+  if (name.empty() || name[0] == '(' || (name[0] >= '0' && name[0] <= '9')) {
+    return {};
+  }
+  return name;
+}
+
+template <EnumType E, size_t... Indices>
+constexpr auto enumNames_(std::index_sequence<Indices...>) {
+  return std::array<std::string_view, sizeof...(Indices)>{
+      enumValueName_<static_cast<E>(Indices)>()...};
+}
+
+}  // namespace detail
+
+template <EnumType E>
+std::string enumName(E value) {
+  auto index = static_cast<std::underlying_type_t<E>>(value);
+  if constexpr (!std::is_convertible_v<E, std::underlying_type_t<E>>) {
+    static constexpr auto names = detail::enumNames_<E>(
+        std::make_index_sequence<VINKAN_ENUM_NAME_MAX>{});
+    if (index >= 0 && static_cast<size_t>(index) < names.size() &&
+        !names[index].empty()) {
+      return std::string(names[index]);
+    }
+  }
+  return std::to_string(index);
+}
+
+}  // namespace vinkan
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef VINKAN_MACROS_HPP
+#define VINKAN_MACROS_HPP
+
+// Unique variable names for the scope macros
+#define VINKAN_CONCAT_IMPL_(a, b) a##b
+#define VINKAN_CONCAT_(a, b) VINKAN_CONCAT_IMPL_(a, b)
+
+#endif
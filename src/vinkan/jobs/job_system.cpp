@@ -0,0 +1,348 @@
+#include "job_system.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "vinkan/logging/logger.hpp"
+
+namespace vinkan {
+
+/////////////////
+// THREAD POOL //
+/////////////////
+
+namespace {
+
+// Worker of a pool running on the current thread, if any
+struct CurrentWorker {
+  const ThreadPool *pool = nullptr;
+  int32_t index = -1;
+};
+thread_local CurrentWorker currentWorker{};
+
+}  // namespace
+
+ThreadPool::ThreadPool(uint32_t workerCount) {
+  for (uint32_t i = 0; i < workerCount; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  // Every deque exists before a worker can steal from it
+  for (uint32_t i = 0; i < workerCount; ++i) {
+    workers_[i]->thread = std::thread([this, i]() { workerLoop_(i); });
+  }
+  SPDLOG_LOGGER_DEBUG(get_vinkan_logger(), "Thread pool started, {} workers",
+                      workerCount);
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(sleepMutex_);
+    stopping_ = true;
+  }
+  wakeUp_.notify_all();
+  for (auto &worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+uint32_t ThreadPool::defaultWorkerCount() {
+  uint32_t coreCount = std::thread::hardware_concurrency();
+  return coreCount > 1 ? coreCount - 1 : 1;
+}
+
+uint32_t ThreadPool::getConcurrency() const {
+  // The thread splitting the work takes a part of it
+  return getWorkerCount() + 1;
+}
+
+void ThreadPool::execute(std::function<void()> job) {
+  int32_t workerIndex = getCurrentWorkerIndex_();
+  if (workerIndex >= 0) {
+    Worker &worker = *workers_[workerIndex];
+    std::lock_guard lock(worker.mutex);
+    worker.jobs.push_back(std::move(job));
+  } else {
+    std::lock_guard lock(sharedMutex_);
+    sharedJobs_.push_back(std::move(job));
+  }
+  pendingCount_.fetch_add(1, std::memory_order_release);
+  // A worker checking the count right before sleeping can't miss the notify
+  { std::lock_guard lock(sleepMutex_); }
+  wakeUp_.notify_one();
+}
+
+bool ThreadPool::runPendingJob() {
+  std::function<void()> job;
+  if (!tryPop_(getCurrentWorkerIndex_(), job)) {
+    return false;
+  }
+  job();
+  return true;
+}
+
+int32_t ThreadPool::getCurrentWorkerIndex_() const {
+  return currentWorker.pool == this ? currentWorker.index : -1;
+}
+
+bool ThreadPool::tryPop_(int32_t ownIndex, std::function<void()> &job) {
+  if (pendingCount_.load(std::memory_order_acquire) == 0) {
+    return false;
+  }
+  bool found = false;
+  // Own jobs first, most recent first
+  if (ownIndex >= 0) {
+    Worker &worker = *workers_[ownIndex];
+    std::lock_guard lock(worker.mutex);
+    if (!worker.jobs.empty()) {
+      job = std::move(worker.jobs.back());
+      worker.jobs.pop_back();
+      found = true;
+    }
+  }
+  if (!found) {
+    std::lock_guard lock(sharedMutex_);
+    if (!sharedJobs_.empty()) {
+      job = std::move(sharedJobs_.front());
+      sharedJobs_.pop_front();
+      found = true;
+    }
+  }
+  // Then the oldest jobs of the others
+  auto workerCount = static_cast<int32_t>(workers_.size());
+  for (int32_t i = 1; !found && i <= workerCount; ++i) {
+    int32_t victimIndex = (std::max(ownIndex, 0) + i) % workerCount;
+    if (victimIndex == ownIndex) {
+      continue;
+    }
+    Worker &victim = *workers_[victimIndex];
+    std::lock_guard lock(victim.mutex);
+    if (!victim.jobs.empty()) {
+      job = std::move(victim.jobs.front());
+      victim.jobs.pop_front();
+      found = true;
+    }
+  }
+  if (found) {
+    pendingCount_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  return found;
+}
+
+void ThreadPool::workerLoop_(uint32_t workerIndex) {
+  currentWorker = CurrentWorker{.pool = this,
+                                .index = static_cast<int32_t>(workerIndex)};
+  std::function<void()> job;
+  while (true) {
+    if (tryPop_(static_cast<int32_t>(workerIndex), job)) {
+      job();
+      job = nullptr;
+      continue;
+    }
+    std::unique_lock lock(sleepMutex_);
+    wakeUp_.wait(lock, [this]() {
+      return stopping_ || pendingCount_.load(std::memory_order_acquire) > 0;
+    });
+    // Pending jobs are drained before stopping
+    if (stopping_ && pendingCount_.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+  }
+}
+
+////////////////
+// JOB SYSTEM //
+////////////////
+
+namespace detail {
+
+struct JobState {
+  std::function<void()> job;
+  // Dependencies not done yet, plus one released once submit() is done
+  std::atomic<uint32_t> remainingDependencies{1};
+  std::atomic<bool> done{false};
+
+  std::mutex mutex;
+  std::vector<std::shared_ptr<JobState>> dependents{};
+  // Of the job itself or of one of its dependencies
+  std::exception_ptr error{};
+};
+
+}  // namespace detail
+
+bool JobHandle::isDone() const {
+  assert(isValid());
+  return state_->done.load(std::memory_order_acquire);
+}
+
+JobSystem::JobSystem(JobExecutor *executor) : executor_(executor) {
+  static InlineExecutor inlineExecutor{};
+  if (executor_ == nullptr) {
+    executor_ = &inlineExecutor;
+  }
+}
+
+JobHandle JobSystem::submit(std::function<void()> job,
+                            const std::vector<JobHandle> &dependencies) {
+  auto state = std::make_shared<detail::JobState>();
+  state->job = std::move(job);
+  state->remainingDependencies.store(
+      static_cast<uint32_t>(dependencies.size()) + 1,
+      std::memory_order_relaxed);
+
+  for (const auto &dependency : dependencies) {
+    assert(dependency.isValid());
+    auto &dependencyState = dependency.state_;
+    std::exception_ptr dependencyError;
+    {
+      std::lock_guard lock(dependencyState->mutex);
+      if (!dependencyState->done.load(std::memory_order_relaxed)) {
+        dependencyState->dependents.push_back(state);
+        continue;
+      }
+      dependencyError = dependencyState->error;
+    }
+    release_(state, dependencyError);
+  }
+  release_(state, nullptr);
+  return JobHandle(state);
+}
+
+void JobSystem::wait(const JobHandle &handle) {
+  assert(handle.isValid());
+  auto &state = handle.state_;
+  while (!state->done.load(std::memory_order_acquire)) {
+    if (!executor_->runPendingJob()) {
+      state->done.wait(false, std::memory_order_acquire);
+    }
+  }
+  std::exception_ptr error;
+  {
+    std::lock_guard lock(state->mutex);
+    error = state->error;
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void JobSystem::wait(const std::vector<JobHandle> &handles) {
+  std::exception_ptr firstError;
+  for (const auto &handle : handles) {
+    try {
+      wait(handle);
+    } catch (...) {
+      if (!firstError) {
+        firstError = std::current_exception();
+      }
+    }
+  }
+  if (firstError) {
+    std::rethrow_exception(firstError);
+  }
+}
+
+void JobSystem::parallelFor(
+    uint32_t count, uint32_t grainSize,
+    const std::function<void(uint32_t, uint32_t)> &body) {
+  if (count == 0) {
+    return;
+  }
+  // A few chunks per thread so that uneven chunks get balanced
+  uint32_t targetChunkCount = getConcurrency() * 4;
+  uint32_t chunkSize =
+      std::max({grainSize, 1u,
+                (count + targetChunkCount - 1) / targetChunkCount});
+  uint32_t chunkCount = (count + chunkSize - 1) / chunkSize;
+  if (chunkCount == 1) {
+    body(0, count);
+    return;
+  }
+
+  std::vector<JobHandle> handles{};
+  handles.reserve(chunkCount - 1);
+  for (uint32_t chunk = 1; chunk < chunkCount; ++chunk) {
+    uint32_t begin = chunk * chunkSize;
+    uint32_t end = std::min(count, begin + chunkSize);
+    handles.push_back(submit([&body, begin, end]() { body(begin, end); }));
+  }
+  // The jobs reference the body, they're waited on even if this one throws
+  std::exception_ptr error;
+  try {
+    body(0, chunkSize);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  try {
+    wait(handles);
+  } catch (...) {
+    if (!error) {
+      error = std::current_exception();
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void JobSystem::parallelCopy(void *dst, const void *src, size_t size) {
+  // Below that, the copy is faster than waking up the workers
+  constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+  if (size < 2 * MIN_CHUNK_SIZE || getConcurrency() == 1) {
+    std::memcpy(dst, src, size);
+    return;
+  }
+  auto chunkCount =
+      static_cast<uint32_t>((size + MIN_CHUNK_SIZE - 1) / MIN_CHUNK_SIZE);
+  parallelFor(chunkCount, 1, [=](uint32_t begin, uint32_t end) {
+    size_t offset = begin * MIN_CHUNK_SIZE;
+    size_t endOffset = std::min(size, end * MIN_CHUNK_SIZE);
+    std::memcpy(static_cast<char *>(dst) + offset,
+                static_cast<const char *>(src) + offset, endOffset - offset);
+  });
+}
+
+void JobSystem::schedule_(const std::shared_ptr<detail::JobState> &state) {
+  executor_->execute([this, state]() { run_(state); });
+}
+
+void JobSystem::run_(const std::shared_ptr<detail::JobState> &state) {
+  // All the dependencies are done, nothing else writes the error now
+  std::exception_ptr error = state->error;
+  if (!error) {
+    try {
+      state->job();
+    } catch (...) {
+      error = std::current_exception();
+    }
+  }
+  state->job = nullptr;
+
+  std::vector<std::shared_ptr<detail::JobState>> dependents;
+  {
+    std::lock_guard lock(state->mutex);
+    state->error = error;
+    state->done.store(true, std::memory_order_release);
+    dependents.swap(state->dependents);
+  }
+  state->done.notify_all();
+  for (auto &dependent : dependents) {
+    release_(dependent, error);
+  }
+}
+
+void JobSystem::release_(const std::shared_ptr<detail::JobState> &state,
+                         std::exception_ptr dependencyError) {
+  if (dependencyError) {
+    std::lock_guard lock(state->mutex);
+    if (!state->error) {
+      state->error = dependencyError;
+    }
+  }
+  if (state->remainingDependencies.fetch_sub(1, std::memory_order_acq_rel) ==
+      1) {
+    schedule_(state);
+  }
+}
+
+}  // namespace vinkan
@@ -0,0 +1,151 @@
+#ifndef VINKAN_JOB_SYSTEM_HPP
+#define VINKAN_JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vinkan {
+
+// Runs the jobs of a JobSystem. Implement it to run them on the application's
+// own scheduler, vinkan never creates threads by itself.
+class JobExecutor {
+ public:
+  virtual ~JobExecutor() = default;
+
+  // The job can run on any thread, even the calling one before returning
+  virtual void execute(std::function<void()> job) = 0;
+  // Jobs that can run at once, ranges are split accordingly
+  virtual uint32_t getConcurrency() const = 0;
+  // Runs one queued job on the calling thread if there's one. Waiting threads
+  // call it to help instead of blocking.
+  virtual bool runPendingJob() { return false; }
+};
+
+// Runs every job on the calling thread, the default executor
+class InlineExecutor : public JobExecutor {
+ public:
+  void execute(std::function<void()> job) override { job(); }
+  uint32_t getConcurrency() const override { return 1; }
+};
+
+// Work-stealing thread pool.
+//
+// Each worker has its own deque: it pops the jobs it submitted itself from
+// the back (the most recent, still in cache) and steals from the front of the
+// other deques when its own is empty. Jobs submitted from outside the pool go
+// to a shared queue.
+class ThreadPool : public JobExecutor {
+ public:
+  // The calling threads help while they wait, so one less worker than the
+  // number of cores is usually enough
+  explicit ThreadPool(uint32_t workerCount = defaultWorkerCount());
+  ~ThreadPool() override;
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  void execute(std::function<void()> job) override;
+  uint32_t getConcurrency() const override;
+  bool runPendingJob() override;
+
+  uint32_t getWorkerCount() const {
+    return static_cast<uint32_t>(workers_.size());
+  }
+
+  static uint32_t defaultWorkerCount();
+
+ private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<std::function<void()>> jobs;
+    std::thread thread;
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers_{};
+  std::mutex sharedMutex_;
+  std::deque<std::function<void()>> sharedJobs_{};
+
+  std::atomic<uint64_t> pendingCount_{0};
+  std::atomic<bool> stopping_{false};
+  std::mutex sleepMutex_;
+  std::condition_variable wakeUp_;
+
+  void workerLoop_(uint32_t workerIndex);
+  // ownIndex is -1 outside of the workers
+  bool tryPop_(int32_t ownIndex, std::function<void()> &job);
+  int32_t getCurrentWorkerIndex_() const;
+};
+
+namespace detail {
+struct JobState;
+}
+
+// Completion of a job submitted to a JobSystem
+class JobHandle {
+ public:
+  JobHandle() = default;
+
+  bool isValid() const { return state_ != nullptr; }
+  bool isDone() const;
+
+ private:
+  std::shared_ptr<detail::JobState> state_;
+
+  explicit JobHandle(std::shared_ptr<detail::JobState> state)
+      : state_(std::move(state)) {}
+
+  friend class JobSystem;
+};
+
+// Jobs with dependencies on top of a JobExecutor.
+//
+// A job is handed to the executor once all its dependencies are done. When a
+// job throws, the jobs depending on it don't run and the exception is
+// rethrown by wait().
+//
+// The JobSystem and its executor must outlive the jobs submitted to them.
+class JobSystem {
+ public:
+  // Without an executor, the jobs run on the calling thread
+  explicit JobSystem(JobExecutor *executor = nullptr);
+
+  JobSystem(const JobSystem &) = delete;
+  JobSystem &operator=(const JobSystem &) = delete;
+
+  JobHandle submit(std::function<void()> job,
+                   const std::vector<JobHandle> &dependencies = {});
+  // The calling thread runs pending jobs while it waits
+  void wait(const JobHandle &handle);
+  void wait(const std::vector<JobHandle> &handles);
+
+  // Calls body(begin, end) on chunks of [0, count) of at least grainSize
+  // elements, the calling thread takes the first chunk. Returns once all the
+  // chunks are done.
+  void parallelFor(uint32_t count, uint32_t grainSize,
+                   const std::function<void(uint32_t, uint32_t)> &body);
+  // memcpy split in chunks, e.g. to fill a mapped staging buffer
+  void parallelCopy(void *dst, const void *src, size_t size);
+
+  uint32_t getConcurrency() const { return executor_->getConcurrency(); }
+
+ private:
+  JobExecutor *executor_;
+
+  void schedule_(const std::shared_ptr<detail::JobState> &state);
+  void run_(const std::shared_ptr<detail::JobState> &state);
+  void release_(const std::shared_ptr<detail::JobState> &state,
+                std::exception_ptr dependencyError);
+};
+
+}  // namespace vinkan
+
+#endif
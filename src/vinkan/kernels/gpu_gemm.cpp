@@ -0,0 +1,281 @@
+#include "gpu_gemm.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "vinkan/kernels/kernel_commands.hpp"
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/logging/tracer.hpp"
+
+namespace vinkan {
+
+namespace {
+
+// Must match the push constant of the kernel
+constexpr uint32_t FLAG_TRANSPOSE_A = 1;
+constexpr uint32_t FLAG_TRANSPOSE_B = 2;
+constexpr uint32_t FLAG_BIAS = 4;
+constexpr uint32_t FLAG_RELU = 8;
+constexpr uint32_t FLAG_ACCUMULATE = 16;
+
+struct GemmPushConstant {
+  VkDeviceAddress a;
+  VkDeviceAddress b;
+  VkDeviceAddress c;
+  VkDeviceAddress bias;
+  uint32_t m;
+  uint32_t n;
+  uint32_t k;
+  uint32_t lda;
+  uint32_t ldb;
+  uint32_t ldc;
+  uint32_t strideA;
+  uint32_t strideB;
+  uint32_t strideC;
+  uint32_t baseGroupX;
+  uint32_t baseGroupY;
+  uint32_t baseGroupZ;
+  float alpha;
+  float beta;
+  uint32_t flags;
+};
+static_assert(sizeof(GemmPushConstant) == 96);
+
+// Specialization constants of the kernel
+struct TileSize {
+  uint32_t m;
+  uint32_t n;
+  uint32_t k;
+};
+constexpr TileSize TILE_SIZES[] = {{32, 32, 32}, {64, 64, 16}, {128, 128, 16}};
+constexpr uint32_t TILE_COUNT = 3;
+
+// Workgroups a tile needs to be picked by default
+constexpr uint64_t MIN_WORKGROUPS = 64;
+
+// Host buffer slots of the host API
+constexpr uint32_t HOST_A = 0;
+constexpr uint32_t HOST_B = 1;
+constexpr uint32_t HOST_BIAS = 2;
+constexpr uint32_t HOST_C = 3;
+
+uint64_t getWorkgroupCount(const GemmInfo &info, const TileSize &tileSize) {
+  uint64_t rowTiles = (info.m + tileSize.m - 1) / tileSize.m;
+  uint64_t columnTiles = (info.n + tileSize.n - 1) / tileSize.n;
+  return rowTiles * columnTiles * info.batchCount;
+}
+
+// Stored rows and row length of a matrix
+struct StoredShape {
+  uint32_t rows;
+  uint32_t columns;
+};
+
+StoredShape getShapeA(const GemmInfo &info) {
+  return info.transposeA ? StoredShape{info.k, info.m}
+                         : StoredShape{info.m, info.k};
+}
+
+StoredShape getShapeB(const GemmInfo &info) {
+  return info.transposeB ? StoredShape{info.n, info.k}
+                         : StoredShape{info.k, info.n};
+}
+
+// Elements a strided batch of matrices spans
+uint64_t getSpan(StoredShape shape, uint32_t leadingDimension,
+                 uint32_t stride, uint32_t batchCount) {
+  if (shape.rows == 0 || shape.columns == 0) {
+    return 0;
+  }
+  return static_cast<uint64_t>(batchCount - 1) * stride +
+         static_cast<uint64_t>(shape.rows - 1) * leadingDimension +
+         shape.columns;
+}
+
+}  // namespace
+
+GpuGemm::GpuGemm(VkDevice device, PhysicalDevice &physicalDevice,
+                 const KernelLibraryInfo &info, bool float16,
+                 const VkAllocationCallbacks *allocator)
+    : limits_(physicalDevice.getLimits()),
+      float16_(float16),
+      pipelines_(device, allocator),
+      hostRunner_(device, physicalDevice.getMemoryProperties(), info.queue,
+                  info.queueFamilyIndex, allocator) {
+  VINKAN_TRACE_SCOPE("GpuGemm::GpuGemm");
+  if (info.kernelsDirectory.empty()) {
+    throw std::runtime_error(
+        "No GEMM kernels, Vinkan must be built with VINKAN_WITH_KERNELS");
+  }
+  if (float16_ && !physicalDevice.supportsFloat16Compute()) {
+    throw std::runtime_error(
+        "The f16 GEMM kernels need shaderFloat16 and "
+        "storageBuffer16BitAccess");
+  }
+
+  pipelines_.createLayout<GemmPushConstant>(GpuGemmLayout::GEMM, {},
+                                            VK_SHADER_STAGE_COMPUTE_BIT);
+  pipelines_.setJobSystem(info.jobSystem);
+
+  VkSpecializationMapEntry tileEntries[] = {
+      {.constantID = 0, .offset = offsetof(TileSize, m), .size = 4},
+      {.constantID = 1, .offset = offsetof(TileSize, n), .size = 4},
+      {.constantID = 2, .offset = offsetof(TileSize, k), .size = 4}};
+  std::vector<VkSpecializationInfo> specializationInfos{};
+  for (const auto &tileSize : TILE_SIZES) {
+    specializationInfos.push_back(
+        VkSpecializationInfo{.mapEntryCount = 3,
+                             .pMapEntries = tileEntries,
+                             .dataSize = sizeof(TileSize),
+                             .pData = &tileSize});
+  }
+
+  using PipelineInfo = ComputePipelineInfo<GpuGemmLayout, ShaderFileInfo>;
+  std::vector<std::pair<GpuGemmPipeline, PipelineInfo>> pipelineInfos{};
+  uint32_t elementTypeCount = float16_ ? 2 : 1;
+  for (uint32_t type = 0; type < elementTypeCount; ++type) {
+    std::string shaderFilepath = info.kernelsDirectory + "/gemm_" +
+                                 (type == 0 ? "f32" : "f16") + ".spv";
+    for (uint32_t tile = 0; tile < TILE_COUNT; ++tile) {
+      pipelineInfos.push_back(
+          {static_cast<GpuGemmPipeline>(type * TILE_COUNT + tile),
+           PipelineInfo{
+               .layoutIdentifier = GpuGemmLayout::GEMM,
+               .shaderInfo = {.shaderFilepath = shaderFilepath,
+                              .shaderStage = VK_SHADER_STAGE_COMPUTE_BIT},
+               .specializationInfo = &specializationInfos[tile]}});
+    }
+  }
+  pipelines_.createComputePipelines(pipelineInfos);
+  for (const auto &[pipeline, pipelineInfo] : pipelineInfos) {
+    if (pipelines_.getWorkgroupSize(pipeline) !=
+        WorkgroupSize{WORKGROUP_SIDE, WORKGROUP_SIDE, 1}) {
+      throw std::runtime_error("GEMM kernel " +
+                               pipelineInfo.shaderInfo.shaderFilepath +
+                               " has an unexpected workgroup size");
+    }
+  }
+  layout_ = pipelines_.get(GpuGemmLayout::GEMM);
+  SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "GPU GEMM created");
+}
+
+GemmTile GpuGemm::getDefaultTile(const GemmInfo &info) {
+  for (auto tile : {GemmTile::LARGE, GemmTile::MEDIUM}) {
+    if (getWorkgroupCount(info, TILE_SIZES[static_cast<uint32_t>(tile)]) >=
+        MIN_WORKGROUPS) {
+      return tile;
+    }
+  }
+  return GemmTile::SMALL;
+}
+
+void GpuGemm::recordGemm(VkCommandBuffer commandBuffer,
+                         GemmElementType elementType, const GemmInfo &info,
+                         VkDeviceAddress a, VkDeviceAddress b,
+                         VkDeviceAddress c, VkDeviceAddress bias) const {
+  assert(elementType == GemmElementType::F32 || float16_);
+  // Every matrix of the batch writes its own C
+  assert(info.batchCount <= 1 || info.strideC != 0);
+  if (info.m == 0 || info.n == 0 || info.batchCount == 0) {
+    return;
+  }
+  GemmTile tile = info.tile.value_or(getDefaultTile(info));
+  const TileSize &tileSize = TILE_SIZES[static_cast<uint32_t>(tile)];
+  GemmPushConstant pushConstant{
+      .a = a,
+      .b = b,
+      .c = c,
+      .bias = bias,
+      .m = info.m,
+      .n = info.n,
+      .k = info.k,
+      .lda = info.lda != 0 ? info.lda : getShapeA(info).columns,
+      .ldb = info.ldb != 0 ? info.ldb : getShapeB(info).columns,
+      .ldc = info.ldc != 0 ? info.ldc : info.n,
+      .strideA = info.strideA,
+      .strideB = info.strideB,
+      .strideC = info.strideC,
+      .alpha = info.alpha,
+      .beta = info.beta,
+      .flags = (info.transposeA ? FLAG_TRANSPOSE_A : 0) |
+               (info.transposeB ? FLAG_TRANSPOSE_B : 0) |
+               (bias != 0 ? FLAG_BIAS : 0) | (info.relu ? FLAG_RELU : 0) |
+               (info.beta != 0.f ? FLAG_ACCUMULATE : 0)};
+
+  auto pipeline = static_cast<GpuGemmPipeline>(
+      static_cast<uint32_t>(elementType) * TILE_COUNT +
+      static_cast<uint32_t>(tile));
+  // One workgroup per output tile and matrix of the batch
+  DispatchExtent extent{
+      .x = static_cast<uint64_t>((info.n + tileSize.n - 1) / tileSize.n) *
+           WORKGROUP_SIDE,
+      .y = static_cast<uint64_t>((info.m + tileSize.m - 1) / tileSize.m) *
+           WORKGROUP_SIDE,
+      .z = info.batchCount};
+  cmdKernelDispatch(
+      commandBuffer,
+      KernelDispatch{.pipeline = pipelines_.getPipeline(pipeline),
+                     .layout = layout_,
+                     .pushConstant = &pushConstant,
+                     .pushConstantSize = sizeof(pushConstant),
+                     .baseGroupX = &pushConstant.baseGroupX,
+                     .baseGroupY = &pushConstant.baseGroupY,
+                     .baseGroupZ = &pushConstant.baseGroupZ,
+                     .extent = extent,
+                     .workgroupSize = {WORKGROUP_SIDE, WORKGROUP_SIDE, 1}},
+      limits_);
+}
+
+std::vector<float> GpuGemm::multiply(const GemmInfo &info,
+                                     std::span<const float> a,
+                                     std::span<const float> b,
+                                     std::span<const float> bias,
+                                     std::span<const float> c) {
+  VINKAN_TRACE_SCOPE("GpuGemm::multiply");
+  std::lock_guard<std::mutex> lock(hostMutex_);
+  StoredShape shapeA = getShapeA(info);
+  StoredShape shapeB = getShapeB(info);
+  uint64_t sizeA =
+      getSpan(shapeA, info.lda != 0 ? info.lda : shapeA.columns, info.strideA,
+              info.batchCount);
+  uint64_t sizeB =
+      getSpan(shapeB, info.ldb != 0 ? info.ldb : shapeB.columns, info.strideB,
+              info.batchCount);
+  uint64_t sizeC = getSpan({info.m, info.n}, info.ldc != 0 ? info.ldc : info.n,
+                           info.strideC, info.batchCount);
+  assert(a.size() >= sizeA && b.size() >= sizeB);
+  assert(bias.empty() || bias.size() >= info.n);
+  assert(info.beta == 0.f || c.size() >= sizeC);
+
+  auto upload = [&](uint32_t slot, const float *values, uint64_t size) {
+    Buffer &buffer = hostRunner_.getHostBuffer(slot, size * sizeof(float));
+    if (values != nullptr) {
+      std::memcpy(buffer.getMappedMemory(), values, size * sizeof(float));
+    } else {
+      std::memset(buffer.getMappedMemory(), 0, size * sizeof(float));
+    }
+    return buffer.getDeviceAddress();
+  };
+  VkDeviceAddress addressA = upload(HOST_A, a.data(), sizeA);
+  VkDeviceAddress addressB = upload(HOST_B, b.data(), sizeB);
+  VkDeviceAddress addressBias =
+      bias.empty() ? 0 : upload(HOST_BIAS, bias.data(), info.n);
+  VkDeviceAddress addressC =
+      upload(HOST_C, info.beta != 0.f ? c.data() : nullptr, sizeC);
+  hostRunner_.run([&](VkCommandBuffer commandBuffer) {
+    recordGemm(commandBuffer, GemmElementType::F32, info, addressA, addressB,
+               addressC, addressBias);
+  });
+
+  std::vector<float> result(sizeC);
+  std::memcpy(result.data(),
+              hostRunner_.getHostBuffer(HOST_C, sizeC * sizeof(float))
+                  .getMappedMemory(),
+              sizeC * sizeof(float));
+  return result;
+}
+
+}  // namespace vinkan
@@ -0,0 +1,124 @@
+#ifndef VINKAN_GPU_GEMM_HPP
+#define VINKAN_GPU_GEMM_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "vinkan/kernels/kernel_host_runner.hpp"
+#include "vinkan/kernels/kernel_library_info.hpp"
+#include "vinkan/pipelines/pipelines.hpp"
+#include "vinkan/wrappers/physical_device.hpp"
+
+namespace vinkan {
+
+enum class GemmElementType { F32, F16 };
+
+// Output tile of a workgroup (M x N) and depth of its shared memory tiles (K),
+// given to the kernel as specialization constants
+enum class GemmTile {
+  // 32 x 32 x 32, for small or skinny problems
+  SMALL,
+  // 64 x 64 x 16
+  MEDIUM,
+  // 128 x 128 x 16, the most reuse per loaded element
+  LARGE,
+};
+
+// Ordered by element type then tile
+enum class GpuGemmPipeline {
+  F32_SMALL,
+  F32_MEDIUM,
+  F32_LARGE,
+  F16_SMALL,
+  F16_MEDIUM,
+  F16_LARGE,
+};
+enum class GpuGemmLayout { GEMM };
+
+// C = alpha * op(A) op(B) + beta * C + bias, then ReLU when enabled, for each
+// matrix of the batch. op(A) is m x k, op(B) k x n and C m x n, row major.
+struct GemmInfo {
+  uint32_t m;
+  uint32_t n;
+  uint32_t k;
+  // A is stored k x m, B n x k
+  bool transposeA = false;
+  bool transposeB = false;
+  // Leading dimensions in elements, the stored row length when 0
+  uint32_t lda = 0;
+  uint32_t ldb = 0;
+  uint32_t ldc = 0;
+  // Elements between two matrices of the batch, 0 shares A or B between
+  // them
+  uint32_t batchCount = 1;
+  uint32_t strideA = 0;
+  uint32_t strideB = 0;
+  uint32_t strideC = 0;
+  // C is only read when beta isn't zero
+  float alpha = 1.f;
+  float beta = 0.f;
+  bool relu = false;
+  // Picked from the problem size when empty
+  std::optional<GemmTile> tile = std::nullopt;
+};
+
+// Matrix multiply of f32 and f16 matrices with shared memory tiling.
+//
+// Every invocation of the 16 x 16 workgroups accumulates a block of the output
+// tile in registers from the A and B tiles staged in shared memory. The f16
+// kernels accumulate in f32.
+class GpuGemm {
+ public:
+  // Must match the kernel
+  static constexpr uint32_t WORKGROUP_SIDE = 16;
+
+  // float16 creates the f16 pipelines, the device must have been created
+  // with Device::Builder::enableFloat16Compute
+  GpuGemm(VkDevice device, PhysicalDevice &physicalDevice,
+          const KernelLibraryInfo &info, bool float16 = false,
+          const VkAllocationCallbacks *allocator = nullptr);
+
+  GpuGemm(const GpuGemm &) = delete;
+  GpuGemm &operator=(const GpuGemm &) = delete;
+
+  bool hasFloat16() const { return float16_; }
+  // Tile used when GemmInfo::tile is empty, the largest one that still gives
+  // enough workgroups to fill the device
+  static GemmTile getDefaultTile(const GemmInfo &info);
+
+  // Record API. A, B and the bias must be visible to compute shaders before
+  // the recorded commands and C is written by compute shaders. bias is 0 or
+  // holds n elements.
+  //
+  // Recording is thread safe.
+  void recordGemm(VkCommandBuffer commandBuffer, GemmElementType elementType,
+                  const GemmInfo &info, VkDeviceAddress a, VkDeviceAddress b,
+                  VkDeviceAddress c, VkDeviceAddress bias = 0) const;
+
+  // Host API of f32 matrices, copies them to host visible buffers, runs the
+  // kernel on the queue and waits for it. c holds the initial C when beta
+  // isn't zero. Calls are serialized.
+  std::vector<float> multiply(const GemmInfo &info, std::span<const float> a,
+                              std::span<const float> b,
+                              std::span<const float> bias = {},
+                              std::span<const float> c = {});
+
+ private:
+  VkPhysicalDeviceLimits limits_;
+  bool float16_;
+  Pipelines<GpuGemmPipeline, GpuGemmLayout> pipelines_;
+  VkPipelineLayout layout_ = VK_NULL_HANDLE;
+
+  // Host API
+  std::mutex hostMutex_;
+  KernelHostRunner hostRunner_;
+};
+
+}  // namespace vinkan
+
+#endif
@@ -0,0 +1,452 @@
+#include "gpu_image_processing.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "vinkan/kernels/kernel_commands.hpp"
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/logging/tracer.hpp"
+
+namespace vinkan {
+
+namespace {
+
+// Must match the push constants of the kernels
+constexpr uint32_t FLAG_VERTICAL = 1;
+constexpr uint32_t FLAG_FULL_RANGE = 1;
+
+struct ConvolvePushConstant {
+  VkDeviceAddress input;
+  VkDeviceAddress temporary;
+  VkDeviceAddress output;
+  uint32_t width;
+  uint32_t height;
+  uint32_t inputPitch;
+  uint32_t outputPitch;
+  uint32_t radius;
+  float sigma;
+  uint32_t flags;
+  uint32_t baseGroupX;
+  uint32_t baseGroupY;
+};
+
+struct ResizePushConstant {
+  VkDeviceAddress input;
+  VkDeviceAddress output;
+  uint32_t inputWidth;
+  uint32_t inputHeight;
+  uint32_t inputPitch;
+  uint32_t outputWidth;
+  uint32_t outputHeight;
+  uint32_t outputPitch;
+  uint32_t filter;
+  uint32_t baseGroupX;
+  uint32_t baseGroupY;
+};
+
+struct ColorPushConstant {
+  VkDeviceAddress rgb;
+  VkDeviceAddress luma;
+  VkDeviceAddress chroma;
+  uint32_t width;
+  uint32_t height;
+  uint32_t rgbPitch;
+  uint32_t lumaPitch;
+  uint32_t chromaPitch;
+  float kr;
+  float kb;
+  uint32_t flags;
+  uint32_t baseGroupX;
+  uint32_t baseGroupY;
+};
+
+// The color kernel converts 4 x 2 pixel blocks
+constexpr uint32_t COLOR_BLOCK_WIDTH = 4;
+constexpr uint32_t COLOR_BLOCK_HEIGHT = 2;
+
+// Bytes of a pixel of the blur temporary, float RGBA
+constexpr VkDeviceSize TEMPORARY_PIXEL_SIZE = 4 * sizeof(float);
+
+// Host buffer slots of the host API
+constexpr uint32_t HOST_INPUT = 0;
+constexpr uint32_t HOST_OUTPUT = 1;
+
+GpuImagePipeline getPipeline(GpuImagePipeline rgba8Pipeline,
+                             PixelFormat format) {
+  return static_cast<GpuImagePipeline>(static_cast<uint32_t>(rgba8Pipeline) +
+                                       static_cast<uint32_t>(format));
+}
+
+uint32_t getPitch(const ImageBufferView &image) {
+  return image.rowPitch != 0 ? image.rowPitch : image.width;
+}
+
+uint32_t getNv12Pitch(uint32_t pitch, uint32_t width) {
+  return pitch != 0 ? pitch : (width + 3) / 4 * 4;
+}
+
+}  // namespace
+
+GpuImageProcessing::GpuImageProcessing(VkDevice device,
+                                       PhysicalDevice &physicalDevice,
+                                       const KernelLibraryInfo &info,
+                                       const VkAllocationCallbacks *allocator)
+    : limits_(physicalDevice.getLimits()),
+      pipelines_(device, allocator),
+      hostRunner_(device, physicalDevice.getMemoryProperties(), info.queue,
+                  info.queueFamilyIndex, allocator) {
+  VINKAN_TRACE_SCOPE("GpuImageProcessing::GpuImageProcessing");
+  if (info.kernelsDirectory.empty()) {
+    throw std::runtime_error(
+        "No image processing kernels, Vinkan must be built with "
+        "VINKAN_WITH_KERNELS");
+  }
+
+  pipelines_.createLayout<ConvolvePushConstant>(
+      GpuImageLayout::CONVOLVE, {}, VK_SHADER_STAGE_COMPUTE_BIT);
+  pipelines_.createLayout<ResizePushConstant>(GpuImageLayout::RESIZE, {},
+                                              VK_SHADER_STAGE_COMPUTE_BIT);
+  pipelines_.createLayout<ColorPushConstant>(GpuImageLayout::COLOR, {},
+                                             VK_SHADER_STAGE_COMPUTE_BIT);
+  pipelines_.setJobSystem(info.jobSystem);
+
+  struct Kernel {
+    const char *name;
+    GpuImageLayout layout;
+  };
+  const Kernel kernels[] = {{"image_convolve_", GpuImageLayout::CONVOLVE},
+                            {"image_resize_", GpuImageLayout::RESIZE},
+                            {"image_color_to_rgb_", GpuImageLayout::COLOR},
+                            {"image_color_to_nv12_", GpuImageLayout::COLOR}};
+  using PipelineInfo = ComputePipelineInfo<GpuImageLayout, ShaderFileInfo>;
+  std::vector<std::pair<GpuImagePipeline, PipelineInfo>> pipelineInfos{};
+  uint32_t pipelineIndex = 0;
+  for (const auto &kernel : kernels) {
+    for (const char *format : {"rgba8", "rgba32f"}) {
+      pipelineInfos.push_back(
+          {static_cast<GpuImagePipeline>(pipelineIndex++),
+           PipelineInfo{
+               .layoutIdentifier = kernel.layout,
+               .shaderInfo = {.shaderFilepath = info.kernelsDirectory + "/" +
+                                                kernel.name + format + ".spv",
+                              .shaderStage = VK_SHADER_STAGE_COMPUTE_BIT}}});
+    }
+  }
+  pipelines_.createComputePipelines(pipelineInfos);
+  for (const auto &[pipeline, pipelineInfo] : pipelineInfos) {
+    if (pipelines_.getWorkgroupSize(pipeline) !=
+        WorkgroupSize{WORKGROUP_SIDE, WORKGROUP_SIDE, 1}) {
+      throw std::runtime_error("Image processing kernel " +
+                               pipelineInfo.shaderInfo.shaderFilepath +
+                               " has an unexpected workgroup size");
+    }
+  }
+  convolveLayout_ = pipelines_.get(GpuImageLayout::CONVOLVE);
+  resizeLayout_ = pipelines_.get(GpuImageLayout::RESIZE);
+  colorLayout_ = pipelines_.get(GpuImageLayout::COLOR);
+  SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "GPU image processing created");
+}
+
+VkDeviceSize GpuImageProcessing::getTemporarySize(uint32_t width,
+                                                  uint32_t height) {
+  return static_cast<VkDeviceSize>(width) * height * TEMPORARY_PIXEL_SIZE;
+}
+
+uint32_t GpuImageProcessing::getGaussianRadius(float sigma) {
+  return std::min(static_cast<uint32_t>(std::ceil(3.f * sigma)),
+                  MAX_BLUR_RADIUS);
+}
+
+void GpuImageProcessing::recordGaussianBlur(
+    VkCommandBuffer commandBuffer, PixelFormat format,
+    const ImageBufferView &input, const ImageBufferView &output,
+    VkDeviceAddress temporary, float sigma) const {
+  assert(sigma > 0.f);
+  recordBlur_(commandBuffer, format, input, output, temporary,
+              getGaussianRadius(sigma), sigma);
+}
+
+void GpuImageProcessing::recordBoxBlur(VkCommandBuffer commandBuffer,
+                                       PixelFormat format,
+                                       const ImageBufferView &input,
+                                       const ImageBufferView &output,
+                                       VkDeviceAddress temporary,
+                                       uint32_t radius) const {
+  // A sigma of 0 gives every tap the same weight
+  recordBlur_(commandBuffer, format, input, output, temporary, radius, 0.f);
+}
+
+void GpuImageProcessing::recordResize(VkCommandBuffer commandBuffer,
+                                      PixelFormat format,
+                                      const ImageBufferView &input,
+                                      const ImageBufferView &output,
+                                      ResizeFilter filter) const {
+  if (input.width == 0 || input.height == 0 || output.width == 0 ||
+      output.height == 0) {
+    return;
+  }
+  ResizePushConstant pushConstant{
+      .input = input.address,
+      .output = output.address,
+      .inputWidth = input.width,
+      .inputHeight = input.height,
+      .inputPitch = getPitch(input),
+      .outputWidth = output.width,
+      .outputHeight = output.height,
+      .outputPitch = getPitch(output),
+      .filter = static_cast<uint32_t>(filter)};
+  recordDispatch_(commandBuffer,
+                  getPipeline(GpuImagePipeline::RESIZE_RGBA8, format),
+                  GpuImageLayout::RESIZE, &pushConstant, sizeof(pushConstant),
+                  &pushConstant.baseGroupX, output.width, output.height);
+}
+
+void GpuImageProcessing::recordNv12ToRgb(VkCommandBuffer commandBuffer,
+                                         PixelFormat format,
+                                         const Nv12BufferView &input,
+                                         const ImageBufferView &output,
+                                         const YuvInfo &yuvInfo) const {
+  assert(output.width == input.width && output.height == input.height);
+  recordColor_(commandBuffer, format, false, output, input, yuvInfo);
+}
+
+void GpuImageProcessing::recordRgbToNv12(VkCommandBuffer commandBuffer,
+                                         PixelFormat format,
+                                         const ImageBufferView &input,
+                                         const Nv12BufferView &output,
+                                         const YuvInfo &yuvInfo) const {
+  assert(output.width == input.width && output.height == input.height);
+  recordColor_(commandBuffer, format, true, input, output, yuvInfo);
+}
+
+void GpuImageProcessing::recordBlur_(VkCommandBuffer commandBuffer,
+                                     PixelFormat format,
+                                     const ImageBufferView &input,
+                                     const ImageBufferView &output,
+                                     VkDeviceAddress temporary,
+                                     uint32_t radius, float sigma) const {
+  assert(radius <= MAX_BLUR_RADIUS);
+  assert(output.width == input.width && output.height == input.height);
+  if (input.width == 0 || input.height == 0) {
+    return;
+  }
+  ConvolvePushConstant pushConstant{.input = input.address,
+                                    .temporary = temporary,
+                                    .output = output.address,
+                                    .width = input.width,
+                                    .height = input.height,
+                                    .inputPitch = getPitch(input),
+                                    .outputPitch = getPitch(output),
+                                    .radius = radius,
+                                    .sigma = sigma,
+                                    .flags = 0};
+  GpuImagePipeline pipeline =
+      getPipeline(GpuImagePipeline::CONVOLVE_RGBA8, format);
+  recordDispatch_(commandBuffer, pipeline, GpuImageLayout::CONVOLVE,
+                  &pushConstant, sizeof(pushConstant),
+                  &pushConstant.baseGroupX, input.width, input.height);
+
+  // The vertical pass reads the temporary written by the horizontal one
+  cmdKernelBarrier(commandBuffer);
+  pushConstant.flags = FLAG_VERTICAL;
+  recordDispatch_(commandBuffer, pipeline, GpuImageLayout::CONVOLVE,
+                  &pushConstant, sizeof(pushConstant),
+                  &pushConstant.baseGroupX, input.width, input.height);
+}
+
+void GpuImageProcessing::recordColor_(VkCommandBuffer commandBuffer,
+                                      PixelFormat format, bool toNv12,
+                                      const ImageBufferView &rgb,
+                                      const Nv12BufferView &nv12,
+                                      const YuvInfo &yuvInfo) const {
+  assert(nv12.width % 2 == 0 && nv12.height % 2 == 0);
+  assert(nv12.lumaPitch % 4 == 0 && nv12.chromaPitch % 4 == 0);
+  if (nv12.width == 0 || nv12.height == 0) {
+    return;
+  }
+  bool bt709 = yuvInfo.colorSpace == YuvColorSpace::BT709;
+  ColorPushConstant pushConstant{
+      .rgb = rgb.address,
+      .luma = nv12.luma,
+      .chroma = nv12.chroma,
+      .width = nv12.width,
+      .height = nv12.height,
+      .rgbPitch = getPitch(rgb),
+      .lumaPitch = getNv12Pitch(nv12.lumaPitch, nv12.width),
+      .chromaPitch = getNv12Pitch(nv12.chromaPitch, nv12.width),
+      .kr = bt709 ? 0.2126f : 0.299f,
+      .kb = bt709 ? 0.0722f : 0.114f,
+      .flags = yuvInfo.fullRange ? FLAG_FULL_RANGE : 0};
+  recordDispatch_(
+      commandBuffer,
+      getPipeline(toNv12 ? GpuImagePipeline::RGB_TO_NV12_RGBA8
+                         : GpuImagePipeline::NV12_TO_RGB_RGBA8,
+                  format),
+      GpuImageLayout::COLOR, &pushConstant, sizeof(pushConstant),
+      &pushConstant.baseGroupX,
+      (nv12.width + COLOR_BLOCK_WIDTH - 1) / COLOR_BLOCK_WIDTH,
+      nv12.height / COLOR_BLOCK_HEIGHT);
+}
+
+void GpuImageProcessing::recordDispatch_(VkCommandBuffer commandBuffer,
+                                         GpuImagePipeline pipeline,
+                                         GpuImageLayout layout,
+                                         void *pushConstant,
+                                         uint32_t pushConstantSize,
+                                         uint32_t *baseGroup,
+                                         uint32_t invocationsX,
+                                         uint32_t invocationsY) const {
+  VkPipelineLayout pipelineLayout = colorLayout_;
+  if (layout == GpuImageLayout::CONVOLVE) {
+    pipelineLayout = convolveLayout_;
+  } else if (layout == GpuImageLayout::RESIZE) {
+    pipelineLayout = resizeLayout_;
+  }
+  cmdKernelDispatch(
+      commandBuffer,
+      KernelDispatch{.pipeline = pipelines_.getPipeline(pipeline),
+                     .layout = pipelineLayout,
+                     .pushConstant = pushConstant,
+                     .pushConstantSize = pushConstantSize,
+                     .baseGroupX = &baseGroup[0],
+                     .baseGroupY = &baseGroup[1],
+                     .extent = {.x = invocationsX, .y = invocationsY},
+                     .workgroupSize = {WORKGROUP_SIDE, WORKGROUP_SIDE, 1}},
+      limits_);
+}
+
+std::vector<uint32_t> GpuImageProcessing::gaussianBlur(
+    std::span<const uint32_t> pixels, uint32_t width, uint32_t height,
+    float sigma) {
+  assert(sigma > 0.f);
+  return blurHost_(pixels, width, height, getGaussianRadius(sigma), sigma);
+}
+
+std::vector<uint32_t> GpuImageProcessing::boxBlur(
+    std::span<const uint32_t> pixels, uint32_t width, uint32_t height,
+    uint32_t radius) {
+  return blurHost_(pixels, width, height, radius, 0.f);
+}
+
+std::vector<uint32_t> GpuImageProcessing::blurHost_(
+    std::span<const uint32_t> pixels, uint32_t width, uint32_t height,
+    uint32_t radius, float sigma) {
+  VINKAN_TRACE_SCOPE("GpuImageProcessing::blur");
+  std::lock_guard<std::mutex> lock(hostMutex_);
+  size_t pixelCount = static_cast<size_t>(width) * height;
+  assert(pixels.size() >= pixelCount);
+  VkDeviceSize size = pixelCount * sizeof(uint32_t);
+  Buffer &input = hostRunner_.getHostBuffer(HOST_INPUT, size);
+  Buffer &output = hostRunner_.getHostBuffer(HOST_OUTPUT, size);
+  Buffer &temporary =
+      hostRunner_.getDeviceBuffer(0, getTemporarySize(width, height));
+  std::memcpy(input.getMappedMemory(), pixels.data(), size);
+  ImageBufferView inputView{.address = input.getDeviceAddress(),
+                            .width = width,
+                            .height = height};
+  ImageBufferView outputView{.address = output.getDeviceAddress(),
+                             .width = width,
+                             .height = height};
+  VkDeviceAddress temporaryAddress = temporary.getDeviceAddress();
+  hostRunner_.run([&](VkCommandBuffer commandBuffer) {
+    recordBlur_(commandBuffer, PixelFormat::RGBA8, inputView, outputView,
+                temporaryAddress, radius, sigma);
+  });
+
+  std::vector<uint32_t> result(pixelCount);
+  std::memcpy(result.data(), output.getMappedMemory(), size);
+  return result;
+}
+
+std::vector<uint32_t> GpuImageProcessing::resize(
+    std::span<const uint32_t> pixels, uint32_t width, uint32_t height,
+    uint32_t outputWidth, uint32_t outputHeight, ResizeFilter filter) {
+  VINKAN_TRACE_SCOPE("GpuImageProcessing::resize");
+  std::lock_guard<std::mutex> lock(hostMutex_);
+  assert(pixels.size() >= static_cast<size_t>(width) * height);
+  VkDeviceSize inputSize =
+      static_cast<VkDeviceSize>(width) * height * sizeof(uint32_t);
+  size_t outputCount = static_cast<size_t>(outputWidth) * outputHeight;
+  VkDeviceSize outputSize = outputCount * sizeof(uint32_t);
+  Buffer &input = hostRunner_.getHostBuffer(HOST_INPUT, inputSize);
+  Buffer &output = hostRunner_.getHostBuffer(HOST_OUTPUT, outputSize);
+  std::memcpy(input.getMappedMemory(), pixels.data(), inputSize);
+  ImageBufferView inputView{.address = input.getDeviceAddress(),
+                            .width = width,
+                            .height = height};
+  ImageBufferView outputView{.address = output.getDeviceAddress(),
+                             .width = outputWidth,
+                             .height = outputHeight};
+  hostRunner_.run([&](VkCommandBuffer commandBuffer) {
+    recordResize(commandBuffer, PixelFormat::RGBA8, inputView, outputView,
+                 filter);
+  });
+
+  std::vector<uint32_t> result(outputCount);
+  std::memcpy(result.data(), output.getMappedMemory(), outputSize);
+  return result;
+}
+
+std::vector<uint32_t> GpuImageProcessing::nv12ToRgb(
+    std::span<const uint8_t> frame, uint32_t width, uint32_t height,
+    const YuvInfo &yuvInfo) {
+  VINKAN_TRACE_SCOPE("GpuImageProcessing::nv12ToRgb");
+  std::lock_guard<std::mutex> lock(hostMutex_);
+  assert(width % 4 == 0);
+  size_t pixelCount = static_cast<size_t>(width) * height;
+  VkDeviceSize frameSize = pixelCount * 3 / 2;
+  assert(frame.size() >= frameSize);
+  VkDeviceSize rgbSize = pixelCount * sizeof(uint32_t);
+  Buffer &input = hostRunner_.getHostBuffer(HOST_INPUT, frameSize);
+  Buffer &output = hostRunner_.getHostBuffer(HOST_OUTPUT, rgbSize);
+  std::memcpy(input.getMappedMemory(), frame.data(), frameSize);
+  Nv12BufferView nv12{.luma = input.getDeviceAddress(),
+                      .chroma = input.getDeviceAddress() + pixelCount,
+                      .width = width,
+                      .height = height};
+  ImageBufferView rgb{.address = output.getDeviceAddress(),
+                      .width = width,
+                      .height = height};
+  hostRunner_.run([&](VkCommandBuffer commandBuffer) {
+    recordNv12ToRgb(commandBuffer, PixelFormat::RGBA8, nv12, rgb, yuvInfo);
+  });
+
+  std::vector<uint32_t> result(pixelCount);
+  std::memcpy(result.data(), output.getMappedMemory(), rgbSize);
+  return result;
+}
+
+std::vector<uint8_t> GpuImageProcessing::rgbToNv12(
+    std::span<const uint32_t> pixels, uint32_t width, uint32_t height,
+    const YuvInfo &yuvInfo) {
+  VINKAN_TRACE_SCOPE("GpuImageProcessing::rgbToNv12");
+  std::lock_guard<std::mutex> lock(hostMutex_);
+  assert(width % 4 == 0);
+  size_t pixelCount = static_cast<size_t>(width) * height;
+  assert(pixels.size() >= pixelCount);
+  VkDeviceSize rgbSize = pixelCount * sizeof(uint32_t);
+  VkDeviceSize frameSize = pixelCount * 3 / 2;
+  Buffer &input = hostRunner_.getHostBuffer(HOST_INPUT, rgbSize);
+  Buffer &output = hostRunner_.getHostBuffer(HOST_OUTPUT, frameSize);
+  std::memcpy(input.getMappedMemory(), pixels.data(), rgbSize);
+  ImageBufferView rgb{.address = input.getDeviceAddress(),
+                      .width = width,
+                      .height = height};
+  Nv12BufferView nv12{.luma = output.getDeviceAddress(),
+                      .chroma = output.getDeviceAddress() + pixelCount,
+                      .width = width,
+                      .height = height};
+  hostRunner_.run([&](VkCommandBuffer commandBuffer) {
+    recordRgbToNv12(commandBuffer, PixelFormat::RGBA8, rgb, nv12, yuvInfo);
+  });
+
+  std::vector<uint8_t> result(frameSize);
+  std::memcpy(result.data(), output.getMappedMemory(), frameSize);
+  return result;
+}
+
+}  // namespace vinkan
@@ -0,0 +1,181 @@
+#ifndef VINKAN_GPU_IMAGE_PROCESSING_HPP
+#define VINKAN_GPU_IMAGE_PROCESSING_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "vinkan/kernels/kernel_host_runner.hpp"
+#include "vinkan/kernels/kernel_library_info.hpp"
+#include "vinkan/pipelines/pipelines.hpp"
+#include "vinkan/wrappers/physical_device.hpp"
+
+namespace vinkan {
+
+// Packed 8 bits RGBA with red in the low byte, or 32 bits float RGBA
+enum class PixelFormat { RGBA8, RGBA32F };
+
+enum class ResizeFilter { BILINEAR, LANCZOS3 };
+
+enum class YuvColorSpace { BT601, BT709 };
+
+// Ordered by kernel then pixel format
+enum class GpuImagePipeline {
+  CONVOLVE_RGBA8,
+  CONVOLVE_RGBA32F,
+  RESIZE_RGBA8,
+  RESIZE_RGBA32F,
+  NV12_TO_RGB_RGBA8,
+  NV12_TO_RGB_RGBA32F,
+  RGB_TO_NV12_RGBA8,
+  RGB_TO_NV12_RGBA32F,
+};
+enum class GpuImageLayout { CONVOLVE, RESIZE, COLOR };
+
+// Image stored in a buffer, row after row
+struct ImageBufferView {
+  VkDeviceAddress address;
+  uint32_t width;
+  uint32_t height;
+  // Row length in pixels, the width when 0
+  uint32_t rowPitch = 0;
+};
+
+// NV12 frame, an 8 bits luma plane and an interleaved 8 bits Cb Cr plane at
+// half the resolution. The width and height are even and the pitches are
+// multiples of 4 bytes.
+struct Nv12BufferView {
+  VkDeviceAddress luma;
+  VkDeviceAddress chroma;
+  uint32_t width;
+  uint32_t height;
+  // Row lengths in bytes, the width rounded up to 4 bytes when 0
+  uint32_t lumaPitch = 0;
+  uint32_t chromaPitch = 0;
+};
+
+struct YuvInfo {
+  YuvColorSpace colorSpace = YuvColorSpace::BT709;
+  // Full range codes use all 256 values, limited range ones 16 to 235 for
+  // luma and 16 to 240 for chroma
+  bool fullRange = false;
+};
+
+// Separable Gaussian and box blurs, bilinear and Lanczos resizes and
+// conversions between NV12 and RGB, of images stored in buffers.
+//
+// The blurs run a horizontal then a vertical pass through a float RGBA
+// temporary, each workgroup staging its pixels and the blur radius around
+// them in shared memory.
+//
+// Operations are chained in a command buffer with a compute to compute memory
+// barrier between them, e.g. cmdKernelBarrier.
+class GpuImageProcessing {
+ public:
+  // Must match the kernels
+  static constexpr uint32_t WORKGROUP_SIDE = 16;
+  static constexpr uint32_t MAX_BLUR_RADIUS = 16;
+
+  GpuImageProcessing(VkDevice device, PhysicalDevice &physicalDevice,
+                     const KernelLibraryInfo &info,
+                     const VkAllocationCallbacks *allocator = nullptr);
+
+  GpuImageProcessing(const GpuImageProcessing &) = delete;
+  GpuImageProcessing &operator=(const GpuImageProcessing &) = delete;
+
+  // Size of the temporary of the blurs
+  static VkDeviceSize getTemporarySize(uint32_t width, uint32_t height);
+  // Radius of a Gaussian blur, 3 sigma clamped to MAX_BLUR_RADIUS
+  static uint32_t getGaussianRadius(float sigma);
+
+  // Record API. The inputs must be visible to compute shaders before the
+  // recorded commands and the outputs are written by compute shaders. The
+  // input and output of an operation don't overlap.
+  //
+  // Recording is thread safe.
+  //
+  // The output has the input size, the temporary holds getTemporarySize bytes
+  // that aren't used by another command at the same time
+  void recordGaussianBlur(VkCommandBuffer commandBuffer, PixelFormat format,
+                          const ImageBufferView &input,
+                          const ImageBufferView &output,
+                          VkDeviceAddress temporary, float sigma) const;
+  // Radius of at most MAX_BLUR_RADIUS
+  void recordBoxBlur(VkCommandBuffer commandBuffer, PixelFormat format,
+                     const ImageBufferView &input,
+                     const ImageBufferView &output, VkDeviceAddress temporary,
+                     uint32_t radius) const;
+  // Lanczos downscales of more than 4 keep the 24 taps of each axis nearest
+  // to the output pixel center, the outer lobes of the kernel are dropped
+  void recordResize(VkCommandBuffer commandBuffer, PixelFormat format,
+                    const ImageBufferView &input,
+                    const ImageBufferView &output, ResizeFilter filter) const;
+  // The RGB image has the NV12 size, alpha is 1
+  void recordNv12ToRgb(VkCommandBuffer commandBuffer, PixelFormat format,
+                       const Nv12BufferView &input,
+                       const ImageBufferView &output,
+                       const YuvInfo &yuvInfo = {}) const;
+  // Chroma is averaged over each 2 x 2 block, alpha is dropped
+  void recordRgbToNv12(VkCommandBuffer commandBuffer, PixelFormat format,
+                       const ImageBufferView &input,
+                       const Nv12BufferView &output,
+                       const YuvInfo &yuvInfo = {}) const;
+
+  // Host API of packed RGBA8 images and tightly packed NV12 frames (luma
+  // plane then chroma plane, width rows), copies them to host visible
+  // buffers, runs the kernels on the queue and waits for them. Calls are
+  // serialized.
+  std::vector<uint32_t> gaussianBlur(std::span<const uint32_t> pixels,
+                                     uint32_t width, uint32_t height,
+                                     float sigma);
+  std::vector<uint32_t> boxBlur(std::span<const uint32_t> pixels,
+                                uint32_t width, uint32_t height,
+                                uint32_t radius);
+  std::vector<uint32_t> resize(std::span<const uint32_t> pixels,
+                               uint32_t width, uint32_t height,
+                               uint32_t outputWidth, uint32_t outputHeight,
+                               ResizeFilter filter);
+  // Widths multiple of 4
+  std::vector<uint32_t> nv12ToRgb(std::span<const uint8_t> frame,
+                                  uint32_t width, uint32_t height,
+                                  const YuvInfo &yuvInfo = {});
+  std::vector<uint8_t> rgbToNv12(std::span<const uint32_t> pixels,
+                                 uint32_t width, uint32_t height,
+                                 const YuvInfo &yuvInfo = {});
+
+ private:
+  VkPhysicalDeviceLimits limits_;
+  Pipelines<GpuImagePipeline, GpuImageLayout> pipelines_;
+  VkPipelineLayout convolveLayout_ = VK_NULL_HANDLE;
+  VkPipelineLayout resizeLayout_ = VK_NULL_HANDLE;
+  VkPipelineLayout colorLayout_ = VK_NULL_HANDLE;
+
+  // Host API
+  std::mutex hostMutex_;
+  KernelHostRunner hostRunner_;
+
+  void recordBlur_(VkCommandBuffer commandBuffer, PixelFormat format,
+                   const ImageBufferView &input, const ImageBufferView &output,
+                   VkDeviceAddress temporary, uint32_t radius,
+                   float sigma) const;
+  void recordColor_(VkCommandBuffer commandBuffer, PixelFormat format,
+                    bool toNv12, const ImageBufferView &rgb,
+                    const Nv12BufferView &nv12, const YuvInfo &yuvInfo) const;
+  // baseGroup points to the X then Y base groups of the push constant
+  void recordDispatch_(VkCommandBuffer commandBuffer,
+                       GpuImagePipeline pipeline, GpuImageLayout layout,
+                       void *pushConstant, uint32_t pushConstantSize,
+                       uint32_t *baseGroup, uint32_t invocationsX,
+                       uint32_t invocationsY) const;
+
+  std::vector<uint32_t> blurHost_(std::span<const uint32_t> pixels,
+                                  uint32_t width, uint32_t height,
+                                  uint32_t radius, float sigma);
+};
+
+}  // namespace vinkan
+
+#endif
@@ -0,0 +1,412 @@
+#include "gpu_primitives.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#include "vinkan/kernels/kernel_commands.hpp"
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/logging/tracer.hpp"
+
+namespace vinkan {
+
+namespace {
+
+// Must match the push constants of the kernels
+constexpr uint32_t FLAG_INCLUSIVE = 1;
+constexpr uint32_t FLAG_NORMALIZE = 2;
+constexpr uint32_t FLAG_TILE_OFFSETS = 4;
+
+struct ScanPushConstant {
+  VkDeviceAddress input;
+  VkDeviceAddress output;
+  VkDeviceAddress tileOffsets;
+  uint32_t count;
+  uint32_t baseTile;
+  uint32_t flags;
+};
+static_assert(sizeof(ScanPushConstant) == 40);
+
+struct CompactPushConstant {
+  VkDeviceAddress input;
+  VkDeviceAddress flags;
+  VkDeviceAddress output;
+  VkDeviceAddress tileOffsets;
+  VkDeviceAddress countOutput;
+  uint32_t count;
+  uint32_t baseTile;
+  uint32_t options;
+};
+static_assert(sizeof(CompactPushConstant) == 56);
+
+constexpr uint32_t ELEMENT_SIZE = sizeof(uint32_t);
+constexpr uint32_t ELEMENT_TYPE_COUNT = 3;
+
+// Host buffer slots of the host API
+constexpr uint32_t HOST_INPUT = 0;
+constexpr uint32_t HOST_FLAGS = 1;
+constexpr uint32_t HOST_OUTPUT = 2;
+
+uint32_t getTileCount(uint32_t count) {
+  return (count + GpuPrimitives::TILE_SIZE - 1) / GpuPrimitives::TILE_SIZE;
+}
+
+const char *getTypeSuffix(PrimitiveElementType elementType) {
+  switch (elementType) {
+    case PrimitiveElementType::U32:
+      return "u32";
+    case PrimitiveElementType::I32:
+      return "i32";
+    case PrimitiveElementType::F32:
+      return "f32";
+  }
+  return "";
+}
+
+// Pipelines are ordered by kernel then element type
+GpuPrimitivePipeline getPipeline(GpuPrimitivePipeline firstOfKernel,
+                                 PrimitiveElementType elementType) {
+  return static_cast<GpuPrimitivePipeline>(
+      static_cast<uint32_t>(firstOfKernel) +
+      static_cast<uint32_t>(elementType));
+}
+
+GpuPrimitivePipeline getReducePipeline(ReduceOperation operation,
+                                       PrimitiveElementType elementType) {
+  auto firstOfKernel = static_cast<GpuPrimitivePipeline>(
+      static_cast<uint32_t>(GpuPrimitivePipeline::REDUCE_ADD_U32) +
+      static_cast<uint32_t>(operation) * ELEMENT_TYPE_COUNT);
+  return getPipeline(firstOfKernel, elementType);
+}
+
+}  // namespace
+
+GpuPrimitives::GpuPrimitives(VkDevice device, PhysicalDevice &physicalDevice,
+                             const KernelLibraryInfo &info,
+                             const VkAllocationCallbacks *allocator)
+    : limits_(physicalDevice.getLimits()),
+      pipelines_(device, allocator),
+      hostRunner_(device, physicalDevice.getMemoryProperties(), info.queue,
+                  info.queueFamilyIndex, allocator) {
+  VINKAN_TRACE_SCOPE("GpuPrimitives::GpuPrimitives");
+  if (info.kernelsDirectory.empty()) {
+    throw std::runtime_error(
+        "No GPU primitive kernels, Vinkan must be built with "
+        "VINKAN_WITH_KERNELS");
+  }
+  auto subgroupProperties = physicalDevice.getSubgroupProperties();
+  if (!(subgroupProperties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) ||
+      !(subgroupProperties.supportedOperations &
+        VK_SUBGROUP_FEATURE_ARITHMETIC_BIT)) {
+    throw std::runtime_error(
+        "The GPU primitives need subgroup arithmetic in compute shaders");
+  }
+  // The workgroup scans index the subgroups by local index, which needs full
+  // subgroups covering the workgroup
+  if (!physicalDevice.supportsFullComputeSubgroups() ||
+      WORKGROUP_SIZE % subgroupProperties.subgroupSize != 0) {
+    throw std::runtime_error(
+        "The GPU primitives need full subgroups in compute shaders");
+  }
+
+  pipelines_.createLayout<ScanPushConstant>(GpuPrimitiveLayout::SCAN, {},
+                                            VK_SHADER_STAGE_COMPUTE_BIT);
+  pipelines_.createLayout<CompactPushConstant>(
+      GpuPrimitiveLayout::COMPACT, {}, VK_SHADER_STAGE_COMPUTE_BIT);
+  pipelines_.setJobSystem(info.jobSystem);
+
+  // The reduce operation is a specialization constant
+  uint32_t reduceOperations[] = {
+      static_cast<uint32_t>(ReduceOperation::ADD),
+      static_cast<uint32_t>(ReduceOperation::MIN),
+      static_cast<uint32_t>(ReduceOperation::MAX)};
+  VkSpecializationMapEntry operationEntry{
+      .constantID = 0, .offset = 0, .size = sizeof(uint32_t)};
+  std::vector<VkSpecializationInfo> specializationInfos{};
+  for (auto &operation : reduceOperations) {
+    specializationInfos.push_back(VkSpecializationInfo{
+        .mapEntryCount = 1,
+        .pMapEntries = &operationEntry,
+        .dataSize = sizeof(uint32_t),
+        .pData = &operation});
+  }
+
+  using PipelineInfo =
+      ComputePipelineInfo<GpuPrimitiveLayout, ShaderFileInfo>;
+  std::vector<std::pair<GpuPrimitivePipeline, PipelineInfo>> pipelineInfos{};
+  auto shaderInfo = [&](const char *kernel, PrimitiveElementType type) {
+    return ShaderFileInfo{
+        .shaderFilepath = info.kernelsDirectory + "/" + kernel + "_" +
+                          getTypeSuffix(type) + ".spv",
+        .shaderStage = VK_SHADER_STAGE_COMPUTE_BIT};
+  };
+  for (auto type : {PrimitiveElementType::U32, PrimitiveElementType::I32,
+                    PrimitiveElementType::F32}) {
+    for (uint32_t i = 0; i < specializationInfos.size(); ++i) {
+      pipelineInfos.push_back(
+          {getReducePipeline(static_cast<ReduceOperation>(i), type),
+           PipelineInfo{.layoutIdentifier = GpuPrimitiveLayout::SCAN,
+                        .shaderInfo = shaderInfo("reduce", type),
+                        .specializationInfo = &specializationInfos[i],
+                        .shaderStageFlags = KERNEL_STAGE_FLAGS}});
+    }
+    pipelineInfos.push_back(
+        {getPipeline(GpuPrimitivePipeline::SCAN_U32, type),
+         PipelineInfo{.layoutIdentifier = GpuPrimitiveLayout::SCAN,
+                      .shaderInfo = shaderInfo("scan", type),
+                      .shaderStageFlags = KERNEL_STAGE_FLAGS}});
+    pipelineInfos.push_back(
+        {getPipeline(GpuPrimitivePipeline::COMPACT_U32, type),
+         PipelineInfo{.layoutIdentifier = GpuPrimitiveLayout::COMPACT,
+                      .shaderInfo = shaderInfo("compact", type),
+                      .shaderStageFlags = KERNEL_STAGE_FLAGS}});
+  }
+  pipelines_.createComputePipelines(pipelineInfos);
+  for (const auto &[pipeline, pipelineInfo] : pipelineInfos) {
+    if (pipelines_.getWorkgroupSize(pipeline) !=
+        WorkgroupSize{WORKGROUP_SIZE, 1, 1}) {
+      throw std::runtime_error("GPU primitive kernel " +
+                               pipelineInfo.shaderInfo.shaderFilepath +
+                               " has an unexpected workgroup size");
+    }
+  }
+  scanLayout_ = pipelines_.get(GpuPrimitiveLayout::SCAN);
+  compactLayout_ = pipelines_.get(GpuPrimitiveLayout::COMPACT);
+
+  SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "GPU primitives created");
+}
+
+VkDeviceSize GpuPrimitives::getScratchSize(uint32_t count) {
+  VkDeviceSize elementCount = 0;
+  while (count > TILE_SIZE) {
+    count = getTileCount(count);
+    elementCount += count;
+  }
+  return elementCount * ELEMENT_SIZE;
+}
+
+void GpuPrimitives::recordReduce(VkCommandBuffer commandBuffer,
+                                 PrimitiveElementType elementType,
+                                 ReduceOperation operation,
+                                 VkDeviceAddress input, uint32_t count,
+                                 VkDeviceAddress output,
+                                 VkDeviceAddress scratch) const {
+  auto pipeline = getReducePipeline(operation, elementType);
+  auto levels =
+      recordUpsweep_(commandBuffer, pipeline, input, count, scratch, 0);
+  if (!levels.empty()) {
+    std::tie(input, count) = levels.back();
+  }
+  // Last tile, an empty input gives the identity of the operation
+  ScanPushConstant pushConstant{
+      .input = input, .output = output, .count = count};
+  recordDispatch_(commandBuffer, pipeline, GpuPrimitiveLayout::SCAN,
+                  &pushConstant, sizeof(pushConstant), &pushConstant.baseTile,
+                  1);
+}
+
+void GpuPrimitives::recordInclusiveScan(VkCommandBuffer commandBuffer,
+                                        PrimitiveElementType elementType,
+                                        VkDeviceAddress input, uint32_t count,
+                                        VkDeviceAddress output,
+                                        VkDeviceAddress scratch) const {
+  recordScan_(commandBuffer, elementType, input, count, output, scratch,
+              FLAG_INCLUSIVE);
+}
+
+void GpuPrimitives::recordExclusiveScan(VkCommandBuffer commandBuffer,
+                                        PrimitiveElementType elementType,
+                                        VkDeviceAddress input, uint32_t count,
+                                        VkDeviceAddress output,
+                                        VkDeviceAddress scratch) const {
+  recordScan_(commandBuffer, elementType, input, count, output, scratch, 0);
+}
+
+void GpuPrimitives::recordCompact(VkCommandBuffer commandBuffer,
+                                  PrimitiveElementType elementType,
+                                  VkDeviceAddress input, VkDeviceAddress flags,
+                                  uint32_t count, VkDeviceAddress output,
+                                  VkDeviceAddress countOutput,
+                                  VkDeviceAddress scratch) const {
+  CompactPushConstant pushConstant{.input = input,
+                                   .flags = flags,
+                                   .output = output,
+                                   .countOutput = countOutput,
+                                   .count = count};
+  if (count > TILE_SIZE) {
+    // Number of flags set per tile, scanned to the output offset of the tiles
+    auto tileCounts =
+        recordUpsweep_(commandBuffer, GpuPrimitivePipeline::REDUCE_ADD_U32,
+                       flags, count, scratch, FLAG_NORMALIZE);
+    recordTileOffsets_(commandBuffer, GpuPrimitivePipeline::SCAN_U32,
+                       tileCounts);
+    pushConstant.tileOffsets = tileCounts.front().first;
+    pushConstant.options = FLAG_TILE_OFFSETS;
+  }
+  // One workgroup at least, it writes the count
+  recordDispatch_(commandBuffer,
+                  getPipeline(GpuPrimitivePipeline::COMPACT_U32, elementType),
+                  GpuPrimitiveLayout::COMPACT, &pushConstant,
+                  sizeof(pushConstant), &pushConstant.baseTile,
+                  std::max(getTileCount(count), 1u));
+}
+
+void GpuPrimitives::recordScan_(VkCommandBuffer commandBuffer,
+                                PrimitiveElementType elementType,
+                                VkDeviceAddress input, uint32_t count,
+                                VkDeviceAddress output,
+                                VkDeviceAddress scratch,
+                                uint32_t flags) const {
+  if (count == 0) {
+    return;
+  }
+  auto reducePipeline = getReducePipeline(ReduceOperation::ADD, elementType);
+  auto scanPipeline = getPipeline(GpuPrimitivePipeline::SCAN_U32, elementType);
+  auto tileSums =
+      recordUpsweep_(commandBuffer, reducePipeline, input, count, scratch, 0);
+  recordTileOffsets_(commandBuffer, scanPipeline, tileSums);
+  ScanPushConstant pushConstant{.input = input,
+                                .output = output,
+                                .count = count,
+                                .flags = flags};
+  if (!tileSums.empty()) {
+    pushConstant.tileOffsets = tileSums.front().first;
+    pushConstant.flags |= FLAG_TILE_OFFSETS;
+  }
+  recordDispatch_(commandBuffer, scanPipeline, GpuPrimitiveLayout::SCAN,
+                  &pushConstant, sizeof(pushConstant), &pushConstant.baseTile,
+                  getTileCount(count));
+}
+
+std::vector<std::pair<VkDeviceAddress, uint32_t>>
+GpuPrimitives::recordUpsweep_(VkCommandBuffer commandBuffer,
+                              GpuPrimitivePipeline pipeline,
+                              VkDeviceAddress input, uint32_t count,
+                              VkDeviceAddress scratch, uint32_t flags) const {
+  std::vector<std::pair<VkDeviceAddress, uint32_t>> levels{};
+  VkDeviceAddress levelAddress = scratch;
+  while (count > TILE_SIZE) {
+    uint32_t tileCount = getTileCount(count);
+    ScanPushConstant pushConstant{.input = input,
+                                  .output = levelAddress,
+                                  .count = count,
+                                  .flags = flags};
+    recordDispatch_(commandBuffer, pipeline, GpuPrimitiveLayout::SCAN,
+                    &pushConstant, sizeof(pushConstant),
+                    &pushConstant.baseTile, tileCount);
+    cmdKernelBarrier(commandBuffer);
+    levels.push_back({levelAddress, tileCount});
+    input = levelAddress;
+    count = tileCount;
+    levelAddress += static_cast<VkDeviceAddress>(tileCount) * ELEMENT_SIZE;
+    // Only the first level reads the flags
+    flags &= ~FLAG_NORMALIZE;
+  }
+  return levels;
+}
+
+void GpuPrimitives::recordTileOffsets_(
+    VkCommandBuffer commandBuffer, GpuPrimitivePipeline scanPipeline,
+    const std::vector<std::pair<VkDeviceAddress, uint32_t>> &levels) const {
+  // The top level is a single tile, every level below starts its tiles from
+  // the scanned level above
+  for (auto level = levels.rbegin(); level != levels.rend(); ++level) {
+    ScanPushConstant pushConstant{.input = level->first,
+                                  .output = level->first,
+                                  .count = level->second};
+    if (level != levels.rbegin()) {
+      pushConstant.tileOffsets = std::prev(level)->first;
+      pushConstant.flags = FLAG_TILE_OFFSETS;
+    }
+    recordDispatch_(commandBuffer, scanPipeline, GpuPrimitiveLayout::SCAN,
+                    &pushConstant, sizeof(pushConstant),
+                    &pushConstant.baseTile, getTileCount(level->second));
+    cmdKernelBarrier(commandBuffer);
+  }
+}
+
+void GpuPrimitives::recordDispatch_(VkCommandBuffer commandBuffer,
+                                    GpuPrimitivePipeline pipeline,
+                                    GpuPrimitiveLayout layout,
+                                    void *pushConstant,
+                                    uint32_t pushConstantSize,
+                                    uint32_t *baseTile,
+                                    uint32_t tileCount) const {
+  // One workgroup per tile
+  cmdKernelDispatch(
+      commandBuffer,
+      KernelDispatch{
+          .pipeline = pipelines_.getPipeline(pipeline),
+          .layout = layout == GpuPrimitiveLayout::SCAN ? scanLayout_
+                                                       : compactLayout_,
+          .pushConstant = pushConstant,
+          .pushConstantSize = pushConstantSize,
+          .baseGroupX = baseTile,
+          .extent = {.x = static_cast<uint64_t>(tileCount) * WORKGROUP_SIZE},
+          .workgroupSize = {WORKGROUP_SIZE, 1, 1}},
+      limits_);
+}
+
+void GpuPrimitives::runHost_(PrimitiveElementType elementType,
+                             HostOperation_ operation,
+                             ReduceOperation reduceOperation,
+                             const void *values, const uint32_t *flags,
+                             uint32_t count, void *result,
+                             uint32_t *keptCount) {
+  VINKAN_TRACE_SCOPE("GpuPrimitives::run");
+  std::lock_guard<std::mutex> lock(hostMutex_);
+  VkDeviceSize valuesSize = static_cast<VkDeviceSize>(count) * ELEMENT_SIZE;
+  // The reduce result and the compaction count are a single element
+  VkDeviceSize outputSize =
+      operation == HostOperation_::REDUCE ? ELEMENT_SIZE : valuesSize;
+
+  Buffer &input = hostRunner_.getHostBuffer(HOST_INPUT, valuesSize);
+  Buffer &output =
+      hostRunner_.getHostBuffer(HOST_OUTPUT, outputSize + ELEMENT_SIZE);
+  Buffer &scratch = hostRunner_.getDeviceBuffer(0, getScratchSize(count));
+  std::memcpy(input.getMappedMemory(), values, valuesSize);
+  VkDeviceAddress flagsAddress = 0;
+  if (operation == HostOperation_::COMPACT) {
+    Buffer &flagsBuffer = hostRunner_.getHostBuffer(HOST_FLAGS, valuesSize);
+    std::memcpy(flagsBuffer.getMappedMemory(), flags, valuesSize);
+    flagsAddress = flagsBuffer.getDeviceAddress();
+  }
+
+  VkDeviceAddress inputAddress = input.getDeviceAddress();
+  VkDeviceAddress outputAddress = output.getDeviceAddress();
+  VkDeviceAddress scratchAddress = scratch.getDeviceAddress();
+  // The count of the compaction is after the compacted elements
+  VkDeviceAddress countAddress = outputAddress + valuesSize;
+  hostRunner_.run([&](VkCommandBuffer commandBuffer) {
+    switch (operation) {
+      case HostOperation_::REDUCE:
+        recordReduce(commandBuffer, elementType, reduceOperation,
+                     inputAddress, count, outputAddress, scratchAddress);
+        break;
+      case HostOperation_::INCLUSIVE_SCAN:
+        recordInclusiveScan(commandBuffer, elementType, inputAddress, count,
+                            outputAddress, scratchAddress);
+        break;
+      case HostOperation_::EXCLUSIVE_SCAN:
+        recordExclusiveScan(commandBuffer, elementType, inputAddress, count,
+                            outputAddress, scratchAddress);
+        break;
+      case HostOperation_::COMPACT:
+        recordCompact(commandBuffer, elementType, inputAddress, flagsAddress,
+                      count, outputAddress, countAddress, scratchAddress);
+        break;
+    }
+  });
+
+  auto outputMemory = static_cast<const char *>(output.getMappedMemory());
+  if (operation == HostOperation_::COMPACT) {
+    std::memcpy(keptCount, outputMemory + valuesSize, ELEMENT_SIZE);
+    std::memcpy(result, outputMemory,
+                static_cast<VkDeviceSize>(*keptCount) * ELEMENT_SIZE);
+  } else {
+    std::memcpy(result, outputMemory, outputSize);
+  }
+}
+
+}  // namespace vinkan
@@ -0,0 +1,203 @@
+#ifndef VINKAN_GPU_PRIMITIVES_HPP
+#define VINKAN_GPU_PRIMITIVES_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "vinkan/kernels/kernel_host_runner.hpp"
+#include "vinkan/kernels/kernel_library_info.hpp"
+#include "vinkan/pipelines/pipelines.hpp"
+#include "vinkan/wrappers/buffer.hpp"
+#include "vinkan/wrappers/physical_device.hpp"
+
+namespace vinkan {
+
+enum class PrimitiveElementType { U32, I32, F32 };
+
+template <typename T>
+concept PrimitiveElement = std::same_as<T, uint32_t> ||
+                           std::same_as<T, int32_t> || std::same_as<T, float>;
+
+template <PrimitiveElement T>
+constexpr PrimitiveElementType getPrimitiveElementType() {
+  if constexpr (std::same_as<T, uint32_t>) {
+    return PrimitiveElementType::U32;
+  } else if constexpr (std::same_as<T, int32_t>) {
+    return PrimitiveElementType::I32;
+  } else {
+    return PrimitiveElementType::F32;
+  }
+}
+
+enum class ReduceOperation { ADD, MIN, MAX };
+
+// Ordered by kernel then element type
+enum class GpuPrimitivePipeline {
+  REDUCE_ADD_U32,
+  REDUCE_ADD_I32,
+  REDUCE_ADD_F32,
+  REDUCE_MIN_U32,
+  REDUCE_MIN_I32,
+  REDUCE_MIN_F32,
+  REDUCE_MAX_U32,
+  REDUCE_MAX_I32,
+  REDUCE_MAX_F32,
+  SCAN_U32,
+  SCAN_I32,
+  SCAN_F32,
+  COMPACT_U32,
+  COMPACT_I32,
+  COMPACT_F32,
+};
+enum class GpuPrimitiveLayout { SCAN, COMPACT };
+
+// Reduce, scan and stream compaction of 32 bits elements.
+//
+// The scans are multi-level: the tiles are reduced to their sums, the sums
+// are scanned the same way, then every tile is scanned again starting from
+// its scanned sum. Within a tile, the invocations scan their elements
+// serially and combine them with subgroup operations, so the device needs the
+// subgroup arithmetic operations in compute shaders. The subgroups are indexed
+// by local index, the pipelines require full subgroups and the device needs
+// Device::Builder::enableFullComputeSubgroups.
+class GpuPrimitives {
+ public:
+  // Must match the kernels
+  static constexpr uint32_t WORKGROUP_SIZE = 256;
+  static constexpr uint32_t ITEMS_PER_THREAD = 4;
+  static constexpr uint32_t TILE_SIZE = WORKGROUP_SIZE * ITEMS_PER_THREAD;
+  // Of the kernels running workgroup scans, also used by GpuRadixSort
+  static constexpr VkPipelineShaderStageCreateFlags KERNEL_STAGE_FLAGS =
+      VK_PIPELINE_SHADER_STAGE_CREATE_REQUIRE_FULL_SUBGROUPS_BIT;
+
+  GpuPrimitives(VkDevice device, PhysicalDevice &physicalDevice,
+                const KernelLibraryInfo &info,
+                const VkAllocationCallbacks *allocator = nullptr);
+
+  GpuPrimitives(const GpuPrimitives &) = delete;
+  GpuPrimitives &operator=(const GpuPrimitives &) = delete;
+
+  // Record API. The inputs must be visible to compute shaders before the
+  // recorded commands and the outputs are written by compute shaders. The
+  // scratch buffer holds the intermediate sums, getScratchSize bytes that
+  // aren't used by another command at the same time. Every element is 32
+  // bits.
+  //
+  // Recording is thread safe.
+  static VkDeviceSize getScratchSize(uint32_t count);
+  // Writes the result as a single element
+  void recordReduce(VkCommandBuffer commandBuffer,
+                    PrimitiveElementType elementType,
+                    ReduceOperation operation, VkDeviceAddress input,
+                    uint32_t count, VkDeviceAddress output,
+                    VkDeviceAddress scratch) const;
+  // The input and output can be the same
+  void recordInclusiveScan(VkCommandBuffer commandBuffer,
+                           PrimitiveElementType elementType,
+                           VkDeviceAddress input, uint32_t count,
+                           VkDeviceAddress output,
+                           VkDeviceAddress scratch) const;
+  void recordExclusiveScan(VkCommandBuffer commandBuffer,
+                           PrimitiveElementType elementType,
+                           VkDeviceAddress input, uint32_t count,
+                           VkDeviceAddress output,
+                           VkDeviceAddress scratch) const;
+  // Keeps the elements whose 32 bits flag isn't zero, in order, and writes
+  // their number to countOutput
+  void recordCompact(VkCommandBuffer commandBuffer,
+                     PrimitiveElementType elementType, VkDeviceAddress input,
+                     VkDeviceAddress flags, uint32_t count,
+                     VkDeviceAddress output, VkDeviceAddress countOutput,
+                     VkDeviceAddress scratch) const;
+
+  // Host API, each call copies the values to host visible buffers, runs the
+  // kernels on the queue and waits for them. Calls are serialized.
+  template <PrimitiveElement T>
+  T reduce(std::span<const T> values,
+           ReduceOperation operation = ReduceOperation::ADD) {
+    assert(values.size() <= UINT32_MAX);
+    T result{};
+    runHost_(getPrimitiveElementType<T>(), HostOperation_::REDUCE, operation,
+             values.data(), nullptr, static_cast<uint32_t>(values.size()),
+             &result, nullptr);
+    return result;
+  }
+  template <PrimitiveElement T>
+  std::vector<T> inclusiveScan(std::span<const T> values) {
+    assert(values.size() <= UINT32_MAX);
+    std::vector<T> result(values.size());
+    runHost_(getPrimitiveElementType<T>(), HostOperation_::INCLUSIVE_SCAN,
+             ReduceOperation::ADD, values.data(), nullptr,
+             static_cast<uint32_t>(values.size()), result.data(), nullptr);
+    return result;
+  }
+  template <PrimitiveElement T>
+  std::vector<T> exclusiveScan(std::span<const T> values) {
+    assert(values.size() <= UINT32_MAX);
+    std::vector<T> result(values.size());
+    runHost_(getPrimitiveElementType<T>(), HostOperation_::EXCLUSIVE_SCAN,
+             ReduceOperation::ADD, values.data(), nullptr,
+             static_cast<uint32_t>(values.size()), result.data(), nullptr);
+    return result;
+  }
+  template <PrimitiveElement T>
+  std::vector<T> compact(std::span<const T> values,
+                         std::span<const uint32_t> flags) {
+    assert(values.size() == flags.size() && values.size() <= UINT32_MAX);
+    std::vector<T> result(values.size());
+    uint32_t keptCount = 0;
+    runHost_(getPrimitiveElementType<T>(), HostOperation_::COMPACT,
+             ReduceOperation::ADD, values.data(), flags.data(),
+             static_cast<uint32_t>(values.size()), result.data(), &keptCount);
+    result.resize(keptCount);
+    return result;
+  }
+
+ private:
+  enum class HostOperation_ { REDUCE, INCLUSIVE_SCAN, EXCLUSIVE_SCAN, COMPACT };
+
+  VkPhysicalDeviceLimits limits_;
+  Pipelines<GpuPrimitivePipeline, GpuPrimitiveLayout> pipelines_;
+  VkPipelineLayout scanLayout_ = VK_NULL_HANDLE;
+  VkPipelineLayout compactLayout_ = VK_NULL_HANDLE;
+
+  // Host API
+  std::mutex hostMutex_;
+  KernelHostRunner hostRunner_;
+
+  void recordScan_(VkCommandBuffer commandBuffer,
+                   PrimitiveElementType elementType, VkDeviceAddress input,
+                   uint32_t count, VkDeviceAddress output,
+                   VkDeviceAddress scratch, uint32_t flags) const;
+  // Exclusive scan of the tile sums in place, from the top level down
+  void recordTileOffsets_(
+      VkCommandBuffer commandBuffer, GpuPrimitivePipeline scanPipeline,
+      const std::vector<std::pair<VkDeviceAddress, uint32_t>> &levels) const;
+  // Reduces the input tiles level by level down to a single tile, returns
+  // the address and element count of each level of tile sums
+  std::vector<std::pair<VkDeviceAddress, uint32_t>> recordUpsweep_(
+      VkCommandBuffer commandBuffer, GpuPrimitivePipeline pipeline,
+      VkDeviceAddress input, uint32_t count, VkDeviceAddress scratch,
+      uint32_t flags) const;
+  void recordDispatch_(VkCommandBuffer commandBuffer,
+                       GpuPrimitivePipeline pipeline, GpuPrimitiveLayout layout,
+                       void *pushConstant, uint32_t pushConstantSize,
+                       uint32_t *baseTile, uint32_t tileCount) const;
+
+  void runHost_(PrimitiveElementType elementType, HostOperation_ operation,
+                ReduceOperation reduceOperation, const void *values,
+                const uint32_t *flags, uint32_t count, void *result,
+                uint32_t *keptCount);
+};
+
+}  // namespace vinkan
+
+#endif
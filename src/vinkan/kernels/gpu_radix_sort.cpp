@@ -0,0 +1,431 @@
+#include "gpu_radix_sort.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "vinkan/kernels/kernel_commands.hpp"
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/logging/tracer.hpp"
+
+namespace vinkan {
+
+namespace {
+
+// Must match the push constants of the kernels
+constexpr uint32_t KEY_TRANSFORM_NONE = 0;
+constexpr uint32_t KEY_TRANSFORM_SIGNED = 1;
+constexpr uint32_t KEY_TRANSFORM_FLOAT = 2;
+
+struct HistogramPushConstant {
+  VkDeviceAddress keys;
+  VkDeviceAddress histograms;
+  uint32_t count;
+  uint32_t baseTile;
+  uint32_t tileCount;
+  uint32_t shift;
+  uint32_t keyTransform;
+};
+static_assert(sizeof(HistogramPushConstant) == 40);
+
+struct ScatterPushConstant {
+  VkDeviceAddress keysIn;
+  VkDeviceAddress keysOut;
+  VkDeviceAddress valuesIn;
+  VkDeviceAddress valuesOut;
+  VkDeviceAddress offsets;
+  uint32_t count;
+  uint32_t baseTile;
+  uint32_t tileCount;
+  uint32_t shift;
+  uint32_t keyTransform;
+  uint32_t hasValues;
+};
+static_assert(sizeof(ScatterPushConstant) == 64);
+
+struct SegmentsPushConstant {
+  VkDeviceAddress keys;
+  VkDeviceAddress segmentKeys;
+  VkDeviceAddress segmentOffsets;
+  uint32_t count;
+  uint32_t baseTile;
+  uint32_t segmentCount;
+  uint32_t keyTransform;
+};
+static_assert(sizeof(SegmentsPushConstant) == 40);
+
+constexpr VkDeviceSize VALUE_SIZE = sizeof(uint32_t);
+// Keeps the 64 bits keys of every scratch region aligned
+constexpr VkDeviceSize SCRATCH_ALIGNMENT = 256;
+
+uint32_t getTileCount(uint32_t count) {
+  return (count + GpuPrimitives::TILE_SIZE - 1) / GpuPrimitives::TILE_SIZE;
+}
+
+bool isKey64(SortKeyType keyType) {
+  return keyType == SortKeyType::U64 || keyType == SortKeyType::I64 ||
+         keyType == SortKeyType::F64;
+}
+
+uint32_t getKeyTransform(SortKeyType keyType) {
+  switch (keyType) {
+    case SortKeyType::I32:
+    case SortKeyType::I64:
+      return KEY_TRANSFORM_SIGNED;
+    case SortKeyType::F32:
+    case SortKeyType::F64:
+      return KEY_TRANSFORM_FLOAT;
+    default:
+      return KEY_TRANSFORM_NONE;
+  }
+}
+
+// Offsets of the regions in the scratch buffer
+struct ScratchLayout {
+  VkDeviceSize segmentKeys = 0;
+  VkDeviceSize alternateKeys = 0;
+  VkDeviceSize alternateValues = 0;
+  VkDeviceSize histograms = 0;
+  VkDeviceSize scanScratch = 0;
+  VkDeviceSize size = 0;
+};
+
+// Segmented sorts sort 64 bits keys from the scratch buffer
+ScratchLayout getScratchLayout(bool keys64, uint32_t count, bool withValues,
+                               bool segmented) {
+  ScratchLayout layout{};
+  auto take = [&](VkDeviceSize size) {
+    VkDeviceSize offset = layout.size;
+    layout.size = (offset + size + SCRATCH_ALIGNMENT - 1) /
+                  SCRATCH_ALIGNMENT * SCRATCH_ALIGNMENT;
+    return offset;
+  };
+  VkDeviceSize keySize = keys64 || segmented ? sizeof(uint64_t)
+                                             : sizeof(uint32_t);
+  if (segmented) {
+    layout.segmentKeys = take(count * keySize);
+  }
+  layout.alternateKeys = take(count * keySize);
+  if (withValues) {
+    layout.alternateValues = take(count * VALUE_SIZE);
+  }
+  uint32_t histogramCount = getTileCount(count) * GpuRadixSort::RADIX;
+  layout.histograms = take(histogramCount * VALUE_SIZE);
+  layout.scanScratch = take(GpuPrimitives::getScratchSize(histogramCount));
+  return layout;
+}
+
+// Host buffer slots of the host API
+constexpr uint32_t HOST_KEYS = 0;
+constexpr uint32_t HOST_VALUES = 1;
+constexpr uint32_t HOST_SEGMENT_OFFSETS = 2;
+
+}  // namespace
+
+GpuRadixSort::GpuRadixSort(VkDevice device, PhysicalDevice &physicalDevice,
+                           const GpuPrimitives &primitives,
+                           const KernelLibraryInfo &info,
+                           const VkAllocationCallbacks *allocator)
+    : primitives_(primitives),
+      limits_(physicalDevice.getLimits()),
+      pipelines_(device, allocator),
+      hostRunner_(device, physicalDevice.getMemoryProperties(), info.queue,
+                  info.queueFamilyIndex, allocator) {
+  VINKAN_TRACE_SCOPE("GpuRadixSort::GpuRadixSort");
+  if (info.kernelsDirectory.empty()) {
+    throw std::runtime_error(
+        "No radix sort kernels, Vinkan must be built with "
+        "VINKAN_WITH_KERNELS");
+  }
+
+  pipelines_.createLayout<HistogramPushConstant>(
+      GpuRadixSortLayout::HISTOGRAM, {}, VK_SHADER_STAGE_COMPUTE_BIT);
+  pipelines_.createLayout<ScatterPushConstant>(
+      GpuRadixSortLayout::SCATTER, {}, VK_SHADER_STAGE_COMPUTE_BIT);
+  pipelines_.createLayout<SegmentsPushConstant>(
+      GpuRadixSortLayout::SEGMENTS, {}, VK_SHADER_STAGE_COMPUTE_BIT);
+  pipelines_.setJobSystem(info.jobSystem);
+
+  using PipelineInfo = ComputePipelineInfo<GpuRadixSortLayout, ShaderFileInfo>;
+  auto pipelineInfo = [&](GpuRadixSortLayout layout, const char *kernel) {
+    return PipelineInfo{
+        .layoutIdentifier = layout,
+        .shaderInfo = ShaderFileInfo{
+            .shaderFilepath = info.kernelsDirectory + "/" + kernel + ".spv",
+            .shaderStage = VK_SHADER_STAGE_COMPUTE_BIT},
+        // The scatter runs workgroup scans
+        .shaderStageFlags = GpuPrimitives::KERNEL_STAGE_FLAGS};
+  };
+  std::vector<std::pair<GpuRadixSortPipeline, PipelineInfo>> pipelineInfos{
+      {GpuRadixSortPipeline::HISTOGRAM_32,
+       pipelineInfo(GpuRadixSortLayout::HISTOGRAM, "radix_histogram_k32")},
+      {GpuRadixSortPipeline::HISTOGRAM_64,
+       pipelineInfo(GpuRadixSortLayout::HISTOGRAM, "radix_histogram_k64")},
+      {GpuRadixSortPipeline::SCATTER_32,
+       pipelineInfo(GpuRadixSortLayout::SCATTER, "radix_scatter_k32")},
+      {GpuRadixSortPipeline::SCATTER_64,
+       pipelineInfo(GpuRadixSortLayout::SCATTER, "radix_scatter_k64")},
+      {GpuRadixSortPipeline::PACK_SEGMENTS,
+       pipelineInfo(GpuRadixSortLayout::SEGMENTS, "radix_segments_pack")},
+      {GpuRadixSortPipeline::UNPACK_SEGMENTS,
+       pipelineInfo(GpuRadixSortLayout::SEGMENTS, "radix_segments_unpack")},
+  };
+  pipelines_.createComputePipelines(pipelineInfos);
+  for (const auto &[pipeline, pipelineInfo] : pipelineInfos) {
+    if (pipelines_.getWorkgroupSize(pipeline) !=
+        WorkgroupSize{GpuPrimitives::WORKGROUP_SIZE, 1, 1}) {
+      throw std::runtime_error("Radix sort kernel " +
+                               pipelineInfo.shaderInfo.shaderFilepath +
+                               " has an unexpected workgroup size");
+    }
+  }
+  histogramLayout_ = pipelines_.get(GpuRadixSortLayout::HISTOGRAM);
+  scatterLayout_ = pipelines_.get(GpuRadixSortLayout::SCATTER);
+  segmentsLayout_ = pipelines_.get(GpuRadixSortLayout::SEGMENTS);
+  SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "GPU radix sort created");
+}
+
+VkDeviceSize GpuRadixSort::getScratchSize(SortKeyType keyType, uint32_t count,
+                                          bool withValues) {
+  return getScratchLayout(isKey64(keyType), count, withValues, false).size;
+}
+
+VkDeviceSize GpuRadixSort::getSegmentedScratchSize(uint32_t count,
+                                                   bool withValues) {
+  return getScratchLayout(false, count, withValues, true).size;
+}
+
+BufferInfo GpuRadixSort::getScratchBufferInfo(VkDeviceSize scratchSize) {
+  return BufferInfo{
+      .instanceSize = std::max<VkDeviceSize>(scratchSize, VALUE_SIZE),
+      .instanceCount = 1,
+      .usageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                    VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+      .sharingMode = {.value = VK_SHARING_MODE_EXCLUSIVE},
+      .memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT};
+}
+
+void GpuRadixSort::recordSort(VkCommandBuffer commandBuffer,
+                              SortKeyType keyType, Buffer &keys,
+                              Buffer *values, uint32_t count,
+                              Buffer &scratch) const {
+  VkDeviceSize keySize =
+      isKey64(keyType) ? sizeof(uint64_t) : sizeof(uint32_t);
+  assert(keys.getBufferSize() >= count * keySize);
+  assert(!values || values->getBufferSize() >= count * VALUE_SIZE);
+  assert(scratch.getBufferSize() >=
+         getScratchSize(keyType, count, values != nullptr));
+  recordSort_(commandBuffer, keyType, keys.getDeviceAddress(),
+              values ? values->getDeviceAddress() : 0, count,
+              scratch.getDeviceAddress());
+}
+
+void GpuRadixSort::recordSegmentedSort(VkCommandBuffer commandBuffer,
+                                       SortKeyType keyType, Buffer &keys,
+                                       Buffer *values, uint32_t count,
+                                       Buffer &segmentOffsets,
+                                       uint32_t segmentCount,
+                                       Buffer &scratch) const {
+  assert(!isKey64(keyType) && segmentCount > 0);
+  assert(keys.getBufferSize() >= count * sizeof(uint32_t));
+  assert(!values || values->getBufferSize() >= count * VALUE_SIZE);
+  assert(segmentOffsets.getBufferSize() >= segmentCount * sizeof(uint32_t));
+  assert(scratch.getBufferSize() >=
+         getSegmentedScratchSize(count, values != nullptr));
+  recordSegmentedSort_(commandBuffer, keyType, keys.getDeviceAddress(),
+                       values ? values->getDeviceAddress() : 0, count,
+                       segmentOffsets.getDeviceAddress(), segmentCount,
+                       scratch.getDeviceAddress());
+}
+
+void GpuRadixSort::recordSort_(VkCommandBuffer commandBuffer,
+                               SortKeyType keyType, VkDeviceAddress keys,
+                               VkDeviceAddress values, uint32_t count,
+                               VkDeviceAddress scratch) const {
+  if (count <= 1) {
+    return;
+  }
+  bool keys64 = isKey64(keyType);
+  auto layout = getScratchLayout(keys64, count, values != 0, false);
+  // 4 or 8 passes, even
+  uint32_t passCount = (keys64 ? 64 : 32) / RADIX_BITS;
+  recordPasses_(commandBuffer, keys64, getKeyTransform(keyType), passCount,
+                keys, scratch + layout.alternateKeys, values,
+                values ? scratch + layout.alternateValues : 0, count,
+                scratch + layout.histograms, scratch + layout.scanScratch);
+}
+
+void GpuRadixSort::recordSegmentedSort_(
+    VkCommandBuffer commandBuffer, SortKeyType keyType, VkDeviceAddress keys,
+    VkDeviceAddress values, uint32_t count, VkDeviceAddress segmentOffsets,
+    uint32_t segmentCount, VkDeviceAddress scratch) const {
+  if (count <= 1) {
+    return;
+  }
+  auto layout = getScratchLayout(false, count, values != 0, true);
+  SegmentsPushConstant pushConstant{
+      .keys = keys,
+      .segmentKeys = scratch + layout.segmentKeys,
+      .segmentOffsets = segmentOffsets,
+      .count = count,
+      .segmentCount = segmentCount,
+      .keyTransform = getKeyTransform(keyType)};
+  recordDispatch_(commandBuffer, GpuRadixSortPipeline::PACK_SEGMENTS,
+                  GpuRadixSortLayout::SEGMENTS, &pushConstant,
+                  sizeof(pushConstant), &pushConstant.baseTile,
+                  getTileCount(count));
+  cmdKernelBarrier(commandBuffer);
+
+  // The key passes, then only the digits the segment indices use. An extra
+  // pass on a zero digit keeps the count even.
+  uint32_t segmentBits = std::bit_width(segmentCount - 1);
+  uint32_t passCount =
+      32 / RADIX_BITS + (segmentBits + RADIX_BITS - 1) / RADIX_BITS;
+  passCount += passCount % 2;
+  recordPasses_(commandBuffer, true, KEY_TRANSFORM_NONE, passCount,
+                scratch + layout.segmentKeys, scratch + layout.alternateKeys,
+                values, values ? scratch + layout.alternateValues : 0, count,
+                scratch + layout.histograms, scratch + layout.scanScratch);
+
+  recordDispatch_(commandBuffer, GpuRadixSortPipeline::UNPACK_SEGMENTS,
+                  GpuRadixSortLayout::SEGMENTS, &pushConstant,
+                  sizeof(pushConstant), &pushConstant.baseTile,
+                  getTileCount(count));
+}
+
+void GpuRadixSort::recordPasses_(
+    VkCommandBuffer commandBuffer, bool keys64, uint32_t keyTransform,
+    uint32_t passCount, VkDeviceAddress keys, VkDeviceAddress alternateKeys,
+    VkDeviceAddress values, VkDeviceAddress alternateValues, uint32_t count,
+    VkDeviceAddress histograms, VkDeviceAddress scanScratch) const {
+  assert(passCount % 2 == 0);
+  uint32_t tileCount = getTileCount(count);
+  auto histogramPipeline = keys64 ? GpuRadixSortPipeline::HISTOGRAM_64
+                                  : GpuRadixSortPipeline::HISTOGRAM_32;
+  auto scatterPipeline = keys64 ? GpuRadixSortPipeline::SCATTER_64
+                                : GpuRadixSortPipeline::SCATTER_32;
+  for (uint32_t pass = 0; pass < passCount; ++pass) {
+    uint32_t shift = pass * RADIX_BITS;
+    HistogramPushConstant histogramPushConstant{.keys = keys,
+                                                .histograms = histograms,
+                                                .count = count,
+                                                .tileCount = tileCount,
+                                                .shift = shift,
+                                                .keyTransform = keyTransform};
+    recordDispatch_(commandBuffer, histogramPipeline,
+                    GpuRadixSortLayout::HISTOGRAM, &histogramPushConstant,
+                    sizeof(histogramPushConstant),
+                    &histogramPushConstant.baseTile, tileCount);
+    cmdKernelBarrier(commandBuffer);
+    // Offset of each digit of each tile, in place
+    primitives_.recordExclusiveScan(commandBuffer, PrimitiveElementType::U32,
+                                    histograms, tileCount * RADIX, histograms,
+                                    scanScratch);
+    cmdKernelBarrier(commandBuffer);
+
+    ScatterPushConstant scatterPushConstant{
+        .keysIn = keys,
+        .keysOut = alternateKeys,
+        .valuesIn = values,
+        .valuesOut = alternateValues,
+        .offsets = histograms,
+        .count = count,
+        .tileCount = tileCount,
+        .shift = shift,
+        .keyTransform = keyTransform,
+        .hasValues = values != 0};
+    recordDispatch_(commandBuffer, scatterPipeline,
+                    GpuRadixSortLayout::SCATTER, &scatterPushConstant,
+                    sizeof(scatterPushConstant), &scatterPushConstant.baseTile,
+                    tileCount);
+    cmdKernelBarrier(commandBuffer);
+    std::swap(keys, alternateKeys);
+    std::swap(values, alternateValues);
+  }
+}
+
+void GpuRadixSort::recordDispatch_(VkCommandBuffer commandBuffer,
+                                   GpuRadixSortPipeline pipeline,
+                                   GpuRadixSortLayout layout,
+                                   void *pushConstant,
+                                   uint32_t pushConstantSize,
+                                   uint32_t *baseTile,
+                                   uint32_t tileCount) const {
+  VkPipelineLayout pipelineLayout = segmentsLayout_;
+  if (layout == GpuRadixSortLayout::HISTOGRAM) {
+    pipelineLayout = histogramLayout_;
+  } else if (layout == GpuRadixSortLayout::SCATTER) {
+    pipelineLayout = scatterLayout_;
+  }
+  // One workgroup per tile
+  constexpr uint32_t workgroupSize = GpuPrimitives::WORKGROUP_SIZE;
+  cmdKernelDispatch(
+      commandBuffer,
+      KernelDispatch{
+          .pipeline = pipelines_.getPipeline(pipeline),
+          .layout = pipelineLayout,
+          .pushConstant = pushConstant,
+          .pushConstantSize = pushConstantSize,
+          .baseGroupX = baseTile,
+          .extent = {.x = static_cast<uint64_t>(tileCount) * workgroupSize},
+          .workgroupSize = {workgroupSize, 1, 1}},
+      limits_);
+}
+
+void GpuRadixSort::runHost_(SortKeyType keyType, void *keys, uint32_t *values,
+                            uint32_t count,
+                            std::span<const uint32_t> segmentOffsets) {
+  VINKAN_TRACE_SCOPE("GpuRadixSort::run");
+  std::lock_guard<std::mutex> lock(hostMutex_);
+  bool segmented = !segmentOffsets.empty();
+  VkDeviceSize keysSize =
+      count * (isKey64(keyType) ? sizeof(uint64_t) : sizeof(uint32_t));
+  VkDeviceSize valuesSize = count * VALUE_SIZE;
+
+  Buffer &hostKeys = hostRunner_.getHostBuffer(HOST_KEYS, keysSize);
+  std::memcpy(hostKeys.getMappedMemory(), keys, keysSize);
+  VkDeviceAddress valuesAddress = 0;
+  if (values) {
+    Buffer &hostValues = hostRunner_.getHostBuffer(HOST_VALUES, valuesSize);
+    std::memcpy(hostValues.getMappedMemory(), values, valuesSize);
+    valuesAddress = hostValues.getDeviceAddress();
+  }
+  VkDeviceAddress segmentOffsetsAddress = 0;
+  if (segmented) {
+    VkDeviceSize offsetsSize = segmentOffsets.size_bytes();
+    Buffer &hostOffsets =
+        hostRunner_.getHostBuffer(HOST_SEGMENT_OFFSETS, offsetsSize);
+    std::memcpy(hostOffsets.getMappedMemory(), segmentOffsets.data(),
+                offsetsSize);
+    segmentOffsetsAddress = hostOffsets.getDeviceAddress();
+  }
+  Buffer &scratch = hostRunner_.getDeviceBuffer(
+      0, segmented ? getSegmentedScratchSize(count, values != nullptr)
+                   : getScratchSize(keyType, count, values != nullptr));
+
+  VkDeviceAddress keysAddress = hostKeys.getDeviceAddress();
+  VkDeviceAddress scratchAddress = scratch.getDeviceAddress();
+  hostRunner_.run([&](VkCommandBuffer commandBuffer) {
+    if (segmented) {
+      recordSegmentedSort_(commandBuffer, keyType, keysAddress, valuesAddress,
+                           count, segmentOffsetsAddress,
+                           static_cast<uint32_t>(segmentOffsets.size()),
+                           scratchAddress);
+    } else {
+      recordSort_(commandBuffer, keyType, keysAddress, valuesAddress, count,
+                  scratchAddress);
+    }
+  });
+
+  std::memcpy(keys, hostKeys.getMappedMemory(), keysSize);
+  if (values) {
+    std::memcpy(values,
+                hostRunner_.getHostBuffer(HOST_VALUES, valuesSize)
+                    .getMappedMemory(),
+                valuesSize);
+  }
+}
+
+}  // namespace vinkan
@@ -0,0 +1,175 @@
+#ifndef VINKAN_GPU_RADIX_SORT_HPP
+#define VINKAN_GPU_RADIX_SORT_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <mutex>
+#include <span>
+
+#include "vinkan/kernels/gpu_primitives.hpp"
+#include "vinkan/kernels/kernel_host_runner.hpp"
+#include "vinkan/pipelines/pipelines.hpp"
+#include "vinkan/wrappers/buffer.hpp"
+#include "vinkan/wrappers/physical_device.hpp"
+
+namespace vinkan {
+
+enum class SortKeyType { U32, I32, F32, U64, I64, F64 };
+
+template <typename T>
+concept SortKey =
+    std::same_as<T, uint32_t> || std::same_as<T, int32_t> ||
+    std::same_as<T, float> || std::same_as<T, uint64_t> ||
+    std::same_as<T, int64_t> || std::same_as<T, double>;
+
+template <SortKey T>
+constexpr SortKeyType getSortKeyType() {
+  if constexpr (std::same_as<T, uint32_t>) {
+    return SortKeyType::U32;
+  } else if constexpr (std::same_as<T, int32_t>) {
+    return SortKeyType::I32;
+  } else if constexpr (std::same_as<T, float>) {
+    return SortKeyType::F32;
+  } else if constexpr (std::same_as<T, uint64_t>) {
+    return SortKeyType::U64;
+  } else if constexpr (std::same_as<T, int64_t>) {
+    return SortKeyType::I64;
+  } else {
+    return SortKeyType::F64;
+  }
+}
+
+enum class GpuRadixSortPipeline {
+  HISTOGRAM_32,
+  HISTOGRAM_64,
+  SCATTER_32,
+  SCATTER_64,
+  PACK_SEGMENTS,
+  UNPACK_SEGMENTS,
+};
+enum class GpuRadixSortLayout { HISTOGRAM, SCATTER, SEGMENTS };
+
+// Stable LSD radix sort of 32 and 64 bits keys, with 32 bits values, and its
+// segmented variant.
+//
+// Each pass sorts on 8 bits of the keys: the tiles count their digits, the
+// counts are scanned with the GPU primitives, then every tile sorts itself by
+// digit in shared memory and writes each digit run to its offset. The keys
+// and values go back and forth between their buffers and the scratch buffer,
+// there is an even number of passes so the result ends in place.
+//
+// Like the GPU primitives, the kernels require full subgroups.
+class GpuRadixSort {
+ public:
+  // Must match the kernels
+  static constexpr uint32_t RADIX_BITS = 8;
+  static constexpr uint32_t RADIX = 1 << RADIX_BITS;
+
+  // Usually the info of the GPU primitives, the kernels are in the same
+  // directory
+  GpuRadixSort(VkDevice device, PhysicalDevice &physicalDevice,
+               const GpuPrimitives &primitives, const KernelLibraryInfo &info,
+               const VkAllocationCallbacks *allocator = nullptr);
+
+  GpuRadixSort(const GpuRadixSort &) = delete;
+  GpuRadixSort &operator=(const GpuRadixSort &) = delete;
+
+  // Record API. The keys, values and segment offsets must be visible to
+  // compute shaders before the recorded commands and are written by compute
+  // shaders. The scratch buffer holds the other half of the passes and the
+  // digit counts, getScratchSize bytes that aren't used by another command at
+  // the same time. Every buffer needs the shader device address usage.
+  //
+  // Recording is thread safe.
+  static VkDeviceSize getScratchSize(SortKeyType keyType, uint32_t count,
+                                     bool withValues);
+  // Segmented sorts only take 32 bits keys
+  static VkDeviceSize getSegmentedScratchSize(uint32_t count, bool withValues);
+  // Device local scratch buffer of scratchSize bytes, to create through
+  // Resources for instance
+  static BufferInfo getScratchBufferInfo(VkDeviceSize scratchSize);
+
+  // Sorts the first count keys in place, values can be null or holds one
+  // 32 bits value per key that is moved along
+  void recordSort(VkCommandBuffer commandBuffer, SortKeyType keyType,
+                  Buffer &keys, Buffer *values, uint32_t count,
+                  Buffer &scratch) const;
+  // Sorts each segment independently. segmentOffsets holds the segmentCount
+  // 32 bits starts of the segments, ascending from 0, a segment ends where
+  // the next one starts and the last one at count.
+  void recordSegmentedSort(VkCommandBuffer commandBuffer, SortKeyType keyType,
+                           Buffer &keys, Buffer *values, uint32_t count,
+                           Buffer &segmentOffsets, uint32_t segmentCount,
+                           Buffer &scratch) const;
+
+  // Host API, each call copies the keys and values to host visible buffers,
+  // sorts them on the queue, waits for it and copies them back. Calls are
+  // serialized.
+  template <SortKey K>
+  void sort(std::span<K> keys) {
+    assert(keys.size() <= UINT32_MAX);
+    runHost_(getSortKeyType<K>(), keys.data(), nullptr,
+             static_cast<uint32_t>(keys.size()), {});
+  }
+  template <SortKey K>
+  void sort(std::span<K> keys, std::span<uint32_t> values) {
+    assert(keys.size() == values.size() && keys.size() <= UINT32_MAX);
+    runHost_(getSortKeyType<K>(), keys.data(), values.data(),
+             static_cast<uint32_t>(keys.size()), {});
+  }
+  template <SortKey K>
+    requires(sizeof(K) == sizeof(uint32_t))
+  void segmentedSort(std::span<K> keys,
+                     std::span<const uint32_t> segmentOffsets,
+                     std::span<uint32_t> values = {}) {
+    assert(keys.size() <= UINT32_MAX && !segmentOffsets.empty());
+    assert(values.empty() || values.size() == keys.size());
+    runHost_(getSortKeyType<K>(), keys.data(),
+             values.empty() ? nullptr : values.data(),
+             static_cast<uint32_t>(keys.size()), segmentOffsets);
+  }
+
+ private:
+  const GpuPrimitives &primitives_;
+  VkPhysicalDeviceLimits limits_;
+  Pipelines<GpuRadixSortPipeline, GpuRadixSortLayout> pipelines_;
+  VkPipelineLayout histogramLayout_ = VK_NULL_HANDLE;
+  VkPipelineLayout scatterLayout_ = VK_NULL_HANDLE;
+  VkPipelineLayout segmentsLayout_ = VK_NULL_HANDLE;
+
+  // Host API
+  std::mutex hostMutex_;
+  KernelHostRunner hostRunner_;
+
+  void recordSort_(VkCommandBuffer commandBuffer, SortKeyType keyType,
+                   VkDeviceAddress keys, VkDeviceAddress values,
+                   uint32_t count, VkDeviceAddress scratch) const;
+  void recordSegmentedSort_(VkCommandBuffer commandBuffer,
+                            SortKeyType keyType, VkDeviceAddress keys,
+                            VkDeviceAddress values, uint32_t count,
+                            VkDeviceAddress segmentOffsets,
+                            uint32_t segmentCount,
+                            VkDeviceAddress scratch) const;
+  // Passes from the lowest digit, keys and values go from the primary to the
+  // alternate addresses and back
+  void recordPasses_(VkCommandBuffer commandBuffer, bool keys64,
+                     uint32_t keyTransform, uint32_t passCount,
+                     VkDeviceAddress keys, VkDeviceAddress alternateKeys,
+                     VkDeviceAddress values, VkDeviceAddress alternateValues,
+                     uint32_t count, VkDeviceAddress histograms,
+                     VkDeviceAddress scanScratch) const;
+  void recordDispatch_(VkCommandBuffer commandBuffer,
+                       GpuRadixSortPipeline pipeline, GpuRadixSortLayout layout,
+                       void *pushConstant, uint32_t pushConstantSize,
+                       uint32_t *baseTile, uint32_t tileCount) const;
+
+  void runHost_(SortKeyType keyType, void *keys, uint32_t *values,
+                uint32_t count, std::span<const uint32_t> segmentOffsets);
+};
+
+}  // namespace vinkan
+
+#endif
@@ -0,0 +1,43 @@
+#include "kernel_commands.hpp"
+
+#include "vinkan/sync/barriers.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
+
+namespace vinkan {
+
+void cmdKernelDispatch(VkCommandBuffer commandBuffer,
+                       const KernelDispatch &dispatch,
+                       const VkPhysicalDeviceLimits &limits) {
+  deviceDispatch.vkCmdBindPipeline(
+      commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, dispatch.pipeline);
+  cmdDispatchExtent(commandBuffer, dispatch.extent, dispatch.workgroupSize,
+                    limits,
+                    [&](VkCommandBuffer commandBuffer,
+                        const DispatchChunk &chunk) {
+                      *dispatch.baseGroupX = chunk.baseGroupX;
+                      if (dispatch.baseGroupY != nullptr) {
+                        *dispatch.baseGroupY = chunk.baseGroupY;
+                      }
+                      if (dispatch.baseGroupZ != nullptr) {
+                        *dispatch.baseGroupZ = chunk.baseGroupZ;
+                      }
+                      deviceDispatch.vkCmdPushConstants(
+                          commandBuffer, dispatch.layout,
+                          VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                          dispatch.pushConstantSize, dispatch.pushConstant);
+                    });
+}
+
+void cmdKernelBarrier(VkCommandBuffer commandBuffer) {
+  // The kernels can also write what the previous ones wrote, e.g. in place
+  // scans. The legacy barrier works whether or not synchronization2 is on.
+  BarrierBatch batch;
+  batch
+      .addMemoryBarrier(
+          VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT,
+          VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+          VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT)
+      .record(commandBuffer, false);
+}
+
+}  // namespace vinkan
@@ -0,0 +1,39 @@
+#ifndef VINKAN_KERNEL_COMMANDS_HPP
+#define VINKAN_KERNEL_COMMANDS_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+
+#include "vinkan/commands/dispatch_sizing.hpp"
+
+namespace vinkan {
+
+// One kernel of the kernel libraries. The push constant holds the base group
+// of the dispatch, a problem split over the device limits is dispatched
+// again with the next base group.
+struct KernelDispatch {
+  VkPipeline pipeline;
+  VkPipelineLayout layout;
+  // Pushed whole for the compute stage before each dispatch
+  void *pushConstant;
+  uint32_t pushConstantSize;
+  // Base group fields of the push constant, Y and Z are optional
+  uint32_t *baseGroupX;
+  uint32_t *baseGroupY = nullptr;
+  uint32_t *baseGroupZ = nullptr;
+  DispatchExtent extent;
+  WorkgroupSize workgroupSize;
+};
+
+// Binds the pipeline then records the dispatches of the kernel
+void cmdKernelDispatch(VkCommandBuffer commandBuffer,
+                       const KernelDispatch &dispatch,
+                       const VkPhysicalDeviceLimits &limits);
+
+// Makes the writes of a kernel visible to the next ones
+void cmdKernelBarrier(VkCommandBuffer commandBuffer);
+
+}  // namespace vinkan
+
+#endif
@@ -0,0 +1,135 @@
+#include "kernel_host_runner.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/logging/tracer.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
+
+namespace vinkan {
+
+KernelHostRunner::KernelHostRunner(
+    VkDevice device, VkPhysicalDeviceMemoryProperties memoryProperties,
+    VkQueue queue, uint32_t queueFamilyIndex,
+    const VkAllocationCallbacks *allocator)
+    : device_(device),
+      memoryProperties_(memoryProperties),
+      queue_(queue),
+      allocator_(allocator) {
+  VkCommandPoolCreateInfo poolInfo{};
+  poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  poolInfo.queueFamilyIndex = queueFamilyIndex;
+  if (vkCreateCommandPool(device_, &poolInfo, allocator_, &commandPool_) !=
+      VK_SUCCESS) {
+    throw std::runtime_error("Failed to create the kernel command pool");
+  }
+  VkCommandBufferAllocateInfo allocInfo{};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.commandPool = commandPool_;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandBufferCount = 1;
+  if (deviceDispatch.vkAllocateCommandBuffers(device_, &allocInfo,
+                                              &commandBuffer_) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to allocate a kernel command buffer");
+  }
+  VkFenceCreateInfo fenceInfo{};
+  fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  if (vkCreateFence(device_, &fenceInfo, allocator_, &fence_) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to create the kernel fence");
+  }
+}
+
+KernelHostRunner::~KernelHostRunner() {
+  vkDestroyFence(device_, fence_, allocator_);
+  vkDestroyCommandPool(device_, commandPool_, allocator_);
+}
+
+Buffer &KernelHostRunner::getHostBuffer(uint32_t slot, VkDeviceSize size) {
+  return getBuffer_(hostBuffers_[slot], size,
+                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+}
+
+Buffer &KernelHostRunner::getDeviceBuffer(uint32_t slot, VkDeviceSize size) {
+  return getBuffer_(deviceBuffers_[slot], size,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+void KernelHostRunner::run(
+    const std::function<void(VkCommandBuffer)> &record) {
+  VINKAN_TRACE_SCOPE("KernelHostRunner::run");
+  if (deviceDispatch.vkResetCommandBuffer(commandBuffer_, 0) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to reset the kernel command buffer");
+  }
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  if (deviceDispatch.vkBeginCommandBuffer(commandBuffer_, &beginInfo) !=
+      VK_SUCCESS) {
+    throw std::runtime_error("Failed to begin the kernel command buffer");
+  }
+  record(commandBuffer_);
+  VkMemoryBarrier hostReadBarrier{};
+  hostReadBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  hostReadBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  hostReadBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+  deviceDispatch.vkCmdPipelineBarrier(
+      commandBuffer_, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &hostReadBarrier, 0, nullptr, 0,
+      nullptr);
+  if (deviceDispatch.vkEndCommandBuffer(commandBuffer_) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to record the kernel command buffer");
+  }
+
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &commandBuffer_;
+  if (deviceDispatch.vkQueueSubmit(queue_, 1, &submitInfo, fence_) !=
+      VK_SUCCESS) {
+    throw std::runtime_error("Failed to submit the kernel command buffer");
+  }
+  VkResult waitResult =
+      deviceDispatch.vkWaitForFences(device_, 1, &fence_, VK_TRUE, UINT64_MAX);
+  deviceDispatch.vkResetFences(device_, 1, &fence_);
+  if (waitResult != VK_SUCCESS) {
+    throw std::runtime_error("Failed to wait for the kernel command buffer");
+  }
+}
+
+Buffer &KernelHostRunner::getBuffer_(
+    std::unique_ptr<Buffer> &buffer, VkDeviceSize size,
+    VkMemoryPropertyFlags memoryPropertyFlags) {
+  // Never empty, the addresses stay valid
+  size = std::max<VkDeviceSize>(size, sizeof(uint32_t));
+  if (buffer && buffer->getBufferSize() >= size) {
+    return *buffer;
+  }
+  // Grown to the next power of two to amortize the reallocations
+  VkDeviceSize capacity = sizeof(uint32_t);
+  while (capacity < size) {
+    capacity *= 2;
+  }
+  buffer.reset();
+  buffer = std::make_unique<Buffer>(
+      device_, memoryProperties_,
+      BufferInfo{.instanceSize = capacity,
+                 .instanceCount = 1,
+                 .usageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                               VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                 .sharingMode = {.value = VK_SHARING_MODE_EXCLUSIVE},
+                 .memoryPropertyFlags = memoryPropertyFlags},
+      allocator_);
+  if (memoryPropertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+    if (buffer->map() != VK_SUCCESS) {
+      throw std::runtime_error("Failed to map a kernel buffer");
+    }
+  }
+  SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Kernel buffer grown to {} bytes",
+                      capacity);
+  return *buffer;
+}
+
+}  // namespace vinkan
@@ -0,0 +1,57 @@
+#ifndef VINKAN_KERNEL_HOST_RUNNER_HPP
+#define VINKAN_KERNEL_HOST_RUNNER_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+
+#include "vinkan/wrappers/buffer.hpp"
+
+namespace vinkan {
+
+// Host side of the kernel libraries: buffers grown on demand and a command
+// buffer recorded, submitted and waited for on each run.
+//
+// Not thread safe, the owner serializes the runs.
+class KernelHostRunner {
+ public:
+  KernelHostRunner(VkDevice device,
+                   VkPhysicalDeviceMemoryProperties memoryProperties,
+                   VkQueue queue, uint32_t queueFamilyIndex,
+                   const VkAllocationCallbacks *allocator = nullptr);
+  ~KernelHostRunner();
+
+  KernelHostRunner(const KernelHostRunner &) = delete;
+  KernelHostRunner &operator=(const KernelHostRunner &) = delete;
+
+  // Addressable storage buffer of at least size bytes, kept for the next runs
+  // under the same slot. Host buffers are coherent and stay mapped.
+  Buffer &getHostBuffer(uint32_t slot, VkDeviceSize size);
+  Buffer &getDeviceBuffer(uint32_t slot, VkDeviceSize size);
+
+  // The host buffers can be read once it returns, a barrier makes the
+  // compute shader writes visible to the host
+  void run(const std::function<void(VkCommandBuffer)> &record);
+
+ private:
+  VkDevice device_;
+  VkPhysicalDeviceMemoryProperties memoryProperties_;
+  VkQueue queue_;
+  const VkAllocationCallbacks *allocator_;
+
+  VkCommandPool commandPool_ = VK_NULL_HANDLE;
+  VkCommandBuffer commandBuffer_ = VK_NULL_HANDLE;
+  VkFence fence_ = VK_NULL_HANDLE;
+  std::map<uint32_t, std::unique_ptr<Buffer>> hostBuffers_{};
+  std::map<uint32_t, std::unique_ptr<Buffer>> deviceBuffers_{};
+
+  Buffer &getBuffer_(std::unique_ptr<Buffer> &buffer, VkDeviceSize size,
+                     VkMemoryPropertyFlags memoryPropertyFlags);
+};
+
+}  // namespace vinkan
+
+#endif
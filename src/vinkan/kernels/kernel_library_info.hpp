@@ -0,0 +1,36 @@
+#ifndef VINKAN_KERNEL_LIBRARY_INFO_HPP
+#define VINKAN_KERNEL_LIBRARY_INFO_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <string>
+
+#include "vinkan/jobs/job_system.hpp"
+
+// Set by CMake to the kernels compiled with VINKAN_WITH_KERNELS
+#ifndef VINKAN_KERNELS_DIR
+#define VINKAN_KERNELS_DIR ""
+#endif
+
+namespace vinkan {
+
+// Creation info of the kernel libraries (GpuPrimitives, GpuRadixSort, GpuGemm
+// and GpuImageProcessing).
+//
+// Their kernels access the buffers through their device address, the device
+// needs the bufferDeviceAddress feature and the buffers the shader device
+// address usage.
+struct KernelLibraryInfo {
+  // Used by the host API only
+  VkQueue queue;
+  uint32_t queueFamilyIndex;
+  // Directory of the compiled kernels
+  std::string kernelsDirectory = VINKAN_KERNELS_DIR;
+  // Builds the pipelines in parallel
+  JobSystem *jobSystem = nullptr;
+};
+
+}  // namespace vinkan
+
+#endif
@@ -0,0 +1,56 @@
+#include "chrome_trace.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace vinkan {
+
+namespace {
+
+std::string escape(const std::string &text) {
+  std::string escaped{};
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
+}  // namespace
+
+void writeChromeTrace(const std::string &filepath,
+                      const std::vector<ChromeTraceEvent> &events) {
+  std::ofstream file(filepath);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open " + filepath);
+  }
+  // Microseconds since boot don't fit the default precision
+  file << std::fixed << std::setprecision(3);
+  file << "{\"traceEvents\":[";
+  bool first = true;
+  for (auto &event : events) {
+    if (!first) {
+      file << ",";
+    }
+    first = false;
+    file << "\n{\"name\":\"" << escape(event.name) << "\",\"cat\":\""
+         << event.category << "\",\"ph\":\"X\",\"pid\":0,\"tid\":\""
+         << escape(event.thread) << "\",\"ts\":" << event.startUs
+         << ",\"dur\":" << event.durationUs;
+    if (!event.args.empty()) {
+      file << ",\"args\":{";
+      for (size_t i = 0; i < event.args.size(); i++) {
+        file << (i > 0 ? "," : "") << "\"" << event.args[i].first
+             << "\":" << event.args[i].second;
+      }
+      file << "}";
+    }
+    file << "}";
+  }
+  file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+}  // namespace vinkan
@@ -0,0 +1,29 @@
+#ifndef VINKAN_CHROME_TRACE_HPP
+#define VINKAN_CHROME_TRACE_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vinkan {
+
+// Complete event ("ph":"X"), the nesting is implied by the time ranges
+struct ChromeTraceEvent {
+  std::string name;
+  const char *category;
+  // Track the event is drawn on
+  std::string thread;
+  double startUs;
+  double durationUs;
+  // Shown when the event is selected
+  std::vector<std::pair<const char *, int64_t>> args{};
+};
+
+// Chrome trace event format, opened with chrome://tracing or Perfetto
+void writeChromeTrace(const std::string &filepath,
+                      const std::vector<ChromeTraceEvent> &events);
+
+}  // namespace vinkan
+
+#endif
@@ -0,0 +1,79 @@
+#include "debug_utils.hpp"
+
+#include <algorithm>
+
+#include "vinkan/logging/logger.hpp"
+
+namespace vinkan {
+
+DebugUtils::DebugUtils(VkInstance instance, VkDevice device)
+    : device_(device) {
+  // Device commands of an instance extension, so loaded from the instance
+  setObjectName_ = (PFN_vkSetDebugUtilsObjectNameEXT)vkGetInstanceProcAddr(
+      instance, "vkSetDebugUtilsObjectNameEXT");
+  cmdBeginLabel_ = (PFN_vkCmdBeginDebugUtilsLabelEXT)vkGetInstanceProcAddr(
+      instance, "vkCmdBeginDebugUtilsLabelEXT");
+  cmdEndLabel_ = (PFN_vkCmdEndDebugUtilsLabelEXT)vkGetInstanceProcAddr(
+      instance, "vkCmdEndDebugUtilsLabelEXT");
+  cmdInsertLabel_ = (PFN_vkCmdInsertDebugUtilsLabelEXT)vkGetInstanceProcAddr(
+      instance, "vkCmdInsertDebugUtilsLabelEXT");
+  if (setObjectName_ == nullptr || cmdBeginLabel_ == nullptr ||
+      cmdEndLabel_ == nullptr || cmdInsertLabel_ == nullptr) {
+    setObjectName_ = nullptr;
+    cmdBeginLabel_ = nullptr;
+    cmdEndLabel_ = nullptr;
+    cmdInsertLabel_ = nullptr;
+    SPDLOG_LOGGER_DEBUG(get_vinkan_logger(),
+                        "VK_EXT_debug_utils isn't enabled, objects won't be "
+                        "named");
+  }
+}
+
+void DebugUtils::setName(VkObjectType objectType, uint64_t objectHandle,
+                         const std::string &name) const {
+  if (!isEnabled() || objectHandle == 0) {
+    return;
+  }
+  VkDebugUtilsObjectNameInfoEXT nameInfo{};
+  nameInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+  nameInfo.objectType = objectType;
+  nameInfo.objectHandle = objectHandle;
+  nameInfo.pObjectName = name.c_str();
+  if (setObjectName_(device_, &nameInfo) != VK_SUCCESS) {
+    SPDLOG_LOGGER_WARN(get_vinkan_logger(), "Failed to name the object {}",
+                       name);
+  }
+}
+
+void DebugUtils::beginLabel(VkCommandBuffer commandBuffer, const char *name,
+                            std::array<float, 4> color) const {
+  if (!isEnabled()) {
+    return;
+  }
+  VkDebugUtilsLabelEXT label{};
+  label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+  label.pLabelName = name;
+  std::copy(color.begin(), color.end(), label.color);
+  cmdBeginLabel_(commandBuffer, &label);
+}
+
+void DebugUtils::endLabel(VkCommandBuffer commandBuffer) const {
+  if (!isEnabled()) {
+    return;
+  }
+  cmdEndLabel_(commandBuffer);
+}
+
+void DebugUtils::insertLabel(VkCommandBuffer commandBuffer, const char *name,
+                             std::array<float, 4> color) const {
+  if (!isEnabled()) {
+    return;
+  }
+  VkDebugUtilsLabelEXT label{};
+  label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+  label.pLabelName = name;
+  std::copy(color.begin(), color.end(), label.color);
+  cmdInsertLabel_(commandBuffer, &label);
+}
+
+}  // namespace vinkan
@@ -0,0 +1,90 @@
+#ifndef VINKAN_DEBUG_UTILS_HPP
+#define VINKAN_DEBUG_UTILS_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "vinkan/generics/enum_name.hpp"
+#include "vinkan/generics/macros.hpp"
+
+namespace vinkan {
+
+// Object names and command buffer labels of VK_EXT_debug_utils, shown by the
+// validation layers, the DiagnosticsSink and GPU debuggers.
+//
+// The functions are only loaded when the instance has the extension (i.e. it
+// was created with validation layers), every call is a no-op otherwise.
+class DebugUtils {
+ public:
+  DebugUtils(VkInstance instance, VkDevice device);
+
+  bool isEnabled() const { return setObjectName_ != nullptr; }
+
+  void setName(VkObjectType objectType, uint64_t objectHandle,
+               const std::string &name) const;
+  template <typename HandleT>
+  void setName(VkObjectType objectType, HandleT handle,
+               const std::string &name) const {
+    setName(objectType, toObjectHandle_(handle), name);
+  }
+  template <typename HandleT, EnumType E>
+  void setName(VkObjectType objectType, HandleT handle, E identifier) const {
+    if (isEnabled()) {
+      setName(objectType, toObjectHandle_(handle), enumName(identifier));
+    }
+  }
+
+  void beginLabel(VkCommandBuffer commandBuffer, const char *name,
+                  std::array<float, 4> color = {}) const;
+  void endLabel(VkCommandBuffer commandBuffer) const;
+  void insertLabel(VkCommandBuffer commandBuffer, const char *name,
+                   std::array<float, 4> color = {}) const;
+
+ private:
+  VkDevice device_;
+  PFN_vkSetDebugUtilsObjectNameEXT setObjectName_ = nullptr;
+  PFN_vkCmdBeginDebugUtilsLabelEXT cmdBeginLabel_ = nullptr;
+  PFN_vkCmdEndDebugUtilsLabelEXT cmdEndLabel_ = nullptr;
+  PFN_vkCmdInsertDebugUtilsLabelEXT cmdInsertLabel_ = nullptr;
+
+  // Non-dispatchable handles are integers on 32-bit platforms
+  template <typename HandleT>
+  static uint64_t toObjectHandle_(HandleT handle) {
+    if constexpr (std::is_pointer_v<HandleT>) {
+      return reinterpret_cast<uint64_t>(handle);
+    } else {
+      return static_cast<uint64_t>(handle);
+    }
+  }
+};
+
+// Labels the commands recorded until the end of the enclosing C++ scope
+class DebugLabel {
+ public:
+  DebugLabel(const DebugUtils &debugUtils, VkCommandBuffer commandBuffer,
+             const char *name)
+      : debugUtils_(debugUtils), commandBuffer_(commandBuffer) {
+    debugUtils_.beginLabel(commandBuffer_, name);
+  }
+  ~DebugLabel() { debugUtils_.endLabel(commandBuffer_); }
+
+  DebugLabel(const DebugLabel &) = delete;
+  DebugLabel &operator=(const DebugLabel &) = delete;
+
+ private:
+  const DebugUtils &debugUtils_;
+  VkCommandBuffer commandBuffer_;
+};
+
+}  // namespace vinkan
+
+#define VINKAN_DEBUG_LABEL(debugUtils, commandBuffer, name)                  \
+  vinkan::DebugLabel VINKAN_CONCAT_(vinkanDebugLabel, __LINE__)(debugUtils,  \
+                                                                commandBuffer, \
+                                                                name)
+
+#endif
@@ -0,0 +1,146 @@
+#include "diagnostics.hpp"
+
+#include <algorithm>
+
+#include "vinkan/logging/logger.hpp"
+#include <spdlog/fmt/ranges.h>
+
+namespace vinkan {
+
+DiagnosticsSink::DiagnosticsSink(uint32_t maxPendingPerformanceWarnings)
+    : maxPendingPerformanceWarnings_(maxPendingPerformanceWarnings) {}
+
+void DiagnosticsSink::onMessage(
+    VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+    VkDebugUtilsMessageTypeFlagsEXT types,
+    const VkDebugUtilsMessengerCallbackDataEXT *callbackData) {
+  DiagnosticMessage message{
+      .idNumber = callbackData->messageIdNumber,
+      .idName = callbackData->pMessageIdName != nullptr
+                    ? callbackData->pMessageIdName
+                    : "",
+      .severity = severity,
+      .types = types,
+      .text = callbackData->pMessage != nullptr ? callbackData->pMessage : ""};
+  for (uint32_t i = 0; i < callbackData->objectCount; ++i) {
+    auto &object = callbackData->pObjects[i];
+    if (object.pObjectName != nullptr) {
+      message.objects.push_back(object.pObjectName);
+    } else {
+      message.objects.push_back(fmt::format("{:#x}", object.objectHandle));
+    }
+  }
+  for (uint32_t i = 0; i < callbackData->cmdBufLabelCount; ++i) {
+    // The layers give the innermost label first
+    auto &label = callbackData->pCmdBufLabels[callbackData->cmdBufLabelCount -
+                                              1 - i];
+    message.labels.push_back(label.pLabelName != nullptr ? label.pLabelName
+                                                         : "");
+  }
+
+  // Some messages have no id, their text is then their identity
+  auto key = message.idName.empty() && message.idNumber == 0
+                 ? message.text
+                 : message.idName + "#" + std::to_string(message.idNumber);
+  bool performanceWarning =
+      (types & VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT) != 0;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
+    errorCount_++;
+  } else if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) {
+    warningCount_++;
+  }
+  if (performanceWarning) {
+    performanceWarningCount_++;
+    if (pendingPerformanceWarnings_.size() < maxPendingPerformanceWarnings_) {
+      pendingPerformanceWarnings_.push_back(message);
+    } else {
+      droppedPerformanceWarningCount_++;
+    }
+  }
+
+  auto it = messages_.find(key);
+  if (it != messages_.end()) {
+    it->second.count++;
+    return;
+  }
+  log_(message);
+  messages_.emplace(key, std::move(message));
+}
+
+std::vector<DiagnosticMessage> DiagnosticsSink::getMessages() const {
+  std::vector<DiagnosticMessage> messages{};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &[key, message] : messages_) {
+      messages.push_back(message);
+    }
+  }
+  std::stable_sort(messages.begin(), messages.end(),
+                   [](const DiagnosticMessage &a, const DiagnosticMessage &b) {
+                     return a.count > b.count;
+                   });
+  return messages;
+}
+
+std::vector<DiagnosticMessage> DiagnosticsSink::takePerformanceWarnings() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<DiagnosticMessage> warnings(
+      std::make_move_iterator(pendingPerformanceWarnings_.begin()),
+      std::make_move_iterator(pendingPerformanceWarnings_.end()));
+  pendingPerformanceWarnings_.clear();
+  return warnings;
+}
+
+uint64_t DiagnosticsSink::getErrorCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return errorCount_;
+}
+
+uint64_t DiagnosticsSink::getWarningCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return warningCount_;
+}
+
+uint64_t DiagnosticsSink::getPerformanceWarningCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return performanceWarningCount_;
+}
+
+uint64_t DiagnosticsSink::getDroppedPerformanceWarningCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return droppedPerformanceWarningCount_;
+}
+
+void DiagnosticsSink::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  messages_.clear();
+  pendingPerformanceWarnings_.clear();
+  errorCount_ = 0;
+  warningCount_ = 0;
+  performanceWarningCount_ = 0;
+  droppedPerformanceWarningCount_ = 0;
+}
+
+void DiagnosticsSink::log_(const DiagnosticMessage &message) const {
+  std::string context{};
+  if (!message.objects.empty()) {
+    context += fmt::format("\n  objects: {}", fmt::join(message.objects, ", "));
+  }
+  if (!message.labels.empty()) {
+    context += fmt::format("\n  labels: {}", fmt::join(message.labels, " > "));
+  }
+  if (message.severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
+    SPDLOG_LOGGER_ERROR(get_vinkan_logger(), "[{}] {}{}", message.idName,
+                        message.text, context);
+  } else if (message.types & VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT) {
+    SPDLOG_LOGGER_WARN(get_vinkan_logger(), "[performance] [{}] {}{}",
+                       message.idName, message.text, context);
+  } else {
+    SPDLOG_LOGGER_WARN(get_vinkan_logger(), "[{}] {}{}", message.idName,
+                       message.text, context);
+  }
+}
+
+}  // namespace vinkan
@@ -0,0 +1,74 @@
+#ifndef VINKAN_DIAGNOSTICS_HPP
+#define VINKAN_DIAGNOSTICS_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vinkan {
+
+struct DiagnosticMessage {
+  int32_t idNumber;
+  std::string idName;
+  VkDebugUtilsMessageSeverityFlagBitsEXT severity;
+  VkDebugUtilsMessageTypeFlagsEXT types;
+  std::string text;
+  // Objects the message is about, by their debug name when they have one
+  std::vector<std::string> objects{};
+  // Command buffer labels open when the message was emitted, outermost first
+  std::vector<std::string> labels{};
+  // Occurrences of the message id
+  uint64_t count = 1;
+};
+
+// Receives the debug messenger messages of an Instance.
+//
+// Messages are deduplicated by id: only the first occurrence of an id is
+// logged, the next ones are counted. Performance warnings are also queued
+// (repeats included) for the application to take.
+class DiagnosticsSink {
+ public:
+  explicit DiagnosticsSink(uint32_t maxPendingPerformanceWarnings = 256);
+
+  DiagnosticsSink(const DiagnosticsSink &) = delete;
+  DiagnosticsSink &operator=(const DiagnosticsSink &) = delete;
+
+  // Called by the debug messenger, from any thread
+  void onMessage(VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+                 VkDebugUtilsMessageTypeFlagsEXT types,
+                 const VkDebugUtilsMessengerCallbackDataEXT *callbackData);
+
+  // Distinct messages, most frequent first
+  std::vector<DiagnosticMessage> getMessages() const;
+  // Performance warnings received since the last call, oldest first. When the
+  // queue is full the newest ones are dropped.
+  std::vector<DiagnosticMessage> takePerformanceWarnings();
+
+  uint64_t getErrorCount() const;
+  uint64_t getWarningCount() const;
+  uint64_t getPerformanceWarningCount() const;
+  uint64_t getDroppedPerformanceWarningCount() const;
+  void clear();
+
+ private:
+  uint32_t maxPendingPerformanceWarnings_;
+
+  mutable std::mutex mutex_;
+  std::map<std::string, DiagnosticMessage> messages_{};
+  std::deque<DiagnosticMessage> pendingPerformanceWarnings_{};
+  uint64_t errorCount_ = 0;
+  uint64_t warningCount_ = 0;
+  uint64_t performanceWarningCount_ = 0;
+  uint64_t droppedPerformanceWarningCount_ = 0;
+
+  void log_(const DiagnosticMessage &message) const;
+};
+
+}  // namespace vinkan
+
+#endif
@@ -1,13 +1,33 @@
 #ifndef VINKAN_LOGGER_HPP
 #define VINKAN_LOGGER_HPP
 
+// Calls below the compile-time level are compiled out, VINKAN_LOG_LEVEL comes
+// from CMake (0 trace, 1 debug, 2 info... 6 off). It only applies if spdlog
+// hasn't been included before with its own level.
+#ifndef SPDLOG_ACTIVE_LEVEL
+#ifdef VINKAN_LOG_LEVEL
+#define SPDLOG_ACTIVE_LEVEL VINKAN_LOG_LEVEL
+#else
 #define SPDLOG_ACTIVE_LEVEL 1
+#endif
+#endif
+
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
+#ifdef VINKAN_ASYNC_LOGGING
+#include <spdlog/async.h>
+#endif
 
-inline std::shared_ptr<spdlog::logger> get_vinkan_logger() {
+inline const std::shared_ptr<spdlog::logger> &get_vinkan_logger() {
   static auto logger = []() {
+#ifdef VINKAN_ASYNC_LOGGING
+    // Lines are formatted and written by the spdlog thread pool, when its ring
+    // buffer is full the oldest lines are dropped instead of blocking
+    auto console_logger =
+        spdlog::create_async_nb<spdlog::sinks::stdout_color_sink_mt>("vinkan");
+#else
     auto console_logger = spdlog::stdout_color_mt("vinkan");
+#endif
     console_logger->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [vinkan] [%l] %v");
     console_logger->set_level(spdlog::level::trace);
     return console_logger;
@@ -15,7 +35,4 @@ inline std::shared_ptr<spdlog::logger> get_vinkan_logger() {
   return logger;
 }
 
-static auto vinkan_logger = get_vinkan_logger();
-
 #endif
-
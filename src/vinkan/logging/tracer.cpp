@@ -0,0 +1,92 @@
+#include "tracer.hpp"
+
+#include <cassert>
+#include <chrono>
+
+#include "vinkan/logging/chrome_trace.hpp"
+
+namespace vinkan {
+
+namespace {
+
+uint32_t currentThreadId() {
+  // Small ids read better than hashed std::thread::id in the trace viewers
+  static std::atomic<uint32_t> nextThreadId = 0;
+  thread_local uint32_t threadId = nextThreadId.fetch_add(1);
+  return threadId;
+}
+
+}  // namespace
+
+Tracer &Tracer::get() {
+  static Tracer tracer;
+  return tracer;
+}
+
+void Tracer::enable(uint32_t capacity) {
+  assert(capacity > 0);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (events_.size() != capacity) {
+    events_.assign(capacity, TraceEvent{});
+    nextEvent_ = 0;
+    wrapped_ = false;
+  }
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::disable() { enabled_.store(false, std::memory_order_relaxed); }
+
+void Tracer::record(const char *name, int64_t startNs, int64_t endNs) {
+  auto threadId = currentThreadId();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (events_.empty()) {
+    return;
+  }
+  events_[nextEvent_] = TraceEvent{.name = name,
+                                   .startNs = startNs,
+                                   .durationNs = endNs - startNs,
+                                   .threadId = threadId};
+  nextEvent_++;
+  if (nextEvent_ == events_.size()) {
+    nextEvent_ = 0;
+    wrapped_ = true;
+  }
+}
+
+std::vector<TraceEvent> Tracer::getEvents() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!wrapped_) {
+    return std::vector<TraceEvent>(events_.begin(),
+                                   events_.begin() + nextEvent_);
+  }
+  std::vector<TraceEvent> events(events_.begin() + nextEvent_, events_.end());
+  events.insert(events.end(), events_.begin(), events_.begin() + nextEvent_);
+  return events;
+}
+
+void Tracer::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  nextEvent_ = 0;
+  wrapped_ = false;
+}
+
+void Tracer::writeChromeTrace(const std::string &filepath) const {
+  std::vector<ChromeTraceEvent> traceEvents{};
+  for (auto &event : getEvents()) {
+    traceEvents.push_back(
+        ChromeTraceEvent{.name = event.name,
+                         .category = "cpu",
+                         .thread = std::to_string(event.threadId),
+                         .startUs = event.startNs / 1e3,
+                         .durationUs = event.durationNs / 1e3});
+  }
+  vinkan::writeChromeTrace(filepath, traceEvents);
+}
+
+int64_t Tracer::nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace vinkan
@@ -0,0 +1,84 @@
+#ifndef VINKAN_TRACER_HPP
+#define VINKAN_TRACER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "vinkan/generics/macros.hpp"
+
+namespace vinkan {
+
+struct TraceEvent {
+  const char *name;
+  int64_t startNs;  // Steady clock
+  int64_t durationNs;
+  uint32_t threadId;
+};
+
+// CPU spans recorded in a fixed size ring buffer, the oldest spans are
+// overwritten once it's full. Nothing is recorded until enable is called.
+class Tracer {
+ public:
+  static Tracer &get();
+
+  void enable(uint32_t capacity = 1 << 16);
+  void disable();
+  bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // The name must outlive the tracer (string literals)
+  void record(const char *name, int64_t startNs, int64_t endNs);
+
+  // Oldest first
+  std::vector<TraceEvent> getEvents() const;
+  void clear();
+
+  // Chrome trace event format. The timestamps share the clock of a
+  // calibrated GpuProfiler so both traces line up.
+  void writeChromeTrace(const std::string &filepath) const;
+
+  static int64_t nowNs();
+
+ private:
+  Tracer() = default;
+
+  std::atomic<bool> enabled_ = false;
+  mutable std::mutex mutex_;
+  std::vector<TraceEvent> events_{};
+  size_t nextEvent_ = 0;
+  bool wrapped_ = false;
+};
+
+// Records the enclosing C++ scope as a span when the tracer is enabled
+class TraceSpan {
+ public:
+  explicit TraceSpan(const char *name)
+      : name_(Tracer::get().isEnabled() ? name : nullptr),
+        startNs_(name_ != nullptr ? Tracer::nowNs() : 0) {}
+  ~TraceSpan() {
+    if (name_ != nullptr) {
+      Tracer::get().record(name_, startNs_, Tracer::nowNs());
+    }
+  }
+
+  TraceSpan(const TraceSpan &) = delete;
+  TraceSpan &operator=(const TraceSpan &) = delete;
+
+ private:
+  const char *name_;
+  int64_t startNs_;
+};
+
+}  // namespace vinkan
+
+// Compiled out unless VINKAN_ENABLE_TRACING is set (CMake option)
+#ifdef VINKAN_ENABLE_TRACING
+#define VINKAN_TRACE_SCOPE(name) \
+  vinkan::TraceSpan VINKAN_CONCAT_(vinkanTraceSpan, __LINE__)(name)
+#else
+#define VINKAN_TRACE_SCOPE(name) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,297 @@
+#include "host_allocator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <new>
+
+#include "vinkan/logging/logger.hpp"
+
+namespace vinkan {
+
+namespace {
+
+// Written right before the pointer given to the driver
+struct BlockHeader {
+  // From the start of the block to the pointer given to the driver
+  uint32_t offset;
+  uint8_t scope;
+  uint8_t sizeClass;
+  uint64_t size;
+};
+static_assert(sizeof(BlockHeader) == 16);
+
+constexpr size_t HEADER_ALIGNMENT = 16;
+constexpr size_t MIN_POOLED_SIZE = 16;
+constexpr uint8_t SIZE_CLASS_COUNT =
+    std::countr_zero(HostAllocator::MAX_POOLED_SIZE) -
+    std::countr_zero(MIN_POOLED_SIZE) + 1;
+constexpr uint8_t NO_SIZE_CLASS = 0xFF;
+
+constexpr size_t getSizeClassSize(uint8_t sizeClass) {
+  return MIN_POOLED_SIZE << sizeClass;
+}
+
+uint8_t getSizeClass(size_t size) {
+  size_t roundedSize = std::bit_ceil(std::max(size, MIN_POOLED_SIZE));
+  return static_cast<uint8_t>(std::countr_zero(roundedSize) -
+                              std::countr_zero(MIN_POOLED_SIZE));
+}
+
+BlockHeader *getHeader(void *memory) {
+  return reinterpret_cast<BlockHeader *>(static_cast<char *>(memory) -
+                                         sizeof(BlockHeader));
+}
+
+void *allocateBlock(size_t offset, size_t capacity) {
+  return ::operator new(offset + capacity, std::align_val_t(offset),
+                        std::nothrow);
+}
+
+void freeBlock(void *block, size_t offset) {
+  ::operator delete(block, std::align_val_t(offset));
+}
+
+// Free lists of the pooled blocks of the current thread, the blocks all have
+// the header alignment
+struct ThreadBlockCache {
+  std::array<std::array<void *, HostAllocator::MAX_CACHED_BLOCKS>,
+             SIZE_CLASS_COUNT>
+      blocks{};
+  std::array<uint32_t, SIZE_CLASS_COUNT> counts{};
+
+  ~ThreadBlockCache() {
+    for (uint8_t sizeClass = 0; sizeClass < SIZE_CLASS_COUNT; ++sizeClass) {
+      for (uint32_t i = 0; i < counts[sizeClass]; ++i) {
+        freeBlock(blocks[sizeClass][i], HEADER_ALIGNMENT);
+      }
+    }
+  }
+
+  void *pop(uint8_t sizeClass) {
+    if (counts[sizeClass] == 0) {
+      return nullptr;
+    }
+    return blocks[sizeClass][--counts[sizeClass]];
+  }
+
+  bool push(uint8_t sizeClass, void *block) {
+    if (counts[sizeClass] == HostAllocator::MAX_CACHED_BLOCKS) {
+      return false;
+    }
+    blocks[sizeClass][counts[sizeClass]++] = block;
+    return true;
+  }
+};
+
+thread_local ThreadBlockCache threadBlockCache{};
+
+constexpr std::array<const char *, 5> SCOPE_NAMES = {
+    "command", "object", "cache", "device", "instance"};
+
+}  // namespace
+
+HostAllocator::HostAllocator() {
+  callbacks_.pUserData = this;
+  callbacks_.pfnAllocation = &HostAllocator::vkAllocation_;
+  callbacks_.pfnReallocation = &HostAllocator::vkReallocation_;
+  callbacks_.pfnFree = &HostAllocator::vkFree_;
+  callbacks_.pfnInternalAllocation = &HostAllocator::vkInternalAllocation_;
+  callbacks_.pfnInternalFree = &HostAllocator::vkInternalFree_;
+}
+
+HostAllocationStats HostAllocator::getStats(
+    VkSystemAllocationScope scope) const {
+  const ScopeCounters &counters = counters_[scopeIndex_(scope)];
+  return HostAllocationStats{
+      .currentBytes = counters.currentBytes.load(std::memory_order_relaxed),
+      .peakBytes = counters.peakBytes.load(std::memory_order_relaxed),
+      .allocationCount =
+          counters.allocationCount.load(std::memory_order_relaxed),
+      .reallocationCount =
+          counters.reallocationCount.load(std::memory_order_relaxed),
+      .freeCount = counters.freeCount.load(std::memory_order_relaxed),
+      .pooledAllocationCount =
+          counters.pooledAllocationCount.load(std::memory_order_relaxed),
+      .internalBytes = counters.internalBytes.load(std::memory_order_relaxed)};
+}
+
+HostAllocationStats HostAllocator::getTotalStats() const {
+  HostAllocationStats total{};
+  for (size_t i = 0; i < SCOPE_COUNT; ++i) {
+    auto stats = getStats(static_cast<VkSystemAllocationScope>(i));
+    total.currentBytes += stats.currentBytes;
+    // Peaks of the scopes may not be simultaneous, it's an upper bound
+    total.peakBytes += stats.peakBytes;
+    total.allocationCount += stats.allocationCount;
+    total.reallocationCount += stats.reallocationCount;
+    total.freeCount += stats.freeCount;
+    total.pooledAllocationCount += stats.pooledAllocationCount;
+    total.internalBytes += stats.internalBytes;
+  }
+  return total;
+}
+
+void HostAllocator::logStats() const {
+  for (size_t i = 0; i < SCOPE_COUNT; ++i) {
+    auto stats = getStats(static_cast<VkSystemAllocationScope>(i));
+    if (stats.allocationCount == 0 && stats.internalBytes == 0) {
+      continue;
+    }
+    SPDLOG_LOGGER_INFO(get_vinkan_logger(),
+                       "Host allocations ({} scope): {} bytes (peak {}), {} "
+                       "allocations ({} pooled), {} reallocations, {} frees, "
+                       "{} internal bytes",
+                       SCOPE_NAMES[i], stats.currentBytes, stats.peakBytes,
+                       stats.allocationCount, stats.pooledAllocationCount,
+                       stats.reallocationCount, stats.freeCount,
+                       stats.internalBytes);
+  }
+}
+
+size_t HostAllocator::scopeIndex_(VkSystemAllocationScope scope) {
+  return std::min(static_cast<size_t>(scope), SCOPE_COUNT - 1);
+}
+
+void HostAllocator::addBytes_(VkSystemAllocationScope scope, uint64_t size) {
+  ScopeCounters &counters = counters_[scopeIndex_(scope)];
+  uint64_t current =
+      counters.currentBytes.fetch_add(size, std::memory_order_relaxed) + size;
+  uint64_t peak = counters.peakBytes.load(std::memory_order_relaxed);
+  while (current > peak && !counters.peakBytes.compare_exchange_weak(
+                               peak, current, std::memory_order_relaxed)) {
+  }
+}
+
+void HostAllocator::removeBytes_(VkSystemAllocationScope scope,
+                                 uint64_t size) {
+  counters_[scopeIndex_(scope)].currentBytes.fetch_sub(
+      size, std::memory_order_relaxed);
+}
+
+void *HostAllocator::allocate_(size_t size, size_t alignment,
+                               VkSystemAllocationScope scope) {
+  if (size == 0) {
+    return nullptr;
+  }
+  size_t offset = std::max(alignment, HEADER_ALIGNMENT);
+  bool poolable = (scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND ||
+                   scope == VK_SYSTEM_ALLOCATION_SCOPE_OBJECT) &&
+                  offset == HEADER_ALIGNMENT && size <= MAX_POOLED_SIZE;
+
+  void *block = nullptr;
+  uint8_t sizeClass = NO_SIZE_CLASS;
+  if (poolable) {
+    sizeClass = getSizeClass(size);
+    block = threadBlockCache.pop(sizeClass);
+    if (block != nullptr) {
+      counters_[scopeIndex_(scope)].pooledAllocationCount.fetch_add(
+          1, std::memory_order_relaxed);
+    } else {
+      block = allocateBlock(offset, getSizeClassSize(sizeClass));
+    }
+  } else {
+    block = allocateBlock(offset, size);
+  }
+  if (block == nullptr) {
+    return nullptr;
+  }
+
+  void *memory = static_cast<char *>(block) + offset;
+  *getHeader(memory) = BlockHeader{.offset = static_cast<uint32_t>(offset),
+                                   .scope = static_cast<uint8_t>(scope),
+                                   .sizeClass = sizeClass,
+                                   .size = size};
+  addBytes_(scope, size);
+  return memory;
+}
+
+void *HostAllocator::reallocate_(void *original, size_t size,
+                                 size_t alignment,
+                                 VkSystemAllocationScope scope) {
+  if (original == nullptr) {
+    return allocate_(size, alignment, scope);
+  }
+  if (size == 0) {
+    free_(original);
+    return nullptr;
+  }
+  BlockHeader *header = getHeader(original);
+  auto originalScope = static_cast<VkSystemAllocationScope>(header->scope);
+  // Pooled blocks have some room left before the next size class
+  if (header->sizeClass != NO_SIZE_CLASS && scope == originalScope &&
+      alignment <= header->offset &&
+      size <= getSizeClassSize(header->sizeClass)) {
+    removeBytes_(originalScope, header->size);
+    addBytes_(scope, size);
+    header->size = size;
+    return original;
+  }
+
+  void *memory = allocate_(size, alignment, scope);
+  if (memory == nullptr) {
+    // The original allocation must stay valid
+    return nullptr;
+  }
+  std::memcpy(memory, original, std::min<size_t>(size, header->size));
+  free_(original);
+  return memory;
+}
+
+void HostAllocator::free_(void *memory) {
+  if (memory == nullptr) {
+    return;
+  }
+  BlockHeader *header = getHeader(memory);
+  auto scope = static_cast<VkSystemAllocationScope>(header->scope);
+  removeBytes_(scope, header->size);
+  counters_[scopeIndex_(scope)].freeCount.fetch_add(1,
+                                                    std::memory_order_relaxed);
+
+  void *block = static_cast<char *>(memory) - header->offset;
+  if (header->sizeClass != NO_SIZE_CLASS &&
+      threadBlockCache.push(header->sizeClass, block)) {
+    return;
+  }
+  freeBlock(block, header->offset);
+}
+
+void *VKAPI_PTR HostAllocator::vkAllocation_(void *userData, size_t size,
+                                             size_t alignment,
+                                             VkSystemAllocationScope scope) {
+  auto *allocator = static_cast<HostAllocator *>(userData);
+  allocator->counters_[scopeIndex_(scope)].allocationCount.fetch_add(
+      1, std::memory_order_relaxed);
+  return allocator->allocate_(size, alignment, scope);
+}
+
+void *VKAPI_PTR HostAllocator::vkReallocation_(
+    void *userData, void *original, size_t size, size_t alignment,
+    VkSystemAllocationScope scope) {
+  auto *allocator = static_cast<HostAllocator *>(userData);
+  allocator->counters_[scopeIndex_(scope)].reallocationCount.fetch_add(
+      1, std::memory_order_relaxed);
+  return allocator->reallocate_(original, size, alignment, scope);
+}
+
+void VKAPI_PTR HostAllocator::vkFree_(void *userData, void *memory) {
+  static_cast<HostAllocator *>(userData)->free_(memory);
+}
+
+void VKAPI_PTR HostAllocator::vkInternalAllocation_(
+    void *userData, size_t size, VkInternalAllocationType,
+    VkSystemAllocationScope scope) {
+  auto *allocator = static_cast<HostAllocator *>(userData);
+  allocator->counters_[scopeIndex_(scope)].internalBytes.fetch_add(
+      size, std::memory_order_relaxed);
+}
+
+void VKAPI_PTR HostAllocator::vkInternalFree_(void *userData, size_t size,
+                                              VkInternalAllocationType,
+                                              VkSystemAllocationScope scope) {
+  auto *allocator = static_cast<HostAllocator *>(userData);
+  allocator->counters_[scopeIndex_(scope)].internalBytes.fetch_sub(
+      size, std::memory_order_relaxed);
+}
+
+}  // namespace vinkan
@@ -0,0 +1,98 @@
+#ifndef VINKAN_HOST_ALLOCATOR_HPP
+#define VINKAN_HOST_ALLOCATOR_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace vinkan {
+
+struct HostAllocationStats {
+  // Bytes requested by the driver and still allocated
+  uint64_t currentBytes = 0;
+  uint64_t peakBytes = 0;
+  uint64_t allocationCount = 0;
+  uint64_t reallocationCount = 0;
+  uint64_t freeCount = 0;
+  // Allocations served from a thread-local pool instead of the heap
+  uint64_t pooledAllocationCount = 0;
+  // Executable memory the driver allocated itself and reported
+  uint64_t internalBytes = 0;
+};
+
+// VkAllocationCallbacks accounting the driver host allocations by
+// VkSystemAllocationScope.
+//
+// Command and object scope allocations are short lived and small, the ones
+// fitting a size class are recycled through per thread free lists instead of
+// going back to the heap. A block freed on another thread joins the free
+// list of that thread.
+//
+// The allocator must outlive every Vulkan object created with its callbacks.
+class HostAllocator {
+ public:
+  HostAllocator();
+
+  HostAllocator(const HostAllocator &) = delete;
+  HostAllocator &operator=(const HostAllocator &) = delete;
+
+  // To pass to Instance, Device and the other wrappers
+  const VkAllocationCallbacks *getCallbacks() const { return &callbacks_; }
+
+  HostAllocationStats getStats(VkSystemAllocationScope scope) const;
+  // All scopes together
+  HostAllocationStats getTotalStats() const;
+  // One line per scope that allocated something
+  void logStats() const;
+
+  // Largest size class, bigger allocations always go to the heap
+  static constexpr size_t MAX_POOLED_SIZE = 2048;
+  // Blocks kept per size class and per thread
+  static constexpr uint32_t MAX_CACHED_BLOCKS = 64;
+
+ private:
+  static constexpr size_t SCOPE_COUNT = 5;
+
+  struct ScopeCounters {
+    std::atomic<uint64_t> currentBytes{0};
+    std::atomic<uint64_t> peakBytes{0};
+    std::atomic<uint64_t> allocationCount{0};
+    std::atomic<uint64_t> reallocationCount{0};
+    std::atomic<uint64_t> freeCount{0};
+    std::atomic<uint64_t> pooledAllocationCount{0};
+    std::atomic<uint64_t> internalBytes{0};
+  };
+
+  VkAllocationCallbacks callbacks_{};
+  std::array<ScopeCounters, SCOPE_COUNT> counters_{};
+
+  void *allocate_(size_t size, size_t alignment,
+                  VkSystemAllocationScope scope);
+  void *reallocate_(void *original, size_t size, size_t alignment,
+                    VkSystemAllocationScope scope);
+  void free_(void *memory);
+  void addBytes_(VkSystemAllocationScope scope, uint64_t size);
+  void removeBytes_(VkSystemAllocationScope scope, uint64_t size);
+  static size_t scopeIndex_(VkSystemAllocationScope scope);
+
+  static void *VKAPI_PTR vkAllocation_(void *userData, size_t size,
+                                       size_t alignment,
+                                       VkSystemAllocationScope scope);
+  static void *VKAPI_PTR vkReallocation_(void *userData, void *original,
+                                         size_t size, size_t alignment,
+                                         VkSystemAllocationScope scope);
+  static void VKAPI_PTR vkFree_(void *userData, void *memory);
+  static void VKAPI_PTR vkInternalAllocation_(void *userData, size_t size,
+                                              VkInternalAllocationType type,
+                                              VkSystemAllocationScope scope);
+  static void VKAPI_PTR vkInternalFree_(void *userData, size_t size,
+                                        VkInternalAllocationType type,
+                                        VkSystemAllocationScope scope);
+};
+
+}  // namespace vinkan
+
+#endif
@@ -2,6 +2,7 @@
 #define VINKAN_MODEL_HPP
 
 #include "model_base.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
 
 namespace vinkan {
 
@@ -21,13 +22,14 @@ class Model : public ModelBase<Vertex> {
         // Draw with indices
         this->bindBuffers_(commandBuffer, this->vertexBuffer_->getHandle(),
                            this->indexBuffer_->getHandle());
-        vkCmdDrawIndexed(commandBuffer, indexCount_, 1, 0, 0, 0);
+        deviceDispatch.vkCmdDrawIndexed(commandBuffer, indexCount_, 1, 0, 0, 0);
       } else {
         // Draw without indices
         VkBuffer buffers[] = {this->vertexBuffer_->getHandle()};
         VkDeviceSize offsets[] = {0};
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
-        vkCmdDraw(commandBuffer, vertexCount_, 1, 0, 0);
+        deviceDispatch.vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers,
+                                              offsets);
+        deviceDispatch.vkCmdDraw(commandBuffer, vertexCount_, 1, 0, 0);
       }
     }
   }
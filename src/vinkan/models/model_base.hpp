@@ -6,7 +6,9 @@
 #include <memory>
 #include <vector>
 
+#include "vinkan/jobs/job_system.hpp"
 #include "vinkan/wrappers/buffer.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
 
 namespace vinkan {
 
@@ -30,6 +32,9 @@ class ModelBase {
 
   virtual void draw(VkCommandBuffer commandBuffer) = 0;
 
+  // The staging buffers are then filled in parallel
+  void setJobSystem(JobSystem* jobSystem) { jobSystem_ = jobSystem; }
+
   void transferModelToDevice(VkCommandBuffer commandBuffer,
                              const ModelData<Vertex>& modelData,
                              VkQueue transferQueue) {
@@ -46,6 +51,7 @@ class ModelBase {
  protected:
   VkDevice device_;
   VkPhysicalDeviceMemoryProperties deviceMemoryProperties_;
+  JobSystem* jobSystem_ = nullptr;
 
   std::unique_ptr<Buffer> indexBuffer_;
   std::unique_ptr<Buffer> vertexBuffer_;
@@ -70,9 +76,8 @@ class ModelBase {
                                VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
 
     Buffer stagingBuffer(device_, deviceMemoryProperties_, stagingBufferInfo);
-    stagingBuffer.map();
-    stagingBuffer.writeToBuffer((void*)vertices.data());
-    stagingBuffer.unmap();
+    writeStagingBuffer_(stagingBuffer, vertices.data(),
+                        vertices.size() * vertexSize);
 
     // Create vertex buffer
     BufferInfo vertexBufferInfo{
@@ -94,6 +99,17 @@ class ModelBase {
     return vertexBuffer;
   }
 
+  void writeStagingBuffer_(Buffer& stagingBuffer, const void* data,
+                           size_t size) {
+    stagingBuffer.map();
+    if (jobSystem_ != nullptr) {
+      jobSystem_->parallelCopy(stagingBuffer.getMappedMemory(), data, size);
+    } else {
+      stagingBuffer.writeToBuffer(const_cast<void*>(data), size);
+    }
+    stagingBuffer.unmap();
+  }
+
   std::unique_ptr<Buffer> createIndexBuffer_(
       VkCommandBuffer commandBuffer, const std::vector<uint32_t>& indices,
       VkQueue transferQueue) {
@@ -114,9 +130,8 @@ class ModelBase {
                                VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
 
     Buffer stagingBuffer(device_, deviceMemoryProperties_, stagingBufferInfo);
-    stagingBuffer.map();
-    stagingBuffer.writeToBuffer((void*)indices.data());
-    stagingBuffer.unmap();
+    writeStagingBuffer_(stagingBuffer, indices.data(),
+                        indices.size() * indexSize);
 
     // Create index buffer
     BufferInfo indexBufferInfo{
@@ -143,8 +158,10 @@ class ModelBase {
     VkBuffer buffers[] = {vertexBuffer};
     VkDeviceSize offsets[] = {0};
 
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
-    vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+    deviceDispatch.vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers,
+                                          offsets);
+    deviceDispatch.vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0,
+                                        VK_INDEX_TYPE_UINT32);
   }
 
  private:
@@ -156,7 +173,8 @@ class ModelBase {
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+    if (deviceDispatch.vkBeginCommandBuffer(commandBuffer, &beginInfo) !=
+        VK_SUCCESS) {
       throw std::runtime_error("Failed to begin recording command buffer");
     }
 
@@ -166,10 +184,11 @@ class ModelBase {
     copyDesc.srcOffset = 0;
     copyDesc.size = size;
 
-    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyDesc);
+    deviceDispatch.vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1,
+                                   &copyDesc);
 
     // End recording
-    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+    if (deviceDispatch.vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
       throw std::runtime_error("Failed to record command buffer");
     }
 
@@ -179,16 +198,16 @@ class ModelBase {
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffer;
 
-    if (vkQueueSubmit(transferQueue, 1, &submitInfo, VK_NULL_HANDLE) !=
-        VK_SUCCESS) {
+    if (deviceDispatch.vkQueueSubmit(transferQueue, 1, &submitInfo,
+                                     VK_NULL_HANDLE) != VK_SUCCESS) {
       throw std::runtime_error("Failed to submit command buffer");
     }
 
     // Wait for completion
-    vkQueueWaitIdle(transferQueue);
+    deviceDispatch.vkQueueWaitIdle(transferQueue);
 
     // Reset command buffer for next use
-    if (vkResetCommandBuffer(commandBuffer, 0) != VK_SUCCESS) {
+    if (deviceDispatch.vkResetCommandBuffer(commandBuffer, 0) != VK_SUCCESS) {
       throw std::runtime_error("Failed to reset command buffer");
     }
   }
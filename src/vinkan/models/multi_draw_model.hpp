@@ -0,0 +1,118 @@
+#ifndef VINKAN_MULTI_DRAW_MODEL_HPP
+#define VINKAN_MULTI_DRAW_MODEL_HPP
+
+#include <cassert>
+#include <memory>
+
+#include "model_base.hpp"
+#include "vinkan/wrappers/indirect_buffer.hpp"
+
+namespace vinkan {
+
+struct MultiDrawInfo {
+  // Device feature, the draws are issued one by one without it
+  bool multiDrawIndirect = true;
+  // Lets a shader write the number of draws (drawIndirectCount feature)
+  bool withCountBuffer = false;
+  // e.g. storage to cull or fill the commands in a compute shader
+  VkBufferUsageFlags extraCommandUsageFlags = 0;
+};
+
+// Several indexed meshes sharing one vertex and one index buffer, drawn with
+// a single indirect call (one VkDrawIndexedIndirectCommand per mesh).
+template <typename Vertex>
+class MultiDrawModel : public ModelBase<Vertex> {
+ public:
+  MultiDrawModel(VkDevice device,
+                 VkPhysicalDeviceMemoryProperties deviceMemoryProperties,
+                 const std::vector<ModelData<Vertex>> &meshes,
+                 MultiDrawInfo info = {})
+      : ModelBase<Vertex>(device, deviceMemoryProperties),
+        meshCount_(static_cast<uint32_t>(meshes.size())),
+        multiDrawIndirect_(info.multiDrawIndirect) {
+    assert(meshCount_ > 0);
+    indirectBuffer_ =
+        std::make_unique<IndirectBuffer<VkDrawIndexedIndirectCommand>>(
+            device, deviceMemoryProperties,
+            IndirectBufferInfo{.maxCommandCount = meshCount_,
+                               .extraUsageFlags = info.extraCommandUsageFlags,
+                               .withCountBuffer = info.withCountBuffer});
+
+    // Meshes keep their own indices, the vertex offset shifts them
+    uint32_t firstIndex = 0;
+    int32_t vertexOffset = 0;
+    for (auto &mesh : meshes) {
+      assert(!mesh.indices.empty() && "Multi draw needs indexed meshes");
+      commands_.push_back(VkDrawIndexedIndirectCommand{
+          .indexCount = static_cast<uint32_t>(mesh.indices.size()),
+          .instanceCount = 1,
+          .firstIndex = firstIndex,
+          .vertexOffset = vertexOffset,
+          .firstInstance = 0});
+      firstIndex += static_cast<uint32_t>(mesh.indices.size());
+      vertexOffset += static_cast<int32_t>(mesh.vertices.size());
+    }
+    indirectBuffer_->write(commands_);
+    if (indirectBuffer_->hasCountBuffer()) {
+      indirectBuffer_->writeCount(meshCount_);
+    }
+  }
+
+  void transferMeshesToDevice(VkCommandBuffer commandBuffer,
+                              const std::vector<ModelData<Vertex>> &meshes,
+                              VkQueue transferQueue) {
+    assert(meshes.size() == meshCount_);
+    ModelData<Vertex> merged{};
+    for (auto &mesh : meshes) {
+      merged.vertices.insert(merged.vertices.end(), mesh.vertices.begin(),
+                             mesh.vertices.end());
+      merged.indices.insert(merged.indices.end(), mesh.indices.begin(),
+                            mesh.indices.end());
+    }
+    this->transferModelToDevice(commandBuffer, merged, transferQueue);
+  }
+
+  // Draws every mesh, each with its instance count
+  void draw(VkCommandBuffer commandBuffer) override {
+    if (!this->vertexBuffer_ || !this->indexBuffer_) {
+      return;
+    }
+    this->bindBuffers_(commandBuffer, this->vertexBuffer_->getHandle(),
+                       this->indexBuffer_->getHandle());
+    indirectBuffer_->cmdDraw(commandBuffer, 0, meshCount_, multiDrawIndirect_);
+  }
+  // Draws as many meshes as the count buffer says (written by the GPU)
+  void drawCount(VkCommandBuffer commandBuffer) {
+    if (!this->vertexBuffer_ || !this->indexBuffer_) {
+      return;
+    }
+    this->bindBuffers_(commandBuffer, this->vertexBuffer_->getHandle(),
+                       this->indexBuffer_->getHandle());
+    indirectBuffer_->cmdDrawCount(commandBuffer, meshCount_);
+  }
+
+  // An instance count of 0 skips the mesh without another draw call
+  void setInstances(uint32_t meshIndex, uint32_t instanceCount,
+                    uint32_t firstInstance = 0) {
+    assert(meshIndex < meshCount_);
+    commands_[meshIndex].instanceCount = instanceCount;
+    commands_[meshIndex].firstInstance = firstInstance;
+    indirectBuffer_->write(meshIndex, commands_[meshIndex]);
+  }
+
+  uint32_t getMeshCount() const { return meshCount_; }
+  IndirectBuffer<VkDrawIndexedIndirectCommand> &getIndirectBuffer() {
+    return *indirectBuffer_;
+  }
+
+ private:
+  uint32_t meshCount_;
+  bool multiDrawIndirect_;
+  std::vector<VkDrawIndexedIndirectCommand> commands_{};
+  std::unique_ptr<IndirectBuffer<VkDrawIndexedIndirectCommand>>
+      indirectBuffer_;
+};
+
+}  // namespace vinkan
+
+#endif  // VINKAN_MULTI_DRAW_MODEL_HPP
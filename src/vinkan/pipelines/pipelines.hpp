@@ -1,13 +1,23 @@
 #ifndef VINKAN_PIPELINES_HPP
 #define VINKAN_PIPELINES_HPP
 
+#include <cstring>
 #include <map>
+#include <optional>
+#include <utility>
 #include <vector>
 
 #include "vinkan/generics/concepts.hpp"
+#include "vinkan/jobs/job_system.hpp"
+#include "vinkan/logging/debug_utils.hpp"
 #include "vinkan/logging/logger.hpp"
+#include "vinkan/logging/tracer.hpp"
 #include "vinkan/pipelines/shader_module_maker.hpp"
+#include "vinkan/pipelines/spirv_reflection.hpp"
+#include "vinkan/profiling/pipeline_executable_report.hpp"
+#include "vinkan/profiling/pipeline_statistics.hpp"
 #include "vinkan/structs/pipeline_info.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
 #include "vulkan/vulkan_core.h"
 
 namespace vinkan {
@@ -15,18 +25,54 @@ namespace vinkan {
 template <EnumType PipelineT, EnumType PipelineLayoutT>
 class Pipelines {
  public:
-  Pipelines(VkDevice device) : device_(device) {}
+  Pipelines(VkDevice device, const VkAllocationCallbacks* allocator = nullptr)
+      : device_(device), allocator_(allocator) {}
   ~Pipelines() {
     for (auto& [identifier, pipeline] : pipelines_) {
-      vkDestroyPipeline(device_, pipeline, nullptr);
+      vkDestroyPipeline(device_, pipeline, allocator_);
     }
     for (auto& [identifier, layout] : pipelineLayouts_) {
-      vkDestroyPipelineLayout(device_, layout, nullptr);
+      vkDestroyPipelineLayout(device_, layout, allocator_);
     }
   }
   Pipelines(const Pipelines&) = delete;
   Pipelines& operator=(const Pipelines&) = delete;
 
+  // Every bind then opens a statistics query scope for the bound pipeline in
+  // its command buffer, binds can run from several recording threads
+  void setStatistics(PipelineStatistics<PipelineT>* statistics) {
+    statistics_ = statistics;
+  }
+  // Names the pipelines and layouts after their identifier, the ones created
+  // afterwards too
+  void setDebugUtils(const DebugUtils* debugUtils) {
+    debugUtils_ = debugUtils;
+    if (debugUtils_ == nullptr) {
+      return;
+    }
+    for (auto& [identifier, pipeline] : pipelines_) {
+      debugUtils_->setName(VK_OBJECT_TYPE_PIPELINE, pipeline, identifier);
+    }
+    for (auto& [identifier, layout] : pipelineLayouts_) {
+      debugUtils_->setName(VK_OBJECT_TYPE_PIPELINE_LAYOUT, layout, identifier);
+    }
+  }
+  // createComputePipelines and createGraphicsPipelines then build the
+  // pipelines in parallel
+  void setJobSystem(JobSystem* jobSystem) { jobSystem_ = jobSystem; }
+  // Pipelines created afterwards keep their shader statistics (needs
+  // VK_KHR_pipeline_executable_properties)
+  void enableExecutableStatistics() {
+    createFlags_ |= VK_PIPELINE_CREATE_CAPTURE_STATISTICS_BIT_KHR;
+  }
+  std::vector<PipelineExecutableReport> getExecutableReports(
+      PipelineT pipeline) const {
+    assert(pipelines_.contains(pipeline));
+    assert((createFlags_ & VK_PIPELINE_CREATE_CAPTURE_STATISTICS_BIT_KHR) &&
+           "Executable statistics weren't enabled");
+    return getPipelineExecutableReports(device_, pipelines_.at(pipeline));
+  }
+
   template <typename PushConstantT>
   void createLayout(PipelineLayoutT layoutIdentifier,
                     std::vector<VkDescriptorSetLayout> setLayouts,
@@ -53,12 +99,17 @@ class Pipelines {
     computePipelineLayoutInfo.pNext = nullptr;
     computePipelineLayoutInfo.flags = 0;
 
-    if (vkCreatePipelineLayout(device_, &computePipelineLayoutInfo, nullptr,
+    if (vkCreatePipelineLayout(device_, &computePipelineLayoutInfo, allocator_,
                                &pipelineLayouts_[layoutIdentifier]) !=
         VK_SUCCESS) {
       throw std::runtime_error("Failed to create pipeline layout");
     }
-    SPDLOG_LOGGER_INFO(get_vinkan_logger(), "Pipeline layout created");
+    if (debugUtils_ != nullptr) {
+      debugUtils_->setName(VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                           pipelineLayouts_[layoutIdentifier],
+                           layoutIdentifier);
+    }
+    SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Pipeline layout created");
   }
 
   VkPipelineBindPoint getBindPoint(PipelineT pipelineIdentifier) const {
@@ -70,11 +121,106 @@ class Pipelines {
   void createComputePipeline(
       PipelineT pipelineIdentifier,
       ComputePipelineInfo<PipelineLayoutT, ShaderInfoT> pipelineInfo) {
+    VINKAN_TRACE_SCOPE("Pipelines::createComputePipeline");
+    registerPipeline_(pipelineIdentifier, buildComputePipeline_(pipelineInfo),
+                      VK_PIPELINE_BIND_POINT_COMPUTE);
+  }
+
+  template <ValidShaderInfo ShaderInfoT>
+  void createGraphicsPipeline(
+      PipelineT pipelineIdentifier,
+      GraphicsPipelineInfo<PipelineLayoutT, ShaderInfoT> pipelineInfo) {
+    VINKAN_TRACE_SCOPE("Pipelines::createGraphicsPipeline");
+    registerPipeline_(pipelineIdentifier, buildGraphicsPipeline_(pipelineInfo),
+                      VK_PIPELINE_BIND_POINT_GRAPHICS);
+  }
+
+  // Compiled in parallel when a job system is set
+  template <ValidShaderInfo ShaderInfoT>
+  void createComputePipelines(
+      const std::vector<std::pair<
+          PipelineT, ComputePipelineInfo<PipelineLayoutT, ShaderInfoT>>>&
+          pipelineInfos) {
+    VINKAN_TRACE_SCOPE("Pipelines::createComputePipelines");
+    createPipelines_(pipelineInfos, VK_PIPELINE_BIND_POINT_COMPUTE,
+                     [this](const auto& pipelineInfo) {
+                       return buildComputePipeline_(pipelineInfo);
+                     });
+  }
+
+  template <ValidShaderInfo ShaderInfoT>
+  void createGraphicsPipelines(
+      const std::vector<std::pair<
+          PipelineT, GraphicsPipelineInfo<PipelineLayoutT, ShaderInfoT>>>&
+          pipelineInfos) {
+    VINKAN_TRACE_SCOPE("Pipelines::createGraphicsPipelines");
+    createPipelines_(pipelineInfos, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                     [this](const auto& pipelineInfo) {
+                       return buildGraphicsPipeline_(pipelineInfo);
+                     });
+  }
+
+  void bindCmdBuffer(VkCommandBuffer commandBuffer, PipelineT pipeline) {
+    assert(pipelines_.contains(pipeline));
+    auto bindPoint = pipelineToBindPoints_[pipeline];
+    deviceDispatch.vkCmdBindPipeline(commandBuffer, bindPoint,
+                                     pipelines_[pipeline]);
+    if (statistics_ != nullptr) {
+      statistics_->onBind(commandBuffer, pipeline);
+    }
+  }
+
+  // Workgroup size of a compute pipeline, reflected from its SPIR-V with its
+  // specialization constants
+  WorkgroupSize getWorkgroupSize(PipelineT pipeline) const {
+    assert(workgroupSizes_.contains(pipeline) &&
+           "Not a compute pipeline or its workgroup size isn't known");
+    return workgroupSizes_.at(pipeline);
+  }
+
+  VkPipeline getPipeline(PipelineT pipeline) const {
+    assert(pipelines_.contains(pipeline));
+    return pipelines_.at(pipeline);
+  }
+
+  VkPipelineLayout get(PipelineLayoutT pipelineLayout) {
+    assert(pipelineLayouts_.contains(pipelineLayout));
+    return pipelineLayouts_[pipelineLayout];
+  }
+
+ private:
+  VkDevice device_;
+  const VkAllocationCallbacks* allocator_;
+  VkPipelineCreateFlags createFlags_ = 0;
+  PipelineStatistics<PipelineT>* statistics_ = nullptr;
+  const DebugUtils* debugUtils_ = nullptr;
+  JobSystem* jobSystem_ = nullptr;
+
+  std::map<PipelineT, VkPipelineBindPoint> pipelineToBindPoints_;
+  std::map<PipelineT, VkPipeline> pipelines_;
+  std::map<PipelineLayoutT, VkPipelineLayout> pipelineLayouts_;
+  std::map<PipelineT, WorkgroupSize> workgroupSizes_;
+
+  struct BuiltPipeline_ {
+    VkPipeline pipeline;
+    // Compute pipelines only
+    std::optional<WorkgroupSize> workgroupSize{};
+  };
+
+  template <ValidShaderInfo ShaderInfoT>
+  BuiltPipeline_ buildComputePipeline_(
+      const ComputePipelineInfo<PipelineLayoutT, ShaderInfoT>& pipelineInfo) {
     assert(pipelineLayouts_.contains(pipelineInfo.layoutIdentifier));
-    auto pipelineLayout = pipelineLayouts_[pipelineInfo.layoutIdentifier];
+    auto pipelineLayout = pipelineLayouts_.at(pipelineInfo.layoutIdentifier);
 
-    ShaderModuleMaker moduleMaker(device_);
-    auto vkShaderStages = moduleMaker(pipelineInfo.shaderInfo);
+    auto shaderCode = readShaderCode(pipelineInfo.shaderInfo);
+    ShaderModuleMaker moduleMaker(device_, allocator_);
+    auto vkShaderStages = moduleMaker(ShaderRawInfo{
+        .shaderData = reinterpret_cast<const unsigned char*>(shaderCode.data()),
+        .shaderSize = shaderCode.size(),
+        .shaderStage = pipelineInfo.shaderInfo.shaderStage});
+    vkShaderStages.pSpecializationInfo = pipelineInfo.specializationInfo;
+    vkShaderStages.flags |= pipelineInfo.shaderStageFlags;
 
     VkComputePipelineCreateInfo computePipelineCreateInfo{};
     computePipelineCreateInfo.sType =
@@ -82,27 +228,35 @@ class Pipelines {
     computePipelineCreateInfo.stage = vkShaderStages;
     computePipelineCreateInfo.layout = pipelineLayout;
     computePipelineCreateInfo.pNext = nullptr;
-    computePipelineCreateInfo.flags = 0;
+    computePipelineCreateInfo.flags = createFlags_;
 
     VkPipeline pipeline;
     if (vkCreateComputePipelines(device_, VK_NULL_HANDLE, 1,
-                                 &computePipelineCreateInfo, nullptr,
+                                 &computePipelineCreateInfo, allocator_,
                                  &pipeline) != VK_SUCCESS) {
       throw std::runtime_error("Could not create the compute pipeline");
     }
-    pipelines_[pipelineIdentifier] = pipeline;
-    pipelineToBindPoints_[pipelineIdentifier] = VK_PIPELINE_BIND_POINT_COMPUTE;
 
-    SPDLOG_LOGGER_INFO(get_vinkan_logger(), "Pipeline created");
+    // Copied to words, the code of a raw shader info may not be aligned
+    std::vector<uint32_t> words(shaderCode.size() / sizeof(uint32_t));
+    std::memcpy(words.data(), shaderCode.data(),
+                words.size() * sizeof(uint32_t));
+    auto workgroupSize =
+        reflectWorkgroupSize(words.data(), words.size(), vkShaderStages.pName,
+                             pipelineInfo.specializationInfo);
+    if (!workgroupSize.has_value()) {
+      SPDLOG_LOGGER_WARN(get_vinkan_logger(),
+                         "Could not reflect a compute shader workgroup size");
+    }
+    return BuiltPipeline_{.pipeline = pipeline, .workgroupSize = workgroupSize};
   }
 
   template <ValidShaderInfo ShaderInfoT>
-  void createGraphicsPipeline(
-      PipelineT pipelineIdentifier,
-      GraphicsPipelineInfo<PipelineLayoutT, ShaderInfoT> pipelineInfo) {
+  BuiltPipeline_ buildGraphicsPipeline_(
+      const GraphicsPipelineInfo<PipelineLayoutT, ShaderInfoT>& pipelineInfo) {
     assert(pipelineLayouts_.contains(pipelineInfo.layoutIdentifier));
-    auto pipelineLayout = pipelineLayouts_[pipelineInfo.layoutIdentifier];
-    ShaderModuleMaker moduleMaker(device_);
+    auto pipelineLayout = pipelineLayouts_.at(pipelineInfo.layoutIdentifier);
+    ShaderModuleMaker moduleMaker(device_, allocator_);
     auto vertexShaderStage = moduleMaker(pipelineInfo.vertexShaderInfo);
     auto fragmentShaderStage = moduleMaker(pipelineInfo.fragmentShaderInfo);
     VkPipelineShaderStageCreateInfo shaderStages[] = {vertexShaderStage,
@@ -131,35 +285,63 @@ class Pipelines {
     graphicsPipelineCreateInfo.basePipelineIndex = -1;
     graphicsPipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
     graphicsPipelineCreateInfo.pNext = nullptr;
-    graphicsPipelineCreateInfo.flags = 0;
+    graphicsPipelineCreateInfo.flags = createFlags_;
     VkPipeline pipeline;
     if (vkCreateGraphicsPipelines(device_, VK_NULL_HANDLE, 1,
-                                  &graphicsPipelineCreateInfo, nullptr,
+                                  &graphicsPipelineCreateInfo, allocator_,
                                   &pipeline) != VK_SUCCESS) {
       throw std::runtime_error("Could not create the graphics pipeline");
     }
-    pipelines_[pipelineIdentifier] = pipeline;
-    pipelineToBindPoints_[pipelineIdentifier] = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    SPDLOG_LOGGER_INFO(get_vinkan_logger(), "Pipeline created");
+    return BuiltPipeline_{.pipeline = pipeline};
   }
 
-  void bindCmdBuffer(VkCommandBuffer commandBuffer, PipelineT pipeline) {
-    assert(pipelines_.contains(pipeline));
-    auto bindPoint = pipelineToBindPoints_[pipeline];
-    vkCmdBindPipeline(commandBuffer, bindPoint, pipelines_[pipeline]);
+  void registerPipeline_(PipelineT pipelineIdentifier,
+                         const BuiltPipeline_& built,
+                         VkPipelineBindPoint bindPoint) {
+    pipelines_[pipelineIdentifier] = built.pipeline;
+    pipelineToBindPoints_[pipelineIdentifier] = bindPoint;
+    if (built.workgroupSize.has_value()) {
+      workgroupSizes_[pipelineIdentifier] = *built.workgroupSize;
+    }
+    if (debugUtils_ != nullptr) {
+      debugUtils_->setName(VK_OBJECT_TYPE_PIPELINE, built.pipeline,
+                           pipelineIdentifier);
+    }
+    SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Pipeline created");
   }
 
-  VkPipelineLayout get(PipelineLayoutT pipelineLayout) {
-    assert(pipelineLayouts_.contains(pipelineLayout));
-    return pipelineLayouts_[pipelineLayout];
+  // The pipelines are built by the jobs, the maps are only filled afterwards
+  // on the calling thread
+  template <typename PipelineInfoT, typename BuildT>
+  void createPipelines_(
+      const std::vector<std::pair<PipelineT, PipelineInfoT>>& pipelineInfos,
+      VkPipelineBindPoint bindPoint, BuildT build) {
+    std::vector<BuiltPipeline_> pipelines(pipelineInfos.size(),
+                                          BuiltPipeline_{VK_NULL_HANDLE});
+    auto buildRange = [&](uint32_t begin, uint32_t end) {
+      for (uint32_t i = begin; i < end; ++i) {
+        pipelines[i] = build(pipelineInfos[i].second);
+      }
+    };
+    auto count = static_cast<uint32_t>(pipelineInfos.size());
+    try {
+      if (jobSystem_ != nullptr) {
+        jobSystem_->parallelFor(count, 1, buildRange);
+      } else {
+        buildRange(0, count);
+      }
+    } catch (...) {
+      for (auto& built : pipelines) {
+        if (built.pipeline != VK_NULL_HANDLE) {
+          vkDestroyPipeline(device_, built.pipeline, allocator_);
+        }
+      }
+      throw;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+      registerPipeline_(pipelineInfos[i].first, pipelines[i], bindPoint);
+    }
   }
-
- private:
-  VkDevice device_;
-
-  std::map<PipelineT, VkPipelineBindPoint> pipelineToBindPoints_;
-  std::map<PipelineT, VkPipeline> pipelines_;
-  std::map<PipelineLayoutT, VkPipelineLayout> pipelineLayouts_;
 };
 
 }  // namespace vinkan
@@ -1,17 +1,29 @@
 #include "shader_module_maker.hpp"
 
 #include "vinkan/logging/logger.hpp"
+#include "vinkan/logging/tracer.hpp"
 #include "vinkan/utils/file_io.hpp"
 namespace vinkan {
 
-ShaderModuleMaker::ShaderModuleMaker(VkDevice device) : device_(device) {}
+std::vector<char> readShaderCode(const ShaderRawInfo &shaderInfo) {
+  return std::vector<char>(shaderInfo.shaderData,
+                           shaderInfo.shaderData + shaderInfo.shaderSize);
+}
+
+std::vector<char> readShaderCode(const ShaderFileInfo &shaderInfo) {
+  return vinkan::readTextFile(shaderInfo.shaderFilepath);
+}
+
+ShaderModuleMaker::ShaderModuleMaker(VkDevice device,
+                                     const VkAllocationCallbacks *allocator)
+    : device_(device), allocator_(allocator) {}
 
 ShaderModuleMaker::~ShaderModuleMaker() {
   if (!device_) {
     return;
   }
   for (auto shaderModule : shaderModules_) {
-    vkDestroyShaderModule(device_, shaderModule, nullptr);
+    vkDestroyShaderModule(device_, shaderModule, allocator_);
   }
 }
 
@@ -23,19 +35,19 @@ VkShaderModule ShaderModuleMaker::createShaderModule_(
   createInfo.pCode = reinterpret_cast<const uint32_t *>(code.data());
 
   VkShaderModule shaderModule;
-  if (vkCreateShaderModule(device_, &createInfo, nullptr, &shaderModule) !=
+  if (vkCreateShaderModule(device_, &createInfo, allocator_, &shaderModule) !=
       VK_SUCCESS) {
     throw std::runtime_error("Failed to create shader module");
   }
-  SPDLOG_LOGGER_INFO(get_vinkan_logger(), "A shader module has been created");
+  SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "A shader module has been created");
   shaderModules_.push_back(shaderModule);
   return shaderModule;
 }
 
 VkPipelineShaderStageCreateInfo ShaderModuleMaker::operator()(
     ShaderRawInfo shaderInfo) {
-  std::vector<char> shaderCode(shaderInfo.shaderData,
-                               shaderInfo.shaderData + shaderInfo.shaderSize);
+  VINKAN_TRACE_SCOPE("ShaderModuleMaker::createModule");
+  auto shaderCode = readShaderCode(shaderInfo);
   auto shaderModule = createShaderModule_(shaderCode);
 
   VkPipelineShaderStageCreateInfo shaderStage;
@@ -52,7 +64,7 @@ VkPipelineShaderStageCreateInfo ShaderModuleMaker::operator()(
 
 VkPipelineShaderStageCreateInfo ShaderModuleMaker::operator()(
     ShaderFileInfo shaderInfo) {
-  auto shaderCode = vinkan::readTextFile(shaderInfo.shaderFilepath);
+  auto shaderCode = readShaderCode(shaderInfo);
   auto shaderData = reinterpret_cast<const unsigned char *>(shaderCode.data());
   auto shaderSize = shaderCode.size();
   return (*this)(ShaderRawInfo{.shaderData = shaderData,
@@ -19,9 +19,14 @@ struct ShaderFileInfo {
   VkShaderStageFlagBits shaderStage;
 };
 
+// The SPIR-V code of a shader, e.g. to reflect it
+std::vector<char> readShaderCode(const ShaderRawInfo &shaderInfo);
+std::vector<char> readShaderCode(const ShaderFileInfo &shaderInfo);
+
 class ShaderModuleMaker {
  public:
-  ShaderModuleMaker(VkDevice device);
+  ShaderModuleMaker(VkDevice device,
+                    const VkAllocationCallbacks *allocator = nullptr);
   ~ShaderModuleMaker();
 
   VkPipelineShaderStageCreateInfo operator()(ShaderRawInfo shaderInfo);
@@ -29,6 +34,7 @@ class ShaderModuleMaker {
 
  private:
   VkDevice device_;
+  const VkAllocationCallbacks *allocator_;
   std::vector<VkShaderModule> shaderModules_{};
 
   VkShaderModule createShaderModule_(const std::vector<char> &code);
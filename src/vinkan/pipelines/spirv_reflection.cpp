@@ -0,0 +1,161 @@
+#include "spirv_reflection.hpp"
+
+#include <cstring>
+#include <map>
+#include <string_view>
+#include <vector>
+
+namespace vinkan {
+
+namespace {
+
+// From the SPIR-V specification, only what the reflection needs
+constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+constexpr uint32_t SPIRV_HEADER_WORD_COUNT = 5;
+
+constexpr uint32_t OP_ENTRY_POINT = 15;
+constexpr uint32_t OP_EXECUTION_MODE = 16;
+constexpr uint32_t OP_CONSTANT = 43;
+constexpr uint32_t OP_CONSTANT_COMPOSITE = 44;
+constexpr uint32_t OP_SPEC_CONSTANT = 50;
+constexpr uint32_t OP_SPEC_CONSTANT_COMPOSITE = 51;
+constexpr uint32_t OP_DECORATE = 71;
+constexpr uint32_t OP_EXECUTION_MODE_ID = 331;
+
+constexpr uint32_t EXECUTION_MODEL_GL_COMPUTE = 5;
+constexpr uint32_t EXECUTION_MODE_LOCAL_SIZE = 17;
+constexpr uint32_t EXECUTION_MODE_LOCAL_SIZE_ID = 38;
+constexpr uint32_t DECORATION_SPEC_ID = 1;
+constexpr uint32_t DECORATION_BUILT_IN = 11;
+constexpr uint32_t BUILT_IN_WORKGROUP_SIZE = 25;
+
+}  // namespace
+
+std::optional<WorkgroupSize> reflectWorkgroupSize(
+    const uint32_t *code, size_t wordCount, const char *entryPoint,
+    const VkSpecializationInfo *specializationInfo) {
+  if (wordCount < SPIRV_HEADER_WORD_COUNT || code[0] != SPIRV_MAGIC) {
+    return std::nullopt;
+  }
+
+  std::optional<uint32_t> entryPointId{};
+  // Execution modes can appear before the entry point is known
+  std::map<uint32_t, WorkgroupSize> localSizes{};
+  std::map<uint32_t, std::vector<uint32_t>> localSizeIds{};
+  std::map<uint32_t, uint32_t> constants{};
+  std::map<uint32_t, uint32_t> specIds{};
+  std::map<uint32_t, std::vector<uint32_t>> composites{};
+  std::optional<uint32_t> workgroupSizeId{};
+
+  size_t offset = SPIRV_HEADER_WORD_COUNT;
+  while (offset < wordCount) {
+    uint32_t instructionWordCount = code[offset] >> 16;
+    uint32_t opcode = code[offset] & 0xffff;
+    if (instructionWordCount == 0 ||
+        offset + instructionWordCount > wordCount) {
+      return std::nullopt;
+    }
+    const uint32_t *operands = code + offset + 1;
+    uint32_t operandCount = instructionWordCount - 1;
+
+    switch (opcode) {
+      case OP_ENTRY_POINT:
+        if (operandCount >= 3 && operands[0] == EXECUTION_MODEL_GL_COMPUTE) {
+          // The name is a nul terminated string packed in the next words
+          auto nameBytes = reinterpret_cast<const char *>(operands + 2);
+          size_t maxLength = (operandCount - 2) * sizeof(uint32_t);
+          std::string_view name(nameBytes, strnlen(nameBytes, maxLength));
+          if (name == entryPoint) {
+            entryPointId = operands[1];
+          }
+        }
+        break;
+      case OP_EXECUTION_MODE:
+        if (operandCount >= 5 && operands[1] == EXECUTION_MODE_LOCAL_SIZE) {
+          localSizes[operands[0]] = {operands[2], operands[3], operands[4]};
+        }
+        break;
+      case OP_EXECUTION_MODE_ID:
+        if (operandCount >= 5 && operands[1] == EXECUTION_MODE_LOCAL_SIZE_ID) {
+          localSizeIds[operands[0]] = {operands[2], operands[3], operands[4]};
+        }
+        break;
+      case OP_DECORATE:
+        if (operandCount >= 3 && operands[1] == DECORATION_SPEC_ID) {
+          specIds[operands[0]] = operands[2];
+        } else if (operandCount >= 3 && operands[1] == DECORATION_BUILT_IN &&
+                   operands[2] == BUILT_IN_WORKGROUP_SIZE) {
+          workgroupSizeId = operands[0];
+        }
+        break;
+      case OP_CONSTANT:
+      case OP_SPEC_CONSTANT:
+        // Workgroup sizes are 32 bit integers, the low word is enough
+        if (operandCount >= 3) {
+          constants[operands[1]] = operands[2];
+        }
+        break;
+      case OP_CONSTANT_COMPOSITE:
+      case OP_SPEC_CONSTANT_COMPOSITE:
+        if (operandCount >= 2) {
+          composites[operands[1]].assign(operands + 2,
+                                         operands + operandCount);
+        }
+        break;
+      default:
+        break;
+    }
+    offset += instructionWordCount;
+  }
+  if (!entryPointId.has_value()) {
+    return std::nullopt;
+  }
+
+  auto resolve = [&](uint32_t id) -> std::optional<uint32_t> {
+    if (!constants.contains(id)) {
+      return std::nullopt;
+    }
+    uint32_t value = constants.at(id);
+    if (specializationInfo == nullptr || !specIds.contains(id)) {
+      return value;
+    }
+    uint32_t specId = specIds.at(id);
+    for (uint32_t i = 0; i < specializationInfo->mapEntryCount; ++i) {
+      const auto &entry = specializationInfo->pMapEntries[i];
+      if (entry.constantID == specId && entry.size == sizeof(uint32_t) &&
+          entry.offset + entry.size <= specializationInfo->dataSize) {
+        std::memcpy(&value,
+                    static_cast<const char *>(specializationInfo->pData) +
+                        entry.offset,
+                    sizeof(uint32_t));
+      }
+    }
+    return value;
+  };
+  auto resolveAll =
+      [&](const std::vector<uint32_t> &ids) -> std::optional<WorkgroupSize> {
+    if (ids.size() != 3) {
+      return std::nullopt;
+    }
+    auto x = resolve(ids[0]);
+    auto y = resolve(ids[1]);
+    auto z = resolve(ids[2]);
+    if (!x || !y || !z) {
+      return std::nullopt;
+    }
+    return WorkgroupSize{*x, *y, *z};
+  };
+
+  if (workgroupSizeId.has_value() && composites.contains(*workgroupSizeId)) {
+    return resolveAll(composites.at(*workgroupSizeId));
+  }
+  if (localSizeIds.contains(*entryPointId)) {
+    return resolveAll(localSizeIds.at(*entryPointId));
+  }
+  if (localSizes.contains(*entryPointId)) {
+    return localSizes.at(*entryPointId);
+  }
+  return std::nullopt;
+}
+
+}  // namespace vinkan
@@ -0,0 +1,34 @@
+#ifndef VINKAN_SPIRV_REFLECTION_HPP
+#define VINKAN_SPIRV_REFLECTION_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace vinkan {
+
+// Invocations per workgroup of a compute shader
+struct WorkgroupSize {
+  uint32_t x = 1;
+  uint32_t y = 1;
+  uint32_t z = 1;
+
+  bool operator==(const WorkgroupSize &) const = default;
+};
+
+// Reads the workgroup size of a compute entry point from its SPIR-V: the
+// LocalSize or LocalSizeId execution mode, or the WorkgroupSize built-in
+// which takes precedence. Specialization constants are resolved with the
+// given specialization info, or their default value.
+//
+// Returns nothing when the code isn't SPIR-V or has no such compute entry
+// point.
+std::optional<WorkgroupSize> reflectWorkgroupSize(
+    const uint32_t *code, size_t wordCount, const char *entryPoint = "main",
+    const VkSpecializationInfo *specializationInfo = nullptr);
+
+}  // namespace vinkan
+
+#endif
@@ -0,0 +1,255 @@
+#include "gpu_profiler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+#include "vinkan/logging/chrome_trace.hpp"
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
+
+namespace vinkan {
+
+GpuProfiler::GpuProfiler(VkDevice device, GpuProfilerInfo info,
+                         const VkAllocationCallbacks *allocator)
+    : device_(device),
+      allocator_(allocator),
+      info_(info),
+      calibratedTimestamps_(info.calibratedTimestamps) {
+  assert(info.framesInFlight > 0 && info.maxScopesPerFrame > 0);
+  assert(info.timestampValidBits > 0 &&
+         "The queue family doesn't support timestamps");
+  timestampMask_ = info.timestampValidBits >= 64
+                       ? UINT64_MAX
+                       : (uint64_t{1} << info.timestampValidBits) - 1;
+
+  if (calibratedTimestamps_) {
+    vkGetCalibratedTimestamps_ =
+        (PFN_vkGetCalibratedTimestampsEXT)vkGetDeviceProcAddr(
+            device_, "vkGetCalibratedTimestampsEXT");
+    if (vkGetCalibratedTimestamps_ == nullptr) {
+      SPDLOG_LOGGER_WARN(get_vinkan_logger(),
+                         "VK_EXT_calibrated_timestamps isn't enabled, GPU "
+                         "timestamps stay on the GPU clock");
+      calibratedTimestamps_ = false;
+    }
+  }
+
+  VkQueryPoolCreateInfo poolInfo{};
+  poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+  poolInfo.queryCount = 2 * info.maxScopesPerFrame;
+  slots_.resize(info.framesInFlight);
+  for (auto &slot : slots_) {
+    if (vkCreateQueryPool(device_, &poolInfo, allocator_, &slot.queryPool) !=
+        VK_SUCCESS) {
+      throw std::runtime_error("Failed to create the timestamp query pool");
+    }
+    // Queries must be reset once before their first use
+    if (info_.hostQueryReset) {
+      deviceDispatch.vkResetQueryPool(device_, slot.queryPool, 0,
+                                      poolInfo.queryCount);
+    }
+  }
+  SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "GPU profiler created");
+}
+
+GpuProfiler::~GpuProfiler() {
+  for (auto &slot : slots_) {
+    vkDestroyQueryPool(device_, slot.queryPool, allocator_);
+  }
+}
+
+void GpuProfiler::beginFrame(uint32_t frameIndex,
+                             VkCommandBuffer commandBuffer) {
+  assert(frameIndex < slots_.size());
+  assert(openScopes_ == 0 && "A scope of the previous frame wasn't ended");
+  assert((info_.hostQueryReset || commandBuffer != VK_NULL_HANDLE) &&
+         "The queries are reset in a command buffer without hostQueryReset");
+  currentSlot_ = frameIndex;
+  auto &slot = slots_[currentSlot_];
+  collect_(slot);
+
+  auto queryCount = 2 * info_.maxScopesPerFrame;
+  if (info_.hostQueryReset) {
+    deviceDispatch.vkResetQueryPool(device_, slot.queryPool, 0, queryCount);
+  } else {
+    deviceDispatch.vkCmdResetQueryPool(commandBuffer, slot.queryPool, 0,
+                                       queryCount);
+  }
+  slot.scopes.clear();
+  slot.usedQueries = 0;
+  slot.frame = frameCount_++;
+  if (calibratedTimestamps_ && !calibrate_(slot)) {
+    calibratedTimestamps_ = false;
+  }
+}
+
+uint32_t GpuProfiler::beginScope(VkCommandBuffer commandBuffer,
+                                 const char *name,
+                                 VkPipelineStageFlagBits stage) {
+  auto &slot = slots_[currentSlot_];
+  if (slot.usedQueries + 2 > 2 * info_.maxScopesPerFrame) {
+    droppedScopeCount_++;
+    return UINT32_MAX;
+  }
+  // The end query is reserved now so that nested scopes don't take it
+  uint32_t beginQuery = slot.usedQueries;
+  slot.usedQueries += 2;
+  deviceDispatch.vkCmdWriteTimestamp(commandBuffer, stage, slot.queryPool,
+                                     beginQuery);
+  slot.scopes.push_back(
+      Scope_{.name = name, .depth = openScopes_, .beginQuery = beginQuery});
+  openScopes_++;
+  return static_cast<uint32_t>(slot.scopes.size() - 1);
+}
+
+void GpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t scopeId,
+                           VkPipelineStageFlagBits stage) {
+  if (scopeId == UINT32_MAX) {
+    return;
+  }
+  auto &slot = slots_[currentSlot_];
+  assert(scopeId < slot.scopes.size() && openScopes_ > 0);
+  auto &scope = slot.scopes[scopeId];
+  scope.endQuery = scope.beginQuery + 1;
+  deviceDispatch.vkCmdWriteTimestamp(commandBuffer, stage, slot.queryPool,
+                                     scope.endQuery);
+  openScopes_--;
+}
+
+std::vector<GpuScopeStats> GpuProfiler::getStats() const {
+  std::vector<GpuScopeStats> stats{};
+  for (auto &[name, durations] : durationsMs_) {
+    if (durations.empty()) {
+      continue;
+    }
+    std::vector<double> sorted(durations.begin(), durations.end());
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.;
+    for (auto duration : sorted) {
+      sum += duration;
+    }
+    auto p99Index = static_cast<size_t>(0.99 * (sorted.size() - 1));
+    stats.push_back(GpuScopeStats{.name = name,
+                                  .count = sorted.size(),
+                                  .minMs = sorted.front(),
+                                  .meanMs = sum / sorted.size(),
+                                  .p99Ms = sorted[p99Index],
+                                  .maxMs = sorted.back()});
+  }
+  return stats;
+}
+
+void GpuProfiler::clear() {
+  durationsMs_.clear();
+  events_.clear();
+  droppedScopeCount_ = 0;
+}
+
+void GpuProfiler::writeChromeTrace(const std::string &filepath) const {
+  std::vector<ChromeTraceEvent> traceEvents{};
+  for (auto &event : events_) {
+    traceEvents.push_back(ChromeTraceEvent{
+        .name = event.name,
+        .category = "gpu",
+        .thread = "GPU",
+        .startUs = event.startUs,
+        .durationUs = event.durationUs,
+        .args = {{"frame", static_cast<int64_t>(event.frame)}}});
+  }
+  vinkan::writeChromeTrace(filepath, traceEvents);
+}
+
+void GpuProfiler::collect_(FrameSlot_ &slot) {
+  if (slot.usedQueries == 0) {
+    return;
+  }
+  // Value and availability of each query, never waits
+  std::vector<uint64_t> results(2 * slot.usedQueries);
+  deviceDispatch.vkGetQueryPoolResults(
+      device_, slot.queryPool, 0, slot.usedQueries,
+      results.size() * sizeof(uint64_t), results.data(), 2 * sizeof(uint64_t),
+      VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+  for (auto &scope : slot.scopes) {
+    if (scope.endQuery == UINT32_MAX) {
+      continue;
+    }
+    bool available = results[2 * scope.beginQuery + 1] != 0 &&
+                     results[2 * scope.endQuery + 1] != 0;
+    if (!available) {
+      droppedScopeCount_++;
+      continue;
+    }
+    uint64_t begin = results[2 * scope.beginQuery] & timestampMask_;
+    uint64_t end = results[2 * scope.endQuery] & timestampMask_;
+    // The counter may have wrapped between the two timestamps
+    double durationNs = ticksToNs_((end - begin) & timestampMask_);
+
+    double startNs;
+    if (calibratedTimestamps_) {
+      auto offsetTicks = static_cast<int64_t>(
+          (begin - slot.calibrationGpuTicks) & timestampMask_);
+      // Scopes can't start long before the calibration, a huge offset is a
+      // timestamp taken just before it
+      if (offsetTicks > static_cast<int64_t>(timestampMask_ >> 1)) {
+        offsetTicks -= static_cast<int64_t>(timestampMask_) + 1;
+      }
+      startNs = static_cast<double>(slot.calibrationCpuNs) +
+                static_cast<double>(offsetTicks) * info_.timestampPeriod;
+    } else {
+      startNs = ticksToNs_(begin);
+    }
+
+    auto &durations = durationsMs_[scope.name];
+    durations.push_back(durationNs / 1e6);
+    if (durations.size() > info_.historySize) {
+      durations.pop_front();
+    }
+    events_.push_back(GpuScopeEvent{.name = scope.name,
+                                    .frame = slot.frame,
+                                    .depth = scope.depth,
+                                    .startUs = startNs / 1e3,
+                                    .durationUs = durationNs / 1e3});
+  }
+  // Keep the events of the last historySize frames
+  while (!events_.empty() &&
+         events_.front().frame + info_.historySize < slot.frame) {
+    events_.pop_front();
+  }
+}
+
+bool GpuProfiler::calibrate_(FrameSlot_ &slot) {
+#if defined(_WIN32)
+  // The host domain there is the performance counter, not the steady clock
+  SPDLOG_LOGGER_WARN(get_vinkan_logger(),
+                     "Calibrated timestamps are only supported with "
+                     "CLOCK_MONOTONIC");
+  return false;
+#else
+  VkCalibratedTimestampInfoEXT timestampInfos[2]{};
+  timestampInfos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+  timestampInfos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+  timestampInfos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+  timestampInfos[1].timeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+  uint64_t timestamps[2];
+  uint64_t maxDeviation;
+  if (vkGetCalibratedTimestamps_(device_, 2, timestampInfos, timestamps,
+                                 &maxDeviation) != VK_SUCCESS) {
+    SPDLOG_LOGGER_WARN(get_vinkan_logger(),
+                       "Failed to calibrate the GPU timestamps");
+    return false;
+  }
+  slot.calibrationGpuTicks = timestamps[0] & timestampMask_;
+  // CLOCK_MONOTONIC is the steady clock of libstdc++ and libc++
+  slot.calibrationCpuNs = static_cast<int64_t>(timestamps[1]);
+  return true;
+#endif
+}
+
+double GpuProfiler::ticksToNs_(uint64_t ticks) const {
+  return static_cast<double>(ticks) * info_.timestampPeriod;
+}
+
+}  // namespace vinkan
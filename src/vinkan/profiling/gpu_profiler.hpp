@@ -0,0 +1,157 @@
+#ifndef VINKAN_GPU_PROFILER_HPP
+#define VINKAN_GPU_PROFILER_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "vinkan/generics/macros.hpp"
+
+namespace vinkan {
+
+struct GpuProfilerInfo {
+  // From VkPhysicalDeviceLimits, nanoseconds per timestamp tick
+  float timestampPeriod;
+  // From the VkQueueFamilyProperties of the profiled queue
+  uint32_t timestampValidBits = 64;
+  // Number of query pools in the ring, a slot is read back when it's begun
+  // again so it must be at least the number of frames in flight
+  uint32_t framesInFlight = 2;
+  uint32_t maxScopesPerFrame = 256;
+  // Reset the queries from the host (hostQueryReset feature) instead of
+  // recording the reset in the frame command buffer
+  bool hostQueryReset = false;
+  // VK_EXT_calibrated_timestamps must be enabled on the device, the GPU
+  // timestamps are then placed on the CPU steady clock
+  bool calibratedTimestamps = false;
+  // Durations kept per scope for the statistics
+  uint32_t historySize = 1024;
+};
+
+struct GpuScopeStats {
+  std::string name;
+  uint64_t count;
+  double minMs;
+  double meanMs;
+  double p99Ms;
+  double maxMs;
+};
+
+struct GpuScopeEvent {
+  std::string name;
+  uint64_t frame;
+  uint32_t depth;
+  // CPU steady clock with calibrated timestamps, GPU clock otherwise
+  double startUs;
+  double durationUs;
+};
+
+// GPU timings from timestamp queries.
+//
+// Each frame slot has its own query pool. The results of a slot are read
+// without waiting when the slot is begun again, i.e. once the frame fence
+// guarding it has been waited on (FrameManager::beginFrame does it).
+class GpuProfiler {
+ public:
+  GpuProfiler(VkDevice device, GpuProfilerInfo info,
+              const VkAllocationCallbacks *allocator = nullptr);
+  ~GpuProfiler();
+
+  GpuProfiler(const GpuProfiler &) = delete;
+  GpuProfiler &operator=(const GpuProfiler &) = delete;
+
+  // Collects the results left in the slot then resets its queries. Without
+  // hostQueryReset, the reset is recorded in the command buffer which must be
+  // the first one of the frame to be submitted.
+  void beginFrame(uint32_t frameIndex,
+                  VkCommandBuffer commandBuffer = VK_NULL_HANDLE);
+
+  // Scopes can be nested, they return an id for endScope. When the frame ran
+  // out of queries, the scope is dropped (id UINT32_MAX).
+  uint32_t beginScope(VkCommandBuffer commandBuffer, const char *name,
+                      VkPipelineStageFlagBits stage =
+                          VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+  void endScope(VkCommandBuffer commandBuffer, uint32_t scopeId,
+                VkPipelineStageFlagBits stage =
+                    VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+  std::vector<GpuScopeStats> getStats() const;
+  // Events of the collected frames, oldest first
+  const std::deque<GpuScopeEvent> &getEvents() const { return events_; }
+  void clear();
+
+  // Chrome trace event format, opened with chrome://tracing or Perfetto
+  void writeChromeTrace(const std::string &filepath) const;
+
+  uint64_t getDroppedScopeCount() const { return droppedScopeCount_; }
+  bool isCalibrated() const { return calibratedTimestamps_; }
+
+ private:
+  struct Scope_ {
+    std::string name;
+    uint32_t depth;
+    uint32_t beginQuery;
+    uint32_t endQuery = UINT32_MAX;
+  };
+  struct FrameSlot_ {
+    VkQueryPool queryPool;
+    std::vector<Scope_> scopes{};
+    uint32_t usedQueries = 0;
+    uint64_t frame = 0;
+    // GPU ticks and CPU nanoseconds sampled together at beginFrame
+    uint64_t calibrationGpuTicks = 0;
+    int64_t calibrationCpuNs = 0;
+  };
+
+  VkDevice device_;
+  const VkAllocationCallbacks *allocator_;
+  GpuProfilerInfo info_;
+  uint64_t timestampMask_;
+  bool calibratedTimestamps_;
+  PFN_vkGetCalibratedTimestampsEXT vkGetCalibratedTimestamps_ = nullptr;
+
+  std::vector<FrameSlot_> slots_{};
+  uint32_t currentSlot_ = 0;
+  uint64_t frameCount_ = 0;
+  uint32_t openScopes_ = 0;
+
+  std::map<std::string, std::deque<double>> durationsMs_{};
+  std::deque<GpuScopeEvent> events_{};
+  uint64_t droppedScopeCount_ = 0;
+
+  void collect_(FrameSlot_ &slot);
+  bool calibrate_(FrameSlot_ &slot);
+  double ticksToNs_(uint64_t ticks) const;
+};
+
+// Times the commands recorded until the end of the enclosing C++ scope
+class GpuScope {
+ public:
+  GpuScope(GpuProfiler &profiler, VkCommandBuffer commandBuffer,
+           const char *name)
+      : profiler_(profiler),
+        commandBuffer_(commandBuffer),
+        scopeId_(profiler.beginScope(commandBuffer, name)) {}
+  ~GpuScope() { profiler_.endScope(commandBuffer_, scopeId_); }
+
+  GpuScope(const GpuScope &) = delete;
+  GpuScope &operator=(const GpuScope &) = delete;
+
+ private:
+  GpuProfiler &profiler_;
+  VkCommandBuffer commandBuffer_;
+  uint32_t scopeId_;
+};
+
+}  // namespace vinkan
+
+#define VINKAN_GPU_SCOPE(profiler, commandBuffer, name)                  \
+  vinkan::GpuScope VINKAN_CONCAT_(vinkanGpuScope, __LINE__)(profiler,    \
+                                                            commandBuffer, \
+                                                            name)
+
+#endif
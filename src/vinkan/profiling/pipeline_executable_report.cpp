@@ -0,0 +1,94 @@
+#include "pipeline_executable_report.hpp"
+
+#include "vinkan/logging/logger.hpp"
+
+namespace vinkan {
+
+std::vector<PipelineExecutableReport> getPipelineExecutableReports(
+    VkDevice device, VkPipeline pipeline) {
+  auto getProperties = (PFN_vkGetPipelineExecutablePropertiesKHR)
+      vkGetDeviceProcAddr(device, "vkGetPipelineExecutablePropertiesKHR");
+  auto getStatistics = (PFN_vkGetPipelineExecutableStatisticsKHR)
+      vkGetDeviceProcAddr(device, "vkGetPipelineExecutableStatisticsKHR");
+  if (getProperties == nullptr || getStatistics == nullptr) {
+    SPDLOG_LOGGER_WARN(get_vinkan_logger(),
+                       "VK_KHR_pipeline_executable_properties isn't enabled");
+    return {};
+  }
+
+  VkPipelineInfoKHR pipelineInfo{};
+  pipelineInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INFO_KHR;
+  pipelineInfo.pipeline = pipeline;
+  uint32_t executableCount = 0;
+  if (getProperties(device, &pipelineInfo, &executableCount, nullptr) !=
+      VK_SUCCESS) {
+    return {};
+  }
+  std::vector<VkPipelineExecutablePropertiesKHR> properties(executableCount);
+  for (auto &property : properties) {
+    property.sType = VK_STRUCTURE_TYPE_PIPELINE_EXECUTABLE_PROPERTIES_KHR;
+  }
+  getProperties(device, &pipelineInfo, &executableCount, properties.data());
+
+  std::vector<PipelineExecutableReport> reports{};
+  for (uint32_t i = 0; i < executableCount; ++i) {
+    PipelineExecutableReport report{.name = properties[i].name,
+                                    .description = properties[i].description,
+                                    .stages = properties[i].stages,
+                                    .subgroupSize = properties[i].subgroupSize};
+
+    VkPipelineExecutableInfoKHR executableInfo{};
+    executableInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_EXECUTABLE_INFO_KHR;
+    executableInfo.pipeline = pipeline;
+    executableInfo.executableIndex = i;
+    uint32_t statisticCount = 0;
+    getStatistics(device, &executableInfo, &statisticCount, nullptr);
+    std::vector<VkPipelineExecutableStatisticKHR> statistics(statisticCount);
+    for (auto &statistic : statistics) {
+      statistic.sType = VK_STRUCTURE_TYPE_PIPELINE_EXECUTABLE_STATISTIC_KHR;
+    }
+    getStatistics(device, &executableInfo, &statisticCount,
+                  statistics.data());
+
+    for (auto &statistic : statistics) {
+      double value = 0.;
+      switch (statistic.format) {
+        case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_BOOL32_KHR:
+          value = statistic.value.b32 ? 1. : 0.;
+          break;
+        case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_INT64_KHR:
+          value = static_cast<double>(statistic.value.i64);
+          break;
+        case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_UINT64_KHR:
+          value = static_cast<double>(statistic.value.u64);
+          break;
+        case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_FLOAT64_KHR:
+          value = statistic.value.f64;
+          break;
+        default:
+          break;
+      }
+      report.statistics.push_back(
+          PipelineExecutableStatistic{.name = statistic.name,
+                                      .description = statistic.description,
+                                      .value = value});
+    }
+    reports.push_back(report);
+  }
+  return reports;
+}
+
+void logPipelineExecutableReports(
+    const std::string &pipelineName,
+    const std::vector<PipelineExecutableReport> &reports) {
+  for (auto &report : reports) {
+    SPDLOG_LOGGER_INFO(get_vinkan_logger(), "{} / {} (subgroup size {})",
+                       pipelineName, report.name, report.subgroupSize);
+    for (auto &statistic : report.statistics) {
+      SPDLOG_LOGGER_INFO(get_vinkan_logger(), "  {}: {}", statistic.name,
+                         statistic.value);
+    }
+  }
+}
+
+}  // namespace vinkan
@@ -0,0 +1,40 @@
+#ifndef VINKAN_PIPELINE_EXECUTABLE_REPORT_HPP
+#define VINKAN_PIPELINE_EXECUTABLE_REPORT_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <vector>
+
+namespace vinkan {
+
+struct PipelineExecutableStatistic {
+  std::string name;
+  std::string description;
+  // Booleans and integers are converted, e.g. register or spill counts
+  double value;
+};
+
+// One executable per compiled shader stage (or more, it's up to the driver)
+struct PipelineExecutableReport {
+  std::string name;
+  std::string description;
+  VkShaderStageFlags stages;
+  uint32_t subgroupSize;
+  std::vector<PipelineExecutableStatistic> statistics{};
+};
+
+// Driver statistics of a pipeline created with
+// VK_PIPELINE_CREATE_CAPTURE_STATISTICS_BIT_KHR. Needs the
+// VK_KHR_pipeline_executable_properties extension and its
+// pipelineExecutableInfo feature, returns nothing without them.
+std::vector<PipelineExecutableReport> getPipelineExecutableReports(
+    VkDevice device, VkPipeline pipeline);
+
+void logPipelineExecutableReports(
+    const std::string &pipelineName,
+    const std::vector<PipelineExecutableReport> &reports);
+
+}  // namespace vinkan
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef VINKAN_PIPELINE_STATISTICS_HPP
+#define VINKAN_PIPELINE_STATISTICS_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <bit>
+#include <cassert>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "vinkan/generics/concepts.hpp"
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
+
+namespace vinkan {
+
+struct PipelineStatisticsCounters {
+  uint64_t scopeCount = 0;
+  uint64_t inputAssemblyVertices = 0;
+  uint64_t inputAssemblyPrimitives = 0;
+  uint64_t vertexShaderInvocations = 0;
+  uint64_t clippingInvocations = 0;
+  uint64_t clippingPrimitives = 0;
+  uint64_t fragmentShaderInvocations = 0;
+  uint64_t computeShaderInvocations = 0;
+};
+
+// The counters of a query come back in the order of their flag bits
+inline constexpr std::pair<VkQueryPipelineStatisticFlags,
+                           uint64_t PipelineStatisticsCounters::*>
+    PIPELINE_STATISTICS_FIELDS[] = {
+        {VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT,
+         &PipelineStatisticsCounters::inputAssemblyVertices},
+        {VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT,
+         &PipelineStatisticsCounters::inputAssemblyPrimitives},
+        {VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT,
+         &PipelineStatisticsCounters::vertexShaderInvocations},
+        {VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT,
+         &PipelineStatisticsCounters::clippingInvocations},
+        {VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT,
+         &PipelineStatisticsCounters::clippingPrimitives},
+        {VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT,
+         &PipelineStatisticsCounters::fragmentShaderInvocations},
+        {VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT,
+         &PipelineStatisticsCounters::computeShaderInvocations},
+};
+
+inline constexpr VkQueryPipelineStatisticFlags ALL_PIPELINE_STATISTICS =
+    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+// Pipeline statistics queries aggregated per pipeline (pipelineStatisticsQuery
+// device feature).
+//
+// Once given to Pipelines::setStatistics, binding a pipeline ends the scope of
+// the previous one bound in the same command buffer and begins a query for
+// the new one. The last scope of each command buffer must be ended with
+// endScope before leaving the render pass (or the command buffer) it was
+// begun in. Like the GpuProfiler, a frame slot is read back without waiting
+// when it's begun again.
+//
+// Command buffers of a frame can be recorded from several threads, e.g. with
+// CommandCoordinator::recordCommandBuffers. beginFrame, getCounters and clear
+// are called outside of the recording.
+template <EnumType PipelineT>
+class PipelineStatistics {
+ public:
+  PipelineStatistics(VkDevice device, uint32_t framesInFlight = 2,
+                     uint32_t maxScopesPerFrame = 64,
+                     VkQueryPipelineStatisticFlags statisticFlags =
+                         ALL_PIPELINE_STATISTICS,
+                     const VkAllocationCallbacks *allocator = nullptr)
+      : device_(device),
+        allocator_(allocator),
+        maxScopesPerFrame_(maxScopesPerFrame),
+        statisticFlags_(statisticFlags),
+        counterCount_(std::popcount(statisticFlags)) {
+    assert(framesInFlight > 0 && counterCount_ > 0);
+    assert((statisticFlags & ~ALL_PIPELINE_STATISTICS) == 0 &&
+           "Unsupported pipeline statistic");
+    VkQueryPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    poolInfo.queryCount = maxScopesPerFrame;
+    poolInfo.pipelineStatistics = statisticFlags;
+    slots_.resize(framesInFlight);
+    for (auto &slot : slots_) {
+      if (vkCreateQueryPool(device_, &poolInfo, allocator_, &slot.queryPool) !=
+          VK_SUCCESS) {
+        throw std::runtime_error(
+            "Failed to create the pipeline statistics query pool");
+      }
+    }
+    SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Pipeline statistics created");
+  }
+  ~PipelineStatistics() {
+    for (auto &slot : slots_) {
+      vkDestroyQueryPool(device_, slot.queryPool, allocator_);
+    }
+  }
+
+  PipelineStatistics(const PipelineStatistics &) = delete;
+  PipelineStatistics &operator=(const PipelineStatistics &) = delete;
+
+  // Collects the slot results and records the reset of its queries, the
+  // command buffer must be outside of any render pass
+  void beginFrame(uint32_t frameIndex, VkCommandBuffer commandBuffer) {
+    assert(frameIndex < slots_.size());
+    std::lock_guard lock(mutex_);
+    assert(openQueries_.empty() && "A scope wasn't ended");
+    currentSlot_ = frameIndex;
+    auto &slot = slots_[currentSlot_];
+    collect_(slot);
+    deviceDispatch.vkCmdResetQueryPool(commandBuffer, slot.queryPool, 0,
+                                       maxScopesPerFrame_);
+    slot.scopePipelines.clear();
+  }
+
+  // Called by Pipelines::bindCmdBuffer
+  void onBind(VkCommandBuffer commandBuffer, PipelineT pipeline) {
+    std::lock_guard lock(mutex_);
+    endScope_(commandBuffer);
+    auto &slot = slots_[currentSlot_];
+    if (slot.scopePipelines.size() >= maxScopesPerFrame_) {
+      droppedScopeCount_++;
+      return;
+    }
+    auto query = static_cast<uint32_t>(slot.scopePipelines.size());
+    slot.scopePipelines.push_back(pipeline);
+    deviceDispatch.vkCmdBeginQuery(commandBuffer, slot.queryPool, query, 0);
+    openQueries_[commandBuffer] = query;
+  }
+
+  // Ends the scope begun in this command buffer, if any
+  void endScope(VkCommandBuffer commandBuffer) {
+    std::lock_guard lock(mutex_);
+    endScope_(commandBuffer);
+  }
+
+  const std::map<PipelineT, PipelineStatisticsCounters> &getCounters() const {
+    return counters_;
+  }
+  void clear() {
+    std::lock_guard lock(mutex_);
+    counters_.clear();
+    droppedScopeCount_ = 0;
+  }
+  uint64_t getDroppedScopeCount() const {
+    std::lock_guard lock(mutex_);
+    return droppedScopeCount_;
+  }
+
+ private:
+  struct FrameSlot_ {
+    VkQueryPool queryPool;
+    std::vector<PipelineT> scopePipelines{};
+  };
+
+  VkDevice device_;
+  const VkAllocationCallbacks *allocator_;
+  uint32_t maxScopesPerFrame_;
+  VkQueryPipelineStatisticFlags statisticFlags_;
+  uint32_t counterCount_;
+
+  // Guards the slots, the open queries and the dropped scope count
+  mutable std::mutex mutex_;
+  std::vector<FrameSlot_> slots_{};
+  uint32_t currentSlot_ = 0;
+  // A query is begun and ended in the same command buffer
+  std::map<VkCommandBuffer, uint32_t> openQueries_{};
+
+  std::map<PipelineT, PipelineStatisticsCounters> counters_{};
+  uint64_t droppedScopeCount_ = 0;
+
+  void endScope_(VkCommandBuffer commandBuffer) {
+    auto it = openQueries_.find(commandBuffer);
+    if (it == openQueries_.end()) {
+      return;
+    }
+    deviceDispatch.vkCmdEndQuery(commandBuffer, slots_[currentSlot_].queryPool,
+                                 it->second);
+    openQueries_.erase(it);
+  }
+
+  void collect_(FrameSlot_ &slot) {
+    auto queryCount = static_cast<uint32_t>(slot.scopePipelines.size());
+    if (queryCount == 0) {
+      return;
+    }
+    // The counters of each query followed by its availability
+    auto stride = counterCount_ + 1;
+    std::vector<uint64_t> results(queryCount * stride);
+    deviceDispatch.vkGetQueryPoolResults(
+        device_, slot.queryPool, 0, queryCount,
+        results.size() * sizeof(uint64_t), results.data(),
+        stride * sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+    for (uint32_t query = 0; query < queryCount; ++query) {
+      const uint64_t *values = &results[query * stride];
+      if (values[counterCount_] == 0) {
+        droppedScopeCount_++;
+        continue;
+      }
+      auto &counters = counters_[slot.scopePipelines[query]];
+      counters.scopeCount++;
+      uint32_t valueIndex = 0;
+      for (auto &[flag, field] : PIPELINE_STATISTICS_FIELDS) {
+        if (statisticFlags_ & flag) {
+          counters.*field += values[valueIndex++];
+        }
+      }
+    }
+  }
+};
+
+}  // namespace vinkan
+
+#endif
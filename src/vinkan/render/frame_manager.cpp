@@ -0,0 +1,207 @@
+#include "frame_manager.hpp"
+
+#include <cassert>
+#include <stdexcept>
+
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/logging/tracer.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
+
+namespace vinkan {
+
+FrameManager::FrameManager(VkDevice device, Swapchain &swapchain,
+                           uint32_t queueFamilyIndex, uint32_t framesInFlight,
+                           const VkAllocationCallbacks *allocator)
+    : device_(device), allocator_(allocator), swapchain_(swapchain) {
+  assert(framesInFlight > 0);
+
+  VkCommandPoolCreateInfo poolInfo{};
+  poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  poolInfo.queueFamilyIndex = queueFamilyIndex;
+  if (vkCreateCommandPool(device_, &poolInfo, allocator_, &commandPool_) !=
+      VK_SUCCESS) {
+    throw std::runtime_error("Failed to create the frames command pool");
+  }
+
+  std::vector<VkCommandBuffer> commandBuffers(framesInFlight);
+  VkCommandBufferAllocateInfo allocInfo{};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.commandPool = commandPool_;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandBufferCount = framesInFlight;
+  if (deviceDispatch.vkAllocateCommandBuffers(
+          device_, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to allocate the frames command buffers");
+  }
+
+  // Fences start signaled so that the first beginFrame of each slot doesn't
+  // block
+  VkFenceCreateInfo fenceInfo{};
+  fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+  VkSemaphoreCreateInfo semaphoreInfo{};
+  semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+  frames_.resize(framesInFlight);
+  for (uint32_t i = 0; i < framesInFlight; ++i) {
+    auto &frame = frames_[i];
+    frame.commandBuffer = commandBuffers[i];
+    if (vkCreateFence(device_, &fenceInfo, allocator_, &frame.fence) !=
+            VK_SUCCESS ||
+        vkCreateSemaphore(device_, &semaphoreInfo, allocator_,
+                          &frame.acquireSemaphore) != VK_SUCCESS) {
+      throw std::runtime_error("Failed to create the frame sync objects");
+    }
+  }
+
+  auto imageCount = static_cast<uint32_t>(swapchain_.getImageViews().size());
+  presentSemaphores_.resize(imageCount);
+  for (auto &semaphore : presentSemaphores_) {
+    if (vkCreateSemaphore(device_, &semaphoreInfo, allocator_, &semaphore) !=
+        VK_SUCCESS) {
+      throw std::runtime_error("Failed to create the present semaphores");
+    }
+  }
+  imagesInFlight_.resize(imageCount, VK_NULL_HANDLE);
+  SPDLOG_LOGGER_INFO(get_vinkan_logger(),
+                     "Frame manager created with {} frames in flight",
+                     framesInFlight);
+}
+
+FrameManager::~FrameManager() {
+  std::vector<VkFence> fences;
+  for (auto &frame : frames_) {
+    fences.push_back(frame.fence);
+  }
+  deviceDispatch.vkWaitForFences(device_, static_cast<uint32_t>(fences.size()),
+                                 fences.data(), VK_TRUE, UINT64_MAX);
+  // Presentation doesn't signal a fence, the semaphores may still be in use
+  deviceDispatch.vkDeviceWaitIdle(device_);
+
+  for (auto &frame : frames_) {
+    runDeferredReleases_(frame);
+    vkDestroyFence(device_, frame.fence, allocator_);
+    vkDestroySemaphore(device_, frame.acquireSemaphore, allocator_);
+  }
+  for (auto semaphore : presentSemaphores_) {
+    vkDestroySemaphore(device_, semaphore, allocator_);
+  }
+  vkDestroyCommandPool(device_, commandPool_, allocator_);
+}
+
+std::optional<FrameContext> FrameManager::beginFrame() {
+  VINKAN_TRACE_SCOPE("FrameManager::beginFrame");
+  assert(!currentImage_.has_value() && "The previous frame wasn't ended");
+  auto &frame = frames_[currentFrame_];
+
+  deviceDispatch.vkWaitForFences(device_, 1, &frame.fence, VK_TRUE, UINT64_MAX);
+  runDeferredReleases_(frame);
+
+  auto imageIndexOpt = swapchain_.acquireNextImageIndex(frame.acquireSemaphore);
+  if (!imageIndexOpt.has_value()) {
+    return std::nullopt;
+  }
+  auto imageIndex = imageIndexOpt.value();
+  assert(imageIndex < imagesInFlight_.size());
+
+  // With more images than frames an image can be acquired while an older
+  // frame slot still renders to it
+  VkFence imageFence = imagesInFlight_[imageIndex];
+  if (imageFence != VK_NULL_HANDLE && imageFence != frame.fence) {
+    deviceDispatch.vkWaitForFences(device_, 1, &imageFence, VK_TRUE,
+                                   UINT64_MAX);
+  }
+  imagesInFlight_[imageIndex] = frame.fence;
+
+  // Only reset once we know the frame will be submitted
+  deviceDispatch.vkResetFences(device_, 1, &frame.fence);
+
+  if (deviceDispatch.vkResetCommandBuffer(frame.commandBuffer, 0) !=
+      VK_SUCCESS) {
+    throw std::runtime_error("Failed to reset the frame command buffer");
+  }
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  if (deviceDispatch.vkBeginCommandBuffer(frame.commandBuffer, &beginInfo) !=
+      VK_SUCCESS) {
+    throw std::runtime_error("Failed to begin the frame command buffer");
+  }
+
+  currentImage_ = imageIndex;
+  submittedCommandBuffers_ = {frame.commandBuffer};
+  return FrameContext{.commandBuffer = frame.commandBuffer,
+                      .frameIndex = currentFrame_,
+                      .imageIndex = imageIndex};
+}
+
+void FrameManager::endFrame(VkQueue queue, SubmitBatch *batch) {
+  endFrame(queue, queue, batch);
+}
+
+void FrameManager::endFrame(VkQueue queue, VkQueue presentQueue,
+                            SubmitBatch *batch) {
+  VINKAN_TRACE_SCOPE("FrameManager::endFrame");
+  assert(currentImage_.has_value() && "No frame has begun");
+  auto &frame = frames_[currentFrame_];
+  auto imageIndex = currentImage_.value();
+
+  if (deviceDispatch.vkEndCommandBuffer(frame.commandBuffer) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to record the frame command buffer");
+  }
+
+  VkSemaphore presentSemaphore = presentSemaphores_[imageIndex];
+  SubmitCommandBufferInfo submitInfo{
+      .waitSemaphores = {frame.acquireSemaphore},
+      .waitDstStages = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT},
+      .signalSemaphores = {presentSemaphore},
+      .signalFence = VK_NULL_HANDLE,
+      .queue = queue};
+  if (batch != nullptr) {
+    assert(batch->getQueue() == queue);
+    batch->add(submittedCommandBuffers_, submitInfo);
+    batch->flush(frame.fence);
+  } else {
+    VkSubmitInfo vkSubmitInfo{};
+    vkSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    vkSubmitInfo.waitSemaphoreCount = 1;
+    vkSubmitInfo.pWaitSemaphores = submitInfo.waitSemaphores.data();
+    vkSubmitInfo.pWaitDstStageMask = submitInfo.waitDstStages.data();
+    vkSubmitInfo.commandBufferCount =
+        static_cast<uint32_t>(submittedCommandBuffers_.size());
+    vkSubmitInfo.pCommandBuffers = submittedCommandBuffers_.data();
+    vkSubmitInfo.signalSemaphoreCount = 1;
+    vkSubmitInfo.pSignalSemaphores = &presentSemaphore;
+    if (deviceDispatch.vkQueueSubmit(queue, 1, &vkSubmitInfo, frame.fence) !=
+        VK_SUCCESS) {
+      throw std::runtime_error("Failed to submit the frame");
+    }
+  }
+
+  swapchain_.present(imageIndex, presentQueue, presentSemaphore);
+
+  currentImage_ = std::nullopt;
+  currentFrame_ = (currentFrame_ + 1) % frames_.size();
+}
+
+void FrameManager::submitWithFrame(VkCommandBuffer commandBuffer) {
+  assert(currentImage_.has_value() &&
+         "Command buffers are submitted with a frame from within it");
+  submittedCommandBuffers_.push_back(commandBuffer);
+}
+
+void FrameManager::deferRelease(std::function<void()> release) {
+  assert(currentImage_.has_value() &&
+         "Releases are deferred from within a frame");
+  frames_[currentFrame_].deferredReleases.push_back(std::move(release));
+}
+
+void FrameManager::runDeferredReleases_(Frame_ &frame) {
+  for (auto &release : frame.deferredReleases) {
+    release();
+  }
+  frame.deferredReleases.clear();
+}
+
+}  // namespace vinkan
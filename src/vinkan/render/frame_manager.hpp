@@ -0,0 +1,98 @@
+#ifndef VINKAN_FRAME_MANAGER_HPP
+#define VINKAN_FRAME_MANAGER_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "vinkan/commands/submit_batch.hpp"
+#include "vinkan/wrappers/swapchain.hpp"
+
+namespace vinkan {
+
+struct FrameContext {
+  VkCommandBuffer commandBuffer;
+  uint32_t frameIndex;  // In [0, framesInFlight[
+  uint32_t imageIndex;  // Swapchain image to render to
+};
+
+// Owns the per-frame objects of a render loop so that the CPU records frame
+// N + 1 while the GPU renders frame N.
+//
+// Each frame has its own command buffer, fence and acquire semaphore. The
+// semaphores signaled for presentation are owned per swapchain image: the
+// presentation engine only releases them when the image is acquired again,
+// which isn't tied to the frame that used them.
+class FrameManager {
+ public:
+  FrameManager(VkDevice device, Swapchain &swapchain,
+               uint32_t queueFamilyIndex, uint32_t framesInFlight = 2,
+               const VkAllocationCallbacks *allocator = nullptr);
+  // Waits for every frame in flight before destroying the frame objects
+  ~FrameManager();
+
+  FrameManager(const FrameManager &) = delete;
+  FrameManager &operator=(const FrameManager &) = delete;
+
+  // Waits for the frame slot to be free, acquires the next swapchain image
+  // and begins the frame command buffer. Returns nullopt if the image couldn't
+  // be acquired (e.g. out of date swapchain), the frame must not be ended then.
+  std::optional<FrameContext> beginFrame();
+
+  // Ends and submits the frame command buffer then presents the image.
+  // If a batch is given, the frame submission is added to it and the batch is
+  // flushed with the frame fence, so that pending submissions of the frame are
+  // sent in the same vkQueueSubmit. The batch queue must be the given queue.
+  void endFrame(VkQueue queue, SubmitBatch *batch = nullptr);
+  // When the queue presenting isn't the one rendering
+  void endFrame(VkQueue queue, VkQueue presentQueue,
+                SubmitBatch *batch = nullptr);
+
+  // Must be called between beginFrame and endFrame. The command buffer (e.g.
+  // a prerecorded one) is submitted with the frame, after the frame command
+  // buffer, so it waits for the image acquisition too.
+  void submitWithFrame(VkCommandBuffer commandBuffer);
+
+  // Must be called between beginFrame and endFrame. The release runs once the
+  // GPU is done with the current frame, i.e. when this frame slot is begun
+  // again (or when the manager is destroyed).
+  void deferRelease(std::function<void()> release);
+
+  uint32_t getFramesInFlight() const {
+    return static_cast<uint32_t>(frames_.size());
+  }
+  uint32_t getImageCount() const {
+    return static_cast<uint32_t>(presentSemaphores_.size());
+  }
+  uint32_t getCurrentFrameIndex() const { return currentFrame_; }
+
+ private:
+  struct Frame_ {
+    VkCommandBuffer commandBuffer;
+    VkFence fence;
+    VkSemaphore acquireSemaphore;
+    std::vector<std::function<void()>> deferredReleases{};
+  };
+
+  VkDevice device_;
+  const VkAllocationCallbacks *allocator_;
+  Swapchain &swapchain_;
+  VkCommandPool commandPool_;
+  std::vector<Frame_> frames_{};
+  std::vector<VkSemaphore> presentSemaphores_{};
+  // Fence of the frame currently using each swapchain image
+  std::vector<VkFence> imagesInFlight_{};
+  // Frame command buffer followed by the ones of submitWithFrame
+  std::vector<VkCommandBuffer> submittedCommandBuffers_{};
+
+  uint32_t currentFrame_ = 0;
+  std::optional<uint32_t> currentImage_ = std::nullopt;
+
+  void runDeferredReleases_(Frame_ &frame);
+};
+
+}  // namespace vinkan
+
+#endif
@@ -0,0 +1,619 @@
+#ifndef VINKAN_RENDER_GRAPH_HPP
+#define VINKAN_RENDER_GRAPH_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "vinkan/generics/concepts.hpp"
+#include "vinkan/logging/debug_utils.hpp"
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/logging/tracer.hpp"
+#include "vinkan/sync/barriers.hpp"
+#include "vinkan/sync/resource_state.hpp"
+#include "vinkan/wrappers/buffer.hpp"
+
+namespace vinkan {
+
+template <EnumType ResourceT>
+struct ResourceAccess {
+  ResourceT resource;
+  VkPipelineStageFlags2 stageMask;
+  VkAccessFlags2 accessMask;
+  // Images only, layout the pass needs the image in
+  VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+  // Images only, when the pass changes the layout itself (e.g. the finalLayout
+  // of a render pass attachment)
+  std::optional<VkImageLayout> layoutAfterPass = std::nullopt;
+};
+
+template <EnumType ResourceT>
+struct RenderGraphPassInfo {
+  std::string name;
+  std::vector<ResourceAccess<ResourceT>> reads{};
+  std::vector<ResourceAccess<ResourceT>> writes{};
+  // Kept even if nothing reads what it writes (e.g. readback to the host)
+  bool hasSideEffects = false;
+};
+
+struct TransientBufferInfo {
+  VkDeviceSize size;
+  VkBufferUsageFlags usageFlags;
+};
+
+// Frame graph on top of the command buffers: passes declare the buffers and
+// images they read and write, the graph then
+// - culls the passes that don't contribute to an output
+// - computes the barriers (and layout transitions) between the passes
+// - aliases the memory of transient buffers whose lifetimes don't overlap
+// - records everything in one or more command buffers
+//
+// The graph is built once, compiled once, then executed every frame. Imported
+// images can change between executions (e.g. the swapchain image).
+template <EnumType ResourceT>
+class RenderGraph {
+ public:
+  using RecordFunction = std::function<void(VkCommandBuffer)>;
+
+  RenderGraph(VkDevice device,
+              VkPhysicalDeviceMemoryProperties deviceMemoryProperties,
+              const VkAllocationCallbacks *allocator = nullptr)
+      : device_(device),
+        allocator_(allocator),
+        deviceMemoryProperties_(deviceMemoryProperties) {}
+
+  ~RenderGraph() {
+    for (auto &[identifier, resource] : resources_) {
+      if (resource.kind == ResourceKind_::TRANSIENT_BUFFER &&
+          resource.buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device_, resource.buffer, allocator_);
+      }
+    }
+    if (transientMemory_ != VK_NULL_HANDLE) {
+      vkFreeMemory(device_, transientMemory_, allocator_);
+    }
+  }
+
+  RenderGraph(const RenderGraph &) = delete;
+  RenderGraph &operator=(const RenderGraph &) = delete;
+
+  // Must be set before compile. The passes are then labeled with their name
+  // and the transient buffers named after their identifier.
+  void setDebugUtils(const DebugUtils *debugUtils) {
+    assert(!compiled_);
+    debugUtils_ = debugUtils;
+  }
+
+  // Resources
+  void importBuffer(ResourceT resourceIdentifier, VkBuffer buffer) {
+    addResource_(resourceIdentifier,
+                 Resource_{.kind = ResourceKind_::IMPORTED_BUFFER,
+                           .buffer = buffer});
+  }
+  void importBuffer(ResourceT resourceIdentifier, Buffer &buffer) {
+    importBuffer(resourceIdentifier, buffer.getHandle());
+  }
+
+  // The image is expected in initialLayout at the start of every execution,
+  // if a finalLayout is given it's transitioned to it after the last pass.
+  void importImage(ResourceT resourceIdentifier, VkImage image,
+                   VkImageLayout initialLayout,
+                   std::optional<VkImageLayout> finalLayout = std::nullopt,
+                   VkImageSubresourceRange subresourceRange = {
+                       .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                       .baseMipLevel = 0,
+                       .levelCount = VK_REMAINING_MIP_LEVELS,
+                       .baseArrayLayer = 0,
+                       .layerCount = VK_REMAINING_ARRAY_LAYERS}) {
+    addResource_(resourceIdentifier,
+                 Resource_{.kind = ResourceKind_::IMPORTED_IMAGE,
+                           .image = image,
+                           .subresourceRange = subresourceRange,
+                           .initialLayout = initialLayout,
+                           .finalLayout = finalLayout});
+  }
+
+  void setImportedImage(ResourceT resourceIdentifier, VkImage image) {
+    assert(resources_.contains(resourceIdentifier));
+    auto &resource = resources_.at(resourceIdentifier);
+    assert(resource.kind == ResourceKind_::IMPORTED_IMAGE);
+    resource.image = image;
+  }
+
+  // Owned by the graph, the buffer only exists between its first and last
+  // pass so its memory can be reused by other transient buffers.
+  void createTransientBuffer(ResourceT resourceIdentifier,
+                             TransientBufferInfo bufferInfo) {
+    addResource_(resourceIdentifier,
+                 Resource_{.kind = ResourceKind_::TRANSIENT_BUFFER,
+                           .transientInfo = bufferInfo});
+  }
+
+  // Outputs are what the graph is executed for, the passes that don't
+  // contribute to an output (or have side effects) are culled.
+  void markOutput(ResourceT resourceIdentifier) {
+    assert(resources_.contains(resourceIdentifier));
+    resources_.at(resourceIdentifier).isOutput = true;
+  }
+
+  // Passes are executed in the order they're added
+  void addPass(RenderGraphPassInfo<ResourceT> passInfo,
+               RecordFunction recordFunction) {
+    assert(!compiled_ && "Passes must be added before compiling");
+    for (auto &access : passInfo.reads) {
+      assert(resources_.contains(access.resource));
+    }
+    for (auto &access : passInfo.writes) {
+      assert(resources_.contains(access.resource));
+    }
+    passes_.push_back(Pass_{.info = std::move(passInfo),
+                            .recordFunction = std::move(recordFunction)});
+  }
+
+  void compile() {
+    VINKAN_TRACE_SCOPE("RenderGraph::compile");
+    assert(!compiled_ && "The graph is already compiled");
+    cullPasses_();
+    computeLifetimes_();
+    allocateTransientBuffers_();
+    computeBarriers_();
+    compiled_ = true;
+
+    SPDLOG_LOGGER_INFO(
+        get_vinkan_logger(),
+        "Render graph compiled: {}/{} passes kept, {} bytes of transient "
+        "memory ({} without aliasing)",
+        getKeptPassCount(), passes_.size(), transientMemorySize_,
+        transientMemorySizeWithoutAliasing_);
+  }
+
+  void execute(VkCommandBuffer commandBuffer, bool synchronization2) {
+    execute(std::vector<VkCommandBuffer>{commandBuffer}, synchronization2);
+  }
+
+  // The kept passes are split in order between the command buffers, which
+  // must then be submitted in that order to the same queue.
+  //
+  // The first access of each resource waits for its last access in the
+  // previous execution, as long as the executions are submitted to the same
+  // queue. An imported image used outside of the graph in between (e.g. an
+  // acquired swapchain image) must be handed back with a semaphore waited at
+  // the stages of its first access.
+  void execute(const std::vector<VkCommandBuffer> &commandBuffers,
+               bool synchronization2) {
+    assert(compiled_ && "The graph must be compiled before being executed");
+    assert(!commandBuffers.empty());
+
+    std::vector<uint32_t> keptPasses{};
+    for (uint32_t i = 0; i < passes_.size(); ++i) {
+      if (!passes_[i].culled) {
+        keptPasses.push_back(i);
+      }
+    }
+    auto passesPerBuffer =
+        (keptPasses.size() + commandBuffers.size() - 1) / commandBuffers.size();
+
+    BarrierBatch barrierBatch;
+    for (size_t n = 0; n < keptPasses.size(); ++n) {
+      VkCommandBuffer commandBuffer = commandBuffers[n / passesPerBuffer];
+      auto &pass = passes_[keptPasses[n]];
+      addBarriers_(barrierBatch, pass.barriers);
+      barrierBatch.record(commandBuffer, synchronization2);
+      if (debugUtils_ != nullptr) {
+        debugUtils_->beginLabel(commandBuffer, pass.info.name.c_str());
+      }
+      pass.recordFunction(commandBuffer);
+      if (debugUtils_ != nullptr) {
+        debugUtils_->endLabel(commandBuffer);
+      }
+    }
+    addBarriers_(barrierBatch, finalBarriers_);
+    barrierBatch.record(commandBuffers.back(), synchronization2);
+  }
+
+  // Handle of a transient buffer, only valid after compile
+  VkBuffer getBuffer(ResourceT resourceIdentifier) {
+    assert(compiled_);
+    assert(resources_.contains(resourceIdentifier));
+    return resources_.at(resourceIdentifier).buffer;
+  }
+
+  uint32_t getKeptPassCount() const {
+    return static_cast<uint32_t>(
+        std::count_if(passes_.begin(), passes_.end(),
+                      [](const Pass_ &pass) { return !pass.culled; }));
+  }
+  bool isPassCulled(const std::string &passName) const {
+    for (auto &pass : passes_) {
+      if (pass.info.name == passName) {
+        return pass.culled;
+      }
+    }
+    return false;
+  }
+  VkDeviceSize getTransientMemorySize() const { return transientMemorySize_; }
+
+ private:
+  enum class ResourceKind_ { IMPORTED_BUFFER, TRANSIENT_BUFFER, IMPORTED_IMAGE };
+
+  struct Resource_ {
+    ResourceKind_ kind;
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkImage image = VK_NULL_HANDLE;
+    VkImageSubresourceRange subresourceRange{};
+    VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    std::optional<VkImageLayout> finalLayout = std::nullopt;
+    TransientBufferInfo transientInfo{};
+    bool isOutput = false;
+
+    // Set by compile
+    std::optional<uint32_t> firstPass = std::nullopt;
+    uint32_t lastPass = 0;
+    VkDeviceSize memoryOffset = 0;
+    VkDeviceSize memorySize = 0;
+  };
+
+  struct ResourceBarrier_ {
+    ResourceT resource;
+    // Memory barriers are used for aliasing, they don't target the resource
+    bool isMemoryBarrier = false;
+    VkPipelineStageFlags2 srcStageMask;
+    VkAccessFlags2 srcAccessMask;
+    VkPipelineStageFlags2 dstStageMask;
+    VkAccessFlags2 dstAccessMask;
+    VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkImageLayout newLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  };
+
+  struct Pass_ {
+    RenderGraphPassInfo<ResourceT> info;
+    RecordFunction recordFunction;
+    bool culled = false;
+    std::vector<ResourceBarrier_> barriers{};
+  };
+
+  // Every access of a pass to one resource merged together
+  struct MergedAccess_ {
+    VkPipelineStageFlags2 stageMask = 0;
+    VkAccessFlags2 accessMask = 0;
+    bool isWrite = false;
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    std::optional<VkImageLayout> layoutAfterPass = std::nullopt;
+  };
+
+  VkDevice device_;
+  const VkAllocationCallbacks *allocator_;
+  VkPhysicalDeviceMemoryProperties deviceMemoryProperties_;
+  const DebugUtils *debugUtils_ = nullptr;
+  bool compiled_ = false;
+
+  std::map<ResourceT, Resource_> resources_{};
+  std::vector<Pass_> passes_{};
+  std::vector<ResourceBarrier_> finalBarriers_{};
+
+  VkDeviceMemory transientMemory_ = VK_NULL_HANDLE;
+  VkDeviceSize transientMemorySize_ = 0;
+  VkDeviceSize transientMemorySizeWithoutAliasing_ = 0;
+
+  void addResource_(ResourceT resourceIdentifier, Resource_ resource) {
+    assert(!compiled_ && "Resources must be added before compiling");
+    assert(!resources_.contains(resourceIdentifier) &&
+           "Resource already in the graph");
+    resources_.emplace(resourceIdentifier, resource);
+  }
+
+  bool isImage_(ResourceT resourceIdentifier) const {
+    return resources_.at(resourceIdentifier).kind ==
+           ResourceKind_::IMPORTED_IMAGE;
+  }
+
+  std::map<ResourceT, MergedAccess_> mergeAccesses_(const Pass_ &pass) const {
+    std::map<ResourceT, MergedAccess_> merged{};
+    auto merge = [&](const ResourceAccess<ResourceT> &access, bool isWrite) {
+      auto &mergedAccess = merged[access.resource];
+      assert((mergedAccess.stageMask == 0 ||
+              mergedAccess.layout == access.layout) &&
+             "A pass needs a single layout per image");
+      mergedAccess.stageMask |= access.stageMask;
+      mergedAccess.accessMask |= access.accessMask;
+      mergedAccess.isWrite |= isWrite;
+      mergedAccess.layout = access.layout;
+      if (access.layoutAfterPass.has_value()) {
+        mergedAccess.layoutAfterPass = access.layoutAfterPass;
+      }
+    };
+    for (auto &access : pass.info.reads) {
+      merge(access, false);
+    }
+    for (auto &access : pass.info.writes) {
+      merge(access, true);
+    }
+    return merged;
+  }
+
+  // A pass is kept if it has side effects or writes something needed, its
+  // reads then become needed for the passes before it.
+  void cullPasses_() {
+    std::set<ResourceT> neededResources{};
+    for (auto &[identifier, resource] : resources_) {
+      if (resource.isOutput) {
+        neededResources.insert(identifier);
+      }
+    }
+    for (auto it = passes_.rbegin(); it != passes_.rend(); ++it) {
+      auto &pass = *it;
+      bool needed = pass.info.hasSideEffects;
+      for (auto &access : pass.info.writes) {
+        needed |= neededResources.contains(access.resource);
+      }
+      pass.culled = !needed;
+      if (needed) {
+        for (auto &access : pass.info.reads) {
+          neededResources.insert(access.resource);
+        }
+      }
+    }
+  }
+
+  void computeLifetimes_() {
+    for (uint32_t i = 0; i < passes_.size(); ++i) {
+      if (passes_[i].culled) {
+        continue;
+      }
+      for (auto &[identifier, access] : mergeAccesses_(passes_[i])) {
+        auto &resource = resources_.at(identifier);
+        if (!resource.firstPass.has_value()) {
+          resource.firstPass = i;
+        }
+        resource.lastPass = i;
+      }
+    }
+  }
+
+  static bool lifetimesOverlap_(const Resource_ &a, const Resource_ &b) {
+    return a.firstPass.value() <= b.lastPass &&
+           b.firstPass.value() <= a.lastPass;
+  }
+
+  // Greedy interval packing: the biggest buffers are placed first, each at
+  // the lowest offset that doesn't collide with an already placed buffer
+  // alive at the same time.
+  void allocateTransientBuffers_() {
+    std::vector<Resource_ *> transients{};
+    uint32_t memoryTypeBits = ~0u;
+    VkDeviceSize alignment = 1;
+    for (auto &[identifier, resource] : resources_) {
+      if (resource.kind != ResourceKind_::TRANSIENT_BUFFER ||
+          !resource.firstPass.has_value()) {
+        continue;
+      }
+      VkBufferCreateInfo bufferInfo{};
+      bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+      bufferInfo.size = resource.transientInfo.size;
+      bufferInfo.usage = resource.transientInfo.usageFlags;
+      bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+      if (vkCreateBuffer(device_, &bufferInfo, allocator_, &resource.buffer) !=
+          VK_SUCCESS) {
+        throw std::runtime_error("Failed to create transient buffer");
+      }
+      if (debugUtils_ != nullptr) {
+        debugUtils_->setName(VK_OBJECT_TYPE_BUFFER, resource.buffer,
+                             identifier);
+      }
+      VkMemoryRequirements requirements;
+      vkGetBufferMemoryRequirements(device_, resource.buffer, &requirements);
+      memoryTypeBits &= requirements.memoryTypeBits;
+      alignment = std::max(alignment, requirements.alignment);
+      resource.memorySize = requirements.size;
+      transientMemorySizeWithoutAliasing_ += requirements.size;
+      transients.push_back(&resource);
+    }
+    if (transients.empty()) {
+      return;
+    }
+
+    std::sort(transients.begin(), transients.end(),
+              [](Resource_ *a, Resource_ *b) {
+                return a->memorySize > b->memorySize;
+              });
+    std::vector<Resource_ *> placed{};
+    for (auto *resource : transients) {
+      std::vector<Resource_ *> alive{};
+      for (auto *other : placed) {
+        if (lifetimesOverlap_(*resource, *other)) {
+          alive.push_back(other);
+        }
+      }
+      std::sort(alive.begin(), alive.end(), [](Resource_ *a, Resource_ *b) {
+        return a->memoryOffset < b->memoryOffset;
+      });
+      VkDeviceSize offset = 0;
+      for (auto *other : alive) {
+        if (offset + resource->memorySize <= other->memoryOffset) {
+          break;
+        }
+        offset = std::max(offset, other->memoryOffset + other->memorySize);
+        offset = (offset + alignment - 1) / alignment * alignment;
+      }
+      resource->memoryOffset = offset;
+      transientMemorySize_ =
+          std::max(transientMemorySize_, offset + resource->memorySize);
+      placed.push_back(resource);
+    }
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = transientMemorySize_;
+    allocInfo.memoryTypeIndex =
+        getMemoryTypeIndex(memoryTypeBits, deviceMemoryProperties_,
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (vkAllocateMemory(device_, &allocInfo, allocator_, &transientMemory_) !=
+        VK_SUCCESS) {
+      throw std::runtime_error("Failed to allocate transient memory");
+    }
+    for (auto *resource : transients) {
+      vkBindBufferMemory(device_, resource->buffer, transientMemory_,
+                         resource->memoryOffset);
+    }
+  }
+
+  // Transient buffers placed in the same memory range, their lifetimes don't
+  // overlap this one
+  std::vector<ResourceT> aliasedBuffers_(ResourceT resourceIdentifier) {
+    std::vector<ResourceT> aliased{};
+    auto &resource = resources_.at(resourceIdentifier);
+    for (auto &[identifier, other] : resources_) {
+      if (identifier == resourceIdentifier ||
+          other.kind != ResourceKind_::TRANSIENT_BUFFER ||
+          !other.firstPass.has_value()) {
+        continue;
+      }
+      bool memoryOverlaps =
+          other.memoryOffset < resource.memoryOffset + resource.memorySize &&
+          resource.memoryOffset < other.memoryOffset + other.memorySize;
+      if (memoryOverlaps) {
+        aliased.push_back(identifier);
+      }
+    }
+    return aliased;
+  }
+
+  // The graph is executed again and again, so the passes are walked twice:
+  // the first walk leaves every resource as the previous execution does, the
+  // barriers of the second walk then order the first accesses after it.
+  void computeBarriers_() {
+    std::map<ResourceT, ResourceAccessState> states{};
+    for (int walk = 0; walk < 2; ++walk) {
+      for (auto &[identifier, resource] : resources_) {
+        auto &state = states[identifier];
+        state.layout = resource.initialLayout;
+        // Brought back to the initial layout outside of the graph
+        if (resource.kind == ResourceKind_::IMPORTED_IMAGE) {
+          state.visibleStages = 0;
+          state.visibleAccess = 0;
+        }
+      }
+      for (auto &pass : passes_) {
+        pass.barriers.clear();
+      }
+      for (uint32_t i = 0; i < passes_.size(); ++i) {
+        if (!passes_[i].culled) {
+          computePassBarriers_(i, states);
+        }
+      }
+    }
+
+    for (auto &[identifier, resource] : resources_) {
+      auto &state = states[identifier];
+      if (resource.kind != ResourceKind_::IMPORTED_IMAGE ||
+          !resource.finalLayout.has_value() ||
+          resource.finalLayout.value() == state.layout) {
+        continue;
+      }
+      // The destination stages are the source ones so that the first
+      // barriers of the next execution wait for the transition too
+      VkPipelineStageFlags2 lastStages = state.writeStages | state.readStages;
+      finalBarriers_.push_back(ResourceBarrier_{
+          .resource = identifier,
+          .srcStageMask = lastStages,
+          .srcAccessMask = state.writeAccess,
+          .dstStageMask = lastStages,
+          .dstAccessMask = VK_ACCESS_2_NONE,
+          .oldLayout = state.layout,
+          .newLayout = resource.finalLayout.value()});
+    }
+  }
+
+  void computePassBarriers_(uint32_t passIndex,
+                            std::map<ResourceT, ResourceAccessState> &states) {
+    auto &pass = passes_[passIndex];
+    for (auto &[identifier, access] : mergeAccesses_(pass)) {
+      auto &state = states[identifier];
+      bool firstAccess =
+          resources_.at(identifier).firstPass.value() == passIndex;
+      std::optional<VkImageLayout> layout = std::nullopt;
+      if (isImage_(identifier)) {
+        layout = access.layout;
+      }
+      auto barrier = trackAccess(state, access.stageMask, access.accessMask,
+                                 access.isWrite, layout);
+      if (access.layoutAfterPass.has_value()) {
+        state.layout = access.layoutAfterPass.value();
+      }
+
+      if (barrier.has_value()) {
+        pass.barriers.push_back(
+            ResourceBarrier_{.resource = identifier,
+                             .srcStageMask = barrier->srcStageMask,
+                             .srcAccessMask = barrier->srcAccessMask,
+                             .dstStageMask = barrier->dstStageMask,
+                             .dstAccessMask = barrier->dstAccessMask,
+                             .oldLayout = barrier->oldLayout,
+                             .newLayout = barrier->newLayout});
+      }
+      if (firstAccess && resources_.at(identifier).kind ==
+                             ResourceKind_::TRANSIENT_BUFFER) {
+        // The memory was used by other buffers before, earlier in this
+        // execution or later in the previous one
+        VkPipelineStageFlags2 srcStageMask = 0;
+        VkAccessFlags2 srcAccessMask = 0;
+        for (auto other : aliasedBuffers_(identifier)) {
+          srcStageMask |=
+              states[other].writeStages | states[other].readStages;
+          srcAccessMask |= states[other].writeAccess;
+        }
+        if (srcStageMask != 0) {
+          pass.barriers.push_back(
+              ResourceBarrier_{.resource = identifier,
+                               .isMemoryBarrier = true,
+                               .srcStageMask = srcStageMask,
+                               .srcAccessMask = srcAccessMask,
+                               .dstStageMask = access.stageMask,
+                               .dstAccessMask = access.accessMask});
+        }
+      }
+    }
+  }
+
+  void addBarriers_(BarrierBatch &barrierBatch,
+                    const std::vector<ResourceBarrier_> &barriers) {
+    for (auto &barrier : barriers) {
+      if (barrier.isMemoryBarrier) {
+        barrierBatch.addMemoryBarrier(
+            barrier.srcStageMask, barrier.srcAccessMask, barrier.dstStageMask,
+            barrier.dstAccessMask);
+        continue;
+      }
+      auto &resource = resources_.at(barrier.resource);
+      if (resource.kind == ResourceKind_::IMPORTED_IMAGE) {
+        assert(resource.image != VK_NULL_HANDLE);
+        barrierBatch.addImageBarrier(
+            resource.image,
+            ImageBarrierInfo{.srcStageMask = barrier.srcStageMask,
+                             .srcAccessMask = barrier.srcAccessMask,
+                             .dstStageMask = barrier.dstStageMask,
+                             .dstAccessMask = barrier.dstAccessMask,
+                             .oldLayout = barrier.oldLayout,
+                             .newLayout = barrier.newLayout,
+                             .subresourceRange = resource.subresourceRange});
+      } else {
+        barrierBatch.addBufferBarrier(
+            resource.buffer,
+            BufferBarrierInfo{.srcStageMask = barrier.srcStageMask,
+                              .srcAccessMask = barrier.srcAccessMask,
+                              .dstStageMask = barrier.dstStageMask,
+                              .dstAccessMask = barrier.dstAccessMask});
+      }
+    }
+  }
+};
+
+}  // namespace vinkan
+
+#endif
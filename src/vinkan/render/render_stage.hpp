@@ -2,6 +2,7 @@
 #define VINKAN_RENDER_STAGE_HPP
 
 #include "vinkan/generics/concepts.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
 #include "vinkan/wrappers/render_pass.hpp"
 
 namespace vinkan {
@@ -19,6 +20,11 @@ class RenderStage {
     }
   }
 
+  VkFramebuffer getFramebuffer(uint32_t frameIndex) const {
+    assert(frameIndex < framebuffers_.size());
+    return framebuffers_[frameIndex];
+  }
+
   void beginRenderPass(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
     assert(frameIndex < framebuffers_.size());
     VkRenderPassBeginInfo renderPassInfo{};
@@ -37,8 +43,8 @@ class RenderStage {
     renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
     renderPassInfo.pClearValues = clearValues.data();
 
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo,
-                         VK_SUBPASS_CONTENTS_INLINE);
+    deviceDispatch.vkCmdBeginRenderPass(commandBuffer, &renderPassInfo,
+                                        VK_SUBPASS_CONTENTS_INLINE);
 
     VkViewport viewport{};
     viewport.x = 0.f;
@@ -48,8 +54,8 @@ class RenderStage {
     viewport.minDepth = 0.f;
     viewport.maxDepth = 1.f;
     VkRect2D scissor{{0, 0}, imageExtent_};
-    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    deviceDispatch.vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    deviceDispatch.vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
   }
 
  private:
@@ -21,16 +21,38 @@ template <EnumType BufferT, EnumType SetT, EnumType SetLayoutT, EnumType PoolT>
 class Resources {
  public:
   Resources(VkDevice device,
-            VkPhysicalDeviceMemoryProperties deviceMemoryProperties)
+            VkPhysicalDeviceMemoryProperties deviceMemoryProperties,
+            const VkAllocationCallbacks *allocator = nullptr)
       : device_(device),
         deviceMemoryProperties_(deviceMemoryProperties),
-        resourcesBinder_(device) {}
+        allocator_(allocator),
+        resourcesBinder_(device, allocator) {}
+
+  // Names the buffers and descriptor objects after their identifier, the
+  // ones created afterwards too
+  void setDebugUtils(const DebugUtils *debugUtils) {
+    debugUtils_ = debugUtils;
+    resourcesBinder_.setDebugUtils(debugUtils);
+    if (debugUtils_ == nullptr) {
+      return;
+    }
+    for (auto &[identifier, buffer] : buffers_) {
+      debugUtils_->setName(VK_OBJECT_TYPE_BUFFER, buffer->getHandle(),
+                           identifier);
+    }
+  }
 
   void create(BufferT bufferIdentifier, BufferInfo bufferInfo) {
     assert(!buffers_.contains(bufferIdentifier));
     buffers_.emplace(
         bufferIdentifier,
-        std::make_unique<Buffer>(device_, deviceMemoryProperties_, bufferInfo));
+        std::make_unique<Buffer>(device_, deviceMemoryProperties_, bufferInfo,
+                                 allocator_));
+    if (debugUtils_ != nullptr) {
+      debugUtils_->setName(VK_OBJECT_TYPE_BUFFER,
+                           buffers_[bufferIdentifier]->getHandle(),
+                           bufferIdentifier);
+    }
   }
 
   Buffer &get(BufferT bufferIdentifier) {
@@ -78,6 +100,8 @@ class Resources {
 
   VkDevice device_;
   VkPhysicalDeviceMemoryProperties deviceMemoryProperties_;
+  const VkAllocationCallbacks *allocator_;
+  const DebugUtils *debugUtils_ = nullptr;
   ResourcesBinder<SetT, SetLayoutT, PoolT> resourcesBinder_;
 };
 }  // namespace vinkan
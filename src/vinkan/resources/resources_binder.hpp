@@ -6,7 +6,9 @@
 #include <vector>
 
 #include "vinkan/generics/concepts.hpp"
+#include "vinkan/logging/debug_utils.hpp"
 #include "vinkan/logging/logger.hpp"
+#include "vinkan/logging/tracer.hpp"
 #include "vinkan/structs/descriptors_structs.hpp"
 #include "vinkan/wrappers/descriptors/descriptor_pool.hpp"
 #include "vinkan/wrappers/descriptors/descriptor_set.hpp"
@@ -17,18 +19,46 @@ namespace vinkan {
 template <EnumType SetT, EnumType SetLayoutT, EnumType PoolT>
 class ResourcesBinder {
  public:
-  ResourcesBinder(VkDevice device) : device_(device) {}
+  ResourcesBinder(VkDevice device,
+                  const VkAllocationCallbacks *allocator = nullptr)
+      : device_(device), allocator_(allocator) {}
+
+  // Names the sets, layouts and pools after their identifier, the ones
+  // created afterwards too
+  void setDebugUtils(const DebugUtils *debugUtils) {
+    debugUtils_ = debugUtils;
+    if (debugUtils_ == nullptr) {
+      return;
+    }
+    for (auto &[identifier, set] : sets_) {
+      debugUtils_->setName(VK_OBJECT_TYPE_DESCRIPTOR_SET, set->getHandle(),
+                           identifier);
+    }
+    for (auto &[identifier, setLayout] : setLayouts_) {
+      debugUtils_->setName(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT,
+                           setLayout->getHandle(), identifier);
+    }
+    for (auto &[identifier, pool] : pools_) {
+      debugUtils_->setName(VK_OBJECT_TYPE_DESCRIPTOR_POOL, pool->getHandle(),
+                           identifier);
+    }
+  }
+
   void createSetLayout(SetLayoutT setLayoutIdentifier,
                        SetLayoutInfo layoutInfo) {
     assert(!layoutIdentifierToInfo_.contains(setLayoutIdentifier) &&
            "This set layout is already defined");
-    DescriptorSetLayout::Builder builder(device_);
+    DescriptorSetLayout::Builder builder(device_, allocator_);
     for (auto &layoutInfo : layoutInfo.bindings) {
       builder.addBinding(layoutInfo);
     }
     layoutIdentifierToInfo_.emplace(setLayoutIdentifier, layoutInfo);
     setLayouts_.emplace(setLayoutIdentifier, builder.build());
-    SPDLOG_LOGGER_INFO(get_vinkan_logger(), "Descriptor set layout created");
+    if (debugUtils_ != nullptr) {
+      debugUtils_->setName(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT,
+                           get(setLayoutIdentifier), setLayoutIdentifier);
+    }
+    SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Descriptor set layout created");
   }
 
   void createPool(PoolT pool,
@@ -53,19 +83,23 @@ class ResourcesBinder {
             layout.nSets * binding.count;
       }
     }
-    DescriptorPool::Builder builder(device_);
+    DescriptorPool::Builder builder(device_, allocator_);
     builder.setMaxSets(totalNSets);
 
     for (const auto &alloc : setsPerDescriptor) {
       builder.addPoolSize(alloc.first, alloc.second);
     }
     pools_.emplace(pool, builder.build());
-    SPDLOG_LOGGER_INFO(get_vinkan_logger(), "Descriptor pool created");
+    if (debugUtils_ != nullptr) {
+      debugUtils_->setName(VK_OBJECT_TYPE_DESCRIPTOR_POOL, get(pool), pool);
+    }
+    SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Descriptor pool created");
   };
 
   void createSet(
       SetT setIdentifier, SetLayoutT setLayoutIdentifier,
       const std::vector<ResourceDescriptorInfo> &resourceDescriptorInfos) {
+    VINKAN_TRACE_SCOPE("ResourcesBinder::createSet");
     assert(setLayouts_.contains(setLayoutIdentifier));
     auto &setLayout = *setLayouts_[setLayoutIdentifier];
     auto &pool = *pools_[layoutIdentifierToPool_[setLayoutIdentifier]];
@@ -74,7 +108,11 @@ class ResourcesBinder {
       builder.setBuffer(resourceDescriptorInfo);
     }
     sets_.emplace(setIdentifier, builder.build());
-    SPDLOG_LOGGER_INFO(get_vinkan_logger(), "Descriptor set created");
+    if (debugUtils_ != nullptr) {
+      debugUtils_->setName(VK_OBJECT_TYPE_DESCRIPTOR_SET, get(setIdentifier),
+                           setIdentifier);
+    }
+    SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Descriptor set created");
   }
 
   VkDescriptorSet get(SetT setIdentifier) {
@@ -92,6 +130,8 @@ class ResourcesBinder {
 
  private:
   VkDevice device_;
+  const VkAllocationCallbacks *allocator_;
+  const DebugUtils *debugUtils_ = nullptr;
   // We keep this to build the pool when needed
   std::map<SetLayoutT, SetLayoutInfo> layoutIdentifierToInfo_;
   std::map<SetLayoutT, PoolT> layoutIdentifierToPool_;
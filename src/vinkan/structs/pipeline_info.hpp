@@ -7,6 +7,10 @@ template <EnumType PipelineLayoutT, ValidShaderInfo ShaderInfoT>
 struct ComputePipelineInfo {
   PipelineLayoutT layoutIdentifier;
   ShaderInfoT shaderInfo;
+  // Must outlive the pipeline creation
+  const VkSpecializationInfo *specializationInfo = nullptr;
+  // E.g. VK_PIPELINE_SHADER_STAGE_CREATE_REQUIRE_FULL_SUBGROUPS_BIT
+  VkPipelineShaderStageCreateFlags shaderStageFlags = 0;
 };
 
 template <EnumType PipelineLayoutT, ValidShaderInfo ShaderInfoT>
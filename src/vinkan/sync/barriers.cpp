@@ -0,0 +1,268 @@
+#include "barriers.hpp"
+
+#include "vinkan/wrappers/device_dispatch.hpp"
+
+namespace vinkan {
+
+namespace {
+constexpr uint64_t LEGACY_FLAGS_MASK = 0xFFFFFFFFull;
+}
+
+VkPipelineStageFlags toLegacyStageFlags(VkPipelineStageFlags2 stageFlags) {
+  auto legacyFlags =
+      static_cast<VkPipelineStageFlags>(stageFlags & LEGACY_FLAGS_MASK);
+  if (stageFlags &
+      (VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_RESOLVE_BIT |
+       VK_PIPELINE_STAGE_2_BLIT_BIT | VK_PIPELINE_STAGE_2_CLEAR_BIT)) {
+    legacyFlags |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+  }
+  if (stageFlags & (VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT |
+                    VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT)) {
+    legacyFlags |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+  }
+  if (stageFlags & VK_PIPELINE_STAGE_2_PRE_RASTERIZATION_SHADERS_BIT) {
+    legacyFlags |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                   VK_PIPELINE_STAGE_TESSELLATION_CONTROL_SHADER_BIT |
+                   VK_PIPELINE_STAGE_TESSELLATION_EVALUATION_SHADER_BIT |
+                   VK_PIPELINE_STAGE_GEOMETRY_SHADER_BIT;
+  }
+  return legacyFlags;
+}
+
+VkAccessFlags toLegacyAccessFlags(VkAccessFlags2 accessFlags) {
+  auto legacyFlags = static_cast<VkAccessFlags>(accessFlags & LEGACY_FLAGS_MASK);
+  if (accessFlags & (VK_ACCESS_2_SHADER_SAMPLED_READ_BIT |
+                     VK_ACCESS_2_SHADER_STORAGE_READ_BIT)) {
+    legacyFlags |= VK_ACCESS_SHADER_READ_BIT;
+  }
+  if (accessFlags & VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT) {
+    legacyFlags |= VK_ACCESS_SHADER_WRITE_BIT;
+  }
+  return legacyFlags;
+}
+
+BarrierBatch &BarrierBatch::addMemoryBarrier(
+    VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+    VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask) {
+  VkMemoryBarrier2 barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+  barrier.srcStageMask = srcStageMask;
+  barrier.srcAccessMask = srcAccessMask;
+  barrier.dstStageMask = dstStageMask;
+  barrier.dstAccessMask = dstAccessMask;
+  memoryBarriers_.push_back(barrier);
+  return *this;
+}
+
+BarrierBatch &BarrierBatch::addBufferBarrier(VkBuffer buffer,
+                                             BufferBarrierInfo barrierInfo) {
+  VkBufferMemoryBarrier2 barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+  barrier.srcStageMask = barrierInfo.srcStageMask;
+  barrier.srcAccessMask = barrierInfo.srcAccessMask;
+  barrier.dstStageMask = barrierInfo.dstStageMask;
+  barrier.dstAccessMask = barrierInfo.dstAccessMask;
+  barrier.srcQueueFamilyIndex = barrierInfo.srcQueueFamilyIndex;
+  barrier.dstQueueFamilyIndex = barrierInfo.dstQueueFamilyIndex;
+  barrier.buffer = buffer;
+  barrier.offset = barrierInfo.offset;
+  barrier.size = barrierInfo.size;
+  bufferBarriers_.push_back(barrier);
+  return *this;
+}
+
+BarrierBatch &BarrierBatch::addBufferBarrier(Buffer &buffer,
+                                             BufferBarrierInfo barrierInfo) {
+  return addBufferBarrier(buffer.getHandle(), barrierInfo);
+}
+
+BarrierBatch &BarrierBatch::addImageBarrier(VkImage image,
+                                            ImageBarrierInfo barrierInfo) {
+  VkImageMemoryBarrier2 barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+  barrier.srcStageMask = barrierInfo.srcStageMask;
+  barrier.srcAccessMask = barrierInfo.srcAccessMask;
+  barrier.dstStageMask = barrierInfo.dstStageMask;
+  barrier.dstAccessMask = barrierInfo.dstAccessMask;
+  barrier.oldLayout = barrierInfo.oldLayout;
+  barrier.newLayout = barrierInfo.newLayout;
+  barrier.srcQueueFamilyIndex = barrierInfo.srcQueueFamilyIndex;
+  barrier.dstQueueFamilyIndex = barrierInfo.dstQueueFamilyIndex;
+  barrier.image = image;
+  barrier.subresourceRange = barrierInfo.subresourceRange;
+  imageBarriers_.push_back(barrier);
+  return *this;
+}
+
+BarrierBatch &BarrierBatch::addBufferRelease(
+    Buffer &buffer, QueueOwnershipTransferInfo transferInfo) {
+  if (transferInfo.srcQueueFamilyIndex == transferInfo.dstQueueFamilyIndex) {
+    return addBufferBarrier(buffer, {.srcStageMask = transferInfo.srcStageMask,
+                                     .srcAccessMask = transferInfo.srcAccessMask,
+                                     .dstStageMask = transferInfo.dstStageMask,
+                                     .dstAccessMask = transferInfo.dstAccessMask,
+                                     .offset = transferInfo.offset,
+                                     .size = transferInfo.size});
+  }
+  // The destination scope is ignored by the release, the semaphore waited by
+  // the destination queue orders it with the acquire
+  return addBufferBarrier(
+      buffer, {.srcStageMask = transferInfo.srcStageMask,
+               .srcAccessMask = transferInfo.srcAccessMask,
+               .dstStageMask = VK_PIPELINE_STAGE_2_NONE,
+               .dstAccessMask = VK_ACCESS_2_NONE,
+               .srcQueueFamilyIndex = transferInfo.srcQueueFamilyIndex,
+               .dstQueueFamilyIndex = transferInfo.dstQueueFamilyIndex,
+               .offset = transferInfo.offset,
+               .size = transferInfo.size});
+}
+
+BarrierBatch &BarrierBatch::addBufferAcquire(
+    Buffer &buffer, QueueOwnershipTransferInfo transferInfo) {
+  if (transferInfo.srcQueueFamilyIndex == transferInfo.dstQueueFamilyIndex) {
+    return *this;
+  }
+  // Same for the source scope of the acquire
+  return addBufferBarrier(
+      buffer, {.srcStageMask = VK_PIPELINE_STAGE_2_NONE,
+               .srcAccessMask = VK_ACCESS_2_NONE,
+               .dstStageMask = transferInfo.dstStageMask,
+               .dstAccessMask = transferInfo.dstAccessMask,
+               .srcQueueFamilyIndex = transferInfo.srcQueueFamilyIndex,
+               .dstQueueFamilyIndex = transferInfo.dstQueueFamilyIndex,
+               .offset = transferInfo.offset,
+               .size = transferInfo.size});
+}
+
+bool BarrierBatch::empty() const {
+  return memoryBarriers_.empty() && bufferBarriers_.empty() &&
+         imageBarriers_.empty();
+}
+
+void BarrierBatch::clear() {
+  memoryBarriers_.clear();
+  bufferBarriers_.clear();
+  imageBarriers_.clear();
+}
+
+void BarrierBatch::record(VkCommandBuffer commandBuffer,
+                          bool synchronization2) {
+  if (empty()) {
+    return;
+  }
+  if (!synchronization2) {
+    recordLegacy_(commandBuffer);
+    clear();
+    return;
+  }
+  VkDependencyInfo dependencyInfo{};
+  dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+  dependencyInfo.memoryBarrierCount =
+      static_cast<uint32_t>(memoryBarriers_.size());
+  dependencyInfo.pMemoryBarriers = memoryBarriers_.data();
+  dependencyInfo.bufferMemoryBarrierCount =
+      static_cast<uint32_t>(bufferBarriers_.size());
+  dependencyInfo.pBufferMemoryBarriers = bufferBarriers_.data();
+  dependencyInfo.imageMemoryBarrierCount =
+      static_cast<uint32_t>(imageBarriers_.size());
+  dependencyInfo.pImageMemoryBarriers = imageBarriers_.data();
+  deviceDispatch.vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+  clear();
+}
+
+void BarrierBatch::recordLegacy_(VkCommandBuffer commandBuffer) {
+  // The legacy barrier only has one stage mask for the whole call so we merge
+  // the stages of every barrier
+  VkPipelineStageFlags srcStageMask = 0;
+  VkPipelineStageFlags dstStageMask = 0;
+
+  std::vector<VkMemoryBarrier> memoryBarriers{};
+  for (auto &barrier2 : memoryBarriers_) {
+    srcStageMask |= toLegacyStageFlags(barrier2.srcStageMask);
+    dstStageMask |= toLegacyStageFlags(barrier2.dstStageMask);
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = toLegacyAccessFlags(barrier2.srcAccessMask);
+    barrier.dstAccessMask = toLegacyAccessFlags(barrier2.dstAccessMask);
+    memoryBarriers.push_back(barrier);
+  }
+
+  std::vector<VkBufferMemoryBarrier> bufferBarriers{};
+  for (auto &barrier2 : bufferBarriers_) {
+    srcStageMask |= toLegacyStageFlags(barrier2.srcStageMask);
+    dstStageMask |= toLegacyStageFlags(barrier2.dstStageMask);
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = toLegacyAccessFlags(barrier2.srcAccessMask);
+    barrier.dstAccessMask = toLegacyAccessFlags(barrier2.dstAccessMask);
+    barrier.srcQueueFamilyIndex = barrier2.srcQueueFamilyIndex;
+    barrier.dstQueueFamilyIndex = barrier2.dstQueueFamilyIndex;
+    barrier.buffer = barrier2.buffer;
+    barrier.offset = barrier2.offset;
+    barrier.size = barrier2.size;
+    bufferBarriers.push_back(barrier);
+  }
+
+  std::vector<VkImageMemoryBarrier> imageBarriers{};
+  for (auto &barrier2 : imageBarriers_) {
+    srcStageMask |= toLegacyStageFlags(barrier2.srcStageMask);
+    dstStageMask |= toLegacyStageFlags(barrier2.dstStageMask);
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = toLegacyAccessFlags(barrier2.srcAccessMask);
+    barrier.dstAccessMask = toLegacyAccessFlags(barrier2.dstAccessMask);
+    barrier.oldLayout = barrier2.oldLayout;
+    barrier.newLayout = barrier2.newLayout;
+    barrier.srcQueueFamilyIndex = barrier2.srcQueueFamilyIndex;
+    barrier.dstQueueFamilyIndex = barrier2.dstQueueFamilyIndex;
+    barrier.image = barrier2.image;
+    barrier.subresourceRange = barrier2.subresourceRange;
+    imageBarriers.push_back(barrier);
+  }
+
+  // A zero stage mask is only valid with synchronization2
+  if (srcStageMask == 0) {
+    srcStageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+  }
+  if (dstStageMask == 0) {
+    dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+  }
+
+  deviceDispatch.vkCmdPipelineBarrier(
+      commandBuffer, srcStageMask, dstStageMask, 0,
+      static_cast<uint32_t>(memoryBarriers.size()), memoryBarriers.data(),
+      static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+      static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+}
+
+void cmdBufferBarrier(VkCommandBuffer commandBuffer, Buffer &buffer,
+                      BufferBarrierInfo barrierInfo, bool synchronization2) {
+  BarrierBatch batch;
+  batch.addBufferBarrier(buffer, barrierInfo);
+  batch.record(commandBuffer, synchronization2);
+}
+
+void cmdImageBarrier(VkCommandBuffer commandBuffer, VkImage image,
+                     ImageBarrierInfo barrierInfo, bool synchronization2) {
+  BarrierBatch batch;
+  batch.addImageBarrier(image, barrierInfo);
+  batch.record(commandBuffer, synchronization2);
+}
+
+void cmdReleaseBuffer(VkCommandBuffer commandBuffer, Buffer &buffer,
+                      QueueOwnershipTransferInfo transferInfo,
+                      bool synchronization2) {
+  BarrierBatch batch;
+  batch.addBufferRelease(buffer, transferInfo);
+  batch.record(commandBuffer, synchronization2);
+}
+
+void cmdAcquireBuffer(VkCommandBuffer commandBuffer, Buffer &buffer,
+                      QueueOwnershipTransferInfo transferInfo,
+                      bool synchronization2) {
+  BarrierBatch batch;
+  batch.addBufferAcquire(buffer, transferInfo);
+  batch.record(commandBuffer, synchronization2);
+}
+
+}  // namespace vinkan
@@ -0,0 +1,110 @@
+#ifndef VINKAN_BARRIERS_HPP
+#define VINKAN_BARRIERS_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+#include "vinkan/wrappers/buffer.hpp"
+
+namespace vinkan {
+
+struct BufferBarrierInfo {
+  VkPipelineStageFlags2 srcStageMask;
+  VkAccessFlags2 srcAccessMask;
+  VkPipelineStageFlags2 dstStageMask;
+  VkAccessFlags2 dstAccessMask;
+  uint32_t srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  uint32_t dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  VkDeviceSize offset = 0;
+  VkDeviceSize size = VK_WHOLE_SIZE;
+};
+
+struct ImageBarrierInfo {
+  VkPipelineStageFlags2 srcStageMask;
+  VkAccessFlags2 srcAccessMask;
+  VkPipelineStageFlags2 dstStageMask;
+  VkAccessFlags2 dstAccessMask;
+  VkImageLayout oldLayout;
+  VkImageLayout newLayout;
+  uint32_t srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  uint32_t dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  VkImageSubresourceRange subresourceRange = {
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .baseMipLevel = 0,
+      .levelCount = VK_REMAINING_MIP_LEVELS,
+      .baseArrayLayer = 0,
+      .layerCount = VK_REMAINING_ARRAY_LAYERS};
+};
+
+// Ownership transfer of an exclusive resource between two queue families.
+// The src stage/access are the last use on the source queue and the dst
+// stage/access the first use on the destination queue.
+struct QueueOwnershipTransferInfo {
+  uint32_t srcQueueFamilyIndex;
+  uint32_t dstQueueFamilyIndex;
+  VkPipelineStageFlags2 srcStageMask;
+  VkAccessFlags2 srcAccessMask;
+  VkPipelineStageFlags2 dstStageMask;
+  VkAccessFlags2 dstAccessMask;
+  VkDeviceSize offset = 0;
+  VkDeviceSize size = VK_WHOLE_SIZE;
+};
+
+// The synchronization2 flags are a superset of the legacy ones, these
+// functions fold the 64 bits only flags onto their closest legacy equivalent.
+VkPipelineStageFlags toLegacyStageFlags(VkPipelineStageFlags2 stageFlags);
+VkAccessFlags toLegacyAccessFlags(VkAccessFlags2 accessFlags);
+
+// Collects barriers so that they are all emitted in a single
+// vkCmdPipelineBarrier2 (or vkCmdPipelineBarrier when synchronization2 is not
+// enabled on the device).
+class BarrierBatch {
+ public:
+  BarrierBatch &addMemoryBarrier(VkPipelineStageFlags2 srcStageMask,
+                                 VkAccessFlags2 srcAccessMask,
+                                 VkPipelineStageFlags2 dstStageMask,
+                                 VkAccessFlags2 dstAccessMask);
+  BarrierBatch &addBufferBarrier(VkBuffer buffer,
+                                 BufferBarrierInfo barrierInfo);
+  BarrierBatch &addBufferBarrier(Buffer &buffer,
+                                 BufferBarrierInfo barrierInfo);
+  BarrierBatch &addImageBarrier(VkImage image, ImageBarrierInfo barrierInfo);
+
+  // The release half is recorded on the source queue and the acquire half on
+  // the destination queue, with a semaphore between the two submissions. When
+  // both families are the same, the release is a plain barrier and the
+  // acquire does nothing.
+  BarrierBatch &addBufferRelease(Buffer &buffer,
+                                 QueueOwnershipTransferInfo transferInfo);
+  BarrierBatch &addBufferAcquire(Buffer &buffer,
+                                 QueueOwnershipTransferInfo transferInfo);
+
+  bool empty() const;
+  void clear();
+
+  // Record every barrier of the batch then clear it
+  void record(VkCommandBuffer commandBuffer, bool synchronization2);
+
+ private:
+  std::vector<VkMemoryBarrier2> memoryBarriers_{};
+  std::vector<VkBufferMemoryBarrier2> bufferBarriers_{};
+  std::vector<VkImageMemoryBarrier2> imageBarriers_{};
+
+  void recordLegacy_(VkCommandBuffer commandBuffer);
+};
+
+void cmdBufferBarrier(VkCommandBuffer commandBuffer, Buffer &buffer,
+                      BufferBarrierInfo barrierInfo, bool synchronization2);
+void cmdImageBarrier(VkCommandBuffer commandBuffer, VkImage image,
+                     ImageBarrierInfo barrierInfo, bool synchronization2);
+void cmdReleaseBuffer(VkCommandBuffer commandBuffer, Buffer &buffer,
+                      QueueOwnershipTransferInfo transferInfo,
+                      bool synchronization2);
+void cmdAcquireBuffer(VkCommandBuffer commandBuffer, Buffer &buffer,
+                      QueueOwnershipTransferInfo transferInfo,
+                      bool synchronization2);
+
+}  // namespace vinkan
+
+#endif
@@ -0,0 +1,65 @@
+#include "fence_pool.hpp"
+
+#include <stdexcept>
+
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
+
+namespace vinkan {
+
+FencePool::FencePool(VkDevice device, uint32_t initialCount,
+                     const VkAllocationCallbacks *allocator)
+    : device_(device), allocator_(allocator) {
+  for (uint32_t i = 0; i < initialCount; ++i) {
+    freeFences_.push_back(createFence_());
+  }
+}
+
+FencePool::~FencePool() {
+  for (auto fence : fences_) {
+    vkDestroyFence(device_, fence, allocator_);
+  }
+}
+
+VkFence FencePool::acquire() {
+  if (freeFences_.empty()) {
+    return createFence_();
+  }
+  VkFence fence = freeFences_.back();
+  freeFences_.pop_back();
+  return fence;
+}
+
+void FencePool::release(const std::vector<VkFence> &fences) {
+  if (fences.empty()) {
+    return;
+  }
+  if (deviceDispatch.vkResetFences(device_,
+                                   static_cast<uint32_t>(fences.size()),
+                                   fences.data()) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to reset pooled fences");
+  }
+  freeFences_.insert(freeFences_.end(), fences.begin(), fences.end());
+}
+
+void FencePool::release(VkFence fence) {
+  if (deviceDispatch.vkResetFences(device_, 1, &fence) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to reset pooled fence");
+  }
+  freeFences_.push_back(fence);
+}
+
+VkFence FencePool::createFence_() {
+  VkFenceCreateInfo fenceInfo{};
+  fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+  VkFence fence;
+  if (vkCreateFence(device_, &fenceInfo, allocator_, &fence) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to create pooled fence");
+  }
+  fences_.push_back(fence);
+  SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Pooled fence created");
+  return fence;
+}
+
+}  // namespace vinkan
@@ -0,0 +1,47 @@
+#ifndef VINKAN_FENCE_POOL_HPP
+#define VINKAN_FENCE_POOL_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+namespace vinkan {
+
+// Hands out unsignaled fences and takes them back once they've been waited on.
+// Fences are only created when the free list is empty, so a steady state
+// workload stops creating fences after its first iterations.
+class FencePool {
+ public:
+  FencePool(VkDevice device, uint32_t initialCount = 0,
+            const VkAllocationCallbacks *allocator = nullptr);
+  ~FencePool();
+
+  FencePool(const FencePool &) = delete;
+  FencePool &operator=(const FencePool &) = delete;
+
+  VkFence acquire();
+
+  // The fences must be signaled (or never submitted), they're reset in a
+  // single vkResetFences call before going back to the free list.
+  void release(const std::vector<VkFence> &fences);
+  void release(VkFence fence);
+
+  uint32_t getCreatedCount() const {
+    return static_cast<uint32_t>(fences_.size());
+  }
+  uint32_t getFreeCount() const {
+    return static_cast<uint32_t>(freeFences_.size());
+  }
+
+ private:
+  VkDevice device_;
+  const VkAllocationCallbacks *allocator_;
+  std::vector<VkFence> fences_{};
+  std::vector<VkFence> freeFences_{};
+
+  VkFence createFence_();
+};
+
+}  // namespace vinkan
+
+#endif
@@ -0,0 +1,101 @@
+#include "in_flight_tracker.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "vinkan/logging/logger.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
+
+namespace vinkan {
+
+InFlightTracker::InFlightTracker(VkDevice device, FencePool &fencePool)
+    : device_(device), fencePool_(fencePool) {}
+
+InFlightTracker::~InFlightTracker() {
+  if (inFlight_.empty()) {
+    return;
+  }
+  std::vector<VkFence> fences;
+  for (auto &submission : inFlight_) {
+    fences.push_back(submission.fence);
+  }
+  deviceDispatch.vkWaitForFences(device_, static_cast<uint32_t>(fences.size()),
+                                 fences.data(), VK_TRUE, UINT64_MAX);
+  fencePool_.release(fences);
+}
+
+void InFlightTracker::track(VkFence fence, std::function<void()> onComplete) {
+  inFlight_.push_back(
+      InFlightSubmission_{.fence = fence, .onComplete = std::move(onComplete)});
+}
+
+uint32_t InFlightTracker::poll(uint32_t maxFences) {
+  completedFences_.clear();
+  completedCallbacks_.clear();
+  auto checkedCount =
+      std::min(maxFences, static_cast<uint32_t>(inFlight_.size()));
+
+  // Completed submissions are removed while keeping the order of the others.
+  // The callbacks run once inFlight_ is consistent, they can track new
+  // submissions.
+  bool statusFailed = false;
+  size_t kept = 0;
+  for (size_t i = 0; i < inFlight_.size(); ++i) {
+    auto &submission = inFlight_[i];
+    if (i < checkedCount && !statusFailed) {
+      VkResult status =
+          deviceDispatch.vkGetFenceStatus(device_, submission.fence);
+      if (status == VK_SUCCESS) {
+        completedFences_.push_back(submission.fence);
+        if (submission.onComplete) {
+          completedCallbacks_.push_back(std::move(submission.onComplete));
+        }
+        continue;
+      }
+      statusFailed = status != VK_NOT_READY;
+    }
+    if (kept != i) {
+      inFlight_[kept] = std::move(submission);
+    }
+    kept++;
+  }
+  inFlight_.resize(kept);
+
+  fencePool_.release(completedFences_);
+  auto completedCount = static_cast<uint32_t>(completedFences_.size());
+  if (completedCount > 0) {
+    SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "{} submissions completed",
+                        completedCount);
+  }
+  // Swapped out so that a callback can poll again
+  std::vector<std::function<void()>> callbacks{};
+  callbacks.swap(completedCallbacks_);
+  for (auto &callback : callbacks) {
+    callback();
+  }
+  callbacks.clear();
+  completedCallbacks_.swap(callbacks);
+
+  if (statusFailed) {
+    throw std::runtime_error("Failed to get the status of a fence");
+  }
+  return completedCount;
+}
+
+void InFlightTracker::waitIdle() {
+  if (inFlight_.empty()) {
+    return;
+  }
+  completedFences_.clear();
+  for (auto &submission : inFlight_) {
+    completedFences_.push_back(submission.fence);
+  }
+  if (deviceDispatch.vkWaitForFences(
+          device_, static_cast<uint32_t>(completedFences_.size()),
+          completedFences_.data(), VK_TRUE, UINT64_MAX) != VK_SUCCESS) {
+    throw std::runtime_error("Failed to wait for in flight submissions");
+  }
+  poll();
+}
+
+}  // namespace vinkan
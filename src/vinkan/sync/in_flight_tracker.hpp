@@ -0,0 +1,60 @@
+#ifndef VINKAN_IN_FLIGHT_TRACKER_HPP
+#define VINKAN_IN_FLIGHT_TRACKER_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <functional>
+#include <vector>
+
+#include "vinkan/sync/fence_pool.hpp"
+
+namespace vinkan {
+
+// Keeps track of submissions signaling a pooled fence. Once the fence is
+// signaled the completion callback runs (e.g. to recycle the command buffers
+// of the submission) and the fence goes back to the pool.
+class InFlightTracker {
+ public:
+  InFlightTracker(VkDevice device, FencePool &fencePool);
+  // Waits for the pending submissions, their callbacks are not called since
+  // their owners may already be gone.
+  ~InFlightTracker();
+
+  InFlightTracker(const InFlightTracker &) = delete;
+  InFlightTracker &operator=(const InFlightTracker &) = delete;
+
+  // Fence to give to the next submission, it must be passed to track right
+  // after the submission.
+  VkFence acquireFence() { return fencePool_.acquire(); }
+  // Gives back an acquired fence whose submission failed
+  void releaseFence(VkFence fence) { fencePool_.release(fence); }
+  void track(VkFence fence, std::function<void()> onComplete);
+
+  // Checks at most maxFences pending fences with vkGetFenceStatus (oldest
+  // first) and returns how many submissions completed. The fences go back to
+  // the pool before the callbacks run.
+  uint32_t poll(uint32_t maxFences = UINT32_MAX);
+  // Blocks until every tracked submission has completed
+  void waitIdle();
+
+  uint32_t getInFlightCount() const {
+    return static_cast<uint32_t>(inFlight_.size());
+  }
+
+ private:
+  struct InFlightSubmission_ {
+    VkFence fence;
+    std::function<void()> onComplete;
+  };
+
+  VkDevice device_;
+  FencePool &fencePool_;
+  std::vector<InFlightSubmission_> inFlight_{};
+  // Reused between polls so that polling doesn't allocate
+  std::vector<VkFence> completedFences_{};
+  std::vector<std::function<void()>> completedCallbacks_{};
+};
+
+}  // namespace vinkan
+
+#endif
@@ -0,0 +1,56 @@
+#include "queue_dependency.hpp"
+
+#include <cassert>
+#include <stdexcept>
+
+#include "vinkan/logging/logger.hpp"
+
+namespace vinkan {
+
+QueueDependency::QueueDependency(VkDevice device,
+                                 const VkAllocationCallbacks *allocator)
+    : device_(device), allocator_(allocator) {
+  VkSemaphoreCreateInfo semaphoreInfo{};
+  semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+  if (vkCreateSemaphore(device_, &semaphoreInfo, allocator_, &semaphore_) !=
+      VK_SUCCESS) {
+    throw std::runtime_error("Failed to create queue dependency semaphore");
+  }
+  SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Queue dependency created");
+}
+
+QueueDependency::~QueueDependency() {
+  vkDestroySemaphore(device_, semaphore_, allocator_);
+}
+
+void QueueDependency::signalIn(SubmitCommandBufferInfo &submitInfo) {
+  assert(!signalPending_ && "The previous signal was never waited on");
+  submitInfo.signalSemaphores.push_back(semaphore_);
+  signalPending_ = true;
+}
+
+void QueueDependency::signalIn(SubmitCommandBufferInfo2 &submitInfo,
+                               VkPipelineStageFlags2 stageMask) {
+  assert(!signalPending_ && "The previous signal was never waited on");
+  submitInfo.signalSemaphores.push_back(
+      SemaphoreSubmit{.semaphore = semaphore_, .stageMask = stageMask});
+  signalPending_ = true;
+}
+
+void QueueDependency::waitIn(SubmitCommandBufferInfo &submitInfo,
+                             VkPipelineStageFlags dstStageMask) {
+  assert(signalPending_ && "Waiting on a dependency that isn't signaled");
+  submitInfo.waitSemaphores.push_back(semaphore_);
+  submitInfo.waitDstStages.push_back(dstStageMask);
+  signalPending_ = false;
+}
+
+void QueueDependency::waitIn(SubmitCommandBufferInfo2 &submitInfo,
+                             VkPipelineStageFlags2 dstStageMask) {
+  assert(signalPending_ && "Waiting on a dependency that isn't signaled");
+  submitInfo.waitSemaphores.push_back(
+      SemaphoreSubmit{.semaphore = semaphore_, .stageMask = dstStageMask});
+  signalPending_ = false;
+}
+
+}  // namespace vinkan
@@ -0,0 +1,48 @@
+#ifndef VINKAN_QUEUE_DEPENDENCY_HPP
+#define VINKAN_QUEUE_DEPENDENCY_HPP
+
+#include <vulkan/vulkan.h>
+
+#include "vinkan/command_coordinator.hpp"
+
+namespace vinkan {
+
+// Makes a submission on one queue wait for a submission on another queue
+// (e.g. graphics waiting for async compute) with a binary semaphore.
+//
+// Every signal must be consumed by exactly one wait before signaling again,
+// the submission waiting must be submitted after the one signaling.
+class QueueDependency {
+ public:
+  explicit QueueDependency(VkDevice device,
+                           const VkAllocationCallbacks *allocator = nullptr);
+  ~QueueDependency();
+
+  QueueDependency(const QueueDependency &) = delete;
+  QueueDependency &operator=(const QueueDependency &) = delete;
+
+  // Add the dependency semaphore to the producer submission
+  void signalIn(SubmitCommandBufferInfo &submitInfo);
+  void signalIn(SubmitCommandBufferInfo2 &submitInfo,
+                VkPipelineStageFlags2 stageMask =
+                    VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+
+  // Add the dependency semaphore to the consumer submission, only the given
+  // stages of the consumer wait for the producer
+  void waitIn(SubmitCommandBufferInfo &submitInfo,
+              VkPipelineStageFlags dstStageMask);
+  void waitIn(SubmitCommandBufferInfo2 &submitInfo,
+              VkPipelineStageFlags2 dstStageMask);
+
+  VkSemaphore getSemaphore() const { return semaphore_; }
+
+ private:
+  VkDevice device_;
+  const VkAllocationCallbacks *allocator_;
+  VkSemaphore semaphore_;
+  bool signalPending_ = false;
+};
+
+}  // namespace vinkan
+
+#endif
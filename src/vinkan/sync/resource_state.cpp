@@ -0,0 +1,86 @@
+#include "resource_state.hpp"
+
+namespace vinkan {
+
+bool isWriteAccess(VkAccessFlags2 accessMask) {
+  constexpr VkAccessFlags2 WRITE_ACCESS_MASK =
+      VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+      VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+      VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+      VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_HOST_WRITE_BIT |
+      VK_ACCESS_2_MEMORY_WRITE_BIT;
+  return (accessMask & WRITE_ACCESS_MASK) != 0;
+}
+
+namespace {
+
+std::optional<AccessBarrier> computeBarrier(const ResourceAccessState &state,
+                                            VkPipelineStageFlags2 stageMask,
+                                            VkAccessFlags2 accessMask,
+                                            bool isWrite,
+                                            VkImageLayout newLayout) {
+  AccessBarrier barrier{.srcStageMask = state.writeStages | state.readStages,
+                        .srcAccessMask = state.writeAccess,
+                        .dstStageMask = stageMask,
+                        .dstAccessMask = accessMask,
+                        .oldLayout = state.layout,
+                        .newLayout = newLayout};
+  bool accessed = state.writeStages != 0 || state.readStages != 0;
+  bool needsTransition = newLayout != state.layout;
+
+  if (!accessed) {
+    // Nothing to wait on, except for the layout transition which is then
+    // ordered with whatever waits at the stage of this access
+    if (!needsTransition) {
+      return std::nullopt;
+    }
+    barrier.srcStageMask = stageMask;
+    barrier.srcAccessMask = VK_ACCESS_2_NONE;
+    return barrier;
+  }
+  if (needsTransition || isWrite) {
+    return barrier;
+  }
+  // Read after write, unless a previous barrier already made the write
+  // visible to this read
+  if (state.writeStages == 0) {
+    return std::nullopt;
+  }
+  bool alreadyVisible = (stageMask & ~state.visibleStages) == 0 &&
+                        (accessMask & ~state.visibleAccess) == 0;
+  if (alreadyVisible) {
+    return std::nullopt;
+  }
+  barrier.srcStageMask = state.writeStages;
+  return barrier;
+}
+
+}  // namespace
+
+std::optional<AccessBarrier> trackAccess(ResourceAccessState &state,
+                                         VkPipelineStageFlags2 stageMask,
+                                         VkAccessFlags2 accessMask,
+                                         bool isWrite,
+                                         std::optional<VkImageLayout> layout) {
+  auto newLayout = layout.value_or(state.layout);
+  auto barrier =
+      computeBarrier(state, stageMask, accessMask, isWrite, newLayout);
+
+  if (isWrite) {
+    state.writeStages = stageMask;
+    state.writeAccess = accessMask;
+    state.readStages = 0;
+    state.visibleStages = 0;
+    state.visibleAccess = 0;
+  } else {
+    state.readStages |= stageMask;
+    if (barrier.has_value()) {
+      state.visibleStages |= barrier->dstStageMask;
+      state.visibleAccess |= barrier->dstAccessMask;
+    }
+  }
+  state.layout = newLayout;
+  return barrier;
+}
+
+}  // namespace vinkan
@@ -0,0 +1,47 @@
+#ifndef VINKAN_RESOURCE_STATE_HPP
+#define VINKAN_RESOURCE_STATE_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <optional>
+
+namespace vinkan {
+
+// What happened last to a buffer or an image on the GPU timeline, as far as
+// the recorded commands know.
+struct ResourceAccessState {
+  VkPipelineStageFlags2 writeStages = 0;
+  VkAccessFlags2 writeAccess = 0;
+  // Stages reading since the last write
+  VkPipelineStageFlags2 readStages = 0;
+  // The last write is already visible to these stages and accesses
+  VkPipelineStageFlags2 visibleStages = 0;
+  VkAccessFlags2 visibleAccess = 0;
+  VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+  // Owner for exclusive resources, ignored until a transfer happens
+  uint32_t queueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+};
+
+struct AccessBarrier {
+  VkPipelineStageFlags2 srcStageMask;
+  VkAccessFlags2 srcAccessMask;
+  VkPipelineStageFlags2 dstStageMask;
+  VkAccessFlags2 dstAccessMask;
+  VkImageLayout oldLayout;
+  VkImageLayout newLayout;
+};
+
+bool isWriteAccess(VkAccessFlags2 accessMask);
+
+// Returns the barrier needed before the access (if any) and moves the state
+// after the access. Reads after reads and reads of a write already made
+// visible to them don't need a barrier, a write after reads only needs an
+// execution dependency. layout is only given for images.
+std::optional<AccessBarrier> trackAccess(
+    ResourceAccessState &state, VkPipelineStageFlags2 stageMask,
+    VkAccessFlags2 accessMask, bool isWrite,
+    std::optional<VkImageLayout> layout = std::nullopt);
+
+}  // namespace vinkan
+
+#endif
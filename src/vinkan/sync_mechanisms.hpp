@@ -24,14 +24,16 @@ class SyncMechanisms {
     return semaphores_.at(semaphoreIdentifier);
   }
 
-  SyncMechanisms(VkDevice device) : device_(device) {}
+  SyncMechanisms(VkDevice device,
+                 const VkAllocationCallbacks* allocator = nullptr)
+      : device_(device), allocator_(allocator) {}
 
   ~SyncMechanisms() {
     for (auto& [identifier, fence] : fences_) {
-      vkDestroyFence(device_, fence, nullptr);
+      vkDestroyFence(device_, fence, allocator_);
     }
     for (auto& [identifier, semaphore] : semaphores_) {
-      vkDestroySemaphore(device_, semaphore, nullptr);
+      vkDestroySemaphore(device_, semaphore, allocator_);
     }
   }
 
@@ -47,12 +49,13 @@ class SyncMechanisms {
 
     for (auto fenceIdentifier : fenceIdentifiers) {
       VkFence fence;
-      if (vkCreateFence(device_, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+      if (vkCreateFence(device_, &fenceInfo, allocator_, &fence) !=
+          VK_SUCCESS) {
         throw std::runtime_error("Failed to create fence");
       }
       fences_[fenceIdentifier] = fence;
     }
-    SPDLOG_LOGGER_INFO(get_vinkan_logger(), "Long lived fences created");
+    SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Long lived fences created");
   }
 
   void createFence(FenceT fenceIdentifier, bool signaled = false) {
@@ -66,13 +69,13 @@ class SyncMechanisms {
 
     for (auto semaphoreIdentifier : semaphoreIdentifiers) {
       VkSemaphore semaphore;
-      if (vkCreateSemaphore(device_, &semaphoreInfo, nullptr, &semaphore) !=
+      if (vkCreateSemaphore(device_, &semaphoreInfo, allocator_, &semaphore) !=
           VK_SUCCESS) {
         throw std::runtime_error("Failed to create semaphore");
       }
       semaphores_[semaphoreIdentifier] = semaphore;
     }
-    SPDLOG_LOGGER_INFO(get_vinkan_logger(), "Long lived semaphores created");
+    SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Long lived semaphores created");
   }
 
   void createSemaphore(SemT semaphoreIdentifier) {
@@ -84,10 +87,10 @@ class SyncMechanisms {
     for (auto fenceIdentifier : fenceIdentifiers) {
       assert(fences_.contains(fenceIdentifier));
 
-      vkDestroyFence(device_, fences_[fenceIdentifier], nullptr);
+      vkDestroyFence(device_, fences_[fenceIdentifier], allocator_);
       fences_.erase(fenceIdentifier);
     }
-    SPDLOG_LOGGER_INFO(get_vinkan_logger(), "Fences freed");
+    SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Fences freed");
   }
 
   void freeFence(FenceT fenceIdentifier) {
@@ -98,10 +101,10 @@ class SyncMechanisms {
     for (auto semaphoreIdentifier : semaphoreIdentifiers) {
       assert(semaphores_.contains(semaphoreIdentifier));
 
-      vkDestroySemaphore(device_, semaphores_[semaphoreIdentifier], nullptr);
+      vkDestroySemaphore(device_, semaphores_[semaphoreIdentifier], allocator_);
       semaphores_.erase(semaphoreIdentifier);
     }
-    SPDLOG_LOGGER_INFO(get_vinkan_logger(), "Semaphores freed");
+    SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Semaphores freed");
   }
 
   void freeSemaphore(SemT semaphoreIdentifier) {
@@ -110,6 +113,7 @@ class SyncMechanisms {
 
  private:
   VkDevice device_;
+  const VkAllocationCallbacks* allocator_;
   std::map<FenceT, VkFence> fences_;
   std::map<SemT, VkSemaphore> semaphores_;
 };
@@ -3,14 +3,50 @@
 
 // Wrappers
 #include "command_coordinator.hpp"
+#include "commands/command_recorder.hpp"
+#include "commands/compute_coalescer.hpp"
+#include "commands/dispatch_sizing.hpp"
+#include "commands/hot_kernel.hpp"
+#include "commands/queue_scheduler.hpp"
+#include "commands/static_command_cache.hpp"
+#include "commands/submit_batch.hpp"
+#include "coroutines/gpu_reactor.hpp"
+#include "coroutines/task.hpp"
 #include "glfw/glfw_vk_surface.hpp"
+#include "jobs/job_system.hpp"
+#include "kernels/gpu_gemm.hpp"
+#include "kernels/gpu_image_processing.hpp"
+#include "kernels/gpu_primitives.hpp"
+#include "kernels/gpu_radix_sort.hpp"
+#include "kernels/kernel_commands.hpp"
+#include "kernels/kernel_host_runner.hpp"
+#include "kernels/kernel_library_info.hpp"
+#include "logging/chrome_trace.hpp"
+#include "logging/debug_utils.hpp"
+#include "logging/diagnostics.hpp"
+#include "logging/tracer.hpp"
+#include "memory/host_allocator.hpp"
 #include "models/model.hpp"
+#include "models/multi_draw_model.hpp"
 #include "pipelines/pipelines.hpp"
+#include "pipelines/spirv_reflection.hpp"
+#include "profiling/gpu_profiler.hpp"
+#include "profiling/pipeline_executable_report.hpp"
+#include "profiling/pipeline_statistics.hpp"
+#include "render/frame_manager.hpp"
+#include "render/render_graph.hpp"
 #include "render/render_stage.hpp"
 #include "resources/resources.hpp"
+#include "sync/barriers.hpp"
+#include "sync/fence_pool.hpp"
+#include "sync/in_flight_tracker.hpp"
+#include "sync/queue_dependency.hpp"
+#include "sync/resource_state.hpp"
 #include "sync_mechanisms.hpp"
 #include "wrappers/buffer.hpp"
 #include "wrappers/device.hpp"
+#include "wrappers/device_dispatch.hpp"
+#include "wrappers/indirect_buffer.hpp"
 #include "wrappers/instance.hpp"
 #include "wrappers/physical_device.hpp"
 #include "wrappers/render_pass.hpp"
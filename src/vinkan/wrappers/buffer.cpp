@@ -1,6 +1,8 @@
 #include "buffer.hpp"
 
 #include "vinkan/logging/logger.hpp"
+#include "vinkan/logging/tracer.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
 
 // std
 #include <cassert>
@@ -34,12 +36,15 @@ VkDeviceSize Buffer::getAlignment(VkDeviceSize instanceSize,
 
 Buffer::Buffer(VkDevice device,
                VkPhysicalDeviceMemoryProperties deviceMemoryProperties,
-               BufferInfo bufferInfo)
+               BufferInfo bufferInfo,
+               const VkAllocationCallbacks *allocator)
     : device_(device),
+      allocator_(allocator),
       instanceSize{bufferInfo.instanceSize},
       instanceCount{bufferInfo.instanceCount},
       usageFlags{bufferInfo.usageFlags},
       memoryPropertyFlags{bufferInfo.memoryPropertyFlags} {
+  VINKAN_TRACE_SCOPE("Buffer::Buffer");
   alignmentSize = getAlignment(instanceSize, bufferInfo.minOffsetAlignment);
   bufferSize = alignmentSize * instanceCount;
 
@@ -56,7 +61,7 @@ Buffer::Buffer(VkDevice device,
         bufferInfo.sharingMode.concurrentQueueFamilies->data();
   }
 
-  if (vkCreateBuffer(device_, &bufferCreateInfo, nullptr, &handle_) !=
+  if (vkCreateBuffer(device_, &bufferCreateInfo, allocator_, &handle_) !=
       VK_SUCCESS) {
     throw std::runtime_error("Failed to create buffer !");
   }
@@ -70,35 +75,52 @@ Buffer::Buffer(VkDevice device,
   allocInfo.memoryTypeIndex =
       getMemoryTypeIndex(memRequirements.memoryTypeBits, deviceMemoryProperties,
                          bufferInfo.memoryPropertyFlags);
+  // Addressable buffers need addressable memory
+  VkMemoryAllocateFlagsInfo allocateFlagsInfo{};
+  allocateFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+  allocateFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+  if (usageFlags & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
+    allocInfo.pNext = &allocateFlagsInfo;
+  }
 
-  if (vkAllocateMemory(device_, &allocInfo, nullptr, &memory_) != VK_SUCCESS) {
+  if (vkAllocateMemory(device_, &allocInfo, allocator_, &memory_) !=
+      VK_SUCCESS) {
     throw std::runtime_error("failed to allocate vertex buffer memory!");
   }
 
   vkBindBufferMemory(device_, handle_, memory_, 0);
-  SPDLOG_LOGGER_INFO(get_vinkan_logger(), "Buffer created");
+  SPDLOG_LOGGER_TRACE(get_vinkan_logger(), "Buffer created");
 }
 
 Buffer::~Buffer() {
   if (isHandleValid()) {
     unmap();
-    vkDestroyBuffer(device_, handle_, nullptr);
-    vkFreeMemory(device_, memory_, nullptr);
+    vkDestroyBuffer(device_, handle_, allocator_);
+    vkFreeMemory(device_, memory_, allocator_);
   }
 }
 
 VkResult Buffer::map(VkDeviceSize size, VkDeviceSize offset) {
   assert(handle_ && memory_ && "Called map on buffer before create");
-  return vkMapMemory(device_, memory_, offset, size, 0, &mapped);
+  return deviceDispatch.vkMapMemory(device_, memory_, offset, size, 0, &mapped);
 }
 
 void Buffer::unmap() {
   if (mapped) {
-    vkUnmapMemory(device_, memory_);
+    deviceDispatch.vkUnmapMemory(device_, memory_);
     mapped = nullptr;
   }
 }
 
+VkDeviceAddress Buffer::getDeviceAddress() const {
+  assert((usageFlags & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) &&
+         "The buffer wasn't created with the shader device address usage");
+  VkBufferDeviceAddressInfo addressInfo{};
+  addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+  addressInfo.buffer = handle_;
+  return deviceDispatch.vkGetBufferDeviceAddress(device_, &addressInfo);
+}
+
 void Buffer::readBuffer(void *data) {
   assert(mapped && "Cannot copy to unmapped buffer");
   memcpy(data, mapped, bufferSize);
@@ -122,7 +144,7 @@ VkResult Buffer::flush(VkDeviceSize size, VkDeviceSize offset) {
   mappedRange.memory = memory_;
   mappedRange.offset = offset;
   mappedRange.size = size;
-  return vkFlushMappedMemoryRanges(device_, 1, &mappedRange);
+  return deviceDispatch.vkFlushMappedMemoryRanges(device_, 1, &mappedRange);
 }
 
 VkResult Buffer::invalidate(VkDeviceSize size, VkDeviceSize offset) {
@@ -131,7 +153,8 @@ VkResult Buffer::invalidate(VkDeviceSize size, VkDeviceSize offset) {
   mappedRange.memory = memory_;
   mappedRange.offset = offset;
   mappedRange.size = size;
-  return vkInvalidateMappedMemoryRanges(device_, 1, &mappedRange);
+  return deviceDispatch.vkInvalidateMappedMemoryRanges(device_, 1,
+                                                       &mappedRange);
 }
 
 VkDescriptorBufferInfo Buffer::descriptorInfo(VkDeviceSize size,
@@ -5,6 +5,7 @@
 
 #include "vinkan/generics/ptr_handle_wrapper.hpp"
 #include "vinkan/structs/sharing_mode.hpp"
+#include "vinkan/sync/resource_state.hpp"
 
 namespace vinkan {
 
@@ -17,11 +18,17 @@ struct BufferInfo {
   VkDeviceSize minOffsetAlignment = 1;
 };
 
+uint32_t getMemoryTypeIndex(
+    uint32_t typeFilter,
+    VkPhysicalDeviceMemoryProperties deviceMemoryProperties,
+    VkMemoryPropertyFlags bufferMemoryPropFlags);
+
 class Buffer : public PtrHandleWrapper<VkBuffer> {
  public:
   Buffer(VkDevice device,
          VkPhysicalDeviceMemoryProperties deviceMemoryProperties,
-         BufferInfo bufferInfo);
+         BufferInfo bufferInfo,
+         const VkAllocationCallbacks* allocator = nullptr);
   ~Buffer();
 
   Buffer(const Buffer&) = delete;
@@ -56,11 +63,18 @@ class Buffer : public PtrHandleWrapper<VkBuffer> {
     return memoryPropertyFlags;
   }
   VkDeviceSize getBufferSize() const { return bufferSize; }
+  // Needs the shader device address usage and the bufferDeviceAddress
+  // feature
+  VkDeviceAddress getDeviceAddress() const;
+
+  // Last GPU accesses recorded through a CommandRecorder
+  ResourceAccessState& getAccessState() { return accessState_; }
 
  private:
   static VkDeviceSize getAlignment(VkDeviceSize instanceSize,
                                    VkDeviceSize minOffsetAlignment);
   VkDevice device_;
+  const VkAllocationCallbacks* allocator_;
 
   void* mapped = nullptr;
   VkDeviceMemory memory_ = VK_NULL_HANDLE;
@@ -71,6 +85,8 @@ class Buffer : public PtrHandleWrapper<VkBuffer> {
   VkDeviceSize alignmentSize;
   VkBufferUsageFlags usageFlags;
   VkMemoryPropertyFlags memoryPropertyFlags;
+
+  ResourceAccessState accessState_{};
 };
 
 }  // namespace vinkan
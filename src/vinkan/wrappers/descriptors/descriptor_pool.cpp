@@ -3,6 +3,8 @@
 // std
 #include <stdexcept>
 
+#include "vinkan/wrappers/device_dispatch.hpp"
+
 namespace vinkan {
 
 ///////////////
@@ -27,7 +29,7 @@ DescriptorPool::Builder &DescriptorPool::Builder::setMaxSets(uint32_t count) {
 
 std::unique_ptr<DescriptorPool> DescriptorPool::Builder::build() const {
   return std::unique_ptr<DescriptorPool>(
-      new DescriptorPool(device_, maxSets, poolFlags, poolSizes));
+      new DescriptorPool(device_, maxSets, poolFlags, poolSizes, allocator_));
 }
 
 ///////////////
@@ -36,8 +38,9 @@ std::unique_ptr<DescriptorPool> DescriptorPool::Builder::build() const {
 
 DescriptorPool::DescriptorPool(
     VkDevice device, uint32_t maxSets, VkDescriptorPoolCreateFlags poolFlags,
-    const std::vector<VkDescriptorPoolSize> &poolSizes)
-    : device_{device} {
+    const std::vector<VkDescriptorPoolSize> &poolSizes,
+    const VkAllocationCallbacks *allocator)
+    : device_{device}, allocator_{allocator} {
   VkDescriptorPoolCreateInfo descriptorPoolInfo{};
   descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
   descriptorPoolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
@@ -45,14 +48,14 @@ DescriptorPool::DescriptorPool(
   descriptorPoolInfo.maxSets = maxSets;
   descriptorPoolInfo.flags = poolFlags;
 
-  if (vkCreateDescriptorPool(device_, &descriptorPoolInfo, nullptr,
+  if (vkCreateDescriptorPool(device_, &descriptorPoolInfo, allocator_,
                              &descriptorPool) != VK_SUCCESS) {
     throw std::runtime_error("failed to create descriptor pool!");
   }
 }
 
 DescriptorPool::~DescriptorPool() {
-  vkDestroyDescriptorPool(device_, descriptorPool, nullptr);
+  vkDestroyDescriptorPool(device_, descriptorPool, allocator_);
 }
 
 bool DescriptorPool::allocateDescriptorSet(
@@ -64,8 +67,8 @@ bool DescriptorPool::allocateDescriptorSet(
   allocInfo.pSetLayouts = &descriptorSetLayout;
   allocInfo.descriptorSetCount = 1;
 
-  if (vkAllocateDescriptorSets(device_, &allocInfo, &descriptor) !=
-      VK_SUCCESS) {
+  if (deviceDispatch.vkAllocateDescriptorSets(
+          device_, &allocInfo, &descriptor) != VK_SUCCESS) {
     return false;
   }
   return true;
@@ -79,7 +82,7 @@ void DescriptorPool::freeDescriptors(
 }
 
 void DescriptorPool::resetPool() {
-  vkResetDescriptorPool(device_, descriptorPool, 0);
+  deviceDispatch.vkResetDescriptorPool(device_, descriptorPool, 0);
 }
 
 }  // namespace vinkan
@@ -12,7 +12,8 @@ class DescriptorPool {
  public:
   class Builder {
    public:
-    Builder(VkDevice device) : device_{device} {}
+    Builder(VkDevice device, const VkAllocationCallbacks *allocator = nullptr)
+        : device_{device}, allocator_{allocator} {}
 
     Builder &addPoolSize(VkDescriptorType descriptorType, uint32_t count);
     Builder &setPoolFlags(VkDescriptorPoolCreateFlags flags);
@@ -21,6 +22,7 @@ class DescriptorPool {
 
    private:
     VkDevice device_;
+    const VkAllocationCallbacks *allocator_;
     std::vector<VkDescriptorPoolSize> poolSizes{};
     uint32_t maxSets = 1000;
     VkDescriptorPoolCreateFlags poolFlags = 0;
@@ -35,11 +37,15 @@ class DescriptorPool {
   void freeDescriptors(const std::vector<VkDescriptorSet> &descriptors) const;
   void resetPool();
 
+  VkDescriptorPool getHandle() const { return descriptorPool; }
+
  private:
   DescriptorPool(VkDevice device, uint32_t maxSets,
                  VkDescriptorPoolCreateFlags poolFlags,
-                 const std::vector<VkDescriptorPoolSize> &poolSizes);
+                 const std::vector<VkDescriptorPoolSize> &poolSizes,
+                 const VkAllocationCallbacks *allocator);
   VkDevice device_;
+  const VkAllocationCallbacks *allocator_;
   VkDescriptorPool descriptorPool;
 
   friend class Builder;
@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <cassert>
 
+#include "vinkan/wrappers/device_dispatch.hpp"
+
 namespace vinkan {
 
 DescriptorSet::Builder &DescriptorSet::Builder::setBuffer(
@@ -40,8 +42,8 @@ std::unique_ptr<DescriptorSet> DescriptorSet::Builder::build() {
     setWrite.dstSet = descriptorSet;
   }
 
-  vkUpdateDescriptorSets(device_, setWrites_.size(), setWrites_.data(), 0,
-                         nullptr);
+  deviceDispatch.vkUpdateDescriptorSets(device_, setWrites_.size(),
+                                        setWrites_.data(), 0, nullptr);
   return std::unique_ptr<DescriptorSet>(new DescriptorSet(descriptorSet));
 }
 
@@ -49,8 +51,8 @@ void DescriptorSet::Builder::build(DescriptorSet &descriptorSet) {
   for (auto &setWrite : setWrites_) {
     setWrite.dstSet = descriptorSet.getHandle();
   }
-  vkUpdateDescriptorSets(device_, setWrites_.size(), setWrites_.data(), 0,
-                         nullptr);
+  deviceDispatch.vkUpdateDescriptorSets(device_, setWrites_.size(),
+                                        setWrites_.data(), 0, nullptr);
 }
 
 DescriptorSet::DescriptorSet(VkDescriptorSet handle) { handle_ = handle; }
@@ -27,7 +27,7 @@ DescriptorSetLayout::Builder &DescriptorSetLayout::Builder::addBinding(
 std::unique_ptr<DescriptorSetLayout> DescriptorSetLayout::Builder::build()
     const {
   auto setLayout = std::unique_ptr<DescriptorSetLayout>(
-      new DescriptorSetLayout(device_, vkBindings_));
+      new DescriptorSetLayout(device_, vkBindings_, allocator_));
   return setLayout;
 }
 
@@ -37,8 +37,9 @@ std::unique_ptr<DescriptorSetLayout> DescriptorSetLayout::Builder::build()
 
 DescriptorSetLayout::DescriptorSetLayout(
     VkDevice device,
-    std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings)
-    : device_(device), bindings_(bindings) {
+    std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
+    const VkAllocationCallbacks *allocator)
+    : device_(device), allocator_(allocator), bindings_(bindings) {
   std::vector<VkDescriptorSetLayoutBinding> layoutBindings{};
   for (const auto &[bindingIndex, binding] : bindings) {
     layoutBindings.push_back(binding);
@@ -51,14 +52,14 @@ DescriptorSetLayout::DescriptorSetLayout(
       static_cast<uint32_t>(layoutBindings.size());
   descriptorSetLayoutInfo.pBindings = layoutBindings.data();
 
-  if (vkCreateDescriptorSetLayout(device_, &descriptorSetLayoutInfo, nullptr,
-                                  &handle_) != VK_SUCCESS) {
+  if (vkCreateDescriptorSetLayout(device_, &descriptorSetLayoutInfo,
+                                  allocator_, &handle_) != VK_SUCCESS) {
     throw std::runtime_error("Could not create the descriptor set layout");
   }
 }
 
 DescriptorSetLayout::~DescriptorSetLayout() {
-  vkDestroyDescriptorSetLayout(device_, handle_, nullptr);
+  vkDestroyDescriptorSetLayout(device_, handle_, allocator_);
 }
 
 VkDescriptorSetLayoutBinding DescriptorSetLayout::getLayoutBinding(
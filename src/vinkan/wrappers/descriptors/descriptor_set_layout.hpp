@@ -21,13 +21,15 @@ class DescriptorSetLayout : public PtrHandleWrapper<VkDescriptorSetLayout> {
  public:
   class Builder {
    public:
-    Builder(VkDevice device) : device_(device) {}
+    Builder(VkDevice device, const VkAllocationCallbacks *allocator = nullptr)
+        : device_(device), allocator_(allocator) {}
 
     Builder &addBinding(DescriptorSetLayoutBinding descriptorSetLayoutBinding);
     std::unique_ptr<DescriptorSetLayout> build() const;
 
    private:
     VkDevice device_;
+    const VkAllocationCallbacks *allocator_;
     std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> vkBindings_{};
   };
 
@@ -42,8 +44,10 @@ class DescriptorSetLayout : public PtrHandleWrapper<VkDescriptorSetLayout> {
  private:
   DescriptorSetLayout(
       VkDevice device,
-      std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings);
+      std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
+      const VkAllocationCallbacks *allocator);
   VkDevice device_;
+  const VkAllocationCallbacks *allocator_;
   std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings_;
 
   friend class Builder;
@@ -3,6 +3,7 @@
 
 #include <vulkan/vulkan.h>
 
+#include <bit>
 #include <map>
 #include <memory>
 #include <optional>
@@ -13,6 +14,7 @@
 #include "vinkan/generics/ptr_handle_wrapper.hpp"
 #include "vinkan/logging/logger.hpp"
 #include "vinkan/structs/queue_family_info.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
 
 namespace vinkan {
 
@@ -43,19 +45,50 @@ class Device : public PtrHandleWrapper<VkDevice> {
     return allocInfo.queueFamilyIndex;
   }
 
+  uint32_t getQueueCount(T queueIdentifier) {
+    auto &allocInfo = familyIdentifierToAllocInfo_[queueIdentifier];
+    return allocInfo.queueCount;
+  }
+
+  std::vector<VkQueue> getQueues(T queueIdentifier) {
+    std::vector<VkQueue> queues{};
+    for (uint32_t n = 0; n < getQueueCount(queueIdentifier); ++n) {
+      queues.push_back(getQueue(queueIdentifier, n));
+    }
+    return queues;
+  }
+
+  bool isSynchronization2Enabled() const { return synchronization2_; }
+
+  // Functions of this device without the loader trampolines, for the
+  // application's own calls (e.g. dispatch.vkCmdDraw(...))
+  const DeviceDispatch &getDispatch() const { return dispatch_; }
+
+  // Host allocation callbacks given to the builder, to pass to the wrappers
+  // creating objects of this device
+  const VkAllocationCallbacks *getAllocator() const { return allocator_; }
+
   ~Device() {
     if (isHandleValid()) {
-      vkDestroyDevice(handle_, nullptr);
+      uninstallDeviceDispatch(handle_);
+      vkDestroyDevice(handle_, allocator_);
     }
   }
 
  private:
   std::map<T, AllocatedQueueFamilyInfo> familyIdentifierToAllocInfo_{};
+  bool synchronization2_ = false;
+  DeviceDispatch dispatch_{};
+  const VkAllocationCallbacks *allocator_ = nullptr;
 
   Device(VkDevice device,
-         std::map<T, AllocatedQueueFamilyInfo> familyIdentifierToAllocInfo)
-      : familyIdentifierToAllocInfo_(familyIdentifierToAllocInfo) {
+         std::map<T, AllocatedQueueFamilyInfo> familyIdentifierToAllocInfo,
+         bool synchronization2, const VkAllocationCallbacks *allocator)
+      : familyIdentifierToAllocInfo_(familyIdentifierToAllocInfo),
+        synchronization2_(synchronization2),
+        allocator_(allocator) {
     handle_ = device;
+    dispatch_.load(device);
   }
 
   friend class Builder;
@@ -65,6 +98,14 @@ class Device : public PtrHandleWrapper<VkDevice> {
 //  BUILDER  //
 ///////////////
 
+enum class QueueSelectionPolicy {
+  // First family fitting the request
+  FIRST_FIT,
+  // Family fitting the request with the fewest other capabilities, e.g. a
+  // compute only family for async compute or a transfer only one for uploads
+  PREFER_DEDICATED,
+};
+
 template <EnumType T>
 struct QueueFamilyRequest {
   T queueFamilyIdentifier;
@@ -73,6 +114,7 @@ struct QueueFamilyRequest {
   std::optional<VkSurfaceKHR> surfacePresentationSupport;
   uint32_t nQueues;
   std::vector<float> queuePriorities;
+  QueueSelectionPolicy selectionPolicy = QueueSelectionPolicy::FIRST_FIT;
 };
 
 template <EnumType T>
@@ -85,6 +127,40 @@ class Device<T>::Builder {
   void addExtensions(const std::set<const char *> deviceExtensions) {
     deviceExtensions_.insert(deviceExtensions.begin(), deviceExtensions.end());
   }
+  // Needs a Vulkan 1.3 instance and physical device
+  void enableSynchronization2() { features13_.synchronization2 = VK_TRUE; }
+  // Core in Vulkan 1.2, needed by the QueueScheduler
+  void enableTimelineSemaphore() { timelineSemaphore_ = true; }
+  // Several draws per indirect call, with a first instance per draw
+  void enableMultiDrawIndirect() { multiDrawIndirect_ = true; }
+  // Core in Vulkan 1.2, draw count read from a buffer
+  void enableDrawIndirectCount() { drawIndirectCount_ = true; }
+  // Core in Vulkan 1.2, lets the GpuProfiler reset its queries from the host
+  void enableHostQueryReset() { hostQueryReset_ = true; }
+  // Core in Vulkan 1.2, buffers created with the shader device address usage
+  // can then be accessed through their address, e.g. by the GpuPrimitives
+  void enableBufferDeviceAddress() { bufferDeviceAddress_ = true; }
+  // Core in Vulkan 1.2, f16 arithmetic in shaders and f16 storage buffers,
+  // e.g. for the f16 GpuGemm kernels
+  void enableFloat16Compute() { float16Compute_ = true; }
+  // Core in Vulkan 1.3, the VK_EXT_subgroup_size_control extension must be
+  // added on older devices. Lets compute pipelines require full subgroups,
+  // needed by the GpuPrimitives and GpuRadixSort kernels
+  void enableFullComputeSubgroups() { fullComputeSubgroups_ = true; }
+  // Needed by PipelineStatistics
+  void enablePipelineStatisticsQuery() { pipelineStatisticsQuery_ = true; }
+  // Shader statistics of the pipelines, the
+  // VK_KHR_pipeline_executable_properties extension must be added too
+  void enablePipelineExecutableInfo() {
+    pipelineExecutableFeatures_.pipelineExecutableInfo = VK_TRUE;
+  }
+  // The vinkan wrappers then call the device functions directly instead of
+  // going through the loader. Only one device can have it at a time.
+  void enableDirectDispatch() { directDispatch_ = true; }
+  // Host allocations of the device, it must outlive the device
+  void setAllocator(const VkAllocationCallbacks *allocator) {
+    allocator_ = allocator;
+  }
   void addQueue(QueueFamilyRequest<T> &queueRequest, bool differentFromPrevious,
                 bool &success) {
     assert(queueRequest.queuePriorities.size() == queueRequest.nQueues);
@@ -94,11 +170,19 @@ class Device<T>::Builder {
       if (differentFromPrevious && isPreviousQueue_(queueInfo)) {
         continue;
       }
-      // If it fits the request, we're done
-      if (queueFitRequest_(queueInfo, queueRequest)) {
+      if (!queueFitRequest_(queueInfo, queueRequest)) {
+        continue;
+      }
+      // If it fits the request, we're done unless we look for a dedicated one
+      if (queueRequest.selectionPolicy == QueueSelectionPolicy::FIRST_FIT) {
         selectedQueueOpt = queueInfo;
         break;
       }
+      if (!selectedQueueOpt.has_value() ||
+          extraCapabilities_(queueInfo, queueRequest) <
+              extraCapabilities_(selectedQueueOpt.value(), queueRequest)) {
+        selectedQueueOpt = queueInfo;
+      }
     }
     // If we didn't find any, we go out
     if (!selectedQueueOpt.has_value()) {
@@ -117,14 +201,59 @@ class Device<T>::Builder {
     success = true;
   }
   std::unique_ptr<Device<T>> build() {
-    VkPhysicalDeviceVulkan12Features features12{};
-    features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
-    features12.runtimeDescriptorArray = VK_TRUE;
-    features12.pNext = nullptr;
+    features12_.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    features12_.runtimeDescriptorArray = VK_TRUE;
+    features12_.timelineSemaphore = timelineSemaphore_ ? VK_TRUE : VK_FALSE;
+    features12_.drawIndirectCount = drawIndirectCount_ ? VK_TRUE : VK_FALSE;
+    features12_.hostQueryReset = hostQueryReset_ ? VK_TRUE : VK_FALSE;
+    features12_.bufferDeviceAddress =
+        bufferDeviceAddress_ ? VK_TRUE : VK_FALSE;
+    features12_.shaderFloat16 = float16Compute_ ? VK_TRUE : VK_FALSE;
+    features12_.pNext = nullptr;
+    features11_.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+    features11_.storageBuffer16BitAccess =
+        float16Compute_ ? VK_TRUE : VK_FALSE;
+    features11_.pNext = &features12_;
+
+    // The 1.3 features are only chained when one of them is requested so
+    // that 1.2 devices keep working
+    bool synchronization2 = features13_.synchronization2 == VK_TRUE;
+    features13_.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    features13_.pNext = nullptr;
+    if (synchronization2) {
+      features12_.pNext = &features13_;
+    }
+    // Through the 1.3 features when they're chained, they can't be chained
+    // with the extension structure
+    subgroupSizeControlFeatures_.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_SIZE_CONTROL_FEATURES;
+    subgroupSizeControlFeatures_.pNext = nullptr;
+    if (fullComputeSubgroups_ && synchronization2) {
+      features13_.subgroupSizeControl = VK_TRUE;
+      features13_.computeFullSubgroups = VK_TRUE;
+    } else if (fullComputeSubgroups_) {
+      subgroupSizeControlFeatures_.subgroupSizeControl = VK_TRUE;
+      subgroupSizeControlFeatures_.computeFullSubgroups = VK_TRUE;
+      subgroupSizeControlFeatures_.pNext = features12_.pNext;
+      features12_.pNext = &subgroupSizeControlFeatures_;
+    }
+    pipelineExecutableFeatures_.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PIPELINE_EXECUTABLE_PROPERTIES_FEATURES_KHR;
+    pipelineExecutableFeatures_.pNext = nullptr;
+    if (pipelineExecutableFeatures_.pipelineExecutableInfo == VK_TRUE) {
+      pipelineExecutableFeatures_.pNext = features12_.pNext;
+      features12_.pNext = &pipelineExecutableFeatures_;
+    }
 
     VkPhysicalDeviceFeatures deviceFeatures{};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
     deviceFeatures.fragmentStoresAndAtomics = VK_TRUE;
+    deviceFeatures.pipelineStatisticsQuery =
+        pipelineStatisticsQuery_ ? VK_TRUE : VK_FALSE;
+    if (multiDrawIndirect_) {
+      deviceFeatures.multiDrawIndirect = VK_TRUE;
+      deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
+    }
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 
@@ -133,7 +262,10 @@ class Device<T>::Builder {
     createInfo.pQueueCreateInfos = queueCreateInfo_.data();
 
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.pNext = &features12;
+    createInfo.pNext = &features12_;
+    if (float16Compute_) {
+      createInfo.pNext = &features11_;
+    }
     std::vector<const char *> deviceExtensionsVector(deviceExtensions_.begin(),
                                                      deviceExtensions_.end());
     createInfo.enabledExtensionCount =
@@ -143,12 +275,16 @@ class Device<T>::Builder {
     createInfo.enabledLayerCount = 0;
 
     VkDevice deviceHandle;
-    if (vkCreateDevice(physicalDevice_, &createInfo, nullptr, &deviceHandle) !=
-        VK_SUCCESS) {
+    if (vkCreateDevice(physicalDevice_, &createInfo, allocator_,
+                       &deviceHandle) != VK_SUCCESS) {
       throw std::runtime_error("Could not create the vulkan device");
     }
     std::unique_ptr<Device<T>> device = std::unique_ptr<Device<T>>(
-        new Device<T>(deviceHandle, familyIdentifierToAllocInfo_));
+        new Device<T>(deviceHandle, familyIdentifierToAllocInfo_,
+                      synchronization2, allocator_));
+    if (directDispatch_) {
+      installDeviceDispatch(device->getDispatch());
+    }
     SPDLOG_LOGGER_INFO(get_vinkan_logger(), "Device created !");
     return std::move(device);
   }
@@ -162,6 +298,22 @@ class Device<T>::Builder {
   VkPhysicalDevice physicalDevice_;
   std::set<const char *> deviceExtensions_{};
   std::vector<VkDeviceQueueCreateInfo> queueCreateInfo_{};
+  VkPhysicalDeviceVulkan11Features features11_{};
+  VkPhysicalDeviceVulkan12Features features12_{};
+  VkPhysicalDeviceVulkan13Features features13_{};
+  VkPhysicalDevicePipelineExecutablePropertiesFeaturesKHR
+      pipelineExecutableFeatures_{};
+  VkPhysicalDeviceSubgroupSizeControlFeatures subgroupSizeControlFeatures_{};
+  bool timelineSemaphore_ = false;
+  bool multiDrawIndirect_ = false;
+  bool drawIndirectCount_ = false;
+  bool hostQueryReset_ = false;
+  bool bufferDeviceAddress_ = false;
+  bool float16Compute_ = false;
+  bool fullComputeSubgroups_ = false;
+  bool pipelineStatisticsQuery_ = false;
+  bool directDispatch_ = false;
+  const VkAllocationCallbacks *allocator_ = nullptr;
 
   bool isPreviousQueue_(QueueFamilyInfo queueInfo) const {
     for (auto previousQueueCreate : queueCreateInfo_) {
@@ -172,6 +324,16 @@ class Device<T>::Builder {
     return false;
   }
 
+  // Number of graphics/compute/transfer capabilities that weren't requested
+  uint32_t extraCapabilities_(QueueFamilyInfo queueInfo,
+                              QueueFamilyRequest<T> &queueRequest) const {
+    uint32_t capabilities =
+        VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+    uint32_t extraFlags =
+        queueInfo.queueFlags & capabilities & ~queueRequest.flagsRequested;
+    return static_cast<uint32_t>(std::popcount(extraFlags));
+  }
+
   bool queueFitRequest_(QueueFamilyInfo queueInfo,
                         QueueFamilyRequest<T> queueRequest) const {
     bool validFlags = false;
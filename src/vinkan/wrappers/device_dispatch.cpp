@@ -0,0 +1,45 @@
+#include "device_dispatch.hpp"
+
+#include <stdexcept>
+#include <string>
+
+#include "vinkan/logging/logger.hpp"
+
+namespace vinkan {
+
+void DeviceDispatch::load(VkDevice device) {
+  this->device = device;
+  uint32_t missingCount = 0;
+#define VINKAN_LOAD_MEMBER_(name)                                            \
+  if (auto function = vkGetDeviceProcAddr(device, #name)) {                  \
+    name = reinterpret_cast<PFN_##name>(function);                           \
+  } else if (auto khrFunction =                                              \
+                 vkGetDeviceProcAddr(device, #name "KHR")) {                 \
+    name = reinterpret_cast<PFN_##name>(khrFunction);                        \
+  } else {                                                                   \
+    missingCount++;                                                          \
+  }
+  VINKAN_DEVICE_FUNCTIONS(VINKAN_LOAD_MEMBER_)
+#undef VINKAN_LOAD_MEMBER_
+  SPDLOG_LOGGER_DEBUG(get_vinkan_logger(),
+                      "Device dispatch loaded, {} functions not exposed by "
+                      "the device",
+                      missingCount);
+}
+
+void installDeviceDispatch(const DeviceDispatch &dispatch) {
+  if (deviceDispatch.device != VK_NULL_HANDLE &&
+      deviceDispatch.device != dispatch.device) {
+    throw std::runtime_error(
+        "The dispatch of another device is already installed");
+  }
+  deviceDispatch = dispatch;
+}
+
+void uninstallDeviceDispatch(VkDevice device) {
+  if (deviceDispatch.device == device) {
+    deviceDispatch = DeviceDispatch{};
+  }
+}
+
+}  // namespace vinkan
@@ -0,0 +1,99 @@
+#ifndef VINKAN_DEVICE_DISPATCH_HPP
+#define VINKAN_DEVICE_DISPATCH_HPP
+
+#include <vulkan/vulkan.h>
+
+namespace vinkan {
+
+// Device functions called while recording and submitting. Creation and
+// destruction functions aren't on hot paths and keep the loader entry points.
+#define VINKAN_DEVICE_FUNCTIONS(X)     \
+  X(vkAcquireNextImageKHR)             \
+  X(vkAllocateCommandBuffers)          \
+  X(vkAllocateDescriptorSets)          \
+  X(vkBeginCommandBuffer)              \
+  X(vkCmdBeginQuery)                   \
+  X(vkCmdBeginRenderPass)              \
+  X(vkCmdBindDescriptorSets)           \
+  X(vkCmdBindIndexBuffer)              \
+  X(vkCmdBindPipeline)                 \
+  X(vkCmdBindVertexBuffers)            \
+  X(vkCmdCopyBuffer)                   \
+  X(vkCmdDispatch)                     \
+  X(vkCmdDispatchIndirect)             \
+  X(vkCmdDraw)                         \
+  X(vkCmdDrawIndexed)                  \
+  X(vkCmdDrawIndexedIndirect)          \
+  X(vkCmdDrawIndexedIndirectCount)     \
+  X(vkCmdDrawIndirect)                 \
+  X(vkCmdDrawIndirectCount)            \
+  X(vkCmdEndQuery)                     \
+  X(vkCmdEndRenderPass)                \
+  X(vkCmdFillBuffer)                   \
+  X(vkCmdPipelineBarrier)              \
+  X(vkCmdPipelineBarrier2)             \
+  X(vkCmdPushConstants)                \
+  X(vkCmdResetQueryPool)               \
+  X(vkCmdSetScissor)                   \
+  X(vkCmdSetViewport)                  \
+  X(vkCmdUpdateBuffer)                 \
+  X(vkCmdWriteTimestamp)               \
+  X(vkDeviceWaitIdle)                  \
+  X(vkEndCommandBuffer)                \
+  X(vkFlushMappedMemoryRanges)         \
+  X(vkFreeCommandBuffers)              \
+  X(vkGetBufferDeviceAddress)          \
+  X(vkGetFenceStatus)                  \
+  X(vkGetQueryPoolResults)             \
+  X(vkGetSemaphoreCounterValue)        \
+  X(vkInvalidateMappedMemoryRanges)    \
+  X(vkMapMemory)                       \
+  X(vkQueuePresentKHR)                 \
+  X(vkQueueSubmit)                     \
+  X(vkQueueSubmit2)                    \
+  X(vkQueueWaitIdle)                   \
+  X(vkResetCommandBuffer)              \
+  X(vkResetCommandPool)                \
+  X(vkResetDescriptorPool)             \
+  X(vkResetFences)                     \
+  X(vkResetQueryPool)                  \
+  X(vkSignalSemaphore)                 \
+  X(vkUnmapMemory)                     \
+  X(vkUpdateDescriptorSets)            \
+  X(vkWaitForFences)                   \
+  X(vkWaitSemaphores)
+
+// Without prototypes (e.g. with volk), the table must be loaded before use
+#ifdef VK_NO_PROTOTYPES
+#define VINKAN_DISPATCH_MEMBER_(name) PFN_##name name = nullptr;
+#else
+#define VINKAN_DISPATCH_MEMBER_(name) PFN_##name name = ::name;
+#endif
+
+// Function table of one device. Until it's loaded, its entries are the loader
+// entry points, which look the device up in the handle then jump to the
+// driver. Once loaded, the calls go to the driver directly.
+struct DeviceDispatch {
+  VINKAN_DEVICE_FUNCTIONS(VINKAN_DISPATCH_MEMBER_)
+
+  VkDevice device = VK_NULL_HANDLE;
+
+  // Entries the device doesn't expose (e.g. a feature of a newer version)
+  // are looked up with the KHR suffix, then keep the loader entry point
+  void load(VkDevice device);
+};
+
+#undef VINKAN_DISPATCH_MEMBER_
+
+// Table the vinkan wrappers call through
+inline DeviceDispatch deviceDispatch{};
+
+// Makes the wrappers call the functions of the device directly. The table is
+// global so only one device can be installed at a time.
+void installDeviceDispatch(const DeviceDispatch &dispatch);
+// Back to the loader entry points, if the device is the installed one
+void uninstallDeviceDispatch(VkDevice device);
+
+}  // namespace vinkan
+
+#endif
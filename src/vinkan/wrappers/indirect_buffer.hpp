@@ -0,0 +1,148 @@
+#ifndef VINKAN_INDIRECT_BUFFER_HPP
+#define VINKAN_INDIRECT_BUFFER_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "vinkan/wrappers/buffer.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
+
+namespace vinkan {
+
+template <typename T>
+concept IndirectCommandType =
+    std::is_same_v<T, VkDrawIndirectCommand> ||
+    std::is_same_v<T, VkDrawIndexedIndirectCommand> ||
+    std::is_same_v<T, VkDispatchIndirectCommand>;
+
+struct IndirectBufferInfo {
+  uint32_t maxCommandCount;
+  // Host visible to write the commands from the CPU, use device local memory
+  // with a storage usage when a shader generates them
+  VkMemoryPropertyFlags memoryPropertyFlags =
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+      VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+  VkBufferUsageFlags extraUsageFlags = 0;
+  // Adds a uint32_t draw count buffer for the *IndirectCount draws
+  bool withCountBuffer = false;
+};
+
+// Buffer of indirect commands, one instance per command so the command i
+// lives at i * sizeof(Command). Host visible buffers stay mapped.
+template <IndirectCommandType Command>
+class IndirectBuffer : public Buffer {
+ public:
+  IndirectBuffer(VkDevice device,
+                 VkPhysicalDeviceMemoryProperties deviceMemoryProperties,
+                 IndirectBufferInfo info)
+      : Buffer(device, deviceMemoryProperties,
+               BufferInfo{.instanceSize = sizeof(Command),
+                          .instanceCount = info.maxCommandCount,
+                          .usageFlags = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                        VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                                        info.extraUsageFlags,
+                          .sharingMode = {.value = VK_SHARING_MODE_EXCLUSIVE},
+                          .memoryPropertyFlags = info.memoryPropertyFlags}) {
+    assert(info.maxCommandCount > 0);
+    if (isHostVisible_(info.memoryPropertyFlags)) {
+      map();
+    }
+    if (info.withCountBuffer) {
+      countBuffer_ = std::make_unique<Buffer>(
+          device, deviceMemoryProperties,
+          BufferInfo{.instanceSize = sizeof(uint32_t),
+                     .instanceCount = 1,
+                     .usageFlags = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                   VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                                   info.extraUsageFlags,
+                     .sharingMode = {.value = VK_SHARING_MODE_EXCLUSIVE},
+                     .memoryPropertyFlags = info.memoryPropertyFlags});
+      if (isHostVisible_(info.memoryPropertyFlags)) {
+        countBuffer_->map();
+      }
+    }
+  }
+
+  void write(uint32_t index, const Command &command) {
+    assert(index < getInstanceCount());
+    writeToIndex((void *)&command, index);
+  }
+  void write(const std::vector<Command> &commands, uint32_t firstIndex = 0) {
+    assert(firstIndex + commands.size() <= getInstanceCount());
+    writeToBuffer((void *)commands.data(), commands.size() * sizeof(Command),
+                  firstIndex * sizeof(Command));
+  }
+  void writeCount(uint32_t count) {
+    assert(countBuffer_ && count <= getInstanceCount());
+    countBuffer_->writeToBuffer(&count);
+  }
+
+  static VkDeviceSize offsetOf(uint32_t index) {
+    return index * sizeof(Command);
+  }
+  uint32_t getMaxCommandCount() const { return getInstanceCount(); }
+  bool hasCountBuffer() const { return countBuffer_ != nullptr; }
+  Buffer &getCountBuffer() {
+    assert(countBuffer_);
+    return *countBuffer_;
+  }
+
+  // Without the multiDrawIndirect feature, drawCount can't exceed 1 and
+  // the draws are issued one by one
+  void cmdDraw(VkCommandBuffer commandBuffer, uint32_t firstCommand,
+               uint32_t drawCount, bool multiDrawIndirect = true)
+    requires(!std::is_same_v<Command, VkDispatchIndirectCommand>)
+  {
+    assert(firstCommand + drawCount <= getInstanceCount());
+    uint32_t callCount = multiDrawIndirect ? 1 : drawCount;
+    uint32_t drawsPerCall = multiDrawIndirect ? drawCount : 1;
+    for (uint32_t i = 0; i < callCount; i++) {
+      auto offset = offsetOf(firstCommand + i);
+      if constexpr (std::is_same_v<Command, VkDrawIndexedIndirectCommand>) {
+        deviceDispatch.vkCmdDrawIndexedIndirect(
+            commandBuffer, getHandle(), offset, drawsPerCall, sizeof(Command));
+      } else {
+        deviceDispatch.vkCmdDrawIndirect(commandBuffer, getHandle(), offset,
+                                         drawsPerCall, sizeof(Command));
+      }
+    }
+  }
+  // The GPU decides how many draws are launched (drawIndirectCount, core in
+  // Vulkan 1.2), at most maxDrawCount
+  void cmdDrawCount(VkCommandBuffer commandBuffer, uint32_t maxDrawCount)
+    requires(!std::is_same_v<Command, VkDispatchIndirectCommand>)
+  {
+    assert(countBuffer_ && maxDrawCount <= getInstanceCount());
+    if constexpr (std::is_same_v<Command, VkDrawIndexedIndirectCommand>) {
+      deviceDispatch.vkCmdDrawIndexedIndirectCount(
+          commandBuffer, getHandle(), 0, countBuffer_->getHandle(), 0,
+          maxDrawCount, sizeof(Command));
+    } else {
+      deviceDispatch.vkCmdDrawIndirectCount(commandBuffer, getHandle(), 0,
+                                            countBuffer_->getHandle(), 0,
+                                            maxDrawCount, sizeof(Command));
+    }
+  }
+  void cmdDispatch(VkCommandBuffer commandBuffer, uint32_t index = 0)
+    requires std::is_same_v<Command, VkDispatchIndirectCommand>
+  {
+    assert(index < getInstanceCount());
+    deviceDispatch.vkCmdDispatchIndirect(commandBuffer, getHandle(),
+                                         offsetOf(index));
+  }
+
+ private:
+  std::unique_ptr<Buffer> countBuffer_;
+
+  static bool isHostVisible_(VkMemoryPropertyFlags flags) {
+    return flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+  }
+};
+
+}  // namespace vinkan
+
+#endif
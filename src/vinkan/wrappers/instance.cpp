@@ -1,8 +1,6 @@
 #include "instance.hpp"
 
 #include <cstring>
-#include <iostream>
-#include <ostream>
 #include <stdexcept>
 #include <unordered_set>
 
@@ -17,7 +15,8 @@ debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
               VkDebugUtilsMessageTypeFlagsEXT messageType,
               const VkDebugUtilsMessengerCallbackDataEXT *pCallbackData,
               void *pUserData) {
-  std::cerr << "Validation layer:\n" << pCallbackData->pMessage << std::endl;
+  auto diagnostics = static_cast<vinkan::DiagnosticsSink *>(pUserData);
+  diagnostics->onMessage(messageSeverity, messageType, pCallbackData);
 
   return VK_FALSE;
 }
@@ -50,7 +49,8 @@ void destroyDebugUtilsMessengerEXT(VkInstance instance,
  **************/
 
 namespace vinkan {
-Instance::Instance(InstanceInfo &instanceInfo) {
+Instance::Instance(InstanceInfo &instanceInfo)
+    : allocator_(instanceInfo.allocator) {
   // Create app info
   VkApplicationInfo appInfo{};
   populateAppInfo_(instanceInfo, appInfo);
@@ -71,7 +71,7 @@ Instance::Instance(InstanceInfo &instanceInfo) {
   // Add the validation layers
   populateValidationLayers_(instanceInfo, createInfo);
 
-  if (vkCreateInstance(&createInfo, nullptr, &handle_) != VK_SUCCESS) {
+  if (vkCreateInstance(&createInfo, allocator_, &handle_) != VK_SUCCESS) {
     throw std::runtime_error("Could not create the vulkan instance");
   }
   SPDLOG_LOGGER_INFO(get_vinkan_logger(), "VkInstance created");
@@ -89,9 +89,9 @@ Instance::~Instance() {
   }
 
   if (debugMessenger_ != nullptr) {
-    destroyDebugUtilsMessengerEXT(handle_, debugMessenger_, nullptr);
+    destroyDebugUtilsMessengerEXT(handle_, debugMessenger_, allocator_);
   }
-  vkDestroyInstance(handle_, nullptr);
+  vkDestroyInstance(handle_, allocator_);
 }
 
 void Instance::populateValidationLayers_(InstanceInfo &instanceInfo,
@@ -214,13 +214,13 @@ void Instance::populateDebugMessengerCreateInfo_(
                            VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
                            VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
   createInfo.pfnUserCallback = debugCallback;
-  createInfo.pUserData = nullptr;  // Optional
+  createInfo.pUserData = &diagnostics_;
 }
 
 void Instance::setupDebugMessenger_() {
   VkDebugUtilsMessengerCreateInfoEXT createInfo;
   populateDebugMessengerCreateInfo_(createInfo);
-  if (createDebugUtilsMessengerEXT(handle_, &createInfo, nullptr,
+  if (createDebugUtilsMessengerEXT(handle_, &createInfo, allocator_,
                                    &debugMessenger_) != VK_SUCCESS) {
     throw std::runtime_error("failed to set up debug messenger!");
   }
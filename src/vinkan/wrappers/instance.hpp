@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "vinkan/generics/ptr_handle_wrapper.hpp"
+#include "vinkan/logging/diagnostics.hpp"
 
 namespace vinkan {
 
@@ -26,6 +27,9 @@ struct InstanceInfo {
   std::vector<const char *> validationLayers;
   bool includePortabilityExtensions;  // Needed to identify M-Series Mac GPU
   std::vector<const char *> &extraVkExtensions;
+  // Host allocations of the instance (e.g. HostAllocator::getCallbacks()),
+  // it must outlive the instance
+  const VkAllocationCallbacks *allocator = nullptr;
 };
 
 class Instance : public PtrHandleWrapper<VkInstance> {
@@ -36,8 +40,15 @@ class Instance : public PtrHandleWrapper<VkInstance> {
   Instance(const Instance &) = delete;
   Instance &operator=(const Instance &) = delete;
 
+  // Messages of the validation layers, when there are some
+  DiagnosticsSink &getDiagnostics() { return diagnostics_; }
+
+  const VkAllocationCallbacks *getAllocator() const { return allocator_; }
+
  private:
-  VkDebugUtilsMessengerEXT debugMessenger_;
+  const VkAllocationCallbacks *allocator_ = nullptr;
+  VkDebugUtilsMessengerEXT debugMessenger_ = nullptr;
+  DiagnosticsSink diagnostics_{};
 
   // Populate
   void prepareCreateInfo_(InstanceInfo &instanceInfo,
@@ -67,6 +67,57 @@ VkPhysicalDeviceMemoryProperties PhysicalDevice::getMemoryProperties() {
   return memProperties;
 }
 
+VkPhysicalDeviceLimits PhysicalDevice::getLimits() {
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(handle_, &properties);
+  return properties.limits;
+}
+
+VkPhysicalDeviceSubgroupProperties PhysicalDevice::getSubgroupProperties() {
+  VkPhysicalDeviceSubgroupProperties subgroupProperties{};
+  subgroupProperties.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+  VkPhysicalDeviceProperties2 properties{};
+  properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  properties.pNext = &subgroupProperties;
+  vkGetPhysicalDeviceProperties2(handle_, &properties);
+  subgroupProperties.pNext = nullptr;
+  return subgroupProperties;
+}
+
+bool PhysicalDevice::supportsFloat16Compute() {
+  VkPhysicalDeviceVulkan12Features features12{};
+  features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+  VkPhysicalDeviceVulkan11Features features11{};
+  features11.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+  features11.pNext = &features12;
+  VkPhysicalDeviceFeatures2 features{};
+  features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  features.pNext = &features11;
+  vkGetPhysicalDeviceFeatures2(handle_, &features);
+  return features12.shaderFloat16 == VK_TRUE &&
+         features11.storageBuffer16BitAccess == VK_TRUE;
+}
+
+bool PhysicalDevice::supportsFullComputeSubgroups() {
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(handle_, &properties);
+  if (properties.apiVersion < VK_API_VERSION_1_3 &&
+      !supportExtensions_(handle_,
+                          {VK_EXT_SUBGROUP_SIZE_CONTROL_EXTENSION_NAME})) {
+    return false;
+  }
+  VkPhysicalDeviceSubgroupSizeControlFeatures subgroupSizeControl{};
+  subgroupSizeControl.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_SIZE_CONTROL_FEATURES;
+  VkPhysicalDeviceFeatures2 features{};
+  features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  features.pNext = &subgroupSizeControl;
+  vkGetPhysicalDeviceFeatures2(handle_, &features);
+  return subgroupSizeControl.subgroupSizeControl == VK_TRUE &&
+         subgroupSizeControl.computeFullSubgroups == VK_TRUE;
+}
+
 bool PhysicalDevice::isSuitable_(VkPhysicalDevice physicalDevice,
                                  PhysicalDeviceInfo physicalDeviceInfo) const {
   VkPhysicalDeviceProperties physicalDeviceProperties;
@@ -29,6 +29,16 @@ class PhysicalDevice : public PtrHandleWrapper<VkPhysicalDevice> {
   SurfaceSupportDetails getSurfaceSupportDetails();
   std::vector<QueueFamilyInfo> getQueues();
   VkPhysicalDeviceMemoryProperties getMemoryProperties();
+  // E.g. maxComputeWorkGroupCount to size the dispatches
+  VkPhysicalDeviceLimits getLimits();
+  // Subgroup size and the subgroup operations supported per stage
+  VkPhysicalDeviceSubgroupProperties getSubgroupProperties();
+  // shaderFloat16 and storageBuffer16BitAccess, see
+  // Device::Builder::enableFloat16Compute
+  bool supportsFloat16Compute();
+  // subgroupSizeControl and computeFullSubgroups (core in Vulkan 1.3), see
+  // Device::Builder::enableFullComputeSubgroups
+  bool supportsFullComputeSubgroups();
 
  private:
   bool withSurfaceSupport = false;
@@ -56,6 +56,10 @@ struct SubpassInfo {
   std::optional<T> depthStencilAttachment = std::nullopt;
   VkPipelineStageFlags dstStage;
   VkAccessFlags dstFlags;
+  // What the subpass waits on, deduced from the attachments written by the
+  // previous subpass when left to 0 (or from outside for the first one)
+  VkPipelineStageFlags srcStage = 0;
+  VkAccessFlags srcFlags = 0;
 };
 
 struct InternalSubpassInfo {
@@ -99,11 +103,34 @@ class RenderPass<T>::Builder {
 
     VkSubpassDependency dependency{};
     if (subpassDependencies_.size() == 0) {
+      // From outside: uploads and the swapchain image acquisition (waited at
+      // the color attachment output stage)
       dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
       dependency.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-      dependency.srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+      dependency.srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT |
+                                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     } else {
-      dependency.dstSubpass = subpasses_.size() - 2;
+      // From the attachments written by the previous subpass
+      auto &previous = intSubpassInfo_[intSubpassInfo_.size() - 2];
+      dependency.srcSubpass = subpasses_.size() - 2;
+      if (!previous.colorAttachments.empty()) {
+        dependency.srcStageMask |=
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependency.srcAccessMask |= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+      }
+      if (previous.depthAttachment.has_value()) {
+        dependency.srcStageMask |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                   VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependency.srcAccessMask |=
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+      }
+      if (dependency.srcStageMask == 0) {
+        dependency.srcStageMask = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT;
+      }
+    }
+    if (subpassInfo.srcStage != 0) {
+      dependency.srcStageMask = subpassInfo.srcStage;
+      dependency.srcAccessMask = subpassInfo.srcFlags;
     }
     dependency.dstSubpass = subpasses_.size() - 1;
     dependency.dstStageMask = subpassInfo.dstStage;
@@ -4,6 +4,7 @@
 #include <stdexcept>
 
 #include "vinkan/logging/logger.hpp"
+#include "vinkan/wrappers/device_dispatch.hpp"
 
 namespace vinkan {
 Swapchain::Swapchain(SwapchainInfo swapchainInfo)
@@ -84,7 +85,7 @@ void Swapchain::present(uint32_t imageIndex, VkQueue presentQueue,
   auto uImageIndex = static_cast<uint32_t>(imageIndex);
   presentInfo.pImageIndices = &uImageIndex;
 
-  vkQueuePresentKHR(presentQueue, &presentInfo);
+  deviceDispatch.vkQueuePresentKHR(presentQueue, &presentInfo);
 }
 
 std::vector<VkImageView> Swapchain::getImageViews() {
@@ -121,7 +122,7 @@ std::vector<VkImageView> Swapchain::getImageViews() {
 std::optional<uint32_t> Swapchain::acquireNextImageIndex(
     VkSemaphore semaphoreToSignal, VkFence fenceToSignal) {
   uint32_t imageIndex;
-  VkResult result = vkAcquireNextImageKHR(
+  VkResult result = deviceDispatch.vkAcquireNextImageKHR(
       device_, handle_, std::numeric_limits<uint64_t>::max(), semaphoreToSignal,
       fenceToSignal, &imageIndex);
   if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR) {